@@ -18,6 +18,7 @@
 #define DIVISOR "  |  "
 #define DIVISOR_LENGTH 5
 #define EXIT_CODE -99
+#define LOAD_BATCH_SIZE 1000        // Number of tuples inserted by one call of rm->insertTuples during load
 
 CLI * CLI::_cli = 0;
 
@@ -256,6 +257,7 @@ RC CLI::process(const std::string input)
     ////////////////////////////////////////////
     // print <tableName>
     // print attributes <tableName>
+    // print iostats <tableName>
     ////////////////////////////////////////////
     else if (expect(tokenizer, "print")) {
       tokenizer = next();
@@ -263,6 +265,8 @@ RC CLI::process(const std::string input)
         code = printAttributes();
       else if (expect(tokenizer, "index"))
         code = printIndex();
+      else if (expect(tokenizer, "iostats"))
+        code = printIOStats();
       else if (tokenizer != NULL)
         code = printTable(string(tokenizer));
       else
@@ -640,7 +644,7 @@ bool CLI::isIterator(const string token, int &code) {
 }
 
 RC CLI::run(Iterator *it) {
-  void *data = malloc(PAGE_SIZE);
+  void *data = malloc(MAX_PAGE_SIZE);
   vector<Attribute> attrs;
   vector<string> outputBuffer;
   it->getAttributes(attrs);
@@ -717,7 +721,7 @@ RC CLI::createCondition(const string tableName, Condition &condition, const bool
 
   Value value;
   value.type = attr.type;
-  value.data = malloc(PAGE_SIZE);
+  value.data = malloc(MAX_PAGE_SIZE);
   token = next();
   attribute = string(token);
 
@@ -953,7 +957,7 @@ RC CLI::addAttribute()
   // Set up the iterator
   RM_ScanIterator rmsi;
   RID rid;
-  void *data_returned = malloc(PAGE_SIZE);
+  void *data_returned = malloc(MAX_PAGE_SIZE);
 
   // convert attributes to vector<string>
   vector<string> stringAttributes;
@@ -1007,7 +1011,7 @@ RC CLI::dropTable()
   // Set up the iterator
   Attribute attr;
   RM_ScanIterator rmsi;
-  void *data_returned = malloc(PAGE_SIZE);
+  void *data_returned = malloc(MAX_PAGE_SIZE);
 
   // convert attributes to vector<string>
   vector<string> stringAttributes;
@@ -1167,7 +1171,7 @@ RC CLI::load()
   this->getAttributesFromCatalog(tableName, attributes);
   uint offset = 0, index = 0, keyIndex = 0;
   uint length;
-  void *buffer = malloc(PAGE_SIZE);
+  void *buffer = malloc(MAX_PAGE_SIZE);
   void *key = malloc(PAGE_SIZE);
   RID rid;
 
@@ -1189,6 +1193,7 @@ RC CLI::load()
 
   string line, token;
   char * tokenizer;
+  vector<const void *> tuples;
   while (ifs.good()) {
     getline(ifs, line);
     if (line.compare("") == 0)
@@ -1238,7 +1243,11 @@ RC CLI::load()
       if (keyIndex == attributes.size())
         keyIndex = 0;
     }
-    if (this->insertTupleToDB(tableName, attributes, buffer, indexMap) != 0) {
+    // tuples are inserted in batches
+    void *tuple = malloc(offset);
+    memcpy(tuple, buffer, offset);
+    tuples.push_back(tuple);
+    if (tuples.size() == LOAD_BATCH_SIZE && this->insertTuplesToDB(tableName, tuples) != 0) {
       return error("error while inserting tuple");
     }
 
@@ -1247,6 +1256,10 @@ RC CLI::load()
     // for (std::vector<Attribute>::iterator it = attrs.begin() ; it != attrs.end(); ++it)
     // totalLength += it->length;
   }
+  if (this->insertTuplesToDB(tableName, tuples) != 0) {
+    return error("error while inserting tuple");
+  }
+
   // clear up indexMap
   for (auto it=indexMap.begin(); it != indexMap.end(); ++it) {
     free (it->second);
@@ -1275,8 +1288,8 @@ RC CLI::insertTuple() {
   this->getAttributesFromCatalog(tableName, attributes);
   int offset = 0, index = 0;
   int length;
-  void *buffer = malloc(PAGE_SIZE);
-  memset(buffer, 0, PAGE_SIZE);
+  void *buffer = malloc(MAX_PAGE_SIZE);
+  memset(buffer, 0, MAX_PAGE_SIZE);
   void *key = malloc(PAGE_SIZE);
   RID rid;
 
@@ -1357,6 +1370,22 @@ RC CLI::insertTupleToDB(const string tableName, const vector<Attribute> attribut
   return 0;
 }
 
+RC CLI::insertTuplesToDB(const string tableName, vector<const void *> &tuples) {
+  vector<RID> rids;
+
+  // insert data to given table (tuples are freed either way)
+  RC rc = tuples.empty() ? 0 : rm->insertTuples(tableName, tuples, rids);
+
+  for (uint i = 0; i < tuples.size(); i++)
+    free((void *) tuples[i]);
+  tuples.clear();
+
+  if (rc != 0)
+    return error("error CLI::insertTuples in rm->insertTuples");
+
+  return 0;
+}
+
 RC CLI::printAttributes()
 {
   char * tokenizer = next();
@@ -1417,6 +1446,85 @@ RC CLI::printIndex() {
   return this->printOutputBuffer(outputBuffer, 2);
 }
 
+// nanoseconds as microseconds with one decimal
+static string toMicros(unsigned long long nanos)
+{
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%.1f", nanos / 1000.0);
+  return string(buffer);
+}
+
+// print I/O statistics of the file of given tableName: latency of page calls (including buffer pool) and of transfers
+// to/from the OS file, followed by distances between consecutive transfers
+RC CLI::printIOStats()
+{
+  char * tokenizer = next();
+  if (tokenizer == NULL)
+    return error ("I expect tableName to print its I/O statistics");
+
+  string tableName = string(tokenizer);
+  vector<Attribute> attributes;
+  if (this->getAttributesFromCatalog(tableName, attributes) != 0)
+    return error ("table: " + tableName + " does not exist");
+
+  // file that has not been opened by this process has no statistics yet, so it is all zeros
+  IOStats callStats, ioStats;
+  PagedFileManager::instance()->collectIOStats(tableName.c_str(), callStats, ioStats);
+
+  const char * kinds[IO_NUM_KINDS] = {"read", "write", "append"};
+  IOStats * stats[2] = {&callStats, &ioStats};
+  const char * sources[2] = {"calls", "file"};
+
+  vector<string> outputBuffer;
+  outputBuffer.push_back("source");
+  outputBuffer.push_back("op");
+  outputBuffer.push_back("count");
+  outputBuffer.push_back("mean(us)");
+  outputBuffer.push_back("p50(us)");
+  outputBuffer.push_back("p99(us)");
+  outputBuffer.push_back("max(us)");
+
+  for (uint i = 0; i < 2; i++) {
+    for (uint j = 0; j < IO_NUM_KINDS; j++) {
+      IOHistogram &latency = stats[i]->_latency[j];
+      outputBuffer.push_back(sources[i]);
+      outputBuffer.push_back(kinds[j]);
+      outputBuffer.push_back(to_string(latency.getCount()));
+      outputBuffer.push_back(toMicros((unsigned long long)latency.getMean()));
+      outputBuffer.push_back(toMicros(latency.getPercentile(50)));
+      outputBuffer.push_back(toMicros(latency.getPercentile(99)));
+      outputBuffer.push_back(toMicros(latency.getMax()));
+    }
+  }
+
+  RC rc = this->printOutputBuffer(outputBuffer, 7);
+  if (rc != 0)
+    return rc;
+
+  // seek distance in bytes; transfers at distance 0 are sequential
+  outputBuffer.clear();
+  outputBuffer.push_back("source");
+  outputBuffer.push_back("bytes read");
+  outputBuffer.push_back("bytes written");
+  outputBuffer.push_back("sequential");
+  outputBuffer.push_back("seeks");
+  outputBuffer.push_back("seek p50");
+  outputBuffer.push_back("seek p99");
+
+  for (uint i = 0; i < 2; i++) {
+    IOHistogram &distance = stats[i]->_seekDistance;
+    outputBuffer.push_back(sources[i]);
+    outputBuffer.push_back(to_string(stats[i]->_bytesRead));
+    outputBuffer.push_back(to_string(stats[i]->_bytesWritten));
+    outputBuffer.push_back(to_string(distance._buckets[0]));
+    outputBuffer.push_back(to_string(distance.getCount() - distance._buckets[0]));
+    outputBuffer.push_back(to_string(distance.getPercentile(50)));
+    outputBuffer.push_back(to_string(distance.getPercentile(99)));
+  }
+
+  return this->printOutputBuffer(outputBuffer, 7);
+}
+
 // print every tuples in given tableName
 RC CLI::printTable(const string tableName)
 {
@@ -1485,6 +1593,7 @@ RC CLI::help(const string input)
     cout << "\tprint <tableName>: print every record in tableName" << endl;
     cout << "\tprint attributes <tableName>: print columns of given tableName" << endl;
     cout << "\tprint index <attributeName> on <tableName>: print columns of given tableName" << endl;
+    cout << "\tprint iostats <tableName>: print latency, bytes and seek distance of page reads/writes of given tableName" << endl;
   }
   else if (input.compare("load") == 0) {
     cout << "\tload <tableName> \"fileName\"";
@@ -1701,7 +1810,7 @@ bool CLI::checkAttribute(const string tableName, const string columnName, RID &r
 
   // Set up the iterator
   RM_ScanIterator rmsi;
-  void *data_returned = malloc(PAGE_SIZE);
+  void *data_returned = malloc(MAX_PAGE_SIZE);
 
   // convert attributes to vector<string>
   vector<string> stringAttributes;
@@ -55,6 +55,7 @@ private:
   RC printTable(const string tableName);
   RC printAttributes();
   RC printIndex();
+  RC printIOStats();
   RC help(const string input);
   RC history();
 
@@ -103,6 +104,7 @@ private:
   RC printOutputBuffer(vector<string> &buffer, uint mod);
   RC updateOutputBuffer(vector<string> &buffer, void *data, vector<Attribute> &attrs);
   RC insertTupleToDB(const string tableName, const vector<Attribute> attributes, const void *data, unordered_map<int, void *> indexMap);
+  RC insertTuplesToDB(const string tableName, vector<const void *> &tuples);
   RC getAttribute(const string name, const vector<Attribute> pool, Attribute &attr);
 
   RelationManager * rm;
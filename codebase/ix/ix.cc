@@ -1544,6 +1544,70 @@ RC PFMExtension::getTuple(void* tuple, BUCKET_NUMBER bkt_number, const unsigned
 	return errCode;
 }
 
+RC PFMExtension::getTuple(const void*& tuple, unsigned int& tupleLength, const BUCKET_NUMBER bkt_number, const PageNum pageNumber, const int slotNumber)
+{
+	RC errCode = 0;
+
+	const void* page = NULL;
+
+	//memory-mapped bucket file: take page straight from the mapping (no need to touch cached page)
+	const FileHandle& handle = ( pageNumber > 0 ? _handle->_overBucketDataFileHandler : _handle->_primBucketDataFileHandler );
+	PageNum physicalPageNumber = 0;
+
+	if( handle._ioMode != IO_MMAP ||
+		translateVirtualToPhysical(physicalPageNumber, bkt_number, pageNumber) != 0 ||
+		handle.readMappedPage(physicalPageNumber, page) != 0 )
+	{
+		//if necessary read in the page (same as in the copying version)
+		if( pageNumber != _curVirtualPage || _bktNumber != bkt_number )
+		{
+			//write the current page to some (primary or overflow depending on the current virtual page number) file
+			if( (errCode = writePage(bkt_number, _curVirtualPage)) != 0 )
+			{
+				return errCode;
+			}
+
+			//read data page
+			if( (errCode = getPage(bkt_number, pageNumber, _buffer)) != 0 )
+			{
+				return errCode;
+			}
+
+			_curVirtualPage = pageNumber;
+			_bktNumber = bkt_number;
+		}
+
+		page = _buffer;
+	}
+
+	//get pointer to the end of directory slots (page format is described in the copying version)
+	const PageDirSlot* ptrEndOfDirSlot = (const PageDirSlot*)((const char*)page + PAGE_SIZE - 2 * sizeof(unsigned int));
+
+	//find out number of directory slots
+	unsigned int numSlots = *((const unsigned int*)ptrEndOfDirSlot);
+
+	//check if rid is correct in terms of indexed slot
+	if( slotNumber >= (int)numSlots )
+	{
+		return -23; //rid is not setup correctly
+	}
+
+	//get slot
+	const PageDirSlot* curSlot = ptrEndOfDirSlot - slotNumber - 1;
+
+	//check if slot attributes make sense
+	if( curSlot->_offRecord == 0 && curSlot->_szRecord == 0 )
+	{
+		return -24;	//directory slot stores wrong information
+	}
+
+	tuple = (const char*)page + curSlot->_offRecord;
+	tupleLength = curSlot->_szRecord;
+
+	//return success
+	return errCode;
+}
+
 //startingInPageNumber is a virtual page number
 RC PFMExtension::shiftRecordsToStart //TESTED, seems to work
 	(const BUCKET_NUMBER bkt_number, const PageNum startingInPageNumber, const int startingFromSlotNumber)
@@ -2152,8 +2216,13 @@ RC PFMExtension::addPage(const void* dataPage, const BUCKET_NUMBER bkt_number)	/
 	}
 	else
 	{
-		//add a page to the overflow file
-		_handle->_overBucketDataFileHandler.appendPage(buf);
+		//add a page to the overflow file (page freed by an earlier merge is re-used, before the file grows)
+		PageNum overflowPageId = 0;
+		if( (errCode = PagedFileManager::instance()->allocatePage(_handle->_overBucketDataFileHandler, buf, overflowPageId)) != 0 )
+		{
+			free(buf);
+			return errCode;
+		}
 		_handle->_overBucketDataFileHandler.writeBackNumOfPages();
 
 		int newOrderValue = 0;
@@ -2179,7 +2248,7 @@ RC PFMExtension::addPage(const void* dataPage, const BUCKET_NUMBER bkt_number)	/
 
 		//insert an entry
 		_handle->_info->_overflowPageIds[bkt_number].insert(
-				std::pair<int, unsigned int>(newOrderValue, _handle->_overBucketDataFileHandler._info->_numPages - 1 ) );
+				std::pair<int, unsigned int>(newOrderValue, overflowPageId ) );
 	}
 
 	//deallocate buffer
@@ -2223,8 +2292,18 @@ RC PFMExtension::removePage(const BUCKET_NUMBER bkt_number, const PageNum pageNu
 		return -44;
 	}
 
-	//remove its record
-	_handle->_info->_overflowPageIds[bkt_number].erase( pageNumber - 1 );
+	//return the page to the allocation map of the overflow file, so that it is re-used by the next overflow page
+	std::map<int, PageNum>::iterator pageIter = _handle->_info->_overflowPageIds[bkt_number].find( pageNumber - 1 );
+	if( pageIter != _handle->_info->_overflowPageIds[bkt_number].end() )
+	{
+		if( (errCode = PagedFileManager::instance()->freePage(_handle->_overBucketDataFileHandler, pageIter->second)) != 0 )
+		{
+			return errCode;
+		}
+
+		//remove its record
+		_handle->_info->_overflowPageIds[bkt_number].erase( pageIter );
+	}
 
 	return errCode;
 }
@@ -2369,6 +2448,13 @@ RC PFMExtension::insertTuple(void* tupleData, unsigned int tupleLength, const BU
 
 	unsigned int numPagesInOverflowFile = _handle->_overBucketDataFileHandler.getNumberOfPages();
 
+	//number of pages in the bucket (overflow file does not grow, when its free page is re-used by the bucket)
+	PageNum numPagesInBucket = 0, numPagesInBucketAfter = 0;
+	if( (errCode = numOfPages(bkt_number, numPagesInBucket)) != 0 )
+	{
+		return errCode;
+	}
+
 	if( pageNumber + 1 > numPagesInOverflowFile )
 	{
 		newPage = true;
@@ -2393,7 +2479,12 @@ RC PFMExtension::insertTuple(void* tupleData, unsigned int tupleLength, const BU
 		return errCode;
 	}
 
-	if( numPagesInOverflowFile < _handle->_overBucketDataFileHandler.getNumberOfPages() )
+	if( (errCode = numOfPages(bkt_number, numPagesInBucketAfter)) != 0 )
+	{
+		return errCode;
+	}
+
+	if( numPagesInBucket < numPagesInBucketAfter )
 	{
 		newPage = true;
 	}
@@ -192,6 +192,9 @@ public:
 	RC getPage(const BUCKET_NUMBER bkt_number, const PageNum pageNumber, void* buffer);
 	RC getPage(const BUCKET_NUMBER bkt_number, const PageNum pageNumber);
 	RC getTuple(void* tuple, const BUCKET_NUMBER bkt_number, const PageNum pageNumber, const int slotNumber);
+	//same as above, but without copying: tuple points into the bucket page (mapping of IO_MMAP bucket file, otherwise
+	//the page cached by this object, which stays valid until the next call that loads another page)
+	RC getTuple(const void*& tuple, unsigned int& tupleLength, const BUCKET_NUMBER bkt_number, const PageNum pageNumber, const int slotNumber);
 	RC shiftRecordsToStart(
 			const BUCKET_NUMBER bkt_number, const PageNum startingInPageNumber, const int startingFromSlotNumber);
 	RC shiftRecordsToEnd(
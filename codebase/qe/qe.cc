@@ -242,7 +242,7 @@ RC Project::getNextTuple(void *data) {
 	 * All tuples are candidates to project, then get all of them and one at a time and return its fields
 	 */
 	int errCode = 0;
-	void *tuple = malloc(PAGE_SIZE);	//this function eventually calls RM.getNextEntry and RM expects that passed data buffer has
+	void *tuple = malloc(MAX_PAGE_SIZE);	//this function eventually calls RM.getNextEntry and RM expects that passed data buffer has
 										//pre-allocated space (for safety reasons it is usually page size => so that it would not overflow)
 	if ((errCode = iterator->getNextTuple(tuple)) != 0) { //get next tuple
 		return errCode;
@@ -662,18 +662,33 @@ GHJoin::GHJoin(Iterator *leftIn, Iterator *rightIn, const Condition &condition,
 		leftPartitions.push_back(fileHandle);
 	}
 
-	void *tuple = malloc(PAGE_SIZE); //this function eventually calls RM.getNextEntry and RM expects that passed data buffer has
+	void *tuple = malloc(MAX_PAGE_SIZE); //this function eventually calls RM.getNextEntry and RM expects that passed data buffer has
 									 //pre-allocated space (for safety reasons it is usually page size => so that it would not overflow)
 
 	unsigned hash_value;
-	RID rid;
+
+	//output buffers of the partitions
+	vector< vector<const void*> > buffers(numPartitions);
+	vector<unsigned> bufferSizes(numPartitions, 0);
 
 	while (leftIn->getNextTuple(tuple) != QE_EOF) { //get next tuple
 		getFieldTuple(tuple, leftValue, leftAttrs, leftPosition); // get the field to apply the hash function
 		hash_value = (_index_manager->hash(leftAttrs[leftPosition], leftValue))
 				% numPartitions; //get the bucker number
-		if ((errCode = _rbfm->insertRecord(leftPartitions[hash_value],
-				leftAttrs, tuple, rid)) != 0) { // insert the tuple into the bucket
+		unsigned tupleSize = sizeOfRecord(leftAttrs, tuple);
+		void *bufferedTuple = malloc(tupleSize);
+		memcpy(bufferedTuple, tuple, tupleSize);
+		buffers[hash_value].push_back(bufferedTuple); // put the tuple into the output buffer of the bucket
+		bufferSizes[hash_value] += tupleSize;
+		if (bufferSizes[hash_value] >= GHJ_PARTITION_BUFFER_SIZE &&
+				(errCode = flushPartition(leftPartitions[hash_value], leftAttrs, buffers[hash_value], bufferSizes[hash_value])) != 0) {
+			cout << "Error: " << errCode << endl;
+		}
+	}
+
+	//flush output buffers of the left partitions
+	for (unsigned i = 0; i < numPartitions; i++) {
+		if ((errCode = flushPartition(leftPartitions[i], leftAttrs, buffers[i], bufferSizes[i])) != 0) {
 			cout << "Error: " << errCode << endl;
 		}
 	}
@@ -716,8 +731,19 @@ GHJoin::GHJoin(Iterator *leftIn, Iterator *rightIn, const Condition &condition,
 		getFieldTuple(tuple, rightValue, rightAttrs, rightPosition); // get the field to apply the hash function
 		hash_value = (_index_manager->hash(rightAttrs[rightPosition],
 				rightValue)) % numPartitions; //get the bucker number
-		_rbfm->insertRecord(rightPartitions[hash_value], rightAttrs, tuple,
-				rid); // insert the tuple into the bucket
+		unsigned tupleSize = sizeOfRecord(rightAttrs, tuple);
+		void *bufferedTuple = malloc(tupleSize);
+		memcpy(bufferedTuple, tuple, tupleSize);
+		buffers[hash_value].push_back(bufferedTuple); // put the tuple into the output buffer of the bucket
+		bufferSizes[hash_value] += tupleSize;
+		if (bufferSizes[hash_value] >= GHJ_PARTITION_BUFFER_SIZE) {
+			flushPartition(rightPartitions[hash_value], rightAttrs, buffers[hash_value], bufferSizes[hash_value]);
+		}
+	}
+
+	//flush output buffers of the right partitions
+	for (unsigned i = 0; i < numPartitions; i++) {
+		flushPartition(rightPartitions[i], rightAttrs, buffers[i], bufferSizes[i]);
 	}
 
 	//set list of final attributes
@@ -726,6 +752,25 @@ GHJoin::GHJoin(Iterator *leftIn, Iterator *rightIn, const Condition &condition,
 
 }
 
+RC GHJoin::flushPartition(FileHandle &partition, const vector<Attribute> &attrs, vector<const void*> &buffer, unsigned &bufferSize) {
+	RC errCode = 0;
+
+	//write the whole output buffer into the partition
+	vector<RID> rids;
+	if (buffer.empty() == false) {
+		errCode = _rbfm->insertRecords(partition, attrs, buffer, rids);
+	}
+
+	//empty the buffer
+	for (unsigned i = 0; i < buffer.size(); i++) {
+		free((void *) buffer[i]);
+	}
+	buffer.clear();
+	bufferSize = 0;
+
+	return errCode;
+}
+
 GHJoin::~GHJoin() {
 	delete _hashTable;
 }
@@ -805,8 +850,6 @@ RC GHJoin::loadNextPartition() {
 	}
 
 	//create hash table
-	RID rid;
-	void *returnedData = malloc(PAGE_SIZE);
 	_hashTable = new inMemoryHashTable(_outerAttrs[_outerPosition].type, _outerAttrs);
 	_hashTable->clearTable();
 
@@ -821,21 +864,25 @@ RC GHJoin::loadNextPartition() {
 	NULL, outer_projected_attrs, rsi)) != 0)
 		return errCode;
 
-	while (rsi.getNextRecord(rid, returnedData) != RM_EOF) {
-		//determine position of the field on which to join
-		int offset = 0;
-		if ((errCode = getOffsetToProperField(returnedData, _outerAttrs,
-				_outerAttrs[_outerPosition], offset)) != 0) {
-			free(returnedData);
+	//partition is read in batches (each page of it is read once)
+	RecordBatch batch;
+	while ((errCode = rsi.getNextBatch(batch)) != RBFM_EOF) {
+		if (errCode != 0)
 			return errCode;
-		}
 
-		//determine size of the record
-		int length = sizeOfRecord(_outerAttrs, returnedData);
+		for (unsigned i = 0; i < batch.getNumRecords(); i++) {
+			//determine position of the field on which to join
+			int offset = 0;
+			if ((errCode = getOffsetToProperField(batch.getRecord(i), _outerAttrs,
+					_outerAttrs[_outerPosition], offset)) != 0) {
+				return errCode;
+			}
 
-		//insert record into hash table
-		_hashTable->insertRecord(returnedData, offset, length);
+			//insert record into hash table (batch already knows size of the record)
+			_hashTable->insertRecord(batch.getRecord(i), offset, batch.getRecordSize(i));
+		}
 	}
+	errCode = 0;
 
 
 
@@ -864,8 +911,8 @@ RC GHJoin::getNextTuple(void *data) {
 	}
 
 	//allocate buffer for iterated record
-	void* recordBuf = malloc(PAGE_SIZE);
-	memset(recordBuf, 0, PAGE_SIZE);
+	void* recordBuf = malloc(MAX_PAGE_SIZE);
+	memset(recordBuf, 0, MAX_PAGE_SIZE);
 	RID rid;
 
 	while (true) {
@@ -902,8 +949,8 @@ RC GHJoin::getNextTuple(void *data) {
 		void* ptr = (char*) recordBuf + offset;
 
 		//records
-		void* recordData = malloc(PAGE_SIZE);
-		memset(recordData, 0, PAGE_SIZE);
+		void* recordData = malloc(MAX_PAGE_SIZE);
+		memset(recordData, 0, MAX_PAGE_SIZE);
 		unsigned int lengthOuter = 0;
 
 		//check if this record is in hash table
@@ -1067,8 +1114,8 @@ RC BNLJoin::loadNextBlock()
 	int curTupleNum = 0;
 
 	//allocate buffer for iterated record
-	void* data = malloc(PAGE_SIZE);
-	memset(data, 0, PAGE_SIZE);
+	void* data = malloc(MAX_PAGE_SIZE);
+	memset(data, 0, MAX_PAGE_SIZE);
 
 	//populate block until either maximum number of records per block is reached OR outer iterator is exhausted
 	while( curTupleNum < _blockSize )
@@ -1111,8 +1158,8 @@ BNLJoin::~BNLJoin() {
 
 RC BNLJoin::getNextTuple(void *data) {
 	//allocate buffer for iterated record
-	void* recordBuf = malloc(PAGE_SIZE);
-	memset(recordBuf, 0, PAGE_SIZE);
+	void* recordBuf = malloc(MAX_PAGE_SIZE);
+	memset(recordBuf, 0, MAX_PAGE_SIZE);
 
 	RC errCode = 0;
 
@@ -1156,8 +1203,8 @@ RC BNLJoin::getNextTuple(void *data) {
 		void* ptr = (char*)recordBuf + offset;
 
 		//records
-		void* recordData = malloc(PAGE_SIZE);
-		memset(recordData, 0, PAGE_SIZE);
+		void* recordData = malloc(MAX_PAGE_SIZE);
+		memset(recordData, 0, MAX_PAGE_SIZE);
 		unsigned int lengthOuter = 0;
 
 		//check if this record is in hash table
@@ -1252,10 +1299,10 @@ RC INLJoin::getNextTuple(void *data) {
 	RC result; //useful for join query result
 
 	//allocate buffer for both part of the hand (outer and inner)
-	void* leftTuple = malloc(PAGE_SIZE);
-	memset(leftTuple, 0, PAGE_SIZE);
-	void* rightTuple = malloc(PAGE_SIZE);
-	memset(rightTuple, 0, PAGE_SIZE);
+	void* leftTuple = malloc(MAX_PAGE_SIZE);
+	memset(leftTuple, 0, MAX_PAGE_SIZE);
+	void* rightTuple = malloc(MAX_PAGE_SIZE);
+	memset(rightTuple, 0, MAX_PAGE_SIZE);
 
 	do{
 		//get the first tuple of left hand
@@ -1467,8 +1514,8 @@ Aggregate::Aggregate(Iterator *input, Attribute aggAttr, Attribute groupAttr,
 	}
 
 	//loop thru input index
-	void* buffer = malloc(PAGE_SIZE);
-	memset(buffer, 0, PAGE_SIZE);
+	void* buffer = malloc(MAX_PAGE_SIZE);
+	memset(buffer, 0, MAX_PAGE_SIZE);
 
 	RC errCode = 0;
 	RecordBasedFileManager* rbfm = RecordBasedFileManager::instance();
@@ -1530,8 +1577,8 @@ Aggregate::Aggregate(Iterator *input, Attribute aggAttr, Attribute groupAttr,
 
 		//iterate over the records to find one with the same group-by attribute
 		RID recRid;
-		void* recBuf = malloc(PAGE_SIZE);
-		memset(recBuf, 0, PAGE_SIZE);
+		void* recBuf = malloc(MAX_PAGE_SIZE);
+		memset(recBuf, 0, MAX_PAGE_SIZE);
 		bool recordIsFound = false;
 		while( it.getNextRecord(recRid, recBuf) == 0 )
 		{
@@ -1875,8 +1922,8 @@ RC Aggregate::next_basic(void* data)
 		inMemValues.push_back(elem);
 	}
 
-	void* buffer = malloc(PAGE_SIZE);
-	memset(buffer, 0, PAGE_SIZE);
+	void* buffer = malloc(MAX_PAGE_SIZE);
+	memset(buffer, 0, MAX_PAGE_SIZE);
 
 	//loop thru iterator and change in-memory values
 	while( _inputStream->getNextTuple(buffer) == 0 )
@@ -1983,8 +2030,8 @@ RC Aggregate::next_groupBy(void* data)
 
 	//iterate over the records to find one with the same group-by attribute
 	RID recRid;
-	void* recBuf = malloc(PAGE_SIZE);
-	memset(recBuf, 0, PAGE_SIZE);
+	void* recBuf = malloc(MAX_PAGE_SIZE);
+	memset(recBuf, 0, MAX_PAGE_SIZE);
 	bool recordIsFound = false;
 
 	//keep looping until either get a record or find an end
@@ -2006,7 +2053,7 @@ RC Aggregate::next_groupBy(void* data)
 			}
 
 			//clean up record buffer
-			memset(recBuf, 0 , PAGE_SIZE);
+			memset(recBuf, 0, MAX_PAGE_SIZE);
 		}
 	}
 
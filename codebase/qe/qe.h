@@ -269,6 +269,9 @@ public:
 
 };
 
+//size of the output buffer of each partition (tuples are inserted into the partition once its buffer fills)
+#define GHJ_PARTITION_BUFFER_SIZE (4 * PAGE_SIZE)
+
 class GHJoin : public Iterator {
     // Grace hash join operator
     public:
@@ -286,6 +289,7 @@ class GHJoin : public Iterator {
     private:
       RC loadNextPartition();
       RC cleanUp();
+      RC flushPartition(FileHandle &partition, const vector<Attribute> &attrs, vector<const void*> &buffer, unsigned &bufferSize);
 
     private:
       RecordBasedFileManager* _rbfm; //necessary to create partitions
@@ -0,0 +1,331 @@
+#include "allocmap.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <algorithm>
+
+PageAllocMap::PageAllocMap(const unsigned int pageSize)
+: _numPagesPerMapPage((pageSize - offsetof(AllocMapPage, _bits)) * 8), _pageSize(pageSize)
+{
+}
+
+PageAllocMap::~PageAllocMap()
+{
+	//do nothing
+}
+
+RC PageAllocMap::build(FileHandle& fileHandle)
+{
+	RC errCode = 0;
+
+	//reset
+	_freePages.clear();
+	_mapPageIds.clear();
+
+	void* data = malloc(_pageSize);
+
+	//chain of the map starts at the first header page
+	if( (errCode = fileHandle.readPage(0, data)) != 0 )
+	{
+		free(data);
+		return errCode;
+	}
+
+	PageNum numPages = fileHandle.getNumberOfPages();
+	PageNum mapPageId = ((Header*)data)->_allocMapPageId;
+
+	//loop thru map pages
+	while( mapPageId > 0 )
+	{
+		//guard against corrupted chain (cycle, or page beyond the end of file)
+		if( mapPageId >= numPages || isMapPage(mapPageId) )
+		{
+			_freePages.clear();
+			_mapPageIds.clear();
+			free(data);
+			return -11;
+		}
+
+		if( (errCode = fileHandle.readPage(mapPageId, data)) != 0 )
+		{
+			_freePages.clear();
+			_mapPageIds.clear();
+			free(data);
+			return errCode;
+		}
+
+		AllocMapPage* mapPage = (AllocMapPage*)data;
+		PageNum firstPage = _mapPageIds.size() * _numPagesPerMapPage;
+		_mapPageIds.push_back(mapPageId);
+
+		//collect set bits (bytes without any are skipped)
+		for( unsigned int i = 0; mapPage->_numFreePages > 0 && i < _numPagesPerMapPage && firstPage + i < numPages; i += 8 )
+		{
+			unsigned char bits = mapPage->_bits[i / 8];
+
+			for( unsigned int j = 0; bits != 0 && j < 8; j++ )
+			{
+				if( (bits & (1 << j)) != 0 && firstPage + i + j < numPages )
+					_freePages.insert(firstPage + i + j);
+			}
+		}
+
+		mapPageId = mapPage->_nextMapPageId;
+	}
+
+	free(data);
+
+	//success
+	return 0;
+}
+
+bool PageAllocMap::findFreePage(PageNum& pageNum) const
+{
+	if( _freePages.empty() )
+		return false;
+
+	pageNum = *(_freePages.begin());
+
+	return true;
+}
+
+bool PageAllocMap::isFreePage(const PageNum pageNum) const
+{
+	return _freePages.find(pageNum) != _freePages.end();
+}
+
+bool PageAllocMap::isMapPage(const PageNum pageNum) const
+{
+	//there is one map page per tens of thousands of pages, so the list is short
+	return std::find(_mapPageIds.begin(), _mapPageIds.end(), pageNum) != _mapPageIds.end();
+}
+
+unsigned int PageAllocMap::getNumFreePages() const
+{
+	return _freePages.size();
+}
+
+PageNum PageAllocMap::getFirstMapPage() const
+{
+	return _mapPageIds.empty() ? 0 : _mapPageIds[0];
+}
+
+RC PageAllocMap::markFree(FileHandle& fileHandle, const PageNum pageNum)
+{
+	return setBit(fileHandle, pageNum, true);
+}
+
+RC PageAllocMap::markUsed(FileHandle& fileHandle, const PageNum pageNum)
+{
+	return setBit(fileHandle, pageNum, false);
+}
+
+RC PageAllocMap::setBit(FileHandle& fileHandle, const PageNum pageNum, const bool isFree)
+{
+	RC errCode = 0;
+	unsigned int position = pageNum / _numPagesPerMapPage;
+
+	//page used to be covered by the map, otherwise it would not be free
+	if( isFree == false && position >= _mapPageIds.size() )
+	{
+		return 0;
+	}
+
+	//range of this page has no map page yet
+	while( position >= _mapPageIds.size() )
+	{
+		if( (errCode = addMapPage(fileHandle)) != 0 )
+		{
+			return errCode;
+		}
+	}
+
+	void* data = malloc(_pageSize);
+
+	if( (errCode = fileHandle.readPage(_mapPageIds[position], data)) != 0 )
+	{
+		free(data);
+		return errCode;
+	}
+
+	AllocMapPage* mapPage = (AllocMapPage*)data;
+	unsigned int bit = pageNum % _numPagesPerMapPage;
+	unsigned char mask = (unsigned char)(1 << (bit % 8));
+	bool wasFree = (mapPage->_bits[bit / 8] & mask) != 0;
+
+	//write map page only if bit actually changes
+	if( wasFree != isFree )
+	{
+		if( isFree )
+		{
+			mapPage->_bits[bit / 8] |= mask;
+			mapPage->_numFreePages++;
+		}
+		else
+		{
+			mapPage->_bits[bit / 8] &= (unsigned char)~mask;
+			mapPage->_numFreePages--;
+		}
+
+		if( (errCode = fileHandle.writePage(_mapPageIds[position], data)) != 0 )
+		{
+			free(data);
+			return errCode;
+		}
+	}
+
+	free(data);
+
+	if( isFree )
+	{
+		_freePages.insert(pageNum);
+	}
+	else
+	{
+		_freePages.erase(pageNum);
+	}
+
+	//success
+	return 0;
+}
+
+RC PageAllocMap::addMapPage(FileHandle& fileHandle)
+{
+	RC errCode = 0;
+
+	//empty map page goes to the end of the file
+	void* data = malloc(_pageSize);
+	memset(data, 0, _pageSize);
+
+	PageNum mapPageId = fileHandle.getNumberOfPages();
+
+	if( (errCode = fileHandle.appendPage(data)) != 0 )
+	{
+		free(data);
+		return errCode;
+	}
+
+	free(data);
+
+	//add it to the chain (in memory first, so that first header page agrees with the map once it is written)
+	_mapPageIds.push_back(mapPageId);
+
+	if( (errCode = linkMapPage(fileHandle, _mapPageIds.size() - 1)) != 0 )
+	{
+		_mapPageIds.pop_back();
+		return errCode;
+	}
+
+	//success
+	return 0;
+}
+
+RC PageAllocMap::linkMapPage(FileHandle& fileHandle, const unsigned int position)
+{
+	RC errCode = 0;
+
+	//first map page is referenced by the first header page, others by the previous map page
+	PageNum prevPageId = (position == 0 ? 0 : _mapPageIds[position - 1]);
+	PageNum mapPageId = (position < _mapPageIds.size() ? _mapPageIds[position] : 0);
+
+	void* data = malloc(_pageSize);
+
+	if( (errCode = fileHandle.readPage(prevPageId, data)) != 0 )
+	{
+		free(data);
+		return errCode;
+	}
+
+	if( position == 0 )
+	{
+		((Header*)data)->_allocMapPageId = mapPageId;
+	}
+	else
+	{
+		((AllocMapPage*)data)->_nextMapPageId = mapPageId;
+	}
+
+	errCode = fileHandle.writePage(prevPageId, data);
+
+	free(data);
+
+	return errCode;
+}
+
+RC PageAllocMap::shrink(FileHandle& fileHandle, PageNum& numPages)
+{
+	RC errCode = 0;
+
+	//find the first page of the run of free pages and map pages at the end of the file (first header page always stays)
+	PageNum newNumPages = numPages;
+	while( newNumPages > 1 && (isFreePage(newNumPages - 1) || isMapPage(newNumPages - 1)) )
+	{
+		newNumPages--;
+	}
+
+	//nothing to cut
+	if( newNumPages == numPages )
+	{
+		return 0;
+	}
+
+	//pages beyond the end are gone, along with map pages among them
+	_freePages.erase(_freePages.lower_bound(newNumPages), _freePages.end());
+
+	std::vector<PageNum> mapPageIds;
+	for( unsigned int i = 0; i < _mapPageIds.size(); i++ )
+	{
+		if( _mapPageIds[i] < newNumPages )
+			mapPageIds.push_back(_mapPageIds[i]);
+	}
+	std::sort(mapPageIds.begin(), mapPageIds.end());
+
+	//remaining free pages still have to be covered by the map; cut pages right after the new end take place of the map
+	//pages that were cut (there were at least as many of them as are missing now)
+	unsigned int numNeeded = _freePages.empty() ? 0 : *(_freePages.rbegin()) / _numPagesPerMapPage + 1;
+	while( mapPageIds.size() < numNeeded )
+	{
+		mapPageIds.push_back(newNumPages++);
+	}
+
+	_mapPageIds.swap(mapPageIds);
+
+	//re-write the whole chain
+	void* data = malloc(_pageSize);
+	std::set<PageNum>::iterator iter = _freePages.begin();
+
+	for( unsigned int position = 0; position < _mapPageIds.size(); position++ )
+	{
+		memset(data, 0, _pageSize);
+
+		AllocMapPage* mapPage = (AllocMapPage*)data;
+		mapPage->_nextMapPageId = (position + 1 < _mapPageIds.size() ? _mapPageIds[position + 1] : 0);
+
+		PageNum endPage = (position + 1) * _numPagesPerMapPage;
+		for( ; iter != _freePages.end() && *iter < endPage; iter++ )
+		{
+			unsigned int bit = *iter % _numPagesPerMapPage;
+			mapPage->_bits[bit / 8] |= (unsigned char)(1 << (bit % 8));
+			mapPage->_numFreePages++;
+		}
+
+		if( (errCode = fileHandle.writePage(_mapPageIds[position], data)) != 0 )
+		{
+			free(data);
+			return errCode;
+		}
+	}
+
+	free(data);
+
+	//first header page references the new chain (or none)
+	if( (errCode = linkMapPage(fileHandle, 0)) != 0 )
+	{
+		return errCode;
+	}
+
+	numPages = newNumPages;
+
+	//success
+	return 0;
+}
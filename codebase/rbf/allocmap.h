@@ -0,0 +1,85 @@
+#ifndef _allocmap_h_
+#define _allocmap_h_
+
+#include <vector>
+#include <set>
+
+#include "../rbf/pfm.h"
+
+/*
+ * page of the allocation map (occupies the whole page of the file)
+**/
+struct AllocMapPage
+{
+	/*
+	 * page number of the next page of the map (0 if this is the last one)
+	**/
+	PageNum _nextMapPageId;
+	/*
+	 * number of bits set in this page
+	**/
+	unsigned int _numFreePages;
+	/*
+	 * bit i of k-th page of the map is set, if page (k * number of bits per map page + i) of the file is free
+	 * (declared with a single byte, continues up to the end of the page)
+	**/
+	unsigned char _bits[1];
+};
+
+/*
+ * page allocation map of the file
+ *
+ * pages given up by their users (e.g. emptied overflow pages of the index, pages left behind by reorganizeFile) are marked
+ * free in the bitmap pages, chain of which starts at PageNum stored in the first header page (Header::_allocMapPageId).
+ * PagedFileManager::allocatePage re-uses the lowest free page before the file is grown, and truncateFile gives free pages
+ * at the end of the file back to the OS. Map pages are appended when the first page of their range is freed, so files
+ * that never free a page do not have any.
+ *
+ * read into memory on first use and written thru the buffer pool (i.e. logged along with the pages being freed/re-used)
+**/
+class PageAllocMap
+{
+public:
+	PageAllocMap(const unsigned int pageSize);
+	~PageAllocMap();
+
+	//read chain of the map pages of the file
+	RC build(FileHandle& fileHandle);
+
+	//find the lowest free page
+	bool findFreePage(PageNum& pageNum) const;
+	bool isFreePage(const PageNum pageNum) const;
+	bool isMapPage(const PageNum pageNum) const;
+	unsigned int getNumFreePages() const;
+	PageNum getFirstMapPage() const;
+
+	//mark page free (appends map pages, if page is not covered by the existing ones) / in use
+	RC markFree(FileHandle& fileHandle, const PageNum pageNum);
+	RC markUsed(FileHandle& fileHandle, const PageNum pageNum);
+
+	//drop free pages (and map pages) at the end of the file, and re-write the map for the free pages that remain;
+	//numPages is the number of pages of the file before and after
+	RC shrink(FileHandle& fileHandle, PageNum& numPages);
+
+protected:
+	RC setBit(FileHandle& fileHandle, const PageNum pageNum, const bool isFree);
+	RC addMapPage(FileHandle& fileHandle);
+	RC linkMapPage(FileHandle& fileHandle, const unsigned int position);
+
+private:
+	/*
+	 * free pages of the file (in-memory copy of the bits)
+	**/
+	std::set<PageNum> _freePages;
+	/*
+	 * map pages in the order of the chain (k-th one covers k-th range of pages)
+	**/
+	std::vector<PageNum> _mapPageIds;
+	/*
+	 * number of pages covered by a single map page, and size of the page
+	**/
+	unsigned int _numPagesPerMapPage;
+	unsigned int _pageSize;
+};
+
+#endif
@@ -0,0 +1,214 @@
+#include "bgwriter.h"
+#include "bpm.h"
+#include "wal.h"
+#include <sys/time.h>
+#include <errno.h>
+
+BackgroundWriter::BackgroundWriter(PagedFileManager* pfm, BufferPool* bufferPool)
+: _roundCounter(0), _writeCounter(0), _checkpointCounter(0), _pfm(pfm), _bufferPool(bufferPool), _log(NULL),
+  _running(false), _stopping(false), _checkpointing(false), _dirtyPercent(BGWRITER_DEFAULT_DIRTY_PERCENT),
+  _maxDirtyAgeMs(BGWRITER_DEFAULT_MAX_DIRTY_AGE_MS), _checkpointIntervalMs(BGWRITER_DEFAULT_CHECKPOINT_INTERVAL_MS),
+  _lastCheckpointTime(0)
+{
+	pthread_mutex_init(&_mutex, NULL);
+	pthread_cond_init(&_wakeCond, NULL);
+	pthread_cond_init(&_idleCond, NULL);
+}
+
+BackgroundWriter::~BackgroundWriter()
+{
+	stop();
+
+	pthread_cond_destroy(&_idleCond);
+	pthread_cond_destroy(&_wakeCond);
+	pthread_mutex_destroy(&_mutex);
+}
+
+void* BackgroundWriter::workerMain(void* writer)
+{
+	((BackgroundWriter*)writer)->run();
+	return NULL;
+}
+
+void BackgroundWriter::start()
+{
+	pthread_mutex_lock(&_mutex);
+
+	if( _running == false )
+	{
+		_stopping = false;
+		_lastCheckpointTime = ioClock();
+		_running = (pthread_create(&_thread, NULL, workerMain, this) == 0);
+	}
+
+	pthread_mutex_unlock(&_mutex);
+}
+
+void BackgroundWriter::stop()
+{
+	pthread_mutex_lock(&_mutex);
+
+	if( _running == false )
+	{
+		pthread_mutex_unlock(&_mutex);
+		return;
+	}
+
+	_stopping = true;
+	pthread_cond_broadcast(&_wakeCond);
+	pthread_mutex_unlock(&_mutex);
+
+	pthread_join(_thread, NULL);
+
+	pthread_mutex_lock(&_mutex);
+	_running = false;
+	pthread_mutex_unlock(&_mutex);
+}
+
+bool BackgroundWriter::isRunning()
+{
+	pthread_mutex_lock(&_mutex);
+	bool running = _running;
+	pthread_mutex_unlock(&_mutex);
+
+	return running;
+}
+
+void BackgroundWriter::setPolicy(const unsigned int dirtyPercent, const unsigned int maxDirtyAgeMs, const unsigned int checkpointIntervalMs)
+{
+	pthread_mutex_lock(&_mutex);
+	_dirtyPercent = (dirtyPercent > 100 ? 100 : dirtyPercent);
+	_maxDirtyAgeMs = maxDirtyAgeMs;
+	_checkpointIntervalMs = checkpointIntervalMs;
+	pthread_mutex_unlock(&_mutex);
+}
+
+void BackgroundWriter::setLogManager(LogManager* log)
+{
+	pthread_mutex_lock(&_mutex);
+
+	while( _checkpointing )
+	{
+		pthread_cond_wait(&_idleCond, &_mutex);
+	}
+
+	_log = log;
+	_lastCheckpointTime = ioClock();
+
+	pthread_mutex_unlock(&_mutex);
+}
+
+void BackgroundWriter::collectCounters(unsigned &writeCount, unsigned &checkpointCount)
+{
+	pthread_mutex_lock(&_mutex);
+	writeCount = _writeCounter;
+	checkpointCount = _checkpointCounter;
+	pthread_mutex_unlock(&_mutex);
+}
+
+void BackgroundWriter::run()
+{
+	pthread_mutex_lock(&_mutex);
+
+	while( _stopping == false )
+	{
+		//sleep until the next round (or until stop)
+		struct timeval now;
+		gettimeofday(&now, NULL);
+
+		struct timespec wakeTime;
+		unsigned long long wakeNanos = (unsigned long long)now.tv_usec * 1000 + (unsigned long long)BGWRITER_INTERVAL_MS * 1000000;
+		wakeTime.tv_sec = now.tv_sec + wakeNanos / 1000000000;
+		wakeTime.tv_nsec = wakeNanos % 1000000000;
+
+		while( _stopping == false && pthread_cond_timedwait(&_wakeCond, &_mutex, &wakeTime) != ETIMEDOUT )
+			;
+
+		if( _stopping )
+			break;
+
+		pthread_mutex_unlock(&_mutex);
+
+		writeDirtyPages();
+		takeCheckpoint();
+
+		pthread_mutex_lock(&_mutex);
+		_roundCounter++;
+	}
+
+	pthread_mutex_unlock(&_mutex);
+}
+
+void BackgroundWriter::writeDirtyPages()
+{
+	pthread_mutex_lock(&_mutex);
+	unsigned int dirtyPercent = _dirtyPercent;
+	unsigned int maxDirtyAgeMs = _maxDirtyAgeMs;
+	pthread_mutex_unlock(&_mutex);
+
+	//pages above the limit on dirty frames are written, as well as pages that are dirty for too long
+	unsigned int maxDirty = (dirtyPercent == 0 ? _bufferPool->getNumFrames() : _bufferPool->getNumFrames() * dirtyPercent / 100);
+	unsigned long long dirtyTime = (maxDirtyAgeMs == 0 ? 0 : ioClock() - (unsigned long long)maxDirtyAgeMs * 1000000);
+
+	//pool is locked for one batch at a time
+	unsigned int numWritten = 0;
+	do
+	{
+		numWritten = 0;
+		if( _bufferPool->writeBackDirty(maxDirty, dirtyTime, BGWRITER_BATCH_PAGES, numWritten) != 0 )
+			break;
+
+		pthread_mutex_lock(&_mutex);
+		_writeCounter += numWritten;
+		bool stopping = _stopping;
+		pthread_mutex_unlock(&_mutex);
+
+		if( stopping )
+			break;
+	}
+	while( numWritten == BGWRITER_BATCH_PAGES );
+}
+
+void BackgroundWriter::takeCheckpoint()
+{
+	pthread_mutex_lock(&_mutex);
+
+	LogManager* log = _log;
+	unsigned long long now = ioClock();
+
+	if( log == NULL || _checkpointIntervalMs == 0 || now - _lastCheckpointTime < (unsigned long long)_checkpointIntervalMs * 1000000 )
+	{
+		pthread_mutex_unlock(&_mutex);
+		return;
+	}
+
+	//log cannot be closed until checkpoint is over
+	_checkpointing = true;
+	pthread_mutex_unlock(&_mutex);
+
+	//nothing was logged since the last checkpoint
+	RC errCode = 0;
+	bool taken = false;
+	if( log->getLogSize() > 0 )
+	{
+		//slow part (fsync of data files) is done while foreground operations go on, so that checkpoint itself only
+		//has to write back and fsync what has changed since then
+		if( (errCode = log->syncDataFiles()) == 0 )
+			errCode = _pfm->takeCheckpoint();
+
+		taken = (errCode == 0);
+	}
+
+	pthread_mutex_lock(&_mutex);
+
+	//failed checkpoint (e.g. log I/O error) is attempted again in the next round
+	if( errCode == 0 )
+		_lastCheckpointTime = now;
+
+	if( taken )
+		_checkpointCounter++;
+
+	_checkpointing = false;
+	pthread_cond_broadcast(&_idleCond);
+	pthread_mutex_unlock(&_mutex);
+}
@@ -0,0 +1,86 @@
+#ifndef _bgwriter_h_
+#define _bgwriter_h_
+
+#include <pthread.h>
+
+#include "../rbf/pfm.h"
+
+/*
+ * time between rounds of the background writer, and maximum number of pages written per round while the buffer pool
+ * is locked (pool is released in between, so that foreground threads are not held up)
+**/
+#define BGWRITER_INTERVAL_MS 10
+#define BGWRITER_BATCH_PAGES 16
+/*
+ * default policy: share of dirty frames above which dirty pages are written back (oldest first), age after which dirty
+ * page is written back regardless, and time between checkpoints (only when write-ahead log is opened)
+**/
+#define BGWRITER_DEFAULT_DIRTY_PERCENT 10
+#define BGWRITER_DEFAULT_MAX_DIRTY_AGE_MS 500
+#define BGWRITER_DEFAULT_CHECKPOINT_INTERVAL_MS 1000
+
+class BufferPool;
+
+/*
+ * background writer of the dirty pages
+ *
+ * thread wakes up every BGWRITER_INTERVAL_MS and writes back dirty pages that are neither pinned nor part of uncommitted
+ * operation, until share of dirty frames drops to the given percent and no page is dirty for longer than the given age.
+ * Buffer pool meanwhile prefers clean frames as victims, so foreground threads find a clean frame instead of writing back
+ * the victim themselves. With write-ahead log opened, thread also takes checkpoints (data files are fsync-ed before
+ * foreground operations are held up for the truncation of the log), so that recovery never has to re-apply more than a
+ * checkpoint interval worth of log.
+**/
+class BackgroundWriter
+{
+public:
+	BackgroundWriter(PagedFileManager* pfm, BufferPool* bufferPool);
+	~BackgroundWriter();
+
+	//start/stop the thread (stop waits for the round in progress)
+	void start();
+	void stop();
+	bool isRunning();
+
+	//policy (see above); 0 turns the corresponding trigger off
+	void setPolicy(const unsigned int dirtyPercent, const unsigned int maxDirtyAgeMs, const unsigned int checkpointIntervalMs);
+
+	//write-ahead log to take checkpoints of (waits for the checkpoint in progress, so that log can be closed afterwards)
+	void setLogManager(LogManager* log);
+
+	//statistics (counters are updated by the thread, so they are read under the mutex)
+	void collectCounters(unsigned &writeCount, unsigned &checkpointCount);
+	unsigned int _roundCounter;
+	unsigned int _writeCounter;
+	unsigned int _checkpointCounter;
+
+protected:
+	static void* workerMain(void* writer);
+	void run();
+	void writeDirtyPages();
+	void takeCheckpoint();
+
+private:
+	PagedFileManager* _pfm;
+	BufferPool* _bufferPool;
+	LogManager* _log;
+	pthread_t _thread;
+	bool _running;
+	bool _stopping;
+	bool _checkpointing;
+	unsigned int _dirtyPercent;
+	unsigned int _maxDirtyAgeMs;
+	unsigned int _checkpointIntervalMs;
+	/*
+	 * time of the last checkpoint (see ioClock in iostats.h)
+	**/
+	unsigned long long _lastCheckpointTime;
+	/*
+	 * guards all members; thread sleeps on _wakeCond between rounds, setLogManager waits on _idleCond for checkpoint
+	**/
+	pthread_mutex_t _mutex;
+	pthread_cond_t _wakeCond;
+	pthread_cond_t _idleCond;
+};
+
+#endif
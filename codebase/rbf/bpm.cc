@@ -0,0 +1,992 @@
+#include "bpm.h"
+#include "wal.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <algorithm>
+
+/*
+ * error codes (continuation of PagedFileManager error codes):
+ * -17 = all frames of the buffer pool are pinned, i.e. there is no victim for replacement
+ * -18 = attempting to unpin a page that is not pinned
+ * -19 = attempting to re-size buffer pool, while some of its pages are pinned
+**/
+
+BufferPool::BufferPool(const unsigned int numFrames)
+: _hitCounter(0), _missCounter(0), _evictionCounter(0), _writeBackCounter(0), _prefetchCounter(0), _clockHand(0), _log(NULL),
+  _cleanVictimsFirst(false), _undoActive(false)
+{
+	pthread_mutex_init(&_mutex, NULL);
+	pthread_cond_init(&_loadedCond, NULL);
+
+	allocateFrames(numFrames);
+}
+
+BufferPool::~BufferPool()
+{
+	flushAll();
+	releaseFrames();
+
+	pthread_cond_destroy(&_loadedCond);
+	pthread_mutex_destroy(&_mutex);
+}
+
+void BufferPool::resetFrame(Frame& frame)
+{
+	frame._file = NULL;
+	frame._pageNum = 0;
+	frame._handle = FileHandle();
+	frame._pinCount = 0;
+	frame._dirty = false;
+	frame._referenced = false;
+	frame._loading = false;
+	frame._pageLSN = 0;
+	frame._dirtyTime = 0;
+}
+
+void BufferPool::allocateFrames(const unsigned int numFrames)
+{
+	//at least one frame is required to move a page between disk and caller
+	unsigned int n = (numFrames == 0 ? 1 : numFrames);
+
+	_frames.resize(n);
+
+	//initialize all frames to be unused
+	for( unsigned int i = 0; i < n; i++ )
+	{
+		resetFrame(_frames[i]);
+
+		_frames[i]._data = NULL;
+		allocateFrameData(_frames[i], PAGE_SIZE);
+	}
+
+	_clockHand = 0;
+}
+
+void BufferPool::allocateFrameData(Frame& frame, const unsigned int size)
+{
+	free(frame._data);
+
+	//page-aligned, so that frames can be used for direct I/O (IO_DIRECT)
+	if( posix_memalign(&(frame._data), PAGE_SIZE, size) != 0 )
+		frame._data = malloc(size);
+
+	memset(frame._data, 0, size);
+	frame._size = size;
+}
+
+void BufferPool::releaseFrames()
+{
+	for( unsigned int i = 0; i < _frames.size(); i++ )
+	{
+		free(_frames[i]._data);
+	}
+
+	_frames.clear();
+	_pageTable.clear();
+}
+
+unsigned int BufferPool::getNumFrames() const
+{
+	return _frames.size();
+}
+
+RC BufferPool::writeBack(Frame& frame)
+{
+	RC errCode = 0;
+
+	//nothing to do for clean pages
+	if( frame._dirty == false || frame._file == NULL )
+		return 0;
+
+	//check that there is OS file-handler to write thru
+	if( frame._handle.isOpened() == false )
+		return -9;
+
+	//write-ahead rule: log records describing this page have to be durable before the page itself
+	if( _log != NULL && frame._pageLSN > 0 && (errCode = _log->flush(frame._pageLSN)) != 0 )
+	{
+		return errCode;
+	}
+
+	if( (errCode = frame._handle.writePhysicalPage(frame._pageNum, frame._data)) != 0 )
+	{
+		return errCode;
+	}
+
+	//data file has to be synced, before log records of this page are dropped by checkpoint
+	if( _log != NULL )
+		_log->noteDataWrite(frame._file->_name);
+
+	//update counters
+	frame._file->_physicalWriteCounter++;
+	frame._file->_writeCallCounter++;
+	_writeBackCounter++;
+
+	frame._dirty = false;
+
+	//success
+	return 0;
+}
+
+RC BufferPool::findVictim(unsigned int& frameIndex)
+{
+	RC errCode = 0;
+
+	//pages modified by the operation that is not committed yet cannot reach the data file (there is no undo)
+	LSN committedLSN = (_log == NULL ? 0 : _log->getCommittedLSN());
+
+	//first dirty frame that could be a victim (when clean frames are preferred)
+	int dirtyIndex = -1;
+
+	//clock hand makes at most two full rounds: first round clears reference bits, second one is guaranteed
+	//to find unreferenced frame unless all of them are pinned
+	for( unsigned int step = 0; step < 2 * _frames.size(); step++ )
+	{
+		Frame& frame = _frames[_clockHand];
+		unsigned int curIndex = _clockHand;
+
+		//move clock hand to the next frame
+		_clockHand = (_clockHand + 1) % _frames.size();
+
+		//skip pinned frames (this includes frames that are being loaded)
+		if( frame._pinCount > 0 )
+			continue;
+
+		//skip pages of uncommitted operation
+		if( frame._dirty && frame._pageLSN > committedLSN )
+			continue;
+
+		//give referenced frames a second chance
+		if( frame._referenced )
+		{
+			frame._referenced = false;
+			continue;
+		}
+
+		//dirty page is taken only if there is no clean one
+		if( _cleanVictimsFirst && frame._dirty )
+		{
+			if( dirtyIndex < 0 )
+				dirtyIndex = curIndex;
+
+			continue;
+		}
+
+		//found victim; if it holds a page then remove this page from buffer pool
+		if( (errCode = evictFrame(frame)) != 0 )
+		{
+			return errCode;
+		}
+
+		frameIndex = curIndex;
+
+		//success
+		return 0;
+	}
+
+	if( dirtyIndex >= 0 )
+	{
+		if( (errCode = evictFrame(_frames[dirtyIndex])) != 0 )
+		{
+			return errCode;
+		}
+
+		frameIndex = dirtyIndex;
+
+		//success
+		return 0;
+	}
+
+	//all frames are pinned
+	return -17;
+}
+
+RC BufferPool::evictFrame(Frame& frame)
+{
+	RC errCode = 0;
+
+	//nothing to do for unused frame
+	if( frame._file == NULL )
+	{
+		return 0;
+	}
+
+	//write back modified page
+	if( (errCode = writeBack(frame)) != 0 )
+	{
+		return errCode;
+	}
+
+	_pageTable.erase(std::make_pair(frame._file, frame._pageNum));
+	_evictionCounter++;
+
+	resetFrame(frame);
+
+	//success
+	return 0;
+}
+
+RC BufferPool::reserveFrame(FileHandle& fileHandle, PageNum pageNum, bool loading, unsigned int& frameIndex)
+{
+	RC errCode = 0;
+
+	//find frame for this page
+	if( (errCode = findVictim(frameIndex)) != 0 )
+	{
+		return errCode;
+	}
+
+	Frame& frame = _frames[frameIndex];
+
+	//files may have different page sizes, so frame takes the size of the page it holds
+	if( frame._size != fileHandle.getPhysicalPageSize() )
+		allocateFrameData(frame, fileHandle.getPhysicalPageSize());
+
+	//setup frame, pin prevents it from being chosen as a victim while page is loading
+	frame._file = fileHandle._info;
+	frame._pageNum = pageNum;
+	frame._handle = fileHandle;
+	frame._pinCount = 1;
+	frame._dirty = false;
+	frame._referenced = true;
+	frame._loading = loading;
+	frame._pageLSN = 0;
+
+	//insert into page table
+	_pageTable.insert(std::make_pair(std::make_pair(fileHandle._info, pageNum), frameIndex));
+
+	//success
+	return 0;
+}
+
+RC BufferPool::loadPage(FileHandle& fileHandle, PageNum pageNum, bool readFromDisk, unsigned int& frameIndex)
+{
+	RC errCode = 0;
+
+	if( (errCode = reserveFrame(fileHandle, pageNum, readFromDisk, frameIndex)) != 0 )
+	{
+		return errCode;
+	}
+
+	Frame& frame = _frames[frameIndex];
+
+	if( readFromDisk )
+	{
+		//positional reads do not depend on shared cursor, so other threads may proceed in the meantime
+		bool unlocked = fileHandle._ioMode != IO_STDIO;
+
+		if( unlocked )
+			pthread_mutex_unlock(&_mutex);
+
+		errCode = fileHandle.readPhysicalPage(pageNum, frame._data);
+
+		if( unlocked )
+			pthread_mutex_lock(&_mutex);
+
+		frame._loading = false;
+
+		if( errCode != 0 )
+		{
+			//release frame
+			_pageTable.erase(std::make_pair(fileHandle._info, pageNum));
+			resetFrame(frame);
+		}
+		else
+		{
+			fileHandle._info->_physicalReadCounter++;
+			fileHandle._info->_readCallCounter++;
+		}
+
+		//wake up threads that wait for this page
+		pthread_cond_broadcast(&_loadedCond);
+	}
+
+	return errCode;
+}
+
+RC BufferPool::readReservedFrames(FileHandle& fileHandle, std::vector<unsigned int>& frameIndexes)
+{
+	RC errCode = 0;
+
+	//split frames into runs of consecutive pages (frame data does not move while frame is pinned)
+	std::vector< std::vector<unsigned int> > runs;
+	for( unsigned int i = 0; i < frameIndexes.size(); i++ )
+	{
+		if( runs.empty() || _frames[runs.back().back()]._pageNum + 1 != _frames[frameIndexes[i]]._pageNum )
+			runs.push_back(std::vector<unsigned int>());
+
+		runs.back().push_back(frameIndexes[i]);
+	}
+
+	std::vector<RC> results(runs.size(), 0);
+	std::vector<PageNum> firstPages(runs.size(), 0);
+	std::vector< std::vector<void*> > buffers(runs.size());
+	for( unsigned int i = 0; i < runs.size(); i++ )
+	{
+		firstPages[i] = _frames[runs[i][0]]._pageNum;
+		for( unsigned int j = 0; j < runs[i].size(); j++ )
+			buffers[i].push_back(_frames[runs[i][j]]._data);
+	}
+
+	//vectored reads are positional, so they are done without the mutex (even for IO_STDIO handles)
+	pthread_mutex_unlock(&_mutex);
+
+	for( unsigned int i = 0; i < runs.size(); i++ )
+	{
+		results[i] = fileHandle.readPhysicalPages(firstPages[i], buffers[i]);
+	}
+
+	pthread_mutex_lock(&_mutex);
+
+	for( unsigned int i = 0; i < runs.size(); i++ )
+	{
+		for( unsigned int j = 0; j < runs[i].size(); j++ )
+		{
+			Frame& frame = _frames[runs[i][j]];
+			frame._loading = false;
+
+			//release frame of the page that could not be read
+			if( results[i] != 0 )
+			{
+				_pageTable.erase(std::make_pair(frame._file, frame._pageNum));
+				resetFrame(frame);
+			}
+		}
+
+		if( results[i] != 0 )
+		{
+			errCode = results[i];
+		}
+		else
+		{
+			fileHandle._info->_physicalReadCounter += runs[i].size();
+			fileHandle._info->_readCallCounter++;
+		}
+	}
+
+	frameIndexes.clear();
+
+	//wake up threads that wait for these pages
+	pthread_cond_broadcast(&_loadedCond);
+
+	return errCode;
+}
+
+RC BufferPool::pinPage(FileHandle& fileHandle, PageNum pageNum, bool readFromDisk, void*& data)
+{
+	RC errCode = 0;
+
+	std::pair<FileInfo*, PageNum> key = std::make_pair(fileHandle._info, pageNum);
+
+	pthread_mutex_lock(&_mutex);
+
+	//check if page is already cached
+	std::map<std::pair<FileInfo*, PageNum>, unsigned int>::iterator iter;
+	while( (iter = _pageTable.find(key)) != _pageTable.end() )
+	{
+		Frame& frame = _frames[iter->second];
+
+		//another thread is reading this page, wait for it and look up page again (reading might have failed)
+		if( frame._loading )
+		{
+			pthread_cond_wait(&_loadedCond, &_mutex);
+			continue;
+		}
+
+		frame._pinCount++;
+		frame._referenced = true;
+		data = frame._data;
+		_hitCounter++;
+		saveUndoImage(frame, true);
+
+		pthread_mutex_unlock(&_mutex);
+		return 0;
+	}
+
+	_missCounter++;
+
+	unsigned int frameIndex = 0;
+	if( (errCode = loadPage(fileHandle, pageNum, readFromDisk, frameIndex)) == 0 )
+		saveUndoImage(_frames[frameIndex], false);
+
+	pthread_mutex_unlock(&_mutex);
+
+	if( errCode != 0 )
+	{
+		return errCode;
+	}
+
+	data = _frames[frameIndex]._data;
+
+	//success
+	return 0;
+}
+
+RC BufferPool::pinPages(FileHandle& fileHandle, const std::vector<PageNum>& pageNums, bool readFromDisk, std::vector<void*>& data)
+{
+	RC errCode = 0;
+
+	//frame of each of the pages, and frames reserved by this call that are not read yet
+	std::vector<unsigned int> frameIndexes(pageNums.size(), 0);
+	std::vector<unsigned int> reserved;
+	unsigned int numPinned = 0;
+
+	pthread_mutex_lock(&_mutex);
+
+	while( numPinned < pageNums.size() && errCode == 0 )
+	{
+		std::pair<FileInfo*, PageNum> key = std::make_pair(fileHandle._info, pageNums[numPinned]);
+		std::map<std::pair<FileInfo*, PageNum>, unsigned int>::iterator iter = _pageTable.find(key);
+
+		if( iter == _pageTable.end() )
+		{
+			_missCounter++;
+
+			if( (errCode = reserveFrame(fileHandle, pageNums[numPinned], readFromDisk, frameIndexes[numPinned])) == 0 )
+			{
+				saveUndoImage(_frames[frameIndexes[numPinned]], false);
+
+				if( readFromDisk )
+					reserved.push_back(frameIndexes[numPinned]);
+
+				numPinned++;
+			}
+
+			continue;
+		}
+
+		Frame& frame = _frames[iter->second];
+
+		//page is being read by another thread; read own reserved pages first (that thread may be waiting for them)
+		if( frame._loading && std::find(reserved.begin(), reserved.end(), iter->second) == reserved.end() )
+		{
+			if( reserved.empty() == false )
+				errCode = readReservedFrames(fileHandle, reserved);
+			else
+				pthread_cond_wait(&_loadedCond, &_mutex);
+
+			continue;
+		}
+
+		//cached page (or page listed twice)
+		frame._pinCount++;
+		frame._referenced = true;
+		frameIndexes[numPinned] = iter->second;
+		_hitCounter++;
+		numPinned++;
+
+		saveUndoImage(frame, true);
+	}
+
+	if( errCode == 0 && reserved.empty() == false )
+	{
+		errCode = readReservedFrames(fileHandle, reserved);
+	}
+
+	if( errCode != 0 )
+	{
+		//reserved frames that have not been read are released, others are unpinned
+		for( unsigned int i = 0; i < reserved.size(); i++ )
+		{
+			Frame& frame = _frames[reserved[i]];
+			_pageTable.erase(std::make_pair(frame._file, frame._pageNum));
+			resetFrame(frame);
+		}
+
+		for( unsigned int i = 0; i < numPinned; i++ )
+		{
+			Frame& frame = _frames[frameIndexes[i]];
+			if( frame._file == fileHandle._info && frame._pageNum == pageNums[i] && frame._pinCount > 0 )
+				frame._pinCount--;
+		}
+
+		pthread_cond_broadcast(&_loadedCond);
+		pthread_mutex_unlock(&_mutex);
+		return errCode;
+	}
+
+	data.resize(pageNums.size());
+	for( unsigned int i = 0; i < pageNums.size(); i++ )
+	{
+		data[i] = _frames[frameIndexes[i]]._data;
+	}
+
+	pthread_mutex_unlock(&_mutex);
+
+	//success
+	return 0;
+}
+
+RC BufferPool::prefetchPages(FileHandle& fileHandle, const std::vector<PageNum>& pageNums)
+{
+	RC errCode = 0;
+	std::vector<unsigned int> reserved;
+
+	pthread_mutex_lock(&_mutex);
+
+	for( unsigned int i = 0; i < pageNums.size(); i++ )
+	{
+		//page is cached or being loaded by someone else
+		if( _pageTable.find(std::make_pair(fileHandle._info, pageNums[i])) != _pageTable.end() )
+			continue;
+
+		unsigned int frameIndex = 0;
+		if( (errCode = reserveFrame(fileHandle, pageNums[i], true, frameIndex)) != 0 )
+			break;
+
+		reserved.push_back(frameIndex);
+	}
+
+	//pages that got a frame are read even if the others did not
+	std::vector<unsigned int> frameIndexes = reserved;
+	RC readCode = readReservedFrames(fileHandle, reserved);
+
+	for( unsigned int i = 0; i < frameIndexes.size(); i++ )
+	{
+		Frame& frame = _frames[frameIndexes[i]];
+
+		//nobody uses the page yet, so it should be the first one to go if the scan does not reach it
+		if( frame._file == fileHandle._info && frame._pinCount > 0 )
+		{
+			frame._pinCount--;
+			frame._referenced = false;
+			_prefetchCounter++;
+		}
+	}
+
+	pthread_mutex_unlock(&_mutex);
+
+	return errCode != 0 ? errCode : readCode;
+}
+
+RC BufferPool::writeBackPages(FileHandle& fileHandle, const std::vector<PageNum>& pageNums)
+{
+	RC errCode = 0;
+
+	pthread_mutex_lock(&_mutex);
+
+	//pages modified by the operation that is not committed yet cannot reach the data file
+	LSN committedLSN = (_log == NULL ? 0 : _log->getCommittedLSN());
+
+	//frames to be written, grouped into runs of consecutive pages
+	std::vector< std::vector<unsigned int> > runs;
+	for( unsigned int i = 0; i < pageNums.size(); i++ )
+	{
+		std::map<std::pair<FileInfo*, PageNum>, unsigned int>::iterator iter =
+				_pageTable.find(std::make_pair(fileHandle._info, pageNums[i]));
+
+		if( iter == _pageTable.end() )
+			continue;
+
+		Frame& frame = _frames[iter->second];
+		if( frame._dirty == false || frame._loading || (_log != NULL && frame._pageLSN > committedLSN) )
+			continue;
+
+		if( runs.empty() || _frames[runs.back().back()]._pageNum + 1 != frame._pageNum )
+			runs.push_back(std::vector<unsigned int>());
+
+		runs.back().push_back(iter->second);
+	}
+
+	for( unsigned int i = 0; i < runs.size() && errCode == 0; i++ )
+	{
+		std::vector<void*> buffers;
+		LSN maxLSN = 0;
+
+		for( unsigned int j = 0; j < runs[i].size(); j++ )
+		{
+			Frame& frame = _frames[runs[i][j]];
+			buffers.push_back(frame._data);
+
+			if( frame._pageLSN > maxLSN )
+				maxLSN = frame._pageLSN;
+		}
+
+		//write-ahead rule
+		if( _log != NULL && maxLSN > 0 && (errCode = _log->flush(maxLSN)) != 0 )
+			break;
+
+		if( (errCode = fileHandle.writePhysicalPages(_frames[runs[i][0]]._pageNum, buffers)) != 0 )
+			break;
+
+		if( _log != NULL )
+			_log->noteDataWrite(fileHandle._info->_name);
+
+		for( unsigned int j = 0; j < runs[i].size(); j++ )
+		{
+			_frames[runs[i][j]]._dirty = false;
+		}
+
+		fileHandle._info->_physicalWriteCounter += runs[i].size();
+		fileHandle._info->_writeCallCounter++;
+		_writeBackCounter += runs[i].size();
+	}
+
+	pthread_mutex_unlock(&_mutex);
+
+	return errCode;
+}
+
+/*
+ * order in which background writer writes selected pages: file by file, in page order
+**/
+static bool precedesInFile(const Frame* frame1, const Frame* frame2)
+{
+	if( frame1->_file != frame2->_file )
+		return frame1->_file < frame2->_file;
+
+	return frame1->_pageNum < frame2->_pageNum;
+}
+
+RC BufferPool::writeBackDirty(const unsigned int maxDirty, const unsigned long long dirtyTime, const unsigned int maxPages, unsigned int& numWritten)
+{
+	RC errCode = 0;
+
+	pthread_mutex_lock(&_mutex);
+
+	LSN committedLSN = (_log == NULL ? 0 : _log->getCommittedLSN());
+
+	//pages that can be written: pinned page may be in the middle of modification, and page of uncommitted operation
+	//cannot reach the data file
+	unsigned int numDirty = 0;
+	std::vector< std::pair<unsigned long long, Frame*> > candidates;
+	for( unsigned int i = 0; i < _frames.size(); i++ )
+	{
+		Frame& frame = _frames[i];
+		if( frame._file == NULL || frame._dirty == false )
+			continue;
+
+		numDirty++;
+
+		if( frame._pinCount == 0 && frame._loading == false && (_log == NULL || frame._pageLSN <= committedLSN) )
+			candidates.push_back(std::make_pair(frame._dirtyTime, &frame));
+	}
+
+	//oldest pages first, until there are not too many dirty pages and the rest are not too old
+	std::sort(candidates.begin(), candidates.end());
+
+	std::vector<Frame*> selected;
+	for( unsigned int i = 0; i < candidates.size() && selected.size() < maxPages; i++ )
+	{
+		if( numDirty - selected.size() <= maxDirty && candidates[i].first >= dirtyTime )
+			break;
+
+		selected.push_back(candidates[i].second);
+	}
+
+	std::sort(selected.begin(), selected.end(), precedesInFile);
+
+	for( unsigned int i = 0; i < selected.size(); i++ )
+	{
+		if( (errCode = writeBack(*selected[i])) != 0 )
+			break;
+
+		numWritten++;
+	}
+
+	pthread_mutex_unlock(&_mutex);
+
+	return errCode;
+}
+
+void BufferPool::setCleanVictimsFirst(const bool enabled)
+{
+	pthread_mutex_lock(&_mutex);
+	_cleanVictimsFirst = enabled;
+	pthread_mutex_unlock(&_mutex);
+}
+
+RC BufferPool::unpinPage(FileHandle& fileHandle, PageNum pageNum, bool isDirty, LSN pageLSN)
+{
+	pthread_mutex_lock(&_mutex);
+
+	std::map<std::pair<FileInfo*, PageNum>, unsigned int>::iterator iter =
+			_pageTable.find(std::make_pair(fileHandle._info, pageNum));
+
+	//page has to be in the buffer pool and pinned
+	if( iter == _pageTable.end() || _frames[iter->second]._pinCount == 0 )
+	{
+		pthread_mutex_unlock(&_mutex);
+		return -18;
+	}
+
+	Frame& frame = _frames[iter->second];
+
+	frame._pinCount--;
+
+	if( isDirty )
+	{
+		if( frame._dirty == false )
+			frame._dirtyTime = ioClock();
+
+		frame._dirty = true;
+
+		//remember handle thru which this page would be written back
+		frame._handle = fileHandle;
+
+		if( pageLSN > frame._pageLSN )
+			frame._pageLSN = pageLSN;
+	}
+
+	pthread_mutex_unlock(&_mutex);
+
+	//success
+	return 0;
+}
+
+RC BufferPool::flushFile(FileInfo* file)
+{
+	RC errCode = 0;
+
+	pthread_mutex_lock(&_mutex);
+
+	//loop thru frames and write back the ones that belong to this file
+	for( unsigned int i = 0; i < _frames.size(); i++ )
+	{
+		if( _frames[i]._file == file && (errCode = writeBack(_frames[i])) != 0 )
+		{
+			pthread_mutex_unlock(&_mutex);
+			return errCode;
+		}
+	}
+
+	pthread_mutex_unlock(&_mutex);
+
+	//success
+	return 0;
+}
+
+void BufferPool::discardFile(FileInfo* file)
+{
+	pthread_mutex_lock(&_mutex);
+
+	//file is gone, so operation cannot restore it
+	std::map<std::pair<FileInfo*, PageNum>, UndoImage>::iterator undoIter = _undoImages.begin();
+	while( undoIter != _undoImages.end() )
+	{
+		if( undoIter->first.first == file )
+		{
+			free(undoIter->second._data);
+			_undoImages.erase(undoIter++);
+		}
+		else
+			undoIter++;
+	}
+	_undoNumPages.erase(file);
+
+	for( unsigned int i = 0; i < _frames.size(); i++ )
+	{
+		Frame& frame = _frames[i];
+		if( frame._file == file )
+		{
+			_pageTable.erase(std::make_pair(frame._file, frame._pageNum));
+			resetFrame(frame);
+		}
+	}
+
+	pthread_mutex_unlock(&_mutex);
+}
+
+RC BufferPool::writeBackAll()
+{
+	RC errCode = 0;
+
+	for( unsigned int i = 0; i < _frames.size(); i++ )
+	{
+		if( (errCode = writeBack(_frames[i])) != 0 )
+		{
+			return errCode;
+		}
+	}
+
+	//success
+	return 0;
+}
+
+RC BufferPool::flushAll()
+{
+	RC errCode = 0;
+
+	pthread_mutex_lock(&_mutex);
+	errCode = writeBackAll();
+	pthread_mutex_unlock(&_mutex);
+
+	return errCode;
+}
+
+RC BufferPool::resize(const unsigned int numFrames)
+{
+	RC errCode = 0;
+
+	pthread_mutex_lock(&_mutex);
+
+	//make sure that nobody holds a pointer into the frames
+	for( unsigned int i = 0; i < _frames.size(); i++ )
+	{
+		if( _frames[i]._pinCount > 0 )
+		{
+			pthread_mutex_unlock(&_mutex);
+			return -19;
+		}
+	}
+
+	//write back modified pages
+	if( (errCode = writeBackAll()) != 0 )
+	{
+		pthread_mutex_unlock(&_mutex);
+		return errCode;
+	}
+
+	//re-create frames
+	releaseFrames();
+	allocateFrames(numFrames);
+
+	pthread_mutex_unlock(&_mutex);
+
+	//success
+	return 0;
+}
+
+void BufferPool::setLogManager(LogManager* log)
+{
+	pthread_mutex_lock(&_mutex);
+	_log = log;
+	pthread_mutex_unlock(&_mutex);
+}
+
+RC BufferPool::clear()
+{
+	RC errCode = 0;
+
+	pthread_mutex_lock(&_mutex);
+
+	//make sure that nobody holds a pointer into the frames
+	for( unsigned int i = 0; i < _frames.size(); i++ )
+	{
+		if( _frames[i]._pinCount > 0 )
+		{
+			pthread_mutex_unlock(&_mutex);
+			return -19;
+		}
+	}
+
+	if( (errCode = writeBackAll()) != 0 )
+	{
+		pthread_mutex_unlock(&_mutex);
+		return errCode;
+	}
+
+	for( unsigned int i = 0; i < _frames.size(); i++ )
+	{
+		resetFrame(_frames[i]);
+	}
+
+	_pageTable.clear();
+
+	pthread_mutex_unlock(&_mutex);
+
+	//success
+	return 0;
+}
+
+void BufferPool::saveUndoImage(Frame& frame, const bool isCached)
+{
+	//only the thread that runs the operation modifies pages
+	if( _undoActive == false || pthread_equal(_undoThread, pthread_self()) == 0 )
+		return;
+
+	std::pair<FileInfo*, PageNum> key = std::make_pair(frame._file, frame._pageNum);
+
+	//page has been saved before its first modification by this operation
+	if( _undoImages.find(key) != _undoImages.end() )
+		return;
+
+	UndoImage image;
+	image._data = NULL;
+	image._size = 0;
+	image._dirty = frame._dirty;
+	image._pageLSN = frame._pageLSN;
+	image._dirtyTime = frame._dirtyTime;
+
+	//page that is just being loaded is dropped on rollback (disk has the same content), cached one may differ from disk
+	if( isCached )
+	{
+		image._size = frame._size;
+		image._data = malloc(frame._size);
+		memcpy(image._data, frame._data, frame._size);
+	}
+
+	_undoImages[key] = image;
+
+	//pages appended by the operation are beyond this number
+	if( _undoNumPages.find(frame._file) == _undoNumPages.end() )
+		_undoNumPages[frame._file] = frame._file->_numPages;
+}
+
+void BufferPool::beginOperation()
+{
+	pthread_mutex_lock(&_mutex);
+	_undoActive = true;
+	_undoThread = pthread_self();
+	pthread_mutex_unlock(&_mutex);
+}
+
+void BufferPool::endOperation(const bool rollback, std::vector<FileInfo*>& files)
+{
+	pthread_mutex_lock(&_mutex);
+
+	std::map<std::pair<FileInfo*, PageNum>, UndoImage>::iterator undoIter = _undoImages.begin();
+	for( ; undoIter != _undoImages.end(); undoIter++ )
+	{
+		UndoImage& image = undoIter->second;
+		std::map<std::pair<FileInfo*, PageNum>, unsigned int>::iterator iter = _pageTable.find(undoIter->first);
+
+		//pages of the operation are not written back before it commits, so evicted page has not been modified by it
+		if( rollback && iter != _pageTable.end() )
+		{
+			Frame& frame = _frames[iter->second];
+
+			if( image._data != NULL )
+			{
+				memcpy(frame._data, image._data, image._size < frame._size ? image._size : frame._size);
+				frame._dirty = image._dirty;
+				frame._pageLSN = image._pageLSN;
+				frame._dirtyTime = image._dirtyTime;
+			}
+			else if( frame._pinCount == 0 && frame._loading == false )
+			{
+				//page is read from disk again when it is needed
+				_pageTable.erase(iter);
+				resetFrame(frame);
+			}
+		}
+
+		free(image._data);
+	}
+
+	if( rollback )
+	{
+		std::map<FileInfo*, PageNum>::iterator fileIter = _undoNumPages.begin();
+		for( ; fileIter != _undoNumPages.end(); fileIter++ )
+		{
+			fileIter->first->_numPages = fileIter->second;
+			files.push_back(fileIter->first);
+		}
+	}
+
+	_undoImages.clear();
+	_undoNumPages.clear();
+	_undoActive = false;
+
+	pthread_mutex_unlock(&_mutex);
+}
+
+unsigned int BufferPool::getNumOperationPages()
+{
+	pthread_mutex_lock(&_mutex);
+	unsigned int numPages = _undoImages.size();
+	pthread_mutex_unlock(&_mutex);
+
+	return numPages;
+}
@@ -0,0 +1,192 @@
+#ifndef _bpm_h_
+#define _bpm_h_
+
+#include <vector>
+#include <map>
+#include <utility>
+#include <pthread.h>
+
+#include "../rbf/pfm.h"
+
+/*
+ * default number of frames in the buffer pool (i.e. 1 MB worth of 4 KB pages)
+**/
+#define BUFFER_POOL_DEFAULT_NUM_FRAMES 256
+
+/*
+ * frame of the buffer pool, i.e. slot that holds a copy of a single file page
+**/
+struct Frame
+{
+	/*
+	 * file that owns the cached page (NULL if frame is not used)
+	**/
+	FileInfo* _file;
+	/*
+	 * page number of the cached page within its file
+	**/
+	PageNum _pageNum;
+	/*
+	 * handle through which the page is written back (only meaningful for dirty frames)
+	**/
+	FileHandle _handle;
+	/*
+	 * number of users that currently hold a pointer into this frame (frame cannot be evicted while > 0)
+	**/
+	unsigned int _pinCount;
+	/*
+	 * page content differs from the one stored on the disk
+	**/
+	bool _dirty;
+	/*
+	 * reference bit of the clock replacement policy
+	**/
+	bool _referenced;
+	/*
+	 * page is being read from the disk (by the thread that pinned it first), other users have to wait
+	**/
+	bool _loading;
+	/*
+	 * page content, and its capacity (page size of the last file that used the frame)
+	**/
+	void* _data;
+	unsigned int _size;
+	/*
+	 * LSN of the latest log record of this page (0 if page was modified without logging), log has to be
+	 * durable up to it before page is written back
+	**/
+	LSN _pageLSN;
+	/*
+	 * time when page became dirty (see ioClock in iostats.h), background writer writes back the oldest pages first
+	**/
+	unsigned long long _dirtyTime;
+};
+
+/*
+ * page as it was before the operation in progress modified it
+**/
+struct UndoImage
+{
+	/*
+	 * copy of the cached page and its size (NULL if page was not cached, i.e. disk has its content)
+	**/
+	void* _data;
+	unsigned int _size;
+	/*
+	 * state of the frame that is restored along with the content
+	**/
+	bool _dirty;
+	LSN _pageLSN;
+	unsigned long long _dirtyTime;
+};
+
+/*
+ * process-wide page cache owned by the PagedFileManager
+ * replacement policy: clock (second chance)
+ * write policy: write-back (dirty pages reach the disk on eviction or when the file is closed, or are written back
+ * ahead of that by the background writer, see bgwriter.h)
+ *
+ * all methods are guarded by a single mutex, so pages may be pinned by several threads at once. Reads of
+ * IO_PREAD/IO_DIRECT handles are done outside of the mutex; IO_STDIO handles share a cursor, so their reads are not.
+ * Modification of pages is still expected to be done by a single thread.
+**/
+class BufferPool
+{
+public:
+	BufferPool(const unsigned int numFrames);
+	~BufferPool();
+
+	//get pointer to the frame holding the given page (read it from disk if needed), increments pin count
+	RC pinPage(FileHandle& fileHandle, PageNum pageNum, bool readFromDisk, void*& data);
+	//decrement pin count, and remember whether page content was modified (and LSN of its log record)
+	RC unpinPage(FileHandle& fileHandle, PageNum pageNum, bool isDirty, LSN pageLSN = 0);
+	//pinPage for at most MAX_VECTORED_PAGES pages (page may appear in the list more than once): pages that are not
+	//cached are read by a single preadv per run of consecutive pages
+	RC pinPages(FileHandle& fileHandle, const std::vector<PageNum>& pageNums, bool readFromDisk, std::vector<void*>& data);
+	//read pages into the buffer pool without pinning them (cached pages are skipped), same vectored reads as above
+	RC prefetchPages(FileHandle& fileHandle, const std::vector<PageNum>& pageNums);
+	//write back dirty (and committed) pages among the given ones, by a single pwritev per run of consecutive pages
+	RC writeBackPages(FileHandle& fileHandle, const std::vector<PageNum>& pageNums);
+	//write back at most maxPages of the committed dirty pages that are not pinned (oldest first, in file order), as long
+	//as more than maxDirty pages are dirty or page became dirty before dirtyTime
+	RC writeBackDirty(const unsigned int maxDirty, const unsigned long long dirtyTime, const unsigned int maxPages, unsigned int& numWritten);
+	//victim is a clean frame, unless all candidates are dirty (dirty pages are left to the background writer)
+	void setCleanVictimsFirst(const bool enabled);
+
+	//write back all dirty pages of the given file
+	RC flushFile(FileInfo* file);
+	//forget all pages of the given file without writing them (file is destroyed)
+	void discardFile(FileInfo* file);
+	//write back all dirty pages
+	RC flushAll();
+	//change number of frames (flushes everything, fails if any page is pinned)
+	RC resize(const unsigned int numFrames);
+
+	unsigned int getNumFrames() const;
+
+	//write-ahead log that has to be consulted before pages are written back (NULL if logging is off)
+	void setLogManager(LogManager* log);
+	//write back dirty pages and forget all cached pages (nothing may be pinned)
+	RC clear();
+
+	//pages pinned by the calling thread are saved before their first modification, until operation ends; rollback
+	//restores them (pages that were not cached are dropped) along with the number of pages of their files, which
+	//are returned (in-place modification of the page that was pinned before operation began is not rolled back)
+	void beginOperation();
+	void endOperation(const bool rollback, std::vector<FileInfo*>& files);
+	//number of pages pinned by the operation in progress (0 while logging is off), bulk operations are split by it
+	unsigned int getNumOperationPages();
+
+	//statistics (read without locking, so values are approximate while other threads use the pool)
+	unsigned int _hitCounter;
+	unsigned int _missCounter;
+	unsigned int _evictionCounter;
+	unsigned int _writeBackCounter;
+	unsigned int _prefetchCounter;
+
+protected:
+	//methods below expect mutex to be held by the caller
+	RC findVictim(unsigned int& frameIndex);
+	RC evictFrame(Frame& frame);
+	//take victim frame, pin it for the given page and read page into it (mutex may be released during read)
+	RC loadPage(FileHandle& fileHandle, PageNum pageNum, bool readFromDisk, unsigned int& frameIndex);
+	//take victim frame and pin it for the given page, without reading it (frame is marked as loading if it is going to be read)
+	RC reserveFrame(FileHandle& fileHandle, PageNum pageNum, bool loading, unsigned int& frameIndex);
+	//read pages into the reserved frames (mutex is released during read); frames that failed to load are released
+	RC readReservedFrames(FileHandle& fileHandle, std::vector<unsigned int>& frameIndexes);
+	RC writeBack(Frame& frame);
+	RC writeBackAll();
+	void allocateFrames(const unsigned int numFrames);
+	void allocateFrameData(Frame& frame, const unsigned int size);
+	void releaseFrames();
+	void resetFrame(Frame& frame);
+	//save page of the frame for the rollback of the operation (if the calling thread runs it and page is not saved yet)
+	void saveUndoImage(Frame& frame, const bool isCached);
+
+private:
+	std::vector<Frame> _frames;
+	/*
+	 * page table: <file, page number> => index of frame
+	**/
+	std::map<std::pair<FileInfo*, PageNum>, unsigned int> _pageTable;
+	/*
+	 * current position of the clock hand
+	**/
+	unsigned int _clockHand;
+	LogManager* _log;
+	bool _cleanVictimsFirst;
+	/*
+	 * operation in progress (if any), thread that runs it, its saved pages, and numbers of pages of its files
+	**/
+	bool _undoActive;
+	pthread_t _undoThread;
+	std::map<std::pair<FileInfo*, PageNum>, UndoImage> _undoImages;
+	std::map<FileInfo*, PageNum> _undoNumPages;
+	/*
+	 * guards frames, page table and clock hand; condition is signaled when a page finished loading
+	**/
+	pthread_mutex_t _mutex;
+	pthread_cond_t _loadedCond;
+};
+
+#endif
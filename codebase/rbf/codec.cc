@@ -0,0 +1,219 @@
+#include "codec.h"
+#include <stdlib.h>
+#include <string.h>
+
+RecordCodec* RecordCodec::create(const vector<Attribute> &recordDescriptor)
+{
+	bool isFixedWidth = recordDescriptor.empty() == false;
+	for( unsigned int i = 0; i < recordDescriptor.size(); i++ )
+	{
+		//dropped attributes have their own rules in encodeRecord/decodeRecord/sizeOfRecord
+		if( recordDescriptor[i].length == 0 )
+			return new GenericRecordCodec(recordDescriptor);
+
+		if( recordDescriptor[i].type == TypeVarChar )
+			isFixedWidth = false;
+	}
+
+	if( recordDescriptor.empty() )
+		return new GenericRecordCodec(recordDescriptor);
+
+	if( isFixedWidth == false )
+		return new VarRecordCodec(recordDescriptor);
+
+	//all-int/real schema with up to MAX_FIXED_CODEC_FIELDS attributes gets the copies of compile-time size
+	switch( recordDescriptor.size() )
+	{
+	case 1:
+		return new FixedRecordCodec<1>(recordDescriptor);
+	case 2:
+		return new FixedRecordCodec<2>(recordDescriptor);
+	case 3:
+		return new FixedRecordCodec<3>(recordDescriptor);
+	case 4:
+		return new FixedRecordCodec<4>(recordDescriptor);
+	case 5:
+		return new FixedRecordCodec<5>(recordDescriptor);
+	case 6:
+		return new FixedRecordCodec<6>(recordDescriptor);
+	case 7:
+		return new FixedRecordCodec<7>(recordDescriptor);
+	case MAX_FIXED_CODEC_FIELDS:
+		return new FixedRecordCodec<MAX_FIXED_CODEC_FIELDS>(recordDescriptor);
+	default:
+		return new FixedRecordCodec<0>(recordDescriptor);
+	}
+}
+
+RecordCodec::RecordCodec(const vector<Attribute> &recordDescriptor, const bool isFixedWidth)
+: _recordDescriptor(recordDescriptor), _isFixedWidth(isFixedWidth), _szOfHeader(RECORD_DIR_OFFSET(recordDescriptor.size()))
+{
+	RecordHeader header;
+	header._numFields = recordDescriptor.size();
+	header._numVarFields = 0;
+	for( unsigned int i = 0; i < recordDescriptor.size(); i++ )
+	{
+		if( recordDescriptor[i].type == TypeVarChar )
+			header._numVarFields++;
+	}
+
+	//null bitmap of the record without NULL fields is all zeros
+	_header.assign(_szOfHeader / sizeof(unsigned int), 0);
+	memcpy(&_header[0], &header, sizeof(RecordHeader));
+}
+
+RecordCodec::~RecordCodec()
+{
+	//do nothing
+}
+
+const vector<Attribute>& RecordCodec::getRecordDescriptor() const
+{
+	return _recordDescriptor;
+}
+
+bool RecordCodec::isFixedWidth() const
+{
+	return _isFixedWidth;
+}
+
+void RecordCodec::decodeGeneric(const void* encData, unsigned int& decodedSize, void* data) const
+{
+	RecordBasedFileManager::instance()->decodeRecord(_recordDescriptor, encData, decodedSize, data);
+}
+
+VarRecordCodec::VarRecordCodec(const vector<Attribute> &recordDescriptor)
+: RecordCodec(recordDescriptor, false), _numPrefixFields(0), _szOfPrefix(0)
+{
+	unsigned int numFields = recordDescriptor.size(), numVarFields = ((const RecordHeader*)&_header[0])->_numVarFields;
+
+	//fixed-width prefix
+	while( _numPrefixFields < numFields && recordDescriptor[_numPrefixFields].type != TypeVarChar )
+		_numPrefixFields++;
+
+	_szOfPrefix = _numPrefixFields * sizeof(unsigned int);
+
+	_dirOffset = RECORD_DIR_OFFSET(numFields);
+	_fixedOffset = RECORD_FIXED_OFFSET(numFields, numVarFields);
+	_varOffset = RECORD_VARCHAR_OFFSET(numFields);
+
+	//TypeInt/TypeReal values after the prefix follow the values of the prefix
+	unsigned int offset = _fixedOffset + _szOfPrefix;
+	for( unsigned int i = _numPrefixFields; i < numFields; i++ )
+	{
+		bool isVarChar = recordDescriptor[i].type == TypeVarChar;
+		_isVarChar.push_back(isVarChar ? 1 : 0);
+		_offsets.push_back(isVarChar ? 0 : offset);
+
+		if( isVarChar == false )
+			offset += sizeof(unsigned int);
+	}
+}
+
+unsigned int VarRecordCodec::sizeOfRecord(const void* data) const
+{
+	const char* ptrField = (const char*)data + _szOfPrefix;
+
+	for( unsigned int i = 0; i < _isVarChar.size(); i++ )
+	{
+		if( _isVarChar[i] )
+			ptrField += sizeof(unsigned int) + *((const unsigned int*)ptrField);
+		else
+			ptrField += sizeof(unsigned int);
+	}
+
+	return (unsigned int)(ptrField - (const char*)data);
+}
+
+void VarRecordCodec::encodeRecord(const void* data, unsigned int& szOfEncRecord, void* encData) const
+{
+	//header and null bitmap are the same for all records, and so is the place of the prefix
+	memcpy(encData, &_header[0], _szOfHeader);
+	memcpy((char*)encData + _fixedOffset, data, _szOfPrefix);
+
+	//characters of VarChar values follow TypeInt/TypeReal values one after another, their end offsets go to the directory
+	const char* ptrField = (const char*)data + _szOfPrefix;
+	unsigned int* ptrDir = (unsigned int*)((char*)encData + _dirOffset);
+	unsigned int curOffset = _varOffset;
+
+	for( unsigned int i = 0; i < _isVarChar.size(); i++ )
+	{
+		if( _isVarChar[i] == 0 )
+		{
+			memcpy((char*)encData + _offsets[i], ptrField, sizeof(unsigned int));
+			ptrField += sizeof(unsigned int);
+			continue;
+		}
+
+		unsigned int szOfField = *((const unsigned int*)ptrField);
+		ptrField += sizeof(unsigned int);
+
+		memcpy((char*)encData + curOffset, ptrField, szOfField);
+
+		ptrField += szOfField;
+		curOffset += szOfField;
+		*ptrDir++ = curOffset;
+	}
+
+	szOfEncRecord = curOffset;
+}
+
+void VarRecordCodec::decodeRecord(const void* encData, unsigned int& decodedSize, void* data) const
+{
+	//record written with a different number of fields, or with NULL fields, does not have the same layout
+	if( memcmp(encData, &_header[0], _szOfHeader) != 0 )
+	{
+		decodeGeneric(encData, decodedSize, data);
+		return;
+	}
+
+	memcpy(data, (const char*)encData + _fixedOffset, _szOfPrefix);
+
+	//characters of each VarChar value start where the previous one ends
+	const unsigned int* ptrDir = (const unsigned int*)((const char*)encData + _dirOffset);
+	unsigned int curOffset = _varOffset;
+	char* ptrData = (char*)data + _szOfPrefix;
+
+	for( unsigned int i = 0; i < _isVarChar.size(); i++ )
+	{
+		if( _isVarChar[i] == 0 )
+		{
+			memcpy(ptrData, (const char*)encData + _offsets[i], sizeof(unsigned int));
+			ptrData += sizeof(unsigned int);
+			continue;
+		}
+
+		unsigned int endOffset = FIELD_OFFSET(*ptrDir++);
+		unsigned int szOfField = endOffset - curOffset;
+
+		*((unsigned int*)ptrData) = szOfField;
+		ptrData += sizeof(unsigned int);
+
+		memcpy(ptrData, (const char*)encData + curOffset, szOfField);
+		ptrData += szOfField;
+		curOffset = endOffset;
+	}
+
+	decodedSize += (unsigned int)(ptrData - (char*)data);
+}
+
+GenericRecordCodec::GenericRecordCodec(const vector<Attribute> &recordDescriptor)
+: RecordCodec(recordDescriptor, false)
+{
+	//do nothing
+}
+
+unsigned int GenericRecordCodec::sizeOfRecord(const void* data) const
+{
+	return ::sizeOfRecord(_recordDescriptor, data);
+}
+
+void GenericRecordCodec::encodeRecord(const void* data, unsigned int& szOfEncRecord, void* encData) const
+{
+	RecordBasedFileManager::instance()->encodeRecord(_recordDescriptor, data, ::sizeOfRecord(_recordDescriptor, data), szOfEncRecord, encData);
+}
+
+void GenericRecordCodec::decodeRecord(const void* encData, unsigned int& decodedSize, void* data) const
+{
+	decodeGeneric(encData, decodedSize, data);
+}
@@ -0,0 +1,161 @@
+#ifndef _codec_h_
+#define _codec_h_
+
+#include <vector>
+#include <string.h>
+
+#include "../rbf/rbfm.h"
+
+/*
+ * largest number of attributes for which the all-int/real codec is instantiated with compile-time sizes (wider schemas get the
+ * instance that keeps the number of attributes at run time)
+**/
+#define MAX_FIXED_CODEC_FIELDS 8
+
+/*
+ * converter between the format of insertRecord/readRecord and the encoded format of RecordBasedFileManager::encodeRecord, built
+ * once for the record descriptor (shape of the schema is analysed up front, so per-record work does not switch on AttrType)
+ *
+ * encoded record is [RecordHeader][null bitmap][end offsets of VarChar values][TypeInt/TypeReal values][VarChar values]; results
+ * are byte-for-byte the same as those of encodeRecord/decodeRecord/sizeOfRecord, which remain the path for descriptors with dropped
+ * attributes, for records written with a different number of fields (i.e. before addAttribute) and for records with NULL fields
+**/
+class RecordCodec
+{
+public:
+	//pick the codec for the shape of the descriptor (caller deletes it)
+	static RecordCodec* create(const vector<Attribute> &recordDescriptor);
+
+	virtual ~RecordCodec();
+
+	//same as sizeOfRecord, RecordBasedFileManager::encodeRecord and RecordBasedFileManager::decodeRecord (decodedSize is added to)
+	virtual unsigned int sizeOfRecord(const void* data) const = 0;
+	virtual void encodeRecord(const void* data, unsigned int& szOfEncRecord, void* encData) const = 0;
+	virtual void decodeRecord(const void* encData, unsigned int& decodedSize, void* data) const = 0;
+
+	const vector<Attribute>& getRecordDescriptor() const;
+	//all attributes are TypeInt/TypeReal, so records have constant size and constant offsets
+	bool isFixedWidth() const;
+
+protected:
+	RecordCodec(const vector<Attribute> &recordDescriptor, const bool isFixedWidth);
+
+	//decode the record thru RecordBasedFileManager::decodeRecord
+	void decodeGeneric(const void* encData, unsigned int& decodedSize, void* data) const;
+
+	/*
+	 * descriptor the codec was built for
+	**/
+	vector<Attribute> _recordDescriptor;
+	bool _isFixedWidth;
+	/*
+	 * [RecordHeader][null bitmap without NULL fields] shared by all records encoded by the codec (record that starts with
+	 * anything else has to be decoded by decodeGeneric), and its size
+	**/
+	vector<unsigned int> _header;
+	unsigned int _szOfHeader;
+};
+
+/*
+ * codec of the schema made of NumFields TypeInt/TypeReal attributes (NumFields = 0: number of attributes is kept at run time)
+ *
+ * record has no directory, and its header does not depend on the values; encoding is two memcpy calls and decoding is a
+ * comparison of the header and one memcpy, all of constant size
+**/
+template <unsigned int NumFields>
+class FixedRecordCodec : public RecordCodec
+{
+public:
+	FixedRecordCodec(const vector<Attribute> &recordDescriptor)
+	: RecordCodec(recordDescriptor, true), _numFields(recordDescriptor.size())
+	{
+		//do nothing
+	}
+
+	unsigned int sizeOfRecord(const void* data) const
+	{
+		return getNumFields() * sizeof(unsigned int);
+	}
+
+	void encodeRecord(const void* data, unsigned int& szOfEncRecord, void* encData) const
+	{
+		memcpy(encData, &_header[0], getSzOfHeader());
+		memcpy((char*)encData + getSzOfHeader(), data, getNumFields() * sizeof(unsigned int));
+		szOfEncRecord = getSzOfHeader() + getNumFields() * sizeof(unsigned int);
+	}
+
+	void decodeRecord(const void* encData, unsigned int& decodedSize, void* data) const
+	{
+		if( memcmp(encData, &_header[0], getSzOfHeader()) != 0 )
+		{
+			decodeGeneric(encData, decodedSize, data);
+			return;
+		}
+
+		memcpy(data, (const char*)encData + getSzOfHeader(), getNumFields() * sizeof(unsigned int));
+		decodedSize += getNumFields() * sizeof(unsigned int);
+	}
+
+protected:
+	//both are constant for the instances with NumFields > 0
+	unsigned int getNumFields() const
+	{
+		return NumFields != 0 ? NumFields : _numFields;
+	}
+
+	unsigned int getSzOfHeader() const
+	{
+		return NumFields != 0 ? RECORD_DIR_OFFSET(NumFields) : _szOfHeader;
+	}
+
+private:
+	unsigned int _numFields;
+};
+
+/*
+ * codec of the schema that has TypeVarChar attributes: leading TypeInt/TypeReal attributes (the fixed-width prefix) are copied
+ * as one block to and from the start of TypeInt/TypeReal values, the rest is walked by the list of varchar positions (other
+ * TypeInt/TypeReal values have precomputed offsets)
+**/
+class VarRecordCodec : public RecordCodec
+{
+public:
+	VarRecordCodec(const vector<Attribute> &recordDescriptor);
+
+	unsigned int sizeOfRecord(const void* data) const;
+	void encodeRecord(const void* data, unsigned int& szOfEncRecord, void* encData) const;
+	void decodeRecord(const void* encData, unsigned int& decodedSize, void* data) const;
+
+private:
+	/*
+	 * number of attributes and bytes of the fixed-width prefix
+	**/
+	unsigned int _numPrefixFields;
+	unsigned int _szOfPrefix;
+	/*
+	 * offsets of the directory, of the first TypeInt/TypeReal value and of the first character of VarChar values
+	**/
+	unsigned int _dirOffset;
+	unsigned int _fixedOffset;
+	unsigned int _varOffset;
+	/*
+	 * attribute after the prefix is TypeVarChar (1) or 4 bytes wide (0), and offset of the value of the latter
+	**/
+	vector<unsigned char> _isVarChar;
+	vector<unsigned int> _offsets;
+};
+
+/*
+ * codec of the descriptor with dropped attributes: everything goes thru the generic functions of RecordBasedFileManager
+**/
+class GenericRecordCodec : public RecordCodec
+{
+public:
+	GenericRecordCodec(const vector<Attribute> &recordDescriptor);
+
+	unsigned int sizeOfRecord(const void* data) const;
+	void encodeRecord(const void* data, unsigned int& szOfEncRecord, void* encData) const;
+	void decodeRecord(const void* encData, unsigned int& decodedSize, void* data) const;
+};
+
+#endif
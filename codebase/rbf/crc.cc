@@ -0,0 +1,193 @@
+#include "crc.h"
+#include <string.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <nmmintrin.h>
+#define CRC32C_HAS_SSE42 1
+#endif
+
+/*
+ * reflected Castagnoli polynomial
+**/
+#define CRC32C_POLYNOMIAL 0x82F63B78u
+/*
+ * hardware implementation computes CRC of three consecutive blocks of this size at once (crc32 instruction has latency
+ * of 3 cycles, but one can be issued every cycle), and then combines them
+**/
+#define CRC32C_BLOCK_SIZE 256
+
+typedef unsigned int (*CrcFunction)(const void*, const size_t);
+
+/*
+ * lookup tables for slicing-by-8: _table[0] is the classic byte-at-a-time table, _table[k] advances CRC of a byte
+ * by k more zero bytes, so that 8 bytes are folded in per step
+ *
+ * _shiftBlock / _shiftTwoBlocks advance CRC (byte by byte of its 4 bytes) over CRC32C_BLOCK_SIZE / twice as many
+ * zero bytes, which is what combining CRCs of adjacent blocks takes
+**/
+struct CrcTables
+{
+	unsigned int _table[8][256];
+	unsigned int _shiftBlock[4][256];
+	unsigned int _shiftTwoBlocks[4][256];
+
+	CrcTables()
+	{
+		for( unsigned int i = 0; i < 256; i++ )
+		{
+			unsigned int crc = i;
+			for( unsigned int bit = 0; bit < 8; bit++ )
+				crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLYNOMIAL : crc >> 1;
+			_table[0][i] = crc;
+		}
+
+		for( unsigned int i = 0; i < 256; i++ )
+		{
+			for( unsigned int k = 1; k < 8; k++ )
+				_table[k][i] = (_table[k - 1][i] >> 8) ^ _table[0][_table[k - 1][i] & 0xFF];
+		}
+
+		for( unsigned int k = 0; k < 4; k++ )
+		{
+			for( unsigned int i = 0; i < 256; i++ )
+			{
+				unsigned int crc = i << (8 * k);
+				for( unsigned int n = 0; n < 2 * CRC32C_BLOCK_SIZE; n++ )
+				{
+					crc = (crc >> 8) ^ _table[0][crc & 0xFF];
+					if( n + 1 == CRC32C_BLOCK_SIZE )
+						_shiftBlock[k][i] = crc;
+				}
+				_shiftTwoBlocks[k][i] = crc;
+			}
+		}
+	}
+
+	//CRC register after the given number of zero bytes
+	static unsigned int shift(const unsigned int (*table)[256], const unsigned int crc)
+	{
+		return table[0][crc & 0xFF] ^ table[1][(crc >> 8) & 0xFF] ^ table[2][(crc >> 16) & 0xFF] ^ table[3][crc >> 24];
+	}
+};
+
+static const CrcTables& crcTables()
+{
+	//initialized once, on first use (thread-safe)
+	static CrcTables tables;
+	return tables;
+}
+
+unsigned int crc32cPortable(const void* data, const size_t size)
+{
+	const unsigned int (*table)[256] = crcTables()._table;
+	const unsigned char* ptr = (const unsigned char*)data;
+	size_t length = size;
+	unsigned int crc = 0xFFFFFFFFu;
+
+	//process 8 bytes at a time (pages are little-endian on all supported platforms)
+	while( length >= 8 )
+	{
+		unsigned int low = 0, high = 0;
+		memcpy(&low, ptr, sizeof(unsigned int));
+		memcpy(&high, ptr + sizeof(unsigned int), sizeof(unsigned int));
+		low ^= crc;
+
+		crc = table[7][low & 0xFF] ^ table[6][(low >> 8) & 0xFF] ^ table[5][(low >> 16) & 0xFF] ^ table[4][low >> 24] ^
+			  table[3][high & 0xFF] ^ table[2][(high >> 8) & 0xFF] ^ table[1][(high >> 16) & 0xFF] ^ table[0][high >> 24];
+
+		ptr += 8;
+		length -= 8;
+	}
+
+	while( length > 0 )
+	{
+		crc = (crc >> 8) ^ table[0][(crc ^ *ptr) & 0xFF];
+		ptr++;
+		length--;
+	}
+
+	return ~crc;
+}
+
+#ifdef CRC32C_HAS_SSE42
+
+__attribute__((target("sse4.2")))
+unsigned int crc32cHardware(const void* data, const size_t size)
+{
+	const unsigned char* ptr = (const unsigned char*)data;
+	size_t length = size;
+	unsigned long long crc = 0xFFFFFFFFu;
+
+	//CRC is linear: crc(A|B|C) = shift2L(crc(A)) ^ shiftL(crc0(B)) ^ crc0(C), where crc0 starts from zero register
+	if( length >= 3 * CRC32C_BLOCK_SIZE )
+	{
+		const CrcTables& tables = crcTables();
+
+		while( length >= 3 * CRC32C_BLOCK_SIZE )
+		{
+			unsigned long long crcB = 0, crcC = 0;
+
+			for( unsigned int i = 0; i < CRC32C_BLOCK_SIZE; i += 8 )
+			{
+				unsigned long long valueA = 0, valueB = 0, valueC = 0;
+				memcpy(&valueA, ptr + i, sizeof(valueA));
+				memcpy(&valueB, ptr + CRC32C_BLOCK_SIZE + i, sizeof(valueB));
+				memcpy(&valueC, ptr + 2 * CRC32C_BLOCK_SIZE + i, sizeof(valueC));
+				crc = _mm_crc32_u64(crc, valueA);
+				crcB = _mm_crc32_u64(crcB, valueB);
+				crcC = _mm_crc32_u64(crcC, valueC);
+			}
+
+			crc = CrcTables::shift(tables._shiftTwoBlocks, (unsigned int)crc) ^
+				  CrcTables::shift(tables._shiftBlock, (unsigned int)crcB) ^ (unsigned int)crcC;
+
+			ptr += 3 * CRC32C_BLOCK_SIZE;
+			length -= 3 * CRC32C_BLOCK_SIZE;
+		}
+	}
+
+	while( length >= 8 )
+	{
+		unsigned long long value = 0;
+		memcpy(&value, ptr, sizeof(value));
+		crc = _mm_crc32_u64(crc, value);
+		ptr += 8;
+		length -= 8;
+	}
+
+	unsigned int crc32 = (unsigned int)crc;
+	while( length > 0 )
+	{
+		crc32 = _mm_crc32_u8(crc32, *ptr);
+		ptr++;
+		length--;
+	}
+
+	return ~crc32;
+}
+
+bool crc32cHardwareSupported()
+{
+	return __builtin_cpu_supports("sse4.2");
+}
+
+#else
+
+unsigned int crc32cHardware(const void* data, const size_t size)
+{
+	return crc32cPortable(data, size);
+}
+
+bool crc32cHardwareSupported()
+{
+	return false;
+}
+
+#endif
+
+unsigned int crc32c(const void* data, const size_t size)
+{
+	//CPU is checked only once
+	static const CrcFunction function = crc32cHardwareSupported() ? crc32cHardware : crc32cPortable;
+	return function(data, size);
+}
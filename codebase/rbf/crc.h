@@ -0,0 +1,21 @@
+#ifndef _crc_h_
+#define _crc_h_
+
+#include <stddef.h>
+
+/*
+ * CRC32C (Castagnoli polynomial), used as checksum of the file pages
+ *
+ * crc32c picks the fastest implementation available on this CPU: SSE4.2 crc32 instruction on x86-64, otherwise
+ * portable table-driven (slicing-by-8) code. All of them produce the same value.
+**/
+unsigned int crc32c(const void* data, const size_t size);
+
+//portable implementation (always available)
+unsigned int crc32cPortable(const void* data, const size_t size);
+
+//SSE4.2 implementation; may be called only if crc32cHardwareSupported returns true
+unsigned int crc32cHardware(const void* data, const size_t size);
+bool crc32cHardwareSupported();
+
+#endif
@@ -0,0 +1,232 @@
+#include "fsm.h"
+#include <stdlib.h>
+#include <string.h>
+
+FreeSpaceMap::FreeSpaceMap(const unsigned int numEntriesPerHeader)
+: _capacity(1), _numEntriesPerHeader(numEntriesPerHeader)
+{
+	_tree.assign(2, 0);
+}
+
+FreeSpaceMap::~FreeSpaceMap()
+{
+	//do nothing
+}
+
+void FreeSpaceMap::reserve(const unsigned int numEntries)
+{
+	if( numEntries <= _capacity )
+		return;
+
+	//grow capacity to the next power of two and re-insert existing leaves
+	unsigned int newCapacity = _capacity;
+	while( newCapacity < numEntries )
+		newCapacity *= 2;
+
+	std::vector<unsigned int> newTree(2 * newCapacity, 0);
+
+	//copy leaves
+	for( unsigned int i = 0; i < _capacity; i++ )
+		newTree[newCapacity + i] = _tree[_capacity + i];
+
+	//re-compute internal nodes
+	for( unsigned int i = newCapacity - 1; i > 0; i-- )
+		newTree[i] = newTree[2 * i] > newTree[2 * i + 1] ? newTree[2 * i] : newTree[2 * i + 1];
+
+	_tree.swap(newTree);
+	_capacity = newCapacity;
+}
+
+void FreeSpaceMap::setEntry(const unsigned int index, const unsigned int numFreeBytes)
+{
+	unsigned int node = _capacity + index;
+
+	//nothing to do, if value did not change
+	if( _tree[node] == numFreeBytes )
+		return;
+
+	_tree[node] = numFreeBytes;
+
+	//propagate maximum up to the root
+	for( node /= 2; node > 0; node /= 2 )
+	{
+		unsigned int maxOfChildren = _tree[2 * node] > _tree[2 * node + 1] ? _tree[2 * node] : _tree[2 * node + 1];
+
+		if( _tree[node] == maxOfChildren )
+			break;
+
+		_tree[node] = maxOfChildren;
+	}
+}
+
+RC FreeSpaceMap::build(FileHandle& fileHandle)
+{
+	RC errCode = 0;
+
+	//reset
+	_headerPageIds.clear();
+	_nextHeaderPageIds.clear();
+	_numUsedPageIds.clear();
+	_headerPosition.clear();
+	_headerOfDataPage.clear();
+	_capacity = 1;
+	_tree.assign(2, 0);
+
+	void* data = malloc(fileHandle.getPageSize());
+
+	//loop thru header pages
+	PageNum headerPageId = 0;
+	do
+	{
+		//guard against corrupted chain (cycle)
+		if( _headerPosition.find(headerPageId) != _headerPosition.end() )
+		{
+			free(data);
+			return -11;
+		}
+
+		if( (errCode = fileHandle.readPage(headerPageId, data)) != 0 )
+		{
+			free(data);
+			return errCode;
+		}
+
+		addHeaderPage(_headerPageIds.empty() ? 0 : _headerPageIds.back(), headerPageId);
+		_nextHeaderPageIds.back() = ((Header*)data)->_nextHeaderPageId;
+		syncHeaderPage(headerPageId, data, fileHandle.getNumberOfPages());
+
+		headerPageId = ((Header*)data)->_nextHeaderPageId;
+
+		//page ids read from the file are not trusted: chain that leads outside of the file is not a header chain
+		if( headerPageId >= fileHandle.getNumberOfPages() )
+		{
+			free(data);
+			return -11;
+		}
+
+	} while( headerPageId > 0 );
+
+	free(data);
+
+	//success
+	return 0;
+}
+
+void FreeSpaceMap::addHeaderPage(const PageNum prevHeaderPageId, const PageNum newHeaderPageId)
+{
+	//link new header page with the previous one
+	if( _headerPageIds.empty() == false )
+	{
+		std::map<PageNum, unsigned int>::iterator iter = _headerPosition.find(prevHeaderPageId);
+		if( iter != _headerPosition.end() )
+			_nextHeaderPageIds[iter->second] = newHeaderPageId;
+	}
+
+	_headerPosition[newHeaderPageId] = _headerPageIds.size();
+	_headerPageIds.push_back(newHeaderPageId);
+	_nextHeaderPageIds.push_back(0);
+	_numUsedPageIds.push_back(0);
+
+	reserve(_headerPageIds.size() * _numEntriesPerHeader);
+}
+
+bool FreeSpaceMap::syncHeaderPage(const PageNum headerPageId, const void* data, const PageNum numPages)
+{
+	std::map<PageNum, unsigned int>::iterator iter = _headerPosition.find(headerPageId);
+
+	//not a header page of this map
+	if( iter == _headerPosition.end() )
+		return true;
+
+	const Header* hPage = (const Header*)data;
+	unsigned int position = iter->second;
+
+	//if chain got re-linked (e.g. all records got deleted), then this map is obsolete
+	if( hPage->_nextHeaderPageId != _nextHeaderPageIds[position] )
+		return false;
+
+	unsigned int numUsed = hPage->_numUsedPageIds;
+	if( numUsed > _numEntriesPerHeader )
+		numUsed = _numEntriesPerHeader;
+
+	_numUsedPageIds[position] = numUsed;
+
+	//update entries of this header page (entries of pages outside of the file never qualify)
+	unsigned int firstEntry = position * _numEntriesPerHeader;
+	for( unsigned int i = 0; i < _numEntriesPerHeader; i++ )
+	{
+		bool isValid = i < numUsed && hPage->_arrOfPageIds[i]._pageid < numPages;
+		setEntry(firstEntry + i, isValid ? hPage->_arrOfPageIds[i]._numFreeBytes : 0);
+	}
+
+	//remember which header lists each of its data pages
+	for( unsigned int i = 0; i < numUsed; i++ )
+	{
+		PageNum pageNum = hPage->_arrOfPageIds[i]._pageid;
+		if( pageNum >= numPages )
+			continue;
+
+		if( pageNum >= _headerOfDataPage.size() )
+			_headerOfDataPage.resize(pageNum + 1, (PageNum)-1);
+
+		_headerOfDataPage[pageNum] = headerPageId;
+	}
+
+	return true;
+}
+
+bool FreeSpaceMap::findPage(const unsigned int numFreeBytes, PageNum& headerPageId, unsigned int& entryIndex) const
+{
+	//unused entries store 0, so they never qualify
+	if( numFreeBytes == 0 || _tree[1] < numFreeBytes )
+		return false;
+
+	//descend to the left-most leaf that satisfies the requirement
+	unsigned int node = 1;
+	while( node < _capacity )
+	{
+		node = ( _tree[2 * node] >= numFreeBytes ) ? 2 * node : 2 * node + 1;
+	}
+
+	unsigned int index = node - _capacity;
+
+	headerPageId = _headerPageIds[index / _numEntriesPerHeader];
+	entryIndex = index % _numEntriesPerHeader;
+
+	return true;
+}
+
+bool FreeSpaceMap::findHeaderPage(const PageNum pageId, PageNum& headerPageId) const
+{
+	//walk of the chain subtracts number of entries per header page until page id fits into number of used entries,
+	//and since none of the header pages has more entries than that, only one header page can match
+	unsigned int position = pageId == 0 ? 0 : (pageId - 1) / _numEntriesPerHeader;
+
+	if( position >= _headerPageIds.size() || pageId - position * _numEntriesPerHeader > _numUsedPageIds[position] )
+		return false;
+
+	headerPageId = _headerPageIds[position];
+
+	return true;
+}
+
+bool FreeSpaceMap::findHeaderOfDataPage(const PageNum pageNum, PageNum& headerPageId) const
+{
+	//page that was moved to another header page is listed by the one that was synchronized last
+	if( pageNum >= _headerOfDataPage.size() || _headerOfDataPage[pageNum] == (PageNum)-1 )
+		return false;
+
+	headerPageId = _headerOfDataPage[pageNum];
+
+	return true;
+}
+
+bool FreeSpaceMap::isHeaderPage(const PageNum pageNum) const
+{
+	return _headerPosition.find(pageNum) != _headerPosition.end();
+}
+
+PageNum FreeSpaceMap::getLastHeaderPage() const
+{
+	return _headerPageIds.empty() ? 0 : _headerPageIds.back();
+}
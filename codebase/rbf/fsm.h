@@ -0,0 +1,85 @@
+#ifndef _fsm_h_
+#define _fsm_h_
+
+#include <vector>
+#include <map>
+
+#include "../rbf/pfm.h"
+
+/*
+ * in-memory free-space map of a file
+ *
+ * mirrors PageInfo::_numFreeBytes of all data pages referenced by the header pages, so that PagedFileManager::getDataPage
+ * does not have to walk the header page chain on every insertion. Entries are kept in the order of the header chain
+ * (header page by header page, entry by entry) and stored as leaves of a max segment tree, which allows to find the
+ * first page with enough free space in O(log n) while preserving the first-fit order of the original linear scan.
+ *
+ * also serves as the directory of header pages (their ids and number of used entries), so that header page of a data
+ * page and the last header page are found without reading the chain
+ *
+ * built when file is opened (or lazily on first use, if that failed) and kept in sync by every write of a header page
+**/
+class FreeSpaceMap
+{
+public:
+	FreeSpaceMap(const unsigned int numEntriesPerHeader);
+	~FreeSpaceMap();
+
+	//read the header chain of the file and fill in the map
+	RC build(FileHandle& fileHandle);
+
+	//find the first data page (in the order of the header chain) that has at least the given number of free bytes
+	bool findPage(const unsigned int numFreeBytes, PageNum& headerPageId, unsigned int& entryIndex) const;
+
+	//header page has been modified; update entries from its new content (entries of pages at or beyond numPages are ignored,
+	//which is how build treats header pages read from the file)
+	//returns false if the structure of the chain has changed (i.e. map has to be re-built)
+	bool syncHeaderPage(const PageNum headerPageId, const void* data, const PageNum numPages = (PageNum)-1);
+
+	//new header page has been linked after the given one
+	void addHeaderPage(const PageNum prevHeaderPageId, const PageNum newHeaderPageId);
+
+	//find header page that references the given data page (same arithmetic as the walk of the header chain)
+	bool findHeaderPage(const PageNum pageId, PageNum& headerPageId) const;
+	//find header page whose entries list the given data page (exact, unlike findHeaderPage: header pages in between and
+	//re-used pages are taken into account)
+	bool findHeaderOfDataPage(const PageNum pageNum, PageNum& headerPageId) const;
+
+	bool isHeaderPage(const PageNum pageNum) const;
+	PageNum getLastHeaderPage() const;
+
+protected:
+	void setEntry(const unsigned int index, const unsigned int numFreeBytes);
+	void reserve(const unsigned int numEntries);
+
+private:
+	/*
+	 * header page ids in the order of the chain, and the next-pointer stored in each of them
+	**/
+	std::vector<PageNum> _headerPageIds;
+	std::vector<PageNum> _nextHeaderPageIds;
+	/*
+	 * number of used page ids in each header page (same order)
+	**/
+	std::vector<unsigned int> _numUsedPageIds;
+	/*
+	 * header page id => position in the chain
+	**/
+	std::map<PageNum, unsigned int> _headerPosition;
+	/*
+	 * data page id => header page that lists it ((PageNum)-1 if none)
+	**/
+	std::vector<PageNum> _headerOfDataPage;
+	/*
+	 * max segment tree: node 1 is the root, leaves occupy [_capacity, 2 * _capacity)
+	 * leaf (headerPosition * _numEntriesPerHeader + entryIndex) stores the number of free bytes of the page, unused entries are 0
+	**/
+	std::vector<unsigned int> _tree;
+	unsigned int _capacity;
+	/*
+	 * number of entries in a header page (depends on page size of the file)
+	**/
+	unsigned int _numEntriesPerHeader;
+};
+
+#endif
@@ -0,0 +1,190 @@
+#include "iostats.h"
+
+#include <string.h>
+
+IOHistogram::IOHistogram()
+: _count(0), _sum(0), _max(0)
+{
+	memset(_buckets, 0, sizeof(_buckets));
+}
+
+unsigned int IOHistogram::getBucket(const unsigned long long value)
+{
+	if( value < 2 )
+		return (unsigned int)value;
+
+	//position of the highest bit, and the bit that follows it
+	unsigned int exponent = 63 - __builtin_clzll(value);
+	unsigned int bucket = 2 * exponent + (unsigned int)((value >> (exponent - 1)) & 1);
+
+	return bucket < IO_HISTOGRAM_NUM_BUCKETS ? bucket : IO_HISTOGRAM_NUM_BUCKETS - 1;
+}
+
+unsigned long long IOHistogram::getBucketLimit(const unsigned int bucket)
+{
+	if( bucket < 2 )
+		return bucket;
+
+	//last bucket is not bounded
+	if( bucket >= IO_HISTOGRAM_NUM_BUCKETS - 1 )
+		return ~0ULL;
+
+	unsigned int exponent = bucket / 2;
+	unsigned long long lowest = (2ULL + (bucket & 1)) << (exponent - 1);
+
+	return lowest + (1ULL << (exponent - 1)) - 1;
+}
+
+void IOHistogram::record(const unsigned long long value)
+{
+	_buckets[getBucket(value)]++;
+	_count++;
+	_sum += value;
+
+	if( value > _max )
+		_max = value;
+}
+
+void IOHistogram::recordShared(const unsigned long long value)
+{
+	__sync_fetch_and_add(&_buckets[getBucket(value)], 1);
+	__sync_fetch_and_add(&_count, 1);
+	__sync_fetch_and_add(&_sum, value);
+
+	//raise maximum, unless other thread raised it above this value in the meantime (it is read atomically, as others swap it)
+	unsigned long long max = __sync_fetch_and_add(&_max, 0);
+	while( value > max && __sync_bool_compare_and_swap(&_max, max, value) == false )
+		max = __sync_fetch_and_add(&_max, 0);
+}
+
+void IOHistogram::merge(const IOHistogram& histogram)
+{
+	for( unsigned int i = 0; i < IO_HISTOGRAM_NUM_BUCKETS; i++ )
+		_buckets[i] += histogram._buckets[i];
+
+	_count += histogram._count;
+	_sum += histogram._sum;
+
+	if( histogram._max > _max )
+		_max = histogram._max;
+}
+
+void IOHistogram::reset()
+{
+	memset(_buckets, 0, sizeof(_buckets));
+	_count = _sum = _max = 0;
+}
+
+unsigned long long IOHistogram::getCount() const
+{
+	return _count;
+}
+
+unsigned long long IOHistogram::getSum() const
+{
+	return _sum;
+}
+
+unsigned long long IOHistogram::getMax() const
+{
+	return _max;
+}
+
+double IOHistogram::getMean() const
+{
+	return _count == 0 ? 0.0 : (double)_sum / _count;
+}
+
+unsigned long long IOHistogram::getPercentile(const double percent) const
+{
+	if( _count == 0 )
+		return 0;
+
+	//rank of the value (1-based), e.g. 50th percentile of 3 values is the 2nd one
+	unsigned long long rank = (unsigned long long)(percent / 100.0 * _count + 0.999999);
+	if( rank == 0 )
+		rank = 1;
+
+	unsigned long long numValues = 0;
+	for( unsigned int i = 0; i < IO_HISTOGRAM_NUM_BUCKETS; i++ )
+	{
+		numValues += _buckets[i];
+		if( numValues >= rank )
+		{
+			//none of the values exceeds the maximum
+			unsigned long long limit = getBucketLimit(i);
+			return limit < _max ? limit : _max;
+		}
+	}
+
+	return _max;
+}
+
+IOStats::IOStats()
+: _bytesRead(0), _bytesWritten(0), _position(0), _endOfFile(0)
+{
+}
+
+void IOStats::record(const IOKind kind, const unsigned long long offset, const unsigned long long numBytes, const unsigned long long nanos)
+{
+	IOKind actualKind = (kind == IO_WRITE && offset >= _endOfFile ? IO_APPEND : kind);
+
+	_latency[actualKind].record(nanos);
+	_seekDistance.record(offset > _position ? offset - _position : _position - offset);
+	_position = offset + numBytes;
+
+	if( kind == IO_READ )
+	{
+		_bytesRead += numBytes;
+	}
+	else
+	{
+		_bytesWritten += numBytes;
+
+		if( _position > _endOfFile )
+			_endOfFile = _position;
+	}
+}
+
+void IOStats::recordShared(const IOKind kind, const unsigned long long offset, const unsigned long long numBytes, const unsigned long long nanos)
+{
+	unsigned long long endOfFile = __sync_fetch_and_add(&_endOfFile, 0);
+	IOKind actualKind = (kind == IO_WRITE && offset >= endOfFile ? IO_APPEND : kind);
+
+	//swap in end of this transfer, so that concurrent transfers measure their distance from distinct positions
+	unsigned long long position = __sync_lock_test_and_set(&_position, offset + numBytes);
+
+	_latency[actualKind].recordShared(nanos);
+	_seekDistance.recordShared(offset > position ? offset - position : position - offset);
+
+	if( kind == IO_READ )
+	{
+		__sync_fetch_and_add(&_bytesRead, numBytes);
+	}
+	else
+	{
+		__sync_fetch_and_add(&_bytesWritten, numBytes);
+
+		while( offset + numBytes > endOfFile && __sync_bool_compare_and_swap(&_endOfFile, endOfFile, offset + numBytes) == false )
+			endOfFile = __sync_fetch_and_add(&_endOfFile, 0);
+	}
+}
+
+void IOStats::merge(const IOStats& stats)
+{
+	for( unsigned int i = 0; i < IO_NUM_KINDS; i++ )
+		_latency[i].merge(stats._latency[i]);
+
+	_seekDistance.merge(stats._seekDistance);
+	_bytesRead += stats._bytesRead;
+	_bytesWritten += stats._bytesWritten;
+}
+
+void IOStats::reset()
+{
+	for( unsigned int i = 0; i < IO_NUM_KINDS; i++ )
+		_latency[i].reset();
+
+	_seekDistance.reset();
+	_bytesRead = _bytesWritten = 0;
+}
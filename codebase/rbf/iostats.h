@@ -0,0 +1,90 @@
+#ifndef _iostats_h_
+#define _iostats_h_
+
+#include <time.h>
+
+/*
+ * histogram has two buckets per power of two (i.e. value is known within 50% of its magnitude), values from 2^40 on
+ * (about 18 minutes in nanoseconds, or 1TB in bytes) share the last bucket
+**/
+#define IO_HISTOGRAM_NUM_BUCKETS 80
+
+/*
+ * kinds of transfers; append is a write that goes beyond the end of file
+**/
+typedef enum { IO_READ = 0, IO_WRITE, IO_APPEND } IOKind;
+#define IO_NUM_KINDS 3
+
+/*
+ * distribution of values with log-scale buckets (similar to HDR histogram): values 0 and 1 have their own buckets, every
+ * other value v with 2^e <= v < 2^(e+1) goes to bucket 2*e when v < 1.5 * 2^e and to bucket 2*e + 1 otherwise
+**/
+class IOHistogram
+{
+public:
+	IOHistogram();
+
+	//add value (recordShared may be called by several threads at once)
+	void record(const unsigned long long value);
+	void recordShared(const unsigned long long value);
+	//add all values of the other histogram
+	void merge(const IOHistogram& histogram);
+	void reset();
+
+	unsigned long long getCount() const;
+	unsigned long long getSum() const;
+	unsigned long long getMax() const;
+	double getMean() const;
+	//value below which the given percent of values are (upper bound of their bucket, so it is over-estimated by up to 50%)
+	unsigned long long getPercentile(const double percent) const;
+
+	//bucket of the value, and the largest value of the bucket
+	static unsigned int getBucket(const unsigned long long value);
+	static unsigned long long getBucketLimit(const unsigned int bucket);
+
+public:
+	unsigned int _buckets[IO_HISTOGRAM_NUM_BUCKETS];
+	unsigned long long _count;
+	unsigned long long _sum;
+	unsigned long long _max;
+};
+
+/*
+ * I/O statistics of the file (or of its handle): latency of reads, writes and appends (in nanoseconds), bytes moved,
+ * and seek distance, i.e. number of bytes between the end of the previous transfer and the start of the next one (0 for
+ * sequential access)
+**/
+class IOStats
+{
+public:
+	IOStats();
+
+	//account for transfer of numBytes at the given offset that took given number of nanoseconds (recordShared may be
+	//called by several threads at once)
+	void record(const IOKind kind, const unsigned long long offset, const unsigned long long numBytes, const unsigned long long nanos);
+	void recordShared(const IOKind kind, const unsigned long long offset, const unsigned long long numBytes, const unsigned long long nanos);
+	//add statistics of other file/handle (position and end of file are not changed)
+	void merge(const IOStats& stats);
+	void reset();
+
+public:
+	IOHistogram _latency[IO_NUM_KINDS];
+	IOHistogram _seekDistance;
+	unsigned long long _bytesRead;
+	unsigned long long _bytesWritten;
+	/*
+	 * end of the last transfer, and end of the file as far as transfers know it (write beyond it is an append)
+	**/
+	unsigned long long _position;
+	unsigned long long _endOfFile;
+};
+
+//monotonic clock in nanoseconds, used to time the transfers
+inline unsigned long long ioClock()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+#endif
@@ -0,0 +1,200 @@
+#include "lz.h"
+#include <string.h>
+
+/*
+ * number of entries (log2) of the table of the most recent positions of 4-byte sequences
+**/
+#define LZ_HASH_BITS 12
+/*
+ * farthest match (offset is stored in 2 bytes)
+**/
+#define LZ_MAX_DISTANCE 65535
+
+static inline unsigned int read32(const unsigned char* ptr)
+{
+	unsigned int value;
+	memcpy(&value, ptr, sizeof(value));
+	return value;
+}
+
+static inline unsigned int hash32(const unsigned int value)
+{
+	return (value * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+/*
+ * write length that did not fit into the nibble of the token (255 per byte, the last byte is less than 255)
+**/
+static inline unsigned char* writeLength(unsigned char* op, size_t length)
+{
+	while( length >= 255 )
+	{
+		*op++ = 255;
+		length -= 255;
+	}
+	*op++ = (unsigned char)length;
+
+	return op;
+}
+
+/*
+ * emit one sequence: literals [anchor, anchor + numLiterals) followed by match (matchLength == 0 for the last sequence)
+ * returns NULL if it does not fit into the output
+**/
+static unsigned char* writeSequence(unsigned char* op, const unsigned char* oend, const unsigned char* anchor, const size_t numLiterals,
+		const unsigned int offset, const size_t matchLength)
+{
+	//token, lengths (at most one byte per 255), literals and offset
+	size_t maxSize = 1 + (numLiterals / 255 + 1) + numLiterals + 2 + (matchLength / 255 + 1);
+	if( (size_t)(oend - op) < maxSize )
+		return NULL;
+
+	size_t matchCode = (matchLength == 0 ? 0 : matchLength - LZ_MIN_MATCH);
+	unsigned char* token = op++;
+	*token = (unsigned char)(((numLiterals < 15 ? numLiterals : 15) << 4) | (matchCode < 15 ? matchCode : 15));
+
+	if( numLiterals >= 15 )
+		op = writeLength(op, numLiterals - 15);
+
+	memcpy(op, anchor, numLiterals);
+	op += numLiterals;
+
+	if( matchLength == 0 )
+		return op;
+
+	*op++ = (unsigned char)(offset & 0xFF);
+	*op++ = (unsigned char)(offset >> 8);
+
+	if( matchCode >= 15 )
+		op = writeLength(op, matchCode - 15);
+
+	return op;
+}
+
+size_t lzCompress(const void* src, const size_t srcSize, void* dst, const size_t dstCapacity)
+{
+	const unsigned char* base = (const unsigned char*)src;
+	const unsigned char* ip = base;
+	const unsigned char* anchor = base;
+	const unsigned char* iend = base + srcSize;
+	unsigned char* op = (unsigned char*)dst;
+	const unsigned char* oend = op + dstCapacity;
+
+	//positions (+1, so that 0 means empty) of the last occurrence of 4-byte sequences
+	unsigned int table[1 << LZ_HASH_BITS];
+	memset(table, 0, sizeof(table));
+
+	//number of positions tried without finding a match; the longer the run, the larger the step (skips incompressible data)
+	unsigned int numMisses = 0;
+
+	while( ip + LZ_MIN_MATCH <= iend )
+	{
+		unsigned int sequence = read32(ip);
+		unsigned int h = hash32(sequence);
+		unsigned int candidate = table[h];
+		table[h] = (unsigned int)(ip - base) + 1;
+
+		const unsigned char* ref = (candidate == 0 ? NULL : base + candidate - 1);
+		if( ref == NULL || ip - ref > LZ_MAX_DISTANCE || read32(ref) != sequence )
+		{
+			ip += 1 + (numMisses++ >> 5);
+			continue;
+		}
+
+		numMisses = 0;
+
+		//extend the match
+		size_t matchLength = LZ_MIN_MATCH;
+		while( ip + matchLength < iend && ref[matchLength] == ip[matchLength] )
+			matchLength++;
+
+		if( (op = writeSequence(op, oend, anchor, ip - anchor, (unsigned int)(ip - ref), matchLength)) == NULL )
+			return 0;
+
+		ip += matchLength;
+		anchor = ip;
+	}
+
+	//remaining bytes are literals of the last sequence
+	if( (op = writeSequence(op, oend, anchor, iend - anchor, 0, 0)) == NULL )
+		return 0;
+
+	return op - (unsigned char*)dst;
+}
+
+int lzDecompress(const void* src, const size_t srcSize, void* dst, const size_t dstCapacity)
+{
+	const unsigned char* ip = (const unsigned char*)src;
+	const unsigned char* iend = ip + srcSize;
+	unsigned char* base = (unsigned char*)dst;
+	unsigned char* op = base;
+	unsigned char* oend = base + dstCapacity;
+
+	while( ip < iend )
+	{
+		unsigned int token = *ip++;
+
+		//literals
+		size_t numLiterals = token >> 4;
+		if( numLiterals == 15 )
+		{
+			unsigned int value = 255;
+			while( value == 255 )
+			{
+				if( ip >= iend )
+					return -1;
+				value = *ip++;
+				numLiterals += value;
+			}
+		}
+
+		if( (size_t)(iend - ip) < numLiterals || (size_t)(oend - op) < numLiterals )
+			return -1;
+
+		memcpy(op, ip, numLiterals);
+		ip += numLiterals;
+		op += numLiterals;
+
+		//last sequence has no match
+		if( ip == iend )
+			break;
+
+		//match
+		if( iend - ip < 2 )
+			return -1;
+
+		size_t offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+
+		size_t matchLength = (token & 15) + LZ_MIN_MATCH;
+		if( (token & 15) == 15 )
+		{
+			unsigned int value = 255;
+			while( value == 255 )
+			{
+				if( ip >= iend )
+					return -1;
+				value = *ip++;
+				matchLength += value;
+			}
+		}
+
+		if( offset == 0 || offset > (size_t)(op - base) || (size_t)(oend - op) < matchLength )
+			return -1;
+
+		const unsigned char* ref = op - offset;
+		if( offset >= matchLength )
+		{
+			memcpy(op, ref, matchLength);
+			op += matchLength;
+		}
+		else
+		{
+			//overlapping match repeats the last offset bytes
+			for( size_t i = 0; i < matchLength; i++ )
+				*op++ = *ref++;
+		}
+	}
+
+	return (int)(op - base);
+}
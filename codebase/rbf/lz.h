@@ -0,0 +1,23 @@
+#ifndef _lz_h_
+#define _lz_h_
+
+#include <stddef.h>
+
+/*
+ * fast LZ77 codec (in the spirit of LZ4) used to compress pages of compressed files
+ *
+ * compressed data is a sequence of: token byte (high nibble - number of literals, low nibble - match length minus
+ * LZ_MIN_MATCH; nibble 15 is followed by bytes that are added to it, until byte != 255), literals, 2-byte little-endian
+ * offset of the match (distance back from the current position) and the match itself. The last sequence ends right
+ * after its literals. Source is at most 64KB (a page), so matches never reach further back than 65535 bytes.
+**/
+#define LZ_MIN_MATCH 4
+
+//compress srcSize bytes into dst; returns size of compressed data, or 0 if it does not fit into dstCapacity bytes
+size_t lzCompress(const void* src, const size_t srcSize, void* dst, const size_t dstCapacity);
+
+//decompress srcSize bytes into dst; returns number of bytes produced, or -1 if compressed data is corrupted
+//(i.e. it refers outside of the buffers, or does not fit into dstCapacity bytes)
+int lzDecompress(const void* src, const size_t srcSize, void* dst, const size_t dstCapacity);
+
+#endif
@@ -0,0 +1,207 @@
+#include "pagemap.h"
+#include "lz.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+PageMap::PageMap(const unsigned int pageSize)
+: _readByteCounter(0), _writeByteCounter(0), _uncompressedByteCounter(0), _endOfSlots(pageSize), _mapFd(-1), _pageSize(pageSize)
+{
+	pthread_mutex_init(&_mutex, NULL);
+}
+
+PageMap::~PageMap()
+{
+	if( _mapFd >= 0 )
+		close(_mapFd);
+
+	pthread_mutex_destroy(&_mutex);
+}
+
+RC PageMap::create(const std::string& fileName)
+{
+	int fd = ::open((fileName + PAGE_MAP_SUFFIX).c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if( fd < 0 )
+		return -2;
+
+	close(fd);
+
+	//success
+	return 0;
+}
+
+RC PageMap::destroy(const std::string& fileName)
+{
+	if( remove((fileName + PAGE_MAP_SUFFIX).c_str()) != 0 )
+		return -6;
+
+	//success
+	return 0;
+}
+
+RC PageMap::open(const std::string& fileName)
+{
+	if( (_mapFd = ::open((fileName + PAGE_MAP_SUFFIX).c_str(), O_RDWR)) < 0 )
+		return -78;
+
+	struct stat mapStat;
+	if( fstat(_mapFd, &mapStat) != 0 )
+		return -78;
+
+	//read the whole map at once
+	_slots.resize(mapStat.st_size / sizeof(PageSlot));
+	if( _slots.empty() == false &&
+		pread(_mapFd, &_slots[0], _slots.size() * sizeof(PageSlot), 0) != (ssize_t)(_slots.size() * sizeof(PageSlot)) )
+		return -78;
+
+	//new slots go after the last one
+	_endOfSlots = _pageSize;
+	for( unsigned int i = 1; i < _slots.size(); i++ )
+	{
+		if( _slots[i]._length > 0 && _slots[i]._offset + _slots[i]._capacity > _endOfSlots )
+			_endOfSlots = _slots[i]._offset + _slots[i]._capacity;
+	}
+
+	//success
+	return 0;
+}
+
+unsigned int PageMap::getNumPages()
+{
+	pthread_mutex_lock(&_mutex);
+	unsigned int numPages = _slots.size();
+	pthread_mutex_unlock(&_mutex);
+
+	return numPages;
+}
+
+RC PageMap::readPage(const int fd, const PageNum pageNum, void* data, PageSlot* location)
+{
+	pthread_mutex_lock(&_mutex);
+
+	//page that is not in the map does not exist, same as page beyond the end of the regular file
+	if( pageNum == 0 || pageNum >= _slots.size() )
+	{
+		pthread_mutex_unlock(&_mutex);
+		return -13;
+	}
+
+	PageSlot slot = _slots[pageNum];
+	_readByteCounter += slot._length;
+
+	pthread_mutex_unlock(&_mutex);
+
+	if( location != NULL )
+		*location = slot;
+
+	//page has not been written yet (gap left by lazily appended pages)
+	if( slot._length == 0 )
+	{
+		memset(data, 0, _pageSize);
+		return 0;
+	}
+
+	//page did not compress, so it is stored as is
+	if( slot._length == _pageSize )
+	{
+		return pread(fd, data, _pageSize, slot._offset) == (ssize_t)_pageSize ? 0 : -13;
+	}
+
+	void* buffer = malloc(slot._length);
+	if( pread(fd, buffer, slot._length, slot._offset) != (ssize_t)slot._length )
+	{
+		free(buffer);
+		return -13;
+	}
+
+	int numBytes = lzDecompress(buffer, slot._length, data, _pageSize);
+	free(buffer);
+
+	return numBytes == (int)_pageSize ? 0 : -78;
+}
+
+RC PageMap::writePage(const int fd, const PageNum pageNum, const void* data, PageSlot* location)
+{
+	if( pageNum == 0 )
+		return -11;
+
+	//compress page, keep it as is if it does not get smaller
+	void* buffer = malloc(_pageSize);
+	unsigned int length = lzCompress(data, _pageSize, buffer, _pageSize - 1);
+	const void* content = buffer;
+
+	if( length == 0 )
+	{
+		length = _pageSize;
+		content = data;
+	}
+
+	pthread_mutex_lock(&_mutex);
+
+	//pages can be written in any order (appended pages are written back lazily)
+	if( pageNum >= _slots.size() )
+	{
+		PageSlot emptySlot = {0, 0, 0};
+		_slots.resize(pageNum + 1, emptySlot);
+	}
+
+	PageSlot slot = _slots[pageNum];
+	PageSlot oldSlot = slot;
+
+	//page does not fit into its slot, so find another one
+	if( slot._length == 0 || slot._capacity < length )
+	{
+		unsigned int capacity = length + length / 8;
+		capacity = (capacity + PAGE_SLOT_ALIGNMENT - 1) / PAGE_SLOT_ALIGNMENT * PAGE_SLOT_ALIGNMENT;
+
+		std::multimap<unsigned int, unsigned long long>::iterator iter = _freeSlots.lower_bound(length);
+		if( iter != _freeSlots.end() && iter->first <= capacity + capacity / 2 )
+		{
+			slot._offset = iter->second;
+			slot._capacity = iter->first;
+			_freeSlots.erase(iter);
+		}
+		else
+		{
+			slot._offset = _endOfSlots;
+			slot._capacity = capacity;
+			_endOfSlots += capacity;
+		}
+	}
+
+	slot._length = length;
+	_writeByteCounter += length;
+	_uncompressedByteCounter += _pageSize;
+
+	//page is written by one thread at a time (buffer pool has a single frame per page), so its slot can be updated here
+	_slots[pageNum] = slot;
+
+	pthread_mutex_unlock(&_mutex);
+
+	if( location != NULL )
+		*location = slot;
+
+	RC errCode = 0;
+
+	//write page into its slot first, then record the slot in the map (old slot keeps the previous content until then)
+	if( pwrite(fd, content, length, slot._offset) != (ssize_t)length ||
+		pwrite(_mapFd, &slot, sizeof(PageSlot), (off_t)pageNum * sizeof(PageSlot)) != (ssize_t)sizeof(PageSlot) )
+	{
+		errCode = -13;
+	}
+
+	free(buffer);
+
+	//old slot can be re-used now
+	if( oldSlot._length > 0 && oldSlot._offset != slot._offset )
+	{
+		pthread_mutex_lock(&_mutex);
+		_freeSlots.insert(std::pair<unsigned int, unsigned long long>(oldSlot._capacity, oldSlot._offset));
+		pthread_mutex_unlock(&_mutex);
+	}
+
+	return errCode;
+}
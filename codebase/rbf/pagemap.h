@@ -0,0 +1,87 @@
+#ifndef _pagemap_h_
+#define _pagemap_h_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <pthread.h>
+
+#include "../rbf/pfm.h"
+
+/*
+ * name of the file that keeps page map of the compressed file is the name of the data file followed by this suffix
+**/
+#define PAGE_MAP_SUFFIX ".pmap"
+/*
+ * slots of the compressed pages start at multiples of this size; slot is larger than compressed page by 1/8 (rounded up
+ * to the alignment), so that page that grows a little after being re-written still fits in place
+**/
+#define PAGE_SLOT_ALIGNMENT 64
+
+/*
+ * location of the page inside compressed file: offset of its slot, size of compressed page (== page size if page did not
+ * compress, so it is stored as is; 0 if page has never been written) and size of the slot
+**/
+struct PageSlot
+{
+	unsigned long long _offset;
+	unsigned int _length;
+	unsigned int _capacity;
+};
+
+/*
+ * page map of the compressed file
+ *
+ * first page (header) of the compressed file is stored as is at offset 0, all other pages are compressed (see lz.h) and
+ * stored in variable-size slots that follow it. Slot of every page is recorded in the map file (array of PageSlot indexed
+ * by page number), which is read into memory when file is opened and updated right after the page is written. Re-written
+ * page that does not fit into its slot moves to a new one, and the old slot is re-used by the following writes of this
+ * session (slots abandoned in earlier sessions are not reclaimed; compressed files are meant to be written once and read many times).
+ *
+ * methods may be called from several threads (buffer pool write backs and read-ahead)
+**/
+class PageMap
+{
+public:
+	PageMap(const unsigned int pageSize);
+	~PageMap();
+
+	//create empty map file for the data file / remove it
+	static RC create(const std::string& fileName);
+	static RC destroy(const std::string& fileName);
+
+	//read map file of the data file (has to be called before any other method)
+	RC open(const std::string& fileName);
+
+	//number of pages recorded in the map (including the first page)
+	unsigned int getNumPages();
+
+	//transfer page (of page size) between memory and its slot in the data file opened as fd (slot that was accessed is
+	//returned thru location, if it is given)
+	RC readPage(const int fd, const PageNum pageNum, void* data, PageSlot* location = NULL);
+	RC writePage(const int fd, const PageNum pageNum, const void* data, PageSlot* location = NULL);
+
+	//statistics: bytes of the compressed pages transferred to/from the data file, and bytes of pages before compression
+	unsigned long long _readByteCounter;
+	unsigned long long _writeByteCounter;
+	unsigned long long _uncompressedByteCounter;
+
+private:
+	/*
+	 * slots of all pages (entry of the first page is not used), and end of the last slot in the data file
+	**/
+	std::vector<PageSlot> _slots;
+	unsigned long long _endOfSlots;
+	/*
+	 * abandoned slots: capacity => offset
+	**/
+	std::multimap<unsigned int, unsigned long long> _freeSlots;
+	/*
+	 * OS file descriptor of the map file
+	**/
+	int _mapFd;
+	unsigned int _pageSize;
+	pthread_mutex_t _mutex;
+};
+
+#endif
@@ -0,0 +1,352 @@
+#include "pax.h"
+#include <stdlib.h>
+#include <string.h>
+
+PaxPage::PaxPage(void* data, const unsigned int pageSize)
+: _data((char*)data), _pageSize(pageSize), _movedOffset(0), _usedSize(0)
+{
+	locateMinipages();
+}
+
+PaxPage::~PaxPage()
+{
+	//do nothing (page belongs to the caller)
+}
+
+unsigned int PaxPage::getSlotSize(const vector<Attribute> &recordDescriptor, const void* encodedRecord)
+{
+	//state of the slot, and value (or end offset) of each attribute in its minipage
+	unsigned int size = sizeof(unsigned int) + recordDescriptor.size() * sizeof(unsigned int);
+
+	//characters follow the end offsets (in the encoded record characters of all VarChar values are stored one after another)
+	const RecordHeader* header = (const RecordHeader*)encodedRecord;
+	if( header->_numVarFields > 0 )
+	{
+		const unsigned int* ptrDir = (const unsigned int*)((const char*)encodedRecord + RECORD_DIR_OFFSET(header->_numFields));
+		size += FIELD_OFFSET(ptrDir[header->_numVarFields - 1]) - RECORD_VARCHAR_OFFSET(header->_numFields);
+	}
+
+	return size;
+}
+
+unsigned int PaxPage::getNumSlots() const
+{
+	return ((const unsigned int*)_data)[0];
+}
+
+unsigned int PaxPage::getNumAttributes() const
+{
+	return ((const unsigned int*)_data)[1];
+}
+
+unsigned int PaxPage::getNumFreeBytes() const
+{
+	return _usedSize < _pageSize ? _pageSize - _usedSize : 0;
+}
+
+unsigned int PaxPage::getSlotState(const unsigned int slotNum) const
+{
+	if( slotNum >= getNumSlots() )
+		return PAX_SLOT_DELETED;
+
+	//states follow the types of the attributes
+	return ((const unsigned int*)_data)[3 + getNumAttributes() + slotNum];
+}
+
+RID PaxPage::getMovedRid(const unsigned int slotNum) const
+{
+	RID rid = {0, 0};
+
+	const PaxMovedEntry* entries = (const PaxMovedEntry*)(_data + _movedOffset);
+	unsigned int numMoved = ((const unsigned int*)_data)[2];
+
+	for( unsigned int i = 0; i < numMoved; i++ )
+	{
+		if( entries[i]._slotNum == slotNum )
+		{
+			rid = entries[i]._rid;
+			break;
+		}
+	}
+
+	return rid;
+}
+
+void PaxPage::locateMinipages()
+{
+	const unsigned int* header = (const unsigned int*)_data;
+	unsigned int numSlots = header[0], numAttributes = header[1], numMoved = header[2];
+	const unsigned int* types = header + 3;
+
+	//first minipage follows the states of the slots
+	unsigned int offset = PAX_PAGE_HEADER_SIZE(numAttributes) + numSlots * sizeof(unsigned int);
+
+	_minipages.resize(numAttributes);
+	for( unsigned int i = 0; i < numAttributes; i++ )
+	{
+		_minipages[i] = offset;
+
+		offset += numSlots * sizeof(unsigned int);
+
+		//characters of all slots follow their end offsets (end offset of the last slot is the size of all characters)
+		if( types[i] == TypeVarChar && numSlots > 0 )
+			offset += FIELD_OFFSET(((const unsigned int*)(_data + _minipages[i]))[numSlots - 1]);
+	}
+
+	_movedOffset = offset;
+	_usedSize = offset + numMoved * sizeof(PaxMovedEntry);
+}
+
+void PaxPage::getField(const unsigned int slotNum, const int position, const char*& ptrField, unsigned int& szOfField, bool& isOverflow) const
+{
+	ptrField = NULL;
+	szOfField = 0;
+	isOverflow = false;
+
+	unsigned int numSlots = getNumSlots();
+
+	//records of this page were inserted before the attribute was added
+	if( position < 0 || (unsigned int)position >= getNumAttributes() || slotNum >= numSlots )
+		return;
+
+	const char* minipage = _data + _minipages[position];
+
+	if( ((const unsigned int*)_data)[3 + position] != TypeVarChar )
+	{
+		ptrField = minipage + slotNum * sizeof(unsigned int);
+		szOfField = sizeof(unsigned int);
+		return;
+	}
+
+	const unsigned int* ends = (const unsigned int*)minipage;
+	unsigned int begin = slotNum == 0 ? 0 : FIELD_OFFSET(ends[slotNum - 1]);
+
+	ptrField = minipage + numSlots * sizeof(unsigned int) + begin;
+	szOfField = FIELD_OFFSET(ends[slotNum]) - begin;
+	isOverflow = (ends[slotNum] & OVERFLOW_FIELD_FLAG) != 0;
+}
+
+unsigned int PaxPage::getRecord(const unsigned int slotNum, void* encodedRecord) const
+{
+	//same format as RecordBasedFileManager::encodeRecord (see RecordHeader); minipages do not keep NULL fields, so none is NULL
+	unsigned int numAttributes = getNumAttributes(), numVarFields = 0;
+	const unsigned int* types = (const unsigned int*)_data + 3;
+	for( unsigned int i = 0; i < numAttributes; i++ )
+	{
+		if( types[i] == TypeVarChar )
+			numVarFields++;
+	}
+
+	RecordHeader* header = (RecordHeader*)encodedRecord;
+	header->_numFields = numAttributes;
+	header->_numVarFields = numVarFields;
+	memset((char*)encodedRecord + sizeof(RecordHeader), 0, RECORD_NULL_BITMAP_SIZE(numAttributes));
+
+	unsigned int* ptrDir = (unsigned int*)((char*)encodedRecord + RECORD_DIR_OFFSET(numAttributes));
+	char* ptrFixed = (char*)encodedRecord + RECORD_FIXED_OFFSET(numAttributes, numVarFields);
+	unsigned int offset = RECORD_VARCHAR_OFFSET(numAttributes);
+	for( unsigned int i = 0; i < numAttributes; i++ )
+	{
+		const char* ptrField = NULL;
+		unsigned int szOfField = 0;
+		bool isOverflow = false;
+		getField(slotNum, i, ptrField, szOfField, isOverflow);
+
+		//fixed size value goes to its static offset
+		if( types[i] != TypeVarChar )
+		{
+			memcpy(ptrFixed, ptrField, sizeof(unsigned int));
+			ptrFixed += sizeof(unsigned int);
+			continue;
+		}
+
+		if( szOfField > 0 )
+			memcpy((char*)encodedRecord + offset, ptrField, szOfField);
+		offset += szOfField;
+		*ptrDir++ = isOverflow ? offset | OVERFLOW_FIELD_FLAG : offset;
+	}
+
+	return offset;
+}
+
+RC PaxPage::insertRecord(const vector<Attribute> &recordDescriptor, const void* encodedRecord, const unsigned int state, unsigned int& slotNum)
+{
+	//lowest deleted slot is re-used
+	unsigned int numSlots = getNumSlots();
+	for( slotNum = 0; slotNum < numSlots; slotNum++ )
+	{
+		if( getSlotState(slotNum) == PAX_SLOT_DELETED )
+			break;
+	}
+
+	return repack(slotNum, state, &recordDescriptor, encodedRecord, NULL);
+}
+
+RC PaxPage::updateRecord(const unsigned int slotNum, const vector<Attribute> &recordDescriptor, const void* encodedRecord)
+{
+	//record that was moved here stays relocated
+	unsigned int state = getSlotState(slotNum) == PAX_SLOT_RELOCATED ? PAX_SLOT_RELOCATED : PAX_SLOT_USED;
+
+	return repack(slotNum, state, &recordDescriptor, encodedRecord, NULL);
+}
+
+RC PaxPage::moveRecord(const unsigned int slotNum, const RID& rid)
+{
+	return repack(slotNum, PAX_SLOT_MOVED, NULL, NULL, &rid);
+}
+
+RC PaxPage::deleteRecord(const unsigned int slotNum)
+{
+	return repack(slotNum, PAX_SLOT_DELETED, NULL, NULL, NULL);
+}
+
+void PaxPage::getNewField(const unsigned int slotNum, const int position, const unsigned int changedSlot, const unsigned int state,
+		const vector<Attribute>* recordDescriptor, const std::vector<unsigned int>& fieldIndexes, const void* encodedRecord,
+		const char*& ptrField, unsigned int& szOfField, bool& isOverflow) const
+{
+	if( slotNum != changedSlot )
+	{
+		getField(slotNum, position, ptrField, szOfField, isOverflow);
+		return;
+	}
+
+	ptrField = NULL;
+	szOfField = 0;
+	isOverflow = false;
+
+	//deleted and moved slots keep empty values
+	if( encodedRecord == NULL || (state != PAX_SLOT_USED && state != PAX_SLOT_RELOCATED) )
+		return;
+
+	//field of the encoded record (record may have fewer attributes than the page, NULL field is kept as empty value)
+	if( (unsigned int)position >= fieldIndexes.size() )
+		return;
+
+	bool isNull = false;
+	getEncodedField(encodedRecord, position, (*recordDescriptor)[position].type, fieldIndexes[position], ptrField, szOfField, isOverflow, isNull);
+}
+
+RC PaxPage::repack(const unsigned int slotNum, const unsigned int state, const vector<Attribute>* recordDescriptor, const void* encodedRecord, const RID* movedRid)
+{
+	const unsigned int* header = (const unsigned int*)_data;
+	unsigned int oldNumSlots = header[0], oldNumAttributes = header[1], oldNumMoved = header[2];
+	const PaxMovedEntry* oldEntries = (const PaxMovedEntry*)(_data + _movedOffset);
+
+	//page gets attributes that were added to the record descriptor
+	unsigned int numAttributes = oldNumAttributes;
+	if( recordDescriptor != NULL && recordDescriptor->size() > numAttributes )
+		numAttributes = recordDescriptor->size();
+
+	//types and states of the new page
+	std::vector<unsigned int> types(numAttributes), states(slotNum + 1 > oldNumSlots ? slotNum + 1 : oldNumSlots, PAX_SLOT_DELETED);
+	for( unsigned int i = 0; i < numAttributes; i++ )
+		types[i] = i < oldNumAttributes ? header[3 + i] : (*recordDescriptor)[i].type;
+	for( unsigned int i = 0; i < oldNumSlots; i++ )
+		states[i] = getSlotState(i);
+	states[slotNum] = state;
+
+	//fields of the new record are located by their index among the fields of their kind
+	std::vector<unsigned int> fieldIndexes;
+	if( recordDescriptor != NULL )
+		getFieldIndexes(*recordDescriptor, fieldIndexes);
+
+	//deleted slots at the end of the page are dropped
+	while( states.empty() == false && states.back() == PAX_SLOT_DELETED )
+		states.pop_back();
+	unsigned int numSlots = states.size();
+
+	//moved records that stay
+	std::vector<PaxMovedEntry> entries;
+	for( unsigned int i = 0; i < oldNumMoved; i++ )
+	{
+		if( oldEntries[i]._slotNum != slotNum && oldEntries[i]._slotNum < numSlots )
+			entries.push_back(oldEntries[i]);
+	}
+	if( state == PAX_SLOT_MOVED )
+	{
+		PaxMovedEntry entry;
+		entry._slotNum = slotNum;
+		entry._rid = *movedRid;
+		entries.push_back(entry);
+	}
+
+	//determine size of the new page first, so that page is left intact if it does not fit
+	unsigned int size = PAX_PAGE_HEADER_SIZE(numAttributes) + numSlots * sizeof(unsigned int) + entries.size() * sizeof(PaxMovedEntry);
+	for( unsigned int i = 0; i < numAttributes; i++ )
+	{
+		size += numSlots * sizeof(unsigned int);
+
+		if( types[i] != TypeVarChar )
+			continue;
+
+		for( unsigned int j = 0; j < numSlots; j++ )
+		{
+			const char* ptrField = NULL;
+			unsigned int szOfField = 0;
+			bool isOverflow = false;
+			getNewField(j, i, slotNum, state, recordDescriptor, fieldIndexes, encodedRecord, ptrField, szOfField, isOverflow);
+			size += szOfField;
+		}
+	}
+
+	if( size > _pageSize )
+	{
+		return -22;	//not enough space in the page
+	}
+
+	//build the new page (rest of it stays zeroed)
+	char* newPage = (char*)malloc(_pageSize);
+	memset(newPage, 0, _pageSize);
+
+	unsigned int* newHeader = (unsigned int*)newPage;
+	newHeader[0] = numSlots;
+	newHeader[1] = numAttributes;
+	newHeader[2] = entries.size();
+	for( unsigned int i = 0; i < numAttributes; i++ )
+		newHeader[3 + i] = types[i];
+	for( unsigned int i = 0; i < numSlots; i++ )
+		newHeader[3 + numAttributes + i] = states[i];
+
+	unsigned int offset = PAX_PAGE_HEADER_SIZE(numAttributes) + numSlots * sizeof(unsigned int);
+	for( unsigned int i = 0; i < numAttributes; i++ )
+	{
+		unsigned int* ends = (unsigned int*)(newPage + offset);
+		char* ptrMinipage = newPage + offset + numSlots * sizeof(unsigned int);
+		unsigned int end = 0;
+
+		for( unsigned int j = 0; j < numSlots; j++ )
+		{
+			const char* ptrField = NULL;
+			unsigned int szOfField = 0;
+			bool isOverflow = false;
+			getNewField(j, i, slotNum, state, recordDescriptor, fieldIndexes, encodedRecord, ptrField, szOfField, isOverflow);
+
+			if( types[i] == TypeVarChar )
+			{
+				if( szOfField > 0 )
+					memcpy(ptrMinipage + end, ptrField, szOfField);
+				end += szOfField;
+				ends[j] = isOverflow ? end | OVERFLOW_FIELD_FLAG : end;
+			}
+			else if( szOfField > 0 )
+			{
+				//empty value of the fixed size attribute stays 0
+				memcpy(newPage + offset + j * sizeof(unsigned int), ptrField, szOfField < sizeof(unsigned int) ? szOfField : sizeof(unsigned int));
+			}
+		}
+
+		offset += numSlots * sizeof(unsigned int) + end;
+	}
+
+	if( entries.empty() == false )
+		memcpy(newPage + offset, &entries[0], entries.size() * sizeof(PaxMovedEntry));
+
+	//replace content of the page
+	memcpy(_data, newPage, _pageSize);
+	free(newPage);
+
+	locateMinipages();
+
+	//success
+	return 0;
+}
@@ -0,0 +1,110 @@
+#ifndef _pax_h_
+#define _pax_h_
+
+#include <vector>
+
+#include "../rbf/rbfm.h"
+
+/*
+ * states of the slots of the PAX page
+**/
+#define PAX_SLOT_DELETED 0		//free slot (re-used by the next insertion)
+#define PAX_SLOT_USED 1			//regular record
+#define PAX_SLOT_MOVED 2		//record did not fit after update, and was moved to the rid stored in the list of moved records
+#define PAX_SLOT_RELOCATED 3	//record that was moved here from another slot (scan returns it at its original rid)
+
+//size of the page meta-data that does not depend on the number of slots: [number of slots][number of attributes][number of moved records][types of attributes]
+#define PAX_PAGE_HEADER_SIZE(numAttributes) (3 * sizeof(unsigned int) + (numAttributes) * sizeof(unsigned int))
+
+/*
+ * entry of the list of moved records (plays the role of the TombStone of the row-wise page)
+**/
+struct PaxMovedEntry
+{
+	/*
+	 * slot of this page that was moved
+	**/
+	unsigned int _slotNum;
+	/*
+	 * place the record was moved to
+	**/
+	RID _rid;
+};
+
+/*
+ * data page of the file created with LAYOUT_PAX (partition attributes across): values of each attribute of all records of the
+ * page are grouped together in the minipage of that attribute, so that a scan touches only minipages of the attributes it
+ * filters on and projects
+ *
+ * page has a following format (all integers are unsigned int):
+ * [number of slots][number of attributes][number of moved records][type of each attribute][state of each slot]
+ * [minipage of the 1st attribute]...[minipage of the last attribute][list of moved records:PaxMovedEntry][free space]
+ *
+ * minipage of the TypeInt/TypeReal attribute holds 4 bytes per slot; minipage of the TypeVarChar attribute holds end offset of
+ * each slot's characters (measured from the end of these offsets) followed by the characters of all slots; value that is kept in
+ * overflow pages is stored as OverflowPointer, and its end offset has OVERFLOW_FIELD_FLAG set. Deleted and moved slots keep empty
+ * values. Page full of zeros is an empty page.
+ *
+ * page is always packed: every modification re-builds it (in memory) in the same format, so there is nothing to reorganize
+**/
+class PaxPage
+{
+public:
+	//wrap content of the page (modifications are made in place, caller writes the page)
+	PaxPage(void* data, const unsigned int pageSize);
+	~PaxPage();
+
+	//number of bytes the encoded record (see RecordBasedFileManager::encodeRecord) takes in a page with the same attributes
+	static unsigned int getSlotSize(const vector<Attribute> &recordDescriptor, const void* encodedRecord);
+
+	unsigned int getNumSlots() const;
+	unsigned int getNumAttributes() const;
+	unsigned int getNumFreeBytes() const;
+	//PAX_SLOT_DELETED for slots beyond the last one
+	unsigned int getSlotState(const unsigned int slotNum) const;
+	//place of the moved record ({0,0} if slot was not moved)
+	RID getMovedRid(const unsigned int slotNum) const;
+
+	//locate value of the attribute (in the same form as inside the encoded record) within its minipage; attributes that
+	//page does not have are returned empty, isOverflow is set if the value is OverflowPointer
+	void getField(const unsigned int slotNum, const int position, const char*& ptrField, unsigned int& szOfField, bool& isOverflow) const;
+
+	//re-assemble encoded record of the slot, returns its size
+	unsigned int getRecord(const unsigned int slotNum, void* encodedRecord) const;
+
+	//all modifications return -22 if page does not have enough space (page is left intact)
+	//put record into the lowest deleted slot (or into a new one)
+	RC insertRecord(const vector<Attribute> &recordDescriptor, const void* encodedRecord, const unsigned int state, unsigned int& slotNum);
+	RC updateRecord(const unsigned int slotNum, const vector<Attribute> &recordDescriptor, const void* encodedRecord);
+	//drop values of the record, and remember where it was moved to
+	RC moveRecord(const unsigned int slotNum, const RID& rid);
+	RC deleteRecord(const unsigned int slotNum);
+
+protected:
+	//find minipages and list of moved records inside the page
+	void locateMinipages();
+
+	//re-build the page with the given slot changed (record is NULL for deleted and moved slots, movedRid is used by moved ones)
+	RC repack(const unsigned int slotNum, const unsigned int state, const vector<Attribute>* recordDescriptor, const void* encodedRecord, const RID* movedRid);
+
+	//value of the slot inside the page being re-built (the changed slot takes it from the new record, fieldIndexes come from
+	//getFieldIndexes for its descriptor)
+	void getNewField(const unsigned int slotNum, const int position, const unsigned int changedSlot, const unsigned int state,
+			const vector<Attribute>* recordDescriptor, const std::vector<unsigned int>& fieldIndexes, const void* encodedRecord,
+			const char*& ptrField, unsigned int& szOfField, bool& isOverflow) const;
+
+private:
+	/*
+	 * content of the page and its size
+	**/
+	char* _data;
+	unsigned int _pageSize;
+	/*
+	 * offset of each minipage from the start of the page, offset of the list of moved records, and number of bytes used
+	**/
+	std::vector<unsigned int> _minipages;
+	unsigned int _movedOffset;
+	unsigned int _usedSize;
+};
+
+#endif
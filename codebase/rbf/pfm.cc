@@ -1,18 +1,47 @@
 #include "pfm.h"
+#include "bpm.h"
+#include "fsm.h"
+#include "allocmap.h"
+#include "wal.h"
+#include "prefetch.h"
+#include "crc.h"
+#include "pagemap.h"
+#include "bgwriter.h"
 #include <stdio.h>
 #include <sys/stat.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <errno.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <iostream>
 
 PagedFileManager* PagedFileManager::_pf_manager = 0;
 
+/*
+ * nesting depth of the operation of the calling thread (operations of different threads commit independently)
+**/
+static __thread unsigned int operationDepth = 0;
+
+/*
+ * buffer pool uses write-back policy, so dirty pages of files that were never closed have to reach the disk before process exits
+**/
+static void flushBufferPoolAtExit()
+{
+	PagedFileManager::instance()->flushBufferPool();
+}
+
 PagedFileManager* PagedFileManager::instance()
 {
     if(!_pf_manager)
     {
         _pf_manager = new PagedFileManager();
         _pf_manager->_files = std::map<std::string, FileInfo>();
+
+        atexit(flushBufferPoolAtExit);
     }
 
     return _pf_manager;
@@ -20,670 +49,2209 @@ PagedFileManager* PagedFileManager::instance()
 
 
 PagedFileManager::PagedFileManager()
+: _bufferPool(new BufferPool(BUFFER_POOL_DEFAULT_NUM_FRAMES)), _log(NULL),
+  _prefetcher(NULL), _prefetchWindow(PREFETCH_DEFAULT_WINDOW), _pageChecksums(false),
+  _pageCompression(false), _extentMinPages(EXTENT_MIN_PAGES), _extentMaxPages(EXTENT_MAX_PAGES), _handleCacheSize(HANDLE_CACHE_DEFAULT_SIZE),
+  _handleCacheHitCounter(0), _handleCacheMissCounter(0), _handleCacheEvictionCounter(0)
 {
+	pthread_mutex_init(&_operationMutex, NULL);
+
+	_prefetcher = new Prefetcher(_bufferPool);
+	_writer = new BackgroundWriter(this, _bufferPool);
 }
 
 
 PagedFileManager::~PagedFileManager()
 {
+	if( _log != NULL )
+		closeLog();
+
+	//close OS file-handlers that were kept for re-use
+	setHandleCacheSize(0);
+
+	//stop background readers and writer before the pool goes away
+	delete _writer;
+	delete _prefetcher;
+	delete _bufferPool;
+
+	pthread_mutex_destroy(&_operationMutex);
 }
 
-/*
- * error codes:
- * -1 = attempting to create a file that already exists
- * -2 = fopen failed to create/open new file
- * -3 = information record conflict, i.e. entry with generated FILE* is already in existence
- * -4 = file does not exist
- * -5 = attempting to delete/re-open an opened file
- * -6 = remove failed to delete a file
- * -7 = record for specific file does not exist in _files
- * -8 = file handler that is used for one file is attempted to be used for opening a second file
- * -9 = file handler does not (point to)/(used by) any file
- * -10 = accessed page number is greater than the available maximum
- * -11 = data is corrupted
- * -12 = fseek failed
- * -13 = fread/fwrite failed
- * ---boundary cases:
- * -14 = fileName is illegal (either NULL or empty string)
- * -15 = unknown number of pages, because handle used to count the pages is not valid (used for not opened file)
-**/
+BufferPool* PagedFileManager::getBufferPool()
+{
+	return _bufferPool;
+}
 
-/*
- * check if file exists
- * NOTE: Taken from rbftest.cc
-**/
-bool PagedFileManager::isExisting(const char *fileName) const
+RC PagedFileManager::setBufferPoolSize(const unsigned int numFrames)
 {
-	struct stat stFileInfo;
-	if(stat(fileName, &stFileInfo) == 0) return true;
-	else return false;
+	return _bufferPool->resize(numFrames);
 }
 
-RC PagedFileManager::createFile(const char *fileName)
+RC PagedFileManager::flushBufferPool()
+{
+	return _bufferPool->flushAll();
+}
+
+void PagedFileManager::collectBufferPoolCounters(unsigned &hitCount, unsigned &missCount, unsigned &evictionCount, unsigned &writeBackCount)
+{
+	hitCount = _bufferPool->_hitCounter;
+	missCount = _bufferPool->_missCounter;
+	evictionCount = _bufferPool->_evictionCounter;
+	writeBackCount = _bufferPool->_writeBackCounter;
+}
+
+Prefetcher* PagedFileManager::getPrefetcher()
+{
+	return _prefetcher;
+}
+
+void PagedFileManager::setPrefetchWindow(const unsigned int numPages)
+{
+	_prefetchWindow = numPages;
+}
+
+unsigned int PagedFileManager::getPrefetchWindow()
+{
+	return _prefetchWindow;
+}
+
+void PagedFileManager::collectPrefetchCounters(unsigned &requestCount, unsigned &prefetchCount, unsigned &droppedCount)
+{
+	requestCount = _prefetcher->_requestCounter;
+	prefetchCount = _bufferPool->_prefetchCounter;
+	droppedCount = _prefetcher->_droppedCounter;
+}
+
+void PagedFileManager::setPageChecksums(const bool enabled)
+{
+	_pageChecksums = enabled;
+}
+
+bool PagedFileManager::getPageChecksums()
+{
+	return _pageChecksums;
+}
+
+void PagedFileManager::setPageCompression(const bool enabled)
+{
+	_pageCompression = enabled;
+}
+
+bool PagedFileManager::getPageCompression()
+{
+	return _pageCompression;
+}
+
+void PagedFileManager::setExtentSize(const unsigned int minPages, const unsigned int maxPages)
+{
+	_extentMinPages = minPages;
+	_extentMaxPages = (maxPages < minPages ? minPages : maxPages);
+}
+
+void PagedFileManager::getExtentSize(unsigned int& minPages, unsigned int& maxPages)
+{
+	minPages = _extentMinPages;
+	maxPages = _extentMaxPages;
+}
+
+void PagedFileManager::setHandleCacheSize(const unsigned int numHandles)
+{
+	_handleCacheSize = numHandles;
+
+	//close least recently closed files first
+	while( _handleCache.size() > _handleCacheSize )
+	{
+		releaseCachedHandle(_handleCache.back());
+		_handleCacheEvictionCounter++;
+	}
+}
+
+unsigned int PagedFileManager::getHandleCacheSize()
+{
+	return _handleCacheSize;
+}
+
+void PagedFileManager::collectHandleCacheCounters(unsigned &hitCount, unsigned &missCount, unsigned &evictionCount)
+{
+	hitCount = _handleCacheHitCounter;
+	missCount = _handleCacheMissCounter;
+	evictionCount = _handleCacheEvictionCounter;
+}
+
+RC PagedFileManager::collectIOStats(const char* fileName, IOStats &callStats, IOStats &ioStats)
 {
-	//check for illegal file name
 	if( fileName == NULL || strlen(fileName) == 0 )
 	{
 		return -14;
 	}
 
-    //check if file already exists
-	if(isExisting(fileName))
+	std::map<std::string, FileInfo>::iterator iter = _files.find(std::string(fileName));
+	if( iter == _files.end() )
 	{
-		return -1;	//unable to create file, because one already exists with this name
+		return -7;
 	}
 
-	//create new file
-	FILE *write_ptr = fopen(fileName,"wb");
+	callStats.merge(iter->second._callStats);
+	ioStats.merge(iter->second._ioStats);
 
-	//check if file was created successfully
-	if(!write_ptr)
+	return 0;
+}
+
+void PagedFileManager::collectIOStats(IOStats &callStats, IOStats &ioStats)
+{
+	std::map<std::string, FileInfo>::iterator iter = _files.begin(), end = _files.end();
+	for( ; iter != end; iter++ )
 	{
-		return -2;	//system is unable to create new file
+		callStats.merge(iter->second._callStats);
+		ioStats.merge(iter->second._ioStats);
 	}
+}
 
-	//create string representing file name
-	std::string name = std::string(fileName);
+void PagedFileManager::releaseCachedHandle(FileInfo* info)
+{
+	if( info->_cachedFilePtr == NULL && info->_cachedFd < 0 )
+	{
+		return;
+	}
 
-	//create file information entity
-	FileInfo info = FileInfo(name, 0, 0);
+	if( info->_cachedFilePtr != NULL )
+	{
+		fclose(info->_cachedFilePtr);
+	}
+	else
+	{
+		close(info->_cachedFd);
+	}
 
-	//insert record into hash-map (_files)
-	if( _files.insert( std::pair<std::string, FileInfo>(name, info) ).second == false )
-		return -3;	//entry with this FILE* already exists
+	info->_cachedFilePtr = NULL;
+	info->_cachedFd = -1;
 
-	//file created successfully
-	//close it and return 0
-	fclose(write_ptr);
-	return 0;
+	_handleCache.remove(info);
 }
 
-RC PagedFileManager::createFileHeader(const char * fileName)
+RC PagedFileManager::openLog(const char* logFileName)
 {
-	/*
-	 * create a header a page:
-	 * I use a page directory method, which implies usage of "linked list" of page headers.
-	 * The content of header page is as follows:
-	 *   + nextHeaderPageId:PageNum
-	 *   + numUsedPageIds:PageNum (i.e. unsigned integer)
-	 *   + array of <pageIds:(unsigned integer), numFreeBytes:{unsigned integer}> for the rest of header page => (unsigned integer)[PAGE_SIZE - 2*SIZEOF(pageNum)]
-	**/
-	RC errCode = 0;
+	//check for illegal file name
+	if( logFileName == NULL || strlen(logFileName) == 0 )
+	{
+		return -14;
+	}
 
-	//open file
-	FileHandle fileHandle;
-	errCode = openFile(fileName, fileHandle);
-	if(errCode != 0)
+	//recovery re-writes data files, so none of them can be opened (and only one log can be used at a time)
+	if( _log != NULL )
 	{
-		return errCode;
+		return -73;
 	}
 
-	//create a header
-	Header header;
+	std::map<std::string, FileInfo>::iterator iter;
+	for( iter = _files.begin(); iter != _files.end(); iter++ )
+	{
+		if( iter->second._numOpen > 0 )
+			return -73;
+	}
 
-	//set all header fields to 0
-	memset(&header, 0, sizeof(Header));
+	RC errCode = 0;
 
-	//insert page header into the file
-	//if( (errCode = insertPage(fileHandle, headerPageId, dataPageId, &header)) != 0 )
-	if( (errCode = fileHandle.appendPage(&header)) != 0 )
+	//write back and forget cached pages, since their files may change underneath
+	if( (errCode = _bufferPool->clear()) != 0 )
 	{
-		//return error code
 		return errCode;
 	}
 
-	//write back that this file has number of pages = 1
-	fileHandle.writeBackNumOfPages();	//moved out from closeFile, since PFM test case # 5 was failing
-										//	reason: PFM functions read/close/append has no understanding of the file headers, so they
-										//			should not alter these attributes. When close was calling writeBackNumOfPages it
-										//			was breaking this agreement - so it was overwriting the data in the data page # 0,
-										//			with the intention to update number of pages in the file. But test case # 5, does
-										//			not require any page headers. In fact, it was storing data in the page # 0. When this
-										//			function (writeBackNumOfPages) was called it was overwriting the data, which caused
-										//			Memcmp to fail...
+	//forget cached file information as well (number of pages and free-space maps are re-read on next open)
+	for( iter = _files.begin(); iter != _files.end(); iter++ )
+	{
+		if( iter->second._freeSpaceMap != NULL )
+			delete iter->second._freeSpaceMap;
 
-	//close file
-	errCode = closeFile(fileHandle);
-	if(errCode != 0)
+		delete iter->second._allocMap;
+		delete iter->second._pageMap;
+
+		releaseCachedHandle(&(iter->second));
+	}
+	_files.clear();
+
+	//run recovery and start logging
+	LogManager* log = new LogManager();
+	if( (errCode = log->open(logFileName)) != 0 )
 	{
+		delete log;
 		return errCode;
 	}
 
+	_log = log;
+	operationDepth = 0;
+	_bufferPool->setLogManager(_log);
+	_writer->setLogManager(_log);
+
 	//success
-	return errCode;
+	return 0;
 }
 
-RC PagedFileManager::getLastHeaderPage(FileHandle& fileHandle, PageNum& lastHeaderPageId)
+RC PagedFileManager::closeLog()
 {
-	RC errCode = 0;
-
-	lastHeaderPageId = 0;
+	if( _log == NULL )
+	{
+		return 0;
+	}
 
-	//pointer to the header page
-	Header* hPage = NULL;
+	RC errCode = 0;
 
-	//allocate temporary buffer for page
-	void* data = malloc(PAGE_SIZE);
+	//background writer stops taking checkpoints (the one in progress is finished first)
+	_writer->setLogManager(NULL);
 
-	//loop thru header pages
-	do
+	//make data files self-sufficient, so that log is not needed anymore
+	if( (errCode = checkpoint()) != 0 )
 	{
-		//get the first header page
-		if( (errCode = fileHandle.readPage((PageNum)lastHeaderPageId, data)) != 0 )
-		{
-			//deallocate data
-			free(data);
+		_writer->setLogManager(_log);
+		return errCode;
+	}
 
-			//return error
-			return errCode;
-		}
+	_bufferPool->setLogManager(NULL);
 
-		//cast data to Header
-		hPage = (Header*)data;
+	errCode = _log->close();
 
-		if( hPage->_nextHeaderPageId == 0 )
-			break;
+	delete _log;
+	_log = NULL;
 
-		lastHeaderPageId = hPage->_nextHeaderPageId;
+	return errCode;
+}
 
-	} while(true);
+LogManager* PagedFileManager::getLogManager()
+{
+	return _log;
+}
 
-	//deallocate temporary buffer for header page
-	free(data);
+RC PagedFileManager::setGroupCommitSize(const unsigned int numCommits)
+{
+	if( _log == NULL )
+	{
+		return -73;
+	}
 
-	//return error
-	return errCode;
+	_log->setGroupCommitSize(numCommits);
+
+	//success
+	return 0;
 }
 
-RC PagedFileManager::findHeaderPage(FileHandle& fileHandle, PageNum pageId, PageNum& retHeaderPage)
+void PagedFileManager::beginOperation()
 {
-	RC errCode = 0;
+	if( operationDepth++ > 0 )
+		return;
 
-	//counters for current header IDs to loop thru
-	PageNum headerPageId = 0;
+	//leader of the group commit waits for this operation
+	if( _log != NULL )
+		_log->beginOperation();
 
-	//pointer to the header page
-	Header* hPage = NULL;
+	//checkpoint of the background writer cannot start until operation ends
+	pthread_mutex_lock(&_operationMutex);
 
-	//allocate temporary buffer for page
-	void* data = malloc(PAGE_SIZE);
+	//pages are saved before the operation modifies them, so that it can be rolled back
+	if( _log != NULL )
+		_bufferPool->beginOperation();
+}
 
-	//loop thru header pages
-	do
+RC PagedFileManager::endOperation(const RC opCode)
+{
+	//outermost operation is over (nested one returns its error to the outer one)
+	if( operationDepth == 0 || --operationDepth > 0 )
 	{
-		//get the first header page
-		if( (errCode = fileHandle.readPage((PageNum)headerPageId, data)) != 0 )
-		{
-			//deallocate data
-			free(data);
+		return 0;
+	}
 
-			//return error
-			return errCode;
-		}
+	RC errCode = 0;
+	LSN lsn = 0;
 
-		//cast data to Header
-		hPage = (Header*)data;
+	if( _log != NULL )
+	{
+		//operation that failed is not committed: its pages are restored, so that they never reach the data files,
+		//and its log records are discarded by recovery
+		bool rollback = (opCode != 0 || (errCode = _log->commit(lsn)) != 0);
 
-		if( pageId <= hPage->_numUsedPageIds )	//NumUsedPageIds counts only the data pages used within this header
-												//data pages start from 1 and go up
-												//pageId is not necessarily equal to page number (i.e. for header pages > 0, it is a module of page number and num_of_page_ids, so it varies between [1, num_page_ids))
-												//for this reason, the comparison between pageId and and numUsedPageIds is inclusive
-		{
-			//assign a found page id
-			retHeaderPage = headerPageId;
+		std::vector<FileInfo*> files;
+		_bufferPool->endOperation(rollback, files);
 
-			//free temporary buffer for header page
-			free(data);
+		//maps are re-built from the restored header pages on next use
+		for( unsigned int i = 0; i < files.size(); i++ )
+		{
+			delete files[i]->_freeSpaceMap;
+			files[i]->_freeSpaceMap = NULL;
+			delete files[i]->_allocMap;
+			files[i]->_allocMap = NULL;
+		}
 
-			//return success
-			return errCode;
+		if( rollback )
+		{
+			RC abortCode = _log->abort();
+			if( errCode == 0 )
+				errCode = abortCode;
 		}
+	}
 
-		pageId -= NUM_OF_PAGE_IDS;
+	pthread_mutex_unlock(&_operationMutex);
 
-		//go to next header page
-		headerPageId = hPage->_nextHeaderPageId;
+	if( _log == NULL || errCode != 0 || opCode != 0 )
+	{
+		return errCode;
+	}
 
-	} while(headerPageId > 0);
+	//operation is committed once its commit record is durable (fsync is shared by operations that commit meanwhile)
+	if( (errCode = _log->syncCommit(lsn)) != 0 )
+	{
+		return errCode;
+	}
 
-	//deallocate temporary buffer for header page
-	free(data);
+	//keep log from growing indefinitely
+	if( _log->getLogSize() > LOG_CHECKPOINT_SIZE )
+	{
+		return checkpoint();
+	}
 
-	//return error
-	return -16;
+	//success
+	return 0;
 }
 
-RC PagedFileManager::insertPage(FileHandle & fileHandle, PageNum & headerPageId, PageNum & dataPageId, const void* content)
+RC PagedFileManager::flushLog()
 {
-	RC errCode = 0;
-
-	//allocate buffer for header page
-	void* data = malloc(PAGE_SIZE);
-	memset(data, 0, PAGE_SIZE);
-
-	//read header page
-	if( (errCode = fileHandle.readPage(headerPageId, data)) != 0 )
+	if( _log == NULL )
 	{
-		//deallocate buffer
-		free(data);
-		//return error code
-		return errCode;
+		return 0;
 	}
 
-	//cast buffer to header
-	Header* hPage = (Header*)data;
+	return _log->flushAll();
+}
 
-	//check if last processed header page can NOT fit a meta-data for new page record
-	if( hPage->_numUsedPageIds >= NUM_OF_PAGE_IDS )
+RC PagedFileManager::checkpoint()
+{
+	if( _log == NULL )
 	{
-		//this header page is full, need to create new header page
-		//assign a new header page id
-		PageNum nextPageId = fileHandle.getNumberOfPages();
+		return 0;
+	}
 
-		//assign a next header page
-		hPage->_nextHeaderPageId = nextPageId;
+	//pages of the operation in progress cannot be written back
+	if( operationDepth > 0 )
+	{
+		return -73;
+	}
 
-		//save header page
-		fileHandle.writePage(headerPageId, data);
+	return takeCheckpoint();
+}
+
+RC PagedFileManager::takeCheckpoint()
+{
+	RC errCode = 0;
+
+	pthread_mutex_lock(&_operationMutex);
+
+	//write back all dirty pages (log is forced before each of them), then drop log records that describe them
+	if( _log != NULL && (errCode = _bufferPool->flushAll()) == 0 )
+	{
+		errCode = _log->truncate();
+	}
+
+	pthread_mutex_unlock(&_operationMutex);
+
+	return errCode;
+}
+
+void PagedFileManager::setBackgroundWriter(const bool enabled)
+{
+	if( enabled )
+	{
+		_writer->start();
+	}
+	else
+	{
+		_writer->stop();
+	}
+
+	//foreground threads leave dirty pages to the writer
+	_bufferPool->setCleanVictimsFirst(enabled);
+}
+
+bool PagedFileManager::getBackgroundWriter()
+{
+	return _writer->isRunning();
+}
+
+void PagedFileManager::setBackgroundWriterPolicy(const unsigned int dirtyPercent, const unsigned int maxDirtyAgeMs, const unsigned int checkpointIntervalMs)
+{
+	_writer->setPolicy(dirtyPercent, maxDirtyAgeMs, checkpointIntervalMs);
+}
+
+void PagedFileManager::collectBackgroundWriterCounters(unsigned &writeCount, unsigned &checkpointCount)
+{
+	_writer->collectCounters(writeCount, checkpointCount);
+}
+
+void PagedFileManager::collectLogCounters(unsigned &recordCount, unsigned &commitCount, unsigned &fsyncCount)
+{
+	recordCount = commitCount = fsyncCount = 0;
+
+	if( _log == NULL )
+		return;
+
+	recordCount = _log->_recordCounter;
+	commitCount = _log->_commitCounter;
+	fsyncCount = _log->_fsyncCounter;
+}
+
+/*
+ * error codes:
+ * -1 = attempting to create a file that already exists
+ * -2 = fopen (open) failed to create/open new file
+ * -3 = information record conflict, i.e. entry with generated FILE* is already in existence
+ * -4 = file does not exist
+ * -5 = attempting to delete/re-open an opened file
+ * -6 = remove failed to delete a file
+ * -7 = record for specific file does not exist in _files
+ * -8 = file handler that is used for one file is attempted to be used for opening a second file
+ * -9 = file handler does not (point to)/(used by) any file
+ * -10 = accessed page number is greater than the available maximum
+ * -11 = data is corrupted
+ * -12 = fseek failed
+ * -13 = fread/fwrite (pread/pwrite) failed
+ * ---boundary cases:
+ * -14 = fileName is illegal (either NULL or empty string)
+ * -15 = unknown number of pages, because handle used to count the pages is not valid (used for not opened file)
+ * -16 = header page for the given data page is not found
+ * ---buffer pool (see bpm.cc):
+ * -17 = all frames of the buffer pool are pinned, i.e. there is no victim for replacement
+ * -18 = attempting to unpin a page that is not pinned
+ * -19 = attempting to re-size buffer pool, while some of its pages are pinned
+ * ---memory-mapped files:
+ * -70 = attempting to modify file thru read-only (IO_MMAP) handle
+ * -71 = mmap failed
+ * -72 = requested page is not memory-mapped (handle is not IO_MMAP or page was appended after file got mapped)
+ * ---write-ahead log (see wal.cc):
+ * -73 = log cannot be opened while files are opened (or log is already opened), or no log is opened, or operation is in progress
+ * -74 = log file I/O failed
+ * ---page size:
+ * -75 = page size is not a power of two in range [PAGE_SIZE, MAX_PAGE_SIZE]
+ * ---format of the file:
+ * -76 = first page of the file is not a header page of the current format (file of the earlier format, or not a record-based file)
+ * ---page checksums:
+ * -77 = checksum of the page read from the file does not match its content (page is torn or corrupted)
+ * ---compressed files (see pagemap.cc):
+ * -78 = page map of the compressed file cannot be read, or compressed page cannot be decompressed
+ * -79 = compressed file cannot be opened as IO_MMAP or IO_DIRECT
+ * ---page allocation map (see allocmap.cc):
+ * -80 = page cannot be freed (first page, header page or page of the allocation map, page beyond the end of file, or page that is already free)
+ * -81 = compressed file cannot be truncated
+**/
+
+/*
+ * check if file exists
+ * NOTE: Taken from rbftest.cc
+**/
+bool PagedFileManager::isExisting(const char *fileName) const
+{
+	struct stat stFileInfo;
+	if(stat(fileName, &stFileInfo) == 0) return true;
+	else return false;
+}
+
+RC PagedFileManager::createFile(const char *fileName, const unsigned int pageSize)
+{
+	//check for illegal file name
+	if( fileName == NULL || strlen(fileName) == 0 )
+	{
+		return -14;
+	}
+
+	//check that page size is supported (power of two keeps pages aligned for direct I/O and memory mapping)
+	if( pageSize < PAGE_SIZE || pageSize > MAX_PAGE_SIZE || (pageSize & (pageSize - 1)) != 0 )
+	{
+		return -75;
+	}
+
+    //check if file already exists
+	if(isExisting(fileName))
+	{
+		return -1;	//unable to create file, because one already exists with this name
+	}
+
+	//create new file
+	FILE *write_ptr = fopen(fileName,"wb");
+
+	//check if file was created successfully
+	if(!write_ptr)
+	{
+		return -2;	//system is unable to create new file
+	}
+
+	//create string representing file name
+	std::string name = std::string(fileName);
+
+	//create file information entity
+	FileInfo info = FileInfo(name, 0, 0);
+	info._pageSize = pageSize;
+	info._pageChecksums = _pageChecksums;
+
+	//compressed file keeps slots of its pages in the page map
+	if( _pageCompression )
+	{
+		RC errCode = 0;
+		PageMap* pageMap = new PageMap(pageSize);
+
+		if( (errCode = PageMap::create(name)) != 0 || (errCode = pageMap->open(name)) != 0 )
+		{
+			delete pageMap;
+			fclose(write_ptr);
+			remove(fileName);
+			return errCode;
+		}
+
+		info._pageMap = pageMap;
+	}
+
+	//insert record into hash-map (_files)
+	if( _files.insert( std::pair<std::string, FileInfo>(name, info) ).second == false )
+	{
+		delete info._pageMap;
+		return -3;	//entry with this FILE* already exists
+	}
+
+	//file created successfully
+	//close it and return 0
+	fclose(write_ptr);
+	return 0;
+}
+
+RC PagedFileManager::createFileHeader(const char * fileName)
+{
+	/*
+	 * create a header a page:
+	 * I use a page directory method, which implies usage of "linked list" of page headers.
+	 * The content of header page is as follows:
+	 *   + nextHeaderPageId:PageNum
+	 *   + numUsedPageIds:PageNum (i.e. unsigned integer)
+	 *   + array of <pageIds:(unsigned integer), numFreeBytes:{unsigned integer}> for the rest of header page => (unsigned integer)[PAGE_SIZE - 2*SIZEOF(pageNum)]
+	 * the first header page also records format of the file (FILE_FORMAT_MAGIC, FILE_FORMAT_VERSION) and page size of the file
+	 * (given to createFile)
+	**/
+	RC errCode = 0;
+
+	//open file
+	FileHandle fileHandle;
+	errCode = openFile(fileName, fileHandle);
+	if(errCode != 0)
+	{
+		return errCode;
+	}
+
+	//create a header (it takes the whole page, which may be larger than Header)
+	void* header = malloc(fileHandle.getPageSize());
+
+	//set all header fields to 0
+	memset(header, 0, fileHandle.getPageSize());
+
+	((Header*)header)->_pageSize = fileHandle.getPhysicalPageSize();
+	((Header*)header)->_pageChecksums = fileHandle.hasPageChecksums() ? 1 : 0;
+	((Header*)header)->_pageCompression = fileHandle.hasPageCompression() ? 1 : 0;
+	((Header*)header)->_magic = FILE_FORMAT_MAGIC;
+	((Header*)header)->_formatVersion = FILE_FORMAT_VERSION;
+
+	//insert page header into the file
+	//if( (errCode = insertPage(fileHandle, headerPageId, dataPageId, &header)) != 0 )
+	if( (errCode = fileHandle.appendPage(header)) != 0 )
+	{
+		free(header);
+		//return error code
+		return errCode;
+	}
+
+	free(header);
+
+	fileHandle._info->_hasFormatHeader = true;
+
+	//write back that this file has number of pages = 1
+	fileHandle.writeBackNumOfPages();	//moved out from closeFile, since PFM test case # 5 was failing
+										//	reason: PFM functions read/close/append has no understanding of the file headers, so they
+										//			should not alter these attributes. When close was calling writeBackNumOfPages it
+										//			was breaking this agreement - so it was overwriting the data in the data page # 0,
+										//			with the intention to update number of pages in the file. But test case # 5, does
+										//			not require any page headers. In fact, it was storing data in the page # 0. When this
+										//			function (writeBackNumOfPages) was called it was overwriting the data, which caused
+										//			Memcmp to fail...
+
+	//close file
+	errCode = closeFile(fileHandle);
+	if(errCode != 0)
+	{
+		return errCode;
+	}
+
+	//success
+	return errCode;
+}
+
+RC PagedFileManager::getLastHeaderPage(FileHandle& fileHandle, PageNum& lastHeaderPageId)
+{
+	RC errCode = 0;
+
+	//use directory of header pages instead of walking thru all of them
+	FreeSpaceMap* fsm = NULL;
+	if( (errCode = getFreeSpaceMap(fileHandle, fsm)) != 0 )
+	{
+		return errCode;
+	}
+
+	lastHeaderPageId = fsm->getLastHeaderPage();
+
+	//success
+	return 0;
+}
+
+RC PagedFileManager::findHeaderPage(FileHandle& fileHandle, PageNum pageId, PageNum& retHeaderPage)
+{
+	RC errCode = 0;
+
+	//use directory of header pages instead of walking thru all of them
+	FreeSpaceMap* fsm = NULL;
+	if( (errCode = getFreeSpaceMap(fileHandle, fsm)) != 0 )
+	{
+		return errCode;
+	}
+
+	//NumUsedPageIds counts only the data pages used within this header, data pages start from 1 and go up
+	if( fsm->findHeaderPage(pageId, retHeaderPage) == false )
+	{
+		return -16;
+	}
+
+	//success
+	return 0;
+}
+
+RC PagedFileManager::insertPage(FileHandle & fileHandle, PageNum & headerPageId, PageNum & dataPageId, const void* content)
+{
+	RC errCode = 0;
+
+	//allocate buffer for header page
+	void* data = malloc(fileHandle.getPageSize());
+	memset(data, 0, fileHandle.getPageSize());
+
+	//read header page
+	if( (errCode = fileHandle.readPage(headerPageId, data)) != 0 )
+	{
+		//deallocate buffer
+		free(data);
+		//return error code
+		return errCode;
+	}
+
+	//cast buffer to header
+	Header* hPage = (Header*)data;
+
+	//check if last processed header page can NOT fit a meta-data for new page record
+	if( hPage->_numUsedPageIds >= fileHandle.getNumOfPageIds() )
+	{
+		//this header page is full, need to create new header page (free page is re-used first, otherwise it is appended)
+		void* newHeader = malloc(fileHandle.getPageSize());
+		memset(newHeader, 0, fileHandle.getPageSize());
+
+		PageNum nextPageId = 0;
+		errCode = allocatePage(fileHandle, newHeader, nextPageId);
+
+		free(newHeader);
+
+		if( errCode != 0 )
+		{
+			//deallocate data
+			free(data);
+
+			//return error code
+			return errCode;
+		}
+
+		//assign a next header page
+		hPage->_nextHeaderPageId = nextPageId;
+
+		//link new header page inside free-space map (before header page is written, so that chain stays consistent)
+		if( fileHandle._info->_freeSpaceMap != NULL )
+		{
+			fileHandle._info->_freeSpaceMap->addHeaderPage(headerPageId, nextPageId);
+		}
+
+		//save header page
+		fileHandle.writePage(headerPageId, data);
 
 		headerPageId = nextPageId;
 
-		//prepare parameters for header page allocation
-		memset(data, 0, PAGE_SIZE);
+		//later all fields of header page are accessed by dereferencing to Header structure (new header page is empty)
+		memset(data, 0, fileHandle.getPageSize());
+		hPage = (Header*)data;
+	}
+
+	//allocate a new data page (page id is not necessarily the last one, if there is a free page)
+	if( (errCode = allocatePage(fileHandle, content, dataPageId)) != 0 )
+	{
+		//deallocate data and dataPaga
+		free(data);
+
+		//if failed, return error code
+		return errCode;
+	}
+
+	//set the new record
+	hPage->_arrOfPageIds[hPage->_numUsedPageIds]._pageid = dataPageId;
+
+	//set the free space
+	hPage->_arrOfPageIds[hPage->_numUsedPageIds]._numFreeBytes = fileHandle.getPageSize();
+
+	//increment number of page IDs used in this page
+	hPage->_numUsedPageIds++;
+
+	//write header page
+	fileHandle.writePage(headerPageId, data);
+
+	//deallocate data(s)
+	free(data);
+
+	//return success, because technically no error occurred
+	return 0;
+}
+
+RC PagedFileManager::getFreeSpaceMap(FileHandle& fileHandle, FreeSpaceMap*& freeSpaceMap)
+{
+	RC errCode = 0;
+
+	//check that handle is pointing to some file
+	if( fileHandle._info == NULL )
+	{
+		return -9;
+	}
+
+	//header chain exists only in files that start with a header page of the current format
+	if( fileHandle._info->_hasFormatHeader == false )
+	{
+		return -76;
+	}
+
+	//build map on the first request
+	if( fileHandle._info->_freeSpaceMap == NULL )
+	{
+		FreeSpaceMap* fsm = new FreeSpaceMap(fileHandle.getNumOfPageIds());
+
+		if( (errCode = fsm->build(fileHandle)) != 0 )
+		{
+			delete fsm;
+			return errCode;
+		}
+
+		fileHandle._info->_freeSpaceMap = fsm;
+	}
+
+	freeSpaceMap = fileHandle._info->_freeSpaceMap;
+
+	//success
+	return 0;
+}
+
+RC PagedFileManager::getAllocMap(FileHandle& fileHandle, PageAllocMap*& allocMap)
+{
+	RC errCode = 0;
+
+	//check that handle is pointing to some file
+	if( fileHandle._info == NULL )
+	{
+		return -9;
+	}
+
+	//read map on the first request (only files that start with a header page of the current format have one)
+	if( fileHandle._info->_allocMap == NULL )
+	{
+		if( fileHandle._info->_hasFormatHeader == false )
+		{
+			return -76;
+		}
+
+		PageAllocMap* map = new PageAllocMap(fileHandle.getPageSize());
+
+		if( (errCode = map->build(fileHandle)) != 0 )
+		{
+			delete map;
+			return errCode;
+		}
+
+		fileHandle._info->_allocMap = map;
+	}
+
+	allocMap = fileHandle._info->_allocMap;
+
+	//success
+	return 0;
+}
+
+RC PagedFileManager::allocatePage(FileHandle& fileHandle, const void* content, PageNum& pageNum)
+{
+	RC errCode = 0;
+
+	//re-use the lowest free page, if there is one
+	PageAllocMap* allocMap = NULL;
+	if( getAllocMap(fileHandle, allocMap) == 0 && allocMap->findFreePage(pageNum) )
+	{
+		//map page and the page itself are committed together
+		beginOperation();
+
+		if( (errCode = allocMap->markUsed(fileHandle, pageNum)) == 0 )
+		{
+			errCode = fileHandle.writePage(pageNum, content);
+		}
+
+		RC endCode = endOperation(errCode);
+
+		return errCode != 0 ? errCode : endCode;
+	}
+
+	//otherwise, file grows by one page
+	pageNum = fileHandle.getNumberOfPages();
+
+	return fileHandle.appendPage(content);
+}
+
+RC PagedFileManager::freePage(FileHandle& fileHandle, const PageNum pageNum)
+{
+	RC errCode = 0;
+
+	//check that handle is pointing to some file
+	if( fileHandle._info == NULL )
+	{
+		return -9;
+	}
+
+	//first (header) page, and pages beyond the end of file cannot be freed
+	if( pageNum == 0 || pageNum >= fileHandle.getNumberOfPages() )
+	{
+		return -80;
+	}
+
+	FreeSpaceMap* fsm = NULL;
+	PageAllocMap* allocMap = NULL;
+	if( (errCode = getFreeSpaceMap(fileHandle, fsm)) != 0 || (errCode = getAllocMap(fileHandle, allocMap)) != 0 )
+	{
+		return errCode;
+	}
+
+	//neither can pages that describe other pages
+	if( fsm->isHeaderPage(pageNum) || allocMap->isMapPage(pageNum) || allocMap->isFreePage(pageNum) )
+	{
+		return -80;
+	}
+
+	//free page is emptied, so that scans of the file do not find anything in it
+	void* data = malloc(fileHandle.getPageSize());
+	memset(data, 0, fileHandle.getPageSize());
+
+	beginOperation();
+
+	if( (errCode = fileHandle.writePage(pageNum, data)) == 0 )
+	{
+		errCode = allocMap->markFree(fileHandle, pageNum);
+	}
+
+	RC endCode = endOperation(errCode);
+
+	free(data);
+
+	return errCode != 0 ? errCode : endCode;
+}
+
+RC PagedFileManager::getNumFreePages(FileHandle& fileHandle, unsigned& numFreePages)
+{
+	RC errCode = 0;
+
+	PageAllocMap* allocMap = NULL;
+	if( (errCode = getAllocMap(fileHandle, allocMap)) != 0 )
+	{
+		return errCode;
+	}
+
+	numFreePages = allocMap->getNumFreePages();
+
+	//success
+	return 0;
+}
+
+RC PagedFileManager::truncateFile(const char* fileName)
+{
+	RC errCode = 0;
+
+	//check for illegal file name
+	if( fileName == NULL || strlen(fileName) == 0 )
+	{
+		return -14;
+	}
+
+	//truncation is done offline, so no one else may have the file opened
+	std::map<std::string, FileInfo>::iterator iter = _files.find(std::string(fileName));
+	if( iter != _files.end() && iter->second._numOpen > 0 )
+	{
+		return -5;
+	}
+
+	FileHandle fileHandle;
+	if( (errCode = openFile(fileName, fileHandle)) != 0 )
+	{
+		return errCode;
+	}
+
+	//slots of the compressed pages are not at fixed offsets, so cutting the file at the page boundary is not possible
+	if( fileHandle.hasPageCompression() )
+	{
+		closeFile(fileHandle);
+		return -81;
+	}
+
+	//drop free pages at the end of the file, and the map pages among them
+	PageAllocMap* allocMap = NULL;
+	PageNum numPages = fileHandle.getNumberOfPages();
+	if( (errCode = getAllocMap(fileHandle, allocMap)) != 0 ||
+		(errCode = allocMap->shrink(fileHandle, numPages)) != 0 )
+	{
+		closeFile(fileHandle);
+		return errCode;
+	}
+
+	bool shrunk = (numPages < fileHandle.getNumberOfPages());
+	FileInfo* info = fileHandle._info;
+
+	if( shrunk )
+	{
+		info->_numPages = numPages;
+		fileHandle.writeBackNumOfPages();
+	}
+
+	//all dirty pages (including the ones being cut) reach the file here
+	if( (errCode = closeFile(fileHandle)) != 0 || shrunk == false )
+	{
+		return errCode;
+	}
+
+	//logged images of the cut pages would re-grow the file on recovery
+	if( _log != NULL && (errCode = checkpoint()) != 0 )
+	{
+		return errCode;
+	}
+
+	//cached pages of this file would be written back beyond its new end
+	_prefetcher->cancelFile(info);
+	_bufferPool->discardFile(info);
+
+	off_t size = (off_t)numPages * info->_pageSize;
+	if( truncate(fileName, size) != 0 )
+	{
+		return -13;
+	}
+
+	//disk space reserved beyond the end is gone as well
+	info->_numAllocatedPages = numPages;
+	info->_ioStats._endOfFile = size;
+
+	//success
+	return 0;
+}
+
+RC PagedFileManager::getDataPage(FileHandle &fileHandle, const unsigned int recordSize, PageNum& pageNum, PageNum& headerPage, unsigned int& freeSpaceLeftInPage)
+{
+	RC errCode = 0;
+
+	//is for IX functions
+	bool ixDataPage = recordSize == (unsigned int)-1;
+
+	//get free-space map instead of walking thru all header pages
+	FreeSpaceMap* fsm = NULL;
+	if( (errCode = getFreeSpaceMap(fileHandle, fsm)) != 0 )
+	{
+		return errCode;
+	}
+
+	//IX functions look for pages marked with (unsigned)-1, records need space for themselves and for their directory slot
+	//inconsistency found: if amount of free space left in page and requested size are exactly equal than it would skip this candidate page and allocate a new data page, so I changed '>' to '>='
+	unsigned int requiredFreeBytes = ixDataPage ? (unsigned int)-1 : recordSize + sizeof(PageDirSlot);
+
+	//keep array of bytes of size of page for reading in page data
+	void* data = malloc(fileHandle.getPageSize());
+
+	//casted data to header page
+	Header* hPage = NULL;
+
+	//find the first page (in the order of header pages) that has the proper number of free bytes
+	PageNum foundHeaderPageId = 0;
+	unsigned int entryIndex = 0;
+	if( fsm->findPage(requiredFreeBytes, foundHeaderPageId, entryIndex) )
+	{
+		//get header page that describes this data page
+		if( (errCode = fileHandle.readPage(foundHeaderPageId, data)) != 0 )
+		{
+			//deallocate data
+			free(data);
+
+			//return error
+			return errCode;
+		}
+
+		//cast data to Header
+		hPage = (Header*)data;
+
+		//get the current data page information
+		PageInfo* pi = &(hPage->_arrOfPageIds[entryIndex]);
+
+		//assign id
+		pageNum = pi->_pageid;
+
+		//update free space left
+		if( ixDataPage )
+		{
+			pi->_numFreeBytes = 0;
+		}
+		else
+		{
+			pi->_numFreeBytes = pi->_numFreeBytes - recordSize - sizeof(PageDirSlot);
+		}
+
+		freeSpaceLeftInPage = pi->_numFreeBytes;
+
+		//assign a header page
+		headerPage = foundHeaderPageId;
+
+		//write header page (free-space map is updated by it)
+		if( (errCode = fileHandle.writePage(headerPage, data)) != 0 )
+		{
+			free(data);
+			return errCode;
+		}
+
+		//deallocate data
+		free(data);
+
+		//return success
+		return 0;
+	}
+
+	//no page has enough space, so new data page would be added to the last header page
+	unsigned int lastHeaderPageId = fsm->getLastHeaderPage();
+
+	if( (errCode = fileHandle.readPage((PageNum)lastHeaderPageId, data)) != 0 )
+	{
+		//deallocate data
+		free(data);
+
+		//return error
+		return errCode;
+	}
+
+	//cast data to Header
+	hPage = (Header*)data;
+
+	//assign a header page id
+	headerPage = lastHeaderPageId;
+
+	void* dataPage = malloc(fileHandle.getPageSize());
+	memset(dataPage, 0, fileHandle.getPageSize());
+
+	unsigned int curPageId = hPage->_numUsedPageIds;
+
+	if( (errCode = insertPage(fileHandle, headerPage, pageNum, dataPage)) != 0 )
+	{
+		//free buffers
+		free(data);
+		free(dataPage);
+		//return error code
+		return errCode;
+	}
+
+	if( headerPage != lastHeaderPageId )
+		curPageId = 0;
+
+	if( ixDataPage == false )
+	{
+		//null data (hPage was not changed upto this point, so no need to write it back)
+		memset(data, 0, fileHandle.getPageSize());
+
+		//read a specified header page
+		if( (errCode = fileHandle.readPage(headerPage, data)) != 0 )
+		{
+			//deallocate buffers
+			free(data);
+			free(dataPage);
+			//return error code
+			return errCode;
+		}
+
+		//cast it to Header pointer
+		hPage = (Header*)data;
+
+		//set free space
+		if( hPage->_arrOfPageIds[curPageId]._numFreeBytes == fileHandle.getPageSize() )
+			hPage->_arrOfPageIds[curPageId]._numFreeBytes =
+					hPage->_arrOfPageIds[curPageId]._numFreeBytes - 2 * sizeof(unsigned int);
+		hPage->_arrOfPageIds[curPageId]._numFreeBytes =
+				hPage->_arrOfPageIds[curPageId]._numFreeBytes - recordSize - sizeof(PageDirSlot);
+
+		freeSpaceLeftInPage = hPage->_arrOfPageIds[curPageId]._numFreeBytes;
+
+		//write header page
+		if( (errCode = fileHandle.writePage(headerPage, data)) != 0 )
+		{
+			//deallocate buffers
+			free(data);
+			free(dataPage);
+			//return error code
+			return errCode;
+		}
+	}
+
+	//deallocate buffers
+	free(data);
+	free(dataPage);
+
+	//return success
+	return 0;
+}
+
+int PagedFileManager::countNumberOfOpenedInstances(const char* fileName)
+{
+	//check for illegal file name
+	if( fileName == NULL || strlen(fileName) == 0 )
+	{
+		return -14;
+	}
+
+	//iterator that should point to the item in _files
+	std::map<std::string, FileInfo>::iterator iter;
+
+	//get the record of this file from _files
+	if( ( iter = _files.find(std::string(fileName)) ) == _files.end() )
+	{
+		return -4;	//cannot delete, because this file does not exist
+	}
+
+	//make sure that file to be deleted is not opened/used
+	return (int)(iter->second._numOpen);
+}
+
+RC PagedFileManager::destroyFile(const char *fileName)
+{
+	//check for illegal file name
+	if( fileName == NULL || strlen(fileName) == 0 )
+	{
+		return -14;
+	}
+
+	//iterator that should point to the item in _files
+	std::map<std::string, FileInfo>::iterator iter;
+
+	//get the record of this file from _files
+	if( ( iter = _files.find(std::string(fileName)) ) == _files.end() )
+	{
+		return -4;	//cannot delete, because this file does not exist
+	}
+
+	//make sure that file to be deleted is not opened/used (TableScan.dtor)
+	//if( iter->second._numOpen != 0 )
+	//{
+	//	return -5;	//attempting to delete an opened file
+	//}
+
+	//removal has to be logged, otherwise recovery could re-create the file from the older page images
+	if( _log != NULL )
+	{
+		RC errCode = 0;
+		LSN lsn = 0;
+
+		beginOperation();
+		if( (errCode = _log->logDestroy(fileName, lsn)) != 0 )
+		{
+			endOperation(errCode);
+			return errCode;
+		}
+		if( (errCode = endOperation()) != 0 )
+		{
+			return errCode;
+		}
+	}
+
+	//OS file-handler kept for re-use would keep removed file alive
+	releaseCachedHandle(&(iter->second));
+
+	//remove file from FileSystem
+	if( remove(fileName) != 0 )
+		return -6;	//system is unable to delete a file
+
+	//cached pages of this file are not needed anymore (including the ones being read ahead)
+	_prefetcher->cancelFile(&(iter->second));
+	_bufferPool->discardFile(&(iter->second));
+
+	//as well as its free-space map and allocation map
+	if( iter->second._freeSpaceMap != NULL )
+	{
+		delete iter->second._freeSpaceMap;
+		iter->second._freeSpaceMap = NULL;
+	}
+
+	delete iter->second._allocMap;
+	iter->second._allocMap = NULL;
+
+	//and page map of the compressed file
+	if( iter->second._pageMap != NULL )
+	{
+		delete iter->second._pageMap;
+		iter->second._pageMap = NULL;
+		PageMap::destroy(fileName);
+	}
+
+	//delete record from _files
+	_files.erase(iter);
+
+	//destruction of a file was successful, return 0
+	return 0;
+}
+
+RC PagedFileManager::getNumOpenInstances(const char* fileName)
+{
+	RC errCode = 0;
+
+	std::map<std::string, FileInfo>::iterator iter;
+	if( ( iter = _files.find(std::string(fileName)) ) != _files.end() )
+	{
+		printf("file named: %s => # opens: %i\n", fileName, (int)iter->second._numOpen);
+	}
+	else
+	{
+		printf("No such entry");
+	}
+
+	return errCode;
+}
+
+RC PagedFileManager::openFile(const char *fileName, FileHandle &fileHandle, FileIOMode ioMode)
+{
+	//check for illegal file name
+	if( fileName == NULL || strlen(fileName) == 0 )
+	{
+		return -14;
+	}
+
+	//if file does not exist, then abort
+	struct stat fileStat;
+	if( stat(fileName, &fileStat) != 0 )
+	{
+		return -4;	//file does not exist
+	}
+
+	//iterator that should point to the item in _files
+	std::map<std::string, FileInfo>::iterator iter;
+
+	bool setup_file_info = false;
+	bool mapFile = false;
+
+	//get the record of this file from _files
+	if( ( iter = _files.find(std::string(fileName)) ) == _files.end() )
+	{
+
+		//create file information entity (by default set created file to be user accessible and modifiable)
+		FileInfo info = FileInfo(fileName, 0, 0);//, user_access);
+
+		//mark this file handle to be in need to setup a file info
+		setup_file_info = true;
+
+		std::pair<std::map<std::string, FileInfo>::iterator, bool> resultOfInsertion = _files.insert( std::pair<std::string, FileInfo>(fileName, info) );
+
+		//insert record into hash-map (_files)
+		if( resultOfInsertion.second == false )
+			return -3;	//entry with this FILE* already exists
+
+		//set the iter
+		iter = resultOfInsertion.first;
+		//return -7; //error removed, since it appears to be possible to open a file that was not created by original DB
+	}
+
+	//make sure that given file handler is not used for any file
+	if( fileHandle._info != NULL || fileHandle._filePtr != NULL || fileHandle._fd >= 0 )
+	{
+		return -8;	//this file handler is being used for another file, yet it is attempted to be used for opening this file
+	}
+
+	//re-use OS file-handler left by closeFile, unless it was opened in another mode or file has been replaced since then
+	FileInfo* info = &(iter->second);
+	bool reused = false;
+	if( info->_cachedFilePtr != NULL || info->_cachedFd >= 0 )
+	{
+		if( info->_cachedIOMode == ioMode &&
+			info->_cachedDevice == (unsigned long long)fileStat.st_dev && info->_cachedInode == (unsigned long long)fileStat.st_ino )
+		{
+			fileHandle._filePtr = info->_cachedFilePtr;
+			fileHandle._fd = info->_cachedFd;
+
+			info->_cachedFilePtr = NULL;
+			info->_cachedFd = -1;
+			_handleCache.remove(info);
+
+			reused = true;
+		}
+		else
+		{
+			releaseCachedHandle(info);
+		}
+	}
+
+	if( reused )
+	{
+		_handleCacheHitCounter++;
+	}
+	else if( ioMode == IO_STDIO )
+	{
+		_handleCacheMissCounter++;
+
+		//open a binary file for both reading and writing
+		FILE* file_ptr = fopen(fileName, "rb+");
+
+		//check if file was created successfully
+		if( !file_ptr )
+		{
+			return -2;	//system is unable to create new file
+		}
+
+		//pages are cached by the buffer pool, so there is no need for stdio to keep a second copy of them
+		setvbuf(file_ptr, NULL, _IONBF, 0);
+
+		fileHandle._filePtr = file_ptr;
+	}
+	else
+	{
+		int fd = -1;
+
+		if( ioMode != IO_MMAP )
+			_handleCacheMissCounter++;
+
+		//O_DIRECT requires page-aligned buffers, which is satisfied by frames of the buffer pool
+		if( ioMode == IO_DIRECT )
+		{
+			fd = open(fileName, O_RDWR | O_DIRECT);
+
+			//file system does not support direct I/O (e.g. tmpfs), so use regular positional I/O
+			if( fd < 0 && errno == EINVAL )
+			{
+				ioMode = IO_PREAD;
+			}
+		}
+
+		if( ioMode == IO_PREAD )
+		{
+			fd = open(fileName, O_RDWR);
+		}
+
+		if( ioMode == IO_MMAP )
+		{
+			fd = open(fileName, O_RDONLY);
+		}
+
+		//check if file was opened successfully
+		if( fd < 0 )
+		{
+			return -2;
+		}
+
+		//file is mapped below (once its page size is known), unless it is already mapped by another handle
+		if( ioMode == IO_MMAP && iter->second._numMappedOpen == 0 )
+		{
+			RC errCode = 0;
+
+			//pages that are cached by buffer pool have to reach the file first
+			if( (errCode = _bufferPool->flushFile(&(iter->second))) != 0 )
+			{
+				close(fd);
+				return errCode;
+			}
+
+			mapFile = true;
+		}
+
+		if( ioMode == IO_MMAP )
+		{
+			iter->second._numMappedOpen++;
+		}
+
+		fileHandle._fd = fd;
+	}
+
+	//setup information for file handler
+	fileHandle._info = &(iter->second);
+	fileHandle._ioMode = ioMode;
+
+	//increment "file open instance" counter
+	(fileHandle._info->_numOpen)++;
+
+	if( setup_file_info )
+	{
+		//allocate memory buffer for the beginning of the 1st page (page-aligned for IO_DIRECT)
+		void* data = NULL;
+		if( posix_memalign(&data, PAGE_SIZE, PAGE_SIZE) != 0 )
+			data = malloc(PAGE_SIZE);
+
+		int errCode = 0;
+
+		//writes beyond the current end of the file are appends
+		fileHandle._info->_ioStats._endOfFile = fileStat.st_size;
+
+		//page size is not known yet, so read the smallest possible page directly from the file (bypassing buffer pool)
+		fileHandle._info->_pageSize = PAGE_SIZE;
+		fileHandle._info->_pageChecksums = false;
+		if( (errCode = fileHandle.readPhysicalPage(0, data)) != 0 )
+		{
+			free(data);
+			return errCode;
+		}
+
+		//fields of the header are trusted only if the first page is a header page of the current format; files without header
+		//page (and files of the earlier format) use default page size, and their number of pages comes from the size of the file
+		const Header* header = (const Header*)data;
+		fileHandle._info->_hasFormatHeader = (header->_magic == FILE_FORMAT_MAGIC && header->_formatVersion == FILE_FORMAT_VERSION);
+		fileHandle._info->_pageLayout = 0;
+		fileHandle._info->_numPages = 0;
+
+		if( fileHandle._info->_hasFormatHeader )
+		{
+			unsigned int pageSize = header->_pageSize;
+			if( pageSize > PAGE_SIZE && pageSize <= MAX_PAGE_SIZE && (pageSize & (pageSize - 1)) == 0 )
+				fileHandle._info->_pageSize = pageSize;
+
+			fileHandle._info->_pageChecksums = (header->_pageChecksums == 1);
+			fileHandle._info->_pageLayout = header->_pageLayout;
+			fileHandle._info->_numPages = header->_totFileSize;
+		}
+
+		//pages of the compressed file (except for this one) are located thru its page map
+		if( fileHandle._info->_hasFormatHeader && header->_pageCompression == 1 )
+		{
+			PageMap* pageMap = new PageMap(fileHandle._info->_pageSize);
+			if( (errCode = pageMap->open(fileName)) != 0 )
+			{
+				delete pageMap;
+				free(data);
+				return errCode;
+			}
+
+			fileHandle._info->_pageMap = pageMap;
+		}
+
+		//header is updated only when file is created, so pages that were appended (or re-applied by log recovery)
+		//since then are known only from the size of the file (or from the page map of the compressed file)
+		if( fileHandle._info->_pageMap != NULL )
+		{
+			if( fileHandle._info->_pageMap->getNumPages() > fileHandle._info->_numPages )
+				fileHandle._info->_numPages = fileHandle._info->_pageMap->getNumPages();
+		}
+		else if( (PageNum)(fileStat.st_size / fileHandle._info->_pageSize) > fileHandle._info->_numPages )
+		{
+			fileHandle._info->_numPages = fileStat.st_size / fileHandle._info->_pageSize;
+		}
+
+		//space reserved beyond the end of file by the previous session is not known (reserving it again is cheap)
+		fileHandle._info->_numAllocatedPages = fileHandle._info->_numPages;
+
+		free(data);
+	}
+
+	//slots of the compressed pages are neither at fixed offsets nor page-aligned
+	if( fileHandle._info->_pageMap != NULL && (fileHandle._ioMode == IO_MMAP || fileHandle._ioMode == IO_DIRECT) )
+	{
+		closeFile(fileHandle);
+		return -79;
+	}
+
+	//statistics of the handle cover this session only
+	fileHandle._ioStats = IOStats();
+	fileHandle._ioStats._endOfFile = (unsigned long long)fileHandle._info->_numPages * fileHandle._info->_pageSize;
+
+	//map header chain into the directory of header pages, but only for files that start with a header page of the current
+	//format (raw files and files of the earlier format are not organized into header pages of this layout)
+	if( setup_file_info && fileHandle._info->_hasFormatHeader && fileHandle._info->_freeSpaceMap == NULL )
+	{
+		FreeSpaceMap* fsm = NULL;
+		getFreeSpaceMap(fileHandle, fsm);
+	}
+
+	if( mapFile )
+	{
+		struct stat stFileInfo;
+		if( fstat(fileHandle._fd, &stFileInfo) != 0 )
+		{
+			closeFile(fileHandle);
+			return -2;
+		}
+
+		//map only complete pages (of the page size of this file)
+		size_t pageSize = fileHandle._info->_pageSize;
+		size_t mappingSize = (stFileInfo.st_size / pageSize) * pageSize;
+		void* mapping = NULL;
+
+		if( mappingSize > 0 && (mapping = mmap(NULL, mappingSize, PROT_READ, MAP_SHARED, fileHandle._fd, 0)) == MAP_FAILED )
+		{
+			closeFile(fileHandle);
+			return -71;
+		}
+
+		fileHandle._info->_mapping = mapping;
+		fileHandle._info->_mappingSize = (mapping == NULL ? 0 : mappingSize);
+	}
+
+	//file is opened successfully => return 0
+	return 0;
+
+}
+
+RC PagedFileManager::closeFile(FileHandle &fileHandle)
+{
+	//make sure that fileHandle actually points to some file
+	if( fileHandle.isOpened() == false )
+	{
+		return -9;
+	}
+
+	//background readers may use OS file-handler of this file
+	_prefetcher->cancelFile(fileHandle._info);
+
+	//write back modified pages of this file, while OS file-handler is still opened
+	RC errCode = 0;
+	if( (errCode = _bufferPool->flushFile(fileHandle._info)) != 0 )
+	{
+		return errCode;
+	}
+
+	//decrement "file open instance" counter
+	(fileHandle._info->_numOpen)--;
+
+	//statistics of the calls outlive the handle
+	fileHandle._info->_callStats.merge(fileHandle._ioStats);
+
+	//keep OS file-handler for the next openFile of this file (memory-mapped and second handler of the same file are closed)
+	FileInfo* info = fileHandle._info;
+	struct stat fileStat;
+	if( _handleCacheSize > 0 && fileHandle._ioMode != IO_MMAP && info->_cachedFilePtr == NULL && info->_cachedFd < 0 &&
+		fstat(fileHandle._ioMode == IO_STDIO ? fileno(fileHandle._filePtr) : fileHandle._fd, &fileStat) == 0 )
+	{
+		info->_cachedFilePtr = fileHandle._filePtr;
+		info->_cachedFd = fileHandle._fd;
+		info->_cachedIOMode = fileHandle._ioMode;
+		info->_cachedDevice = fileStat.st_dev;
+		info->_cachedInode = fileStat.st_ino;
+
+		_handleCache.push_front(info);
+
+		//respect the limit on number of kept handlers
+		if( _handleCache.size() > _handleCacheSize )
+		{
+			releaseCachedHandle(_handleCache.back());
+			_handleCacheEvictionCounter++;
+		}
+	}
+	else if( fileHandle._ioMode == IO_STDIO )
+	{
+		fclose(fileHandle._filePtr);
+	}
+	else
+	{
+		close(fileHandle._fd);
+	}
+
+	//release mapping when the last memory-mapped handle is closed
+	if( fileHandle._ioMode == IO_MMAP && --(fileHandle._info->_numMappedOpen) == 0 )
+	{
+		if( fileHandle._info->_mapping != NULL )
+		{
+			munmap(fileHandle._info->_mapping, fileHandle._info->_mappingSize);
+		}
+
+		fileHandle._info->_mapping = NULL;
+		fileHandle._info->_mappingSize = 0;
+	}
+
+	//reset attributes of fileHandler to null for info, file_ptr and fd
+	fileHandle._filePtr = NULL;
+	fileHandle._fd = -1;
+	fileHandle._ioMode = IO_STDIO;
+	fileHandle._info = NULL;
+	fileHandle._lastReadPage = 0;
+	fileHandle._numSequentialReads = 0;
+	fileHandle._readAheadPage = 0;
+
+	//file is closed successfully => return 0
+	return 0;
+}
+
+
+FileHandle::FileHandle()
+: _info(NULL), _filePtr(NULL), _fd(-1), _ioMode(IO_STDIO), readPageCounter(0), writePageCounter(0), appendPageCounter(0),
+  _lastReadPage(0), _numSequentialReads(0), _readAheadPage(0)
+{
+}
+
+unsigned FileHandle::getPageSize() const
+{
+	if( _info == NULL )
+		return PAGE_SIZE;
+
+	//checksum trailer is not visible to the users of the page
+	return _info->_pageChecksums ? _info->_pageSize - PAGE_CHECKSUM_SIZE : _info->_pageSize;
+}
+
+unsigned FileHandle::getPhysicalPageSize() const
+{
+	return _info == NULL ? PAGE_SIZE : _info->_pageSize;
+}
+
+bool FileHandle::hasPageChecksums() const
+{
+	return _info != NULL && _info->_pageChecksums;
+}
+
+bool FileHandle::hasPageCompression() const
+{
+	return _info != NULL && _info->_pageMap != NULL;
+}
+
+unsigned FileHandle::getPageLayout() const
+{
+	return _info == NULL ? 0 : _info->_pageLayout;
+}
+
+LogManager* FileHandle::getLogManager() const
+{
+	//log records page images at fixed offsets, which compressed file does not have
+	return hasPageCompression() ? NULL : PagedFileManager::instance()->getLogManager();
+}
+
+void FileHandle::sealPage(void* data) const
+{
+	if( hasPageChecksums() == false )
+		return;
+
+	unsigned int checksum = crc32c(data, getPageSize());
+	memcpy((char*)data + getPageSize(), &checksum, PAGE_CHECKSUM_SIZE);
+}
 
-		//append new header page
-		if( (errCode = fileHandle.appendPage(data)) != 0 )
-		{
-			//deallocate data
-			free(data);
+RC FileHandle::verifyPage(const void* data) const
+{
+	if( hasPageChecksums() == false )
+		return 0;
 
-			//return error code
-			return errCode;
-		}
+	unsigned int checksum = 0;
+	memcpy(&checksum, (const char*)data + getPageSize(), PAGE_CHECKSUM_SIZE);
 
-		//later all fields of header page are accessed by dereferencing to Header structure
-		hPage = (Header*)data;
+	if( crc32c(data, getPageSize()) == checksum )
+		return 0;
+
+	//page that has never been written (e.g. gap left by lazily appended pages) is all zeros, including its trailer
+	const char* ptr = (const char*)data;
+	for( unsigned int i = 0; i < getPhysicalPageSize(); i++ )
+	{
+		if( ptr[i] != 0 )
+			return -77;
 	}
 
-	//allocate a new data page
-	if( (errCode = fileHandle.appendPage(content)) != 0 )
+	return 0;
+}
+
+unsigned FileHandle::getNumOfPageIds() const
+{
+	return (getPageSize() - offsetof(Header, _arrOfPageIds)) / sizeof(PageInfo);
+}
+
+bool FileHandle::isOpened() const
+{
+	return _info != NULL && ( _ioMode == IO_STDIO ? _filePtr != NULL : _fd >= 0 );
+}
+
+RC FileHandle::readPhysicalPage(PageNum pageNum, void* data) const
+{
+	size_t numBytes = 0;
+	size_t pageSize = _info->_pageSize;
+	unsigned long long startTime = ioClock();
+
+	//compressed page is decompressed into the buffer (positional read does not move the cursor of stdio file)
+	if( _info->_pageMap != NULL && pageNum > 0 )
 	{
-		//deallocate data and dataPaga
-		free(data);
+		RC errCode = 0;
+		PageSlot slot;
+		if( (errCode = _info->_pageMap->readPage(_ioMode == IO_STDIO ? fileno(_filePtr) : _fd, pageNum, data, &slot)) != 0 )
+			return errCode;
 
-		//if failed, return error code
-		return errCode;
+		//page that has never been written is not read from the file
+		if( slot._length > 0 )
+			_info->_ioStats.recordShared(IO_READ, slot._offset, slot._length, ioClock() - startTime);
+
+		return verifyPage(data);
 	}
 
-	//get page id of this newly added page
-	dataPageId = fileHandle.getNumberOfPages() - 1;	//page indexes are off by extra 1, header page is '0' and first data page is '1'!
+	if( _ioMode == IO_STDIO )
+	{
+		//go to the specified page
+		if( fseeko(_filePtr, (off_t)pageSize * pageNum, SEEK_SET) != 0 )
+		{
+			//error occurred during fseek
+			return -12;
+		}
 
-	//set the new record
-	hPage->_arrOfPageIds[hPage->_numUsedPageIds]._pageid = dataPageId;
+		//attempt to read the whole page
+		numBytes = fread(data, 1, pageSize, _filePtr);
+	}
+	else
+	{
+		//read at the given offset, file cursor is not used, so it is safe to call from several threads
+		ssize_t result = pread(_fd, data, pageSize, (off_t)pageSize * pageNum);
 
-	//set the free space
-	hPage->_arrOfPageIds[hPage->_numUsedPageIds]._numFreeBytes = PAGE_SIZE;
+		if( result < 0 )
+			return -13;
 
-	//increment number of page IDs used in this page
-	hPage->_numUsedPageIds++;
+		numBytes = (size_t)result;
+	}
 
-	//write header page
-	fileHandle.writePage(headerPageId, data);
+	if( numBytes == 0 )
+		return -13;
 
-	//deallocate data(s)
-	free(data);
+	_info->_ioStats.recordShared(IO_READ, (unsigned long long)pageSize * pageNum, numBytes, ioClock() - startTime);
 
-	//return success, because technically no error occurred
-	return 0;
+	//page is shorter than page size (last page of the file that was not written fully)
+	if( numBytes < pageSize )
+		memset((char*)data + numBytes, 0, pageSize - numBytes);
+
+	//page that reached the disk only partially (or got corrupted there) is not handed to the caller
+	return verifyPage(data);
 }
 
-RC PagedFileManager::getDataPage(FileHandle &fileHandle, const unsigned int recordSize, PageNum& pageNum, PageNum& headerPage, unsigned int& freeSpaceLeftInPage)
+RC FileHandle::readMappedPage(PageNum pageNum, const void*& data) const
 {
-	RC errCode = 0;
+	//check that file handler is pointing to some file
+	if( isOpened() == false )
+	{
+		return -9;
+	}
 
-	//is for IX functions
-	bool ixDataPage = recordSize == (unsigned int)-1;
+	//check that page is inside the mapping
+	if( _ioMode != IO_MMAP || _info->_mapping == NULL || (size_t)_info->_pageSize * (pageNum + 1) > _info->_mappingSize )
+	{
+		return -72;
+	}
 
-	//maintain current header page id and its former value (from past iteration)
-	unsigned int headerPageId = 0, lastHeaderPageId = 0;
+	data = (const char*)_info->_mapping + (size_t)_info->_pageSize * pageNum;
 
-	//keep array of bytes of size of page for reading in page data
-	void* data = malloc(PAGE_SIZE);
+	return verifyPage(data);
+}
 
-	//casted data to header page
-	Header* hPage = NULL;
+RC FileHandle::writePhysicalPage(PageNum pageNum, void* data) const
+{
+	size_t pageSize = _info->_pageSize;
 
-	//loop thru header pages
-	do
-	{
-		//get the first header page
-		if( (errCode = fileHandle.readPage((PageNum)headerPageId, data)) != 0 )
-		{
-			//deallocate data
-			free(data);
+	sealPage(data);
 
-			//return error
+	unsigned long long startTime = ioClock();
+
+	//compressed page goes into its slot (time includes compression)
+	if( _info->_pageMap != NULL && pageNum > 0 )
+	{
+		RC errCode = 0;
+		PageSlot slot;
+		if( (errCode = _info->_pageMap->writePage(_ioMode == IO_STDIO ? fileno(_filePtr) : _fd, pageNum, data, &slot)) != 0 )
 			return errCode;
-		}
 
-		//cast data to Header
-		hPage = (Header*)data;
+		_info->_ioStats.recordShared(IO_WRITE, slot._offset, slot._length, ioClock() - startTime);
 
-		//get the id of the next header page
-		lastHeaderPageId = headerPageId;
-		headerPageId = hPage->_nextHeaderPageId;
+		return 0;
+	}
 
-		//loop thru page entries of the current header page
-		for( unsigned int i = 0; i < hPage->_numUsedPageIds; i++ )
+	if( _ioMode == IO_STDIO )
+	{
+		//go to the specified page (it is possible to go beyond the end of file, since appended pages are written lazily)
+		if( fseeko(_filePtr, (off_t)pageSize * pageNum, SEEK_SET) != 0 )
 		{
-			//get the current data page information
-			PageInfo* pi = &(hPage->_arrOfPageIds[i]);
+			//error occurred during fseek
+			return -12;
+		}
 
-			//if it has the proper number of free bytes than return information about this page
-			if( (ixDataPage == true && pi->_numFreeBytes == (unsigned int)-1) ||
-				(ixDataPage == false && pi->_numFreeBytes >= recordSize + sizeof(PageDirSlot)) )	//inconsistency found: if amount of free space left in page and requested size are exactly equal than it would skip this candidate page and allocate a new data page, so I changed '>' to '>='
-			{
-				//assign id
-				pageNum = pi->_pageid;
-
-				//update free space left
-				if( ixDataPage )
-				{
-					pi->_numFreeBytes = 0;
-				}
-				else
-				{
-					pi->_numFreeBytes = pi->_numFreeBytes - recordSize - sizeof(PageDirSlot);
-				}
-
-				freeSpaceLeftInPage = pi->_numFreeBytes;
-
-				//assign a header page
-				headerPage = lastHeaderPageId;
-
-				//write header page
-				if( (errCode = fileHandle.writePage(headerPage, data)) != 0 )
-				{
-					free(data);
-					return errCode;
-				}
-
-				//deallocate data
-				free(data);
+		//write the whole page
+		if( fwrite(data, 1, pageSize, _filePtr) != pageSize )
+			return -13;
 
-				//return success
-				return 0;
-			}
-		}
+		//make sure that data reached the OS, so other handles of the same file observe it
+		if( fflush(_filePtr) != 0 )
+			return -13;
+	}
+	else
+	{
+		if( pwrite(_fd, data, pageSize, (off_t)pageSize * pageNum) != (ssize_t)pageSize )
+			return -13;
+	}
 
-	} while(headerPageId > 0);
+	_info->_ioStats.recordShared(IO_WRITE, (unsigned long long)pageSize * pageNum, pageSize, ioClock() - startTime);
 
-	//assign a header page id
-	headerPage = lastHeaderPageId;
+	//success
+	return 0;
+}
 
-	void* dataPage = malloc(PAGE_SIZE);
-	memset(dataPage, 0, PAGE_SIZE);
+RC FileHandle::readPhysicalPages(PageNum firstPage, const std::vector<void*>& pages) const
+{
+	size_t pageSize = _info->_pageSize;
+	struct iovec vectors[MAX_VECTORED_PAGES];
 
-	unsigned int curPageId = hPage->_numUsedPageIds;
+	if( pages.empty() || pages.size() > MAX_VECTORED_PAGES )
+		return -11;
 
-	if( (errCode = insertPage(fileHandle, headerPage, pageNum, dataPage)) != 0 )
+	//compressed pages are not adjacent in the file, so they are read one by one
+	if( _info->_pageMap != NULL )
 	{
-		//free buffers
-		free(data);
-		free(dataPage);
-		//return error code
+		RC errCode = 0;
+		for( unsigned int i = 0; i < pages.size() && errCode == 0; i++ )
+			errCode = readPhysicalPage(firstPage + i, pages[i]);
+
 		return errCode;
 	}
 
-	if( headerPage != lastHeaderPageId )
-		curPageId = 0;
+	for( unsigned int i = 0; i < pages.size(); i++ )
+	{
+		vectors[i].iov_base = pages[i];
+		vectors[i].iov_len = pageSize;
+	}
 
-	if( ixDataPage == false )
+	//positional read does not move the cursor, so stdio file can be read thru its descriptor (stdio does not buffer it)
+	int fd = (_ioMode == IO_STDIO ? fileno(_filePtr) : _fd);
+	unsigned long long startTime = ioClock();
+	ssize_t result = preadv(fd, vectors, pages.size(), (off_t)pageSize * firstPage);
+
+	if( result < 0 )
+		return -13;
+
+	_info->_ioStats.recordShared(IO_READ, (unsigned long long)pageSize * firstPage, result, ioClock() - startTime);
+
+	RC errCode = 0;
+	for( unsigned int i = 0; i < pages.size() && errCode == 0; i++ )
 	{
-		//null data (hPage was not changed upto this point, so no need to write it back)
-		memset(data, 0, PAGE_SIZE);
+		size_t numBytes = ( (size_t)result > i * pageSize ? (size_t)result - i * pageSize : 0 );
 
-		//read a specified header page
-		if( (errCode = fileHandle.readPage(headerPage, data)) != 0 )
-		{
-			//deallocate buffers
-			free(data);
-			free(dataPage);
-			//return error code
-			return errCode;
-		}
+		//same as readPhysicalPage: page beyond the end of file is an error, the last one may be partial
+		if( numBytes == 0 )
+			return -13;
 
-		//cast it to Header pointer
-		hPage = (Header*)data;
+		if( numBytes < pageSize )
+			memset((char*)pages[i] + numBytes, 0, pageSize - numBytes);
 
-		//set free space
-		if( hPage->_arrOfPageIds[curPageId]._numFreeBytes == PAGE_SIZE )
-			hPage->_arrOfPageIds[curPageId]._numFreeBytes =
-					hPage->_arrOfPageIds[curPageId]._numFreeBytes - 2 * sizeof(unsigned int);
-		hPage->_arrOfPageIds[curPageId]._numFreeBytes =
-				hPage->_arrOfPageIds[curPageId]._numFreeBytes - recordSize + sizeof(PageDirSlot);
+		errCode = verifyPage(pages[i]);
+	}
 
-		freeSpaceLeftInPage = hPage->_arrOfPageIds[curPageId]._numFreeBytes;
+	return errCode;
+}
 
-		//write header page
-		if( (errCode = fileHandle.writePage(headerPage, data)) != 0 )
-		{
-			//deallocate buffers
-			free(data);
-			free(dataPage);
-			//return error code
-			return errCode;
-		}
+RC FileHandle::writePhysicalPages(PageNum firstPage, const std::vector<void*>& pages) const
+{
+	size_t pageSize = _info->_pageSize;
+	struct iovec vectors[MAX_VECTORED_PAGES];
+
+	if( pages.empty() || pages.size() > MAX_VECTORED_PAGES )
+		return -11;
+
+	//same for writes
+	if( _info->_pageMap != NULL )
+	{
+		RC errCode = 0;
+		for( unsigned int i = 0; i < pages.size() && errCode == 0; i++ )
+			errCode = writePhysicalPage(firstPage + i, pages[i]);
+
+		return errCode;
 	}
 
-	//deallocate buffers
-	free(data);
-	free(dataPage);
+	for( unsigned int i = 0; i < pages.size(); i++ )
+	{
+		sealPage(pages[i]);
 
-	//return success
+		vectors[i].iov_base = pages[i];
+		vectors[i].iov_len = pageSize;
+	}
+
+	int fd = (_ioMode == IO_STDIO ? fileno(_filePtr) : _fd);
+	unsigned long long startTime = ioClock();
+	if( pwritev(fd, vectors, pages.size(), (off_t)pageSize * firstPage) != (ssize_t)(pageSize * pages.size()) )
+		return -13;
+
+	_info->_ioStats.recordShared(IO_WRITE, (unsigned long long)pageSize * firstPage, pageSize * pages.size(), ioClock() - startTime);
+
+	//success
 	return 0;
 }
 
-int PagedFileManager::countNumberOfOpenedInstances(const char* fileName)
+RC FileHandle::collectCounterValues(unsigned &readPageCount, unsigned &writePageCount, unsigned &appendPageCount)
 {
-	//check for illegal file name
-	if( fileName == NULL || strlen(fileName) == 0 )
+	RC errCode = 0;
+
+	readPageCount += this->readPageCounter;
+	writePageCount += this->writePageCounter;
+	appendPageCount += this->appendPageCounter;
+
+	return errCode;
+}
+
+RC FileHandle::collectPhysicalCounterValues(unsigned &readPageCount, unsigned &writePageCount)
+{
+	//physical I/O is tracked per file, since write back may happen thru any of the handles of the file
+	if( _info == NULL )
 	{
-		return -14;
+		return -9;
 	}
 
-	//iterator that should point to the item in _files
-	std::map<std::string, FileInfo>::iterator iter;
+	readPageCount += _info->_physicalReadCounter;
+	writePageCount += _info->_physicalWriteCounter;
 
-	//get the record of this file from _files
-	if( ( iter = _files.find(std::string(fileName)) ) == _files.end() )
+	return 0;
+}
+
+RC FileHandle::collectIOCallCounterValues(unsigned &readCallCount, unsigned &writeCallCount)
+{
+	if( _info == NULL )
 	{
-		return -4;	//cannot delete, because this file does not exist
+		return -9;
 	}
 
-	//make sure that file to be deleted is not opened/used
-	return (int)(iter->second._numOpen);
+	readCallCount += _info->_readCallCounter;
+	writeCallCount += _info->_writeCallCounter;
+
+	return 0;
 }
 
-RC PagedFileManager::destroyFile(const char *fileName)
+RC FileHandle::collectCompressionCounterValues(unsigned long long &readByteCount, unsigned long long &writeByteCount, unsigned long long &uncompressedByteCount)
 {
-	//check for illegal file name
-	if( fileName == NULL || strlen(fileName) == 0 )
+	if( _info == NULL || _info->_pageMap == NULL )
 	{
-		return -14;
+		return -9;
 	}
 
-	//iterator that should point to the item in _files
-	std::map<std::string, FileInfo>::iterator iter;
+	readByteCount += _info->_pageMap->_readByteCounter;
+	writeByteCount += _info->_pageMap->_writeByteCounter;
+	uncompressedByteCount += _info->_pageMap->_uncompressedByteCounter;
 
-	//get the record of this file from _files
-	if( ( iter = _files.find(std::string(fileName)) ) == _files.end() )
+	return 0;
+}
+
+RC FileHandle::collectForwardingCounterValues(unsigned &forwardedReadCount, unsigned &forwardedRecordCount, unsigned &migratedRecordCount)
+{
+	//records may be read thru any of the handles of the file, so counters are kept per file
+	if( _info == NULL )
 	{
-		return -4;	//cannot delete, because this file does not exist
+		return -9;
 	}
 
-	//make sure that file to be deleted is not opened/used (TableScan.dtor)
-	//if( iter->second._numOpen != 0 )
-	//{
-	//	return -5;	//attempting to delete an opened file
-	//}
+	forwardedReadCount += _info->_forwardedReadCounter;
+	forwardedRecordCount += _info->_forwardedRecordCounter;
+	migratedRecordCount += _info->_migratedRecordCounter;
 
-	//remove file from FileSystem
-	if( remove(fileName) != 0 )
-		return -6;	//system is unable to delete a file
+	return 0;
+}
 
-	//delete record from _files
-	_files.erase(iter);
+RC FileHandle::collectIOStats(IOStats &stats)
+{
+	stats.merge(_ioStats);
 
-	//destruction of a file was successful, return 0
 	return 0;
 }
 
-RC PagedFileManager::getNumOpenInstances(const char* fileName)
+RC FileHandle::collectPhysicalIOStats(IOStats &stats)
 {
-	RC errCode = 0;
+	//same as physical counters, transfers are tracked per file
+	if( _info == NULL )
+	{
+		return -9;
+	}
 
-	std::map<std::string, FileInfo>::iterator iter;
-	if( ( iter = _files.find(std::string(fileName)) ) != _files.end() )
+	stats.merge(_info->_ioStats);
+
+	return 0;
+}
+
+RC FileHandle::pinPage(PageNum pageNum, void*& data)
+{
+	//check that file handler is pointing to some file
+	if( isOpened() == false )
 	{
-		printf("file named: %s => # opens: %i\n", fileName, (int)iter->second._numOpen);
+		return -9;
 	}
-	else
+
+	//check that pageNum is within the boundaries of a given file
+	if( pageNum >= getNumberOfPages() )
 	{
-		printf("No such entry");
+		return -10;
 	}
 
-	return errCode;
+	readAhead(pageNum);
+
+	return PagedFileManager::instance()->getBufferPool()->pinPage(*this, pageNum, true, data);
+}
+
+void FileHandle::reserveExtent(PageNum pageNum)
+{
+	//compressed pages do not occupy page-sized blocks
+	if( pageNum < _info->_numAllocatedPages || _info->_pageMap != NULL )
+		return;
+
+	unsigned int minPages = 0, maxPages = 0;
+	PagedFileManager::instance()->getExtentSize(minPages, maxPages);
+
+	if( minPages == 0 )
+		return;
+
+	//extent doubles the reservation, within the configured bounds, and it has to cover the page
+	unsigned int numPages = _info->_numAllocatedPages;
+	if( numPages < minPages )
+		numPages = minPages;
+	if( numPages > maxPages )
+		numPages = maxPages;
+	if( _info->_numAllocatedPages + numPages <= pageNum )
+		numPages = pageNum + 1 - _info->_numAllocatedPages;
+
+	//reserve disk blocks without changing file size (number of pages is derived from it);
+	//reservation is best-effort, i.e. if file system does not support it, then file grows on write back as before
+	int fd = (_ioMode == IO_STDIO ? fileno(_filePtr) : _fd);
+	if( fallocate(fd, FALLOC_FL_KEEP_SIZE, (off_t)_info->_pageSize * _info->_numAllocatedPages, (off_t)_info->_pageSize * numPages) == 0 )
+	{
+		_info->_extentCounter++;
+	}
+
+	_info->_numAllocatedPages += numPages;
 }
 
-RC PagedFileManager::openFile(const char *fileName, FileHandle &fileHandle)
-{
-	//check for illegal file name
-	if( fileName == NULL || strlen(fileName) == 0 )
+void FileHandle::readAhead(PageNum pageNum)
+{
+	PagedFileManager* pfm = PagedFileManager::instance();
+
+	//same page is read again (e.g. next record of the same page)
+	if( pageNum == _lastReadPage )
+		return;
+
+	//count consecutive pages, and start over on any jump
+	if( pageNum == _lastReadPage + 1 )
 	{
-		return -14;
+		_numSequentialReads++;
 	}
-
-	//if file does not exist, then abort
-	if( !isExisting(fileName) )
+	else
 	{
-		return -4;	//file does not exist
+		_numSequentialReads = 0;
+		_readAheadPage = 0;
 	}
 
-	//iterator that should point to the item in _files
-	std::map<std::string, FileInfo>::iterator iter;
-
-	bool setup_file_info = false;
+	_lastReadPage = pageNum;
 
-	//get the record of this file from _files
-	if( ( iter = _files.find(std::string(fileName)) ) == _files.end() )
-	{
+	//read-ahead window cannot take more than a quarter of the buffer pool, otherwise it would evict pages it brings in
+	unsigned int window = pfm->getPrefetchWindow();
+	unsigned int maxWindow = pfm->getBufferPool()->getNumFrames() / 4;
+	if( window > maxWindow )
+		window = maxWindow;
 
-		//create file information entity (by default set created file to be user accessible and modifiable)
-		FileInfo info = FileInfo(fileName, 0, 0);//, user_access);
+	if( window == 0 || _numSequentialReads < PREFETCH_SEQUENTIAL_THRESHOLD )
+		return;
 
-		//mark this file handle to be in need to setup a file info
-		setup_file_info = true;
+	//request pages in batches, i.e. once reader consumed half of the pages requested before
+	if( _readAheadPage > pageNum + window / 2 )
+		return;
 
-		std::pair<std::map<std::string, FileInfo>::iterator, bool> resultOfInsertion = _files.insert( std::pair<std::string, FileInfo>(fileName, info) );
+	PageNum firstPage = (_readAheadPage > pageNum ? _readAheadPage : pageNum + 1);
+	PageNum lastPage = pageNum + window;
+	if( lastPage >= getNumberOfPages() )
+		lastPage = getNumberOfPages() - 1;
 
-		//insert record into hash-map (_files)
-		if( resultOfInsertion.second == false )
-			return -3;	//entry with this FILE* already exists
+	if( firstPage > lastPage )
+		return;
 
-		//set the iter
-		iter = resultOfInsertion.first;
-		//return -7; //error removed, since it appears to be possible to open a file that was not created by original DB
-	}
+	pfm->getPrefetcher()->request(*this, firstPage, lastPage);
+	_readAheadPage = lastPage + 1;
+}
 
-	//make sure that given file handler is not used for any file
-	if( fileHandle._info != NULL || fileHandle._filePtr != NULL )
+RC FileHandle::unpinPage(PageNum pageNum, bool isDirty)
+{
+	//check that file handler is pointing to some file
+	if( isOpened() == false )
 	{
-		return -8;	//this file handler is being used for another file, yet it is attempted to be used for opening this file
+		return -9;
 	}
 
-	//open a binary file for both reading and writing
-	FILE* file_ptr = fopen(fileName, "rb+");
+	RC errCode = 0;
+	PagedFileManager* pfm = PagedFileManager::instance();
+	BufferPool* pool = pfm->getBufferPool();
+	LogManager* log = getLogManager();
 
-	//check if file was created successfully
-	if( !file_ptr )
+	//memory-mapped file is read-only, so page cannot be modified thru this handle
+	if( isDirty && _ioMode == IO_MMAP )
 	{
-		return -2;	//system is unable to create new file
+		pool->unpinPage(*this, pageNum, false);
+		return -70;
 	}
 
-	//setup information for file handler
-	fileHandle._info = &(iter->second);
-	fileHandle._filePtr = file_ptr;
+	//page has been modified in place, so take its content from the frame (page is still pinned here)
+	if( isDirty && (log != NULL || (_info->_freeSpaceMap != NULL && _info->_freeSpaceMap->isHeaderPage(pageNum))) )
+	{
+		void* frameData = NULL;
+		LSN lsn = 0;
 
-	//increment "file open instance" counter
-	(fileHandle._info->_numOpen)++;
+		if( (errCode = pool->pinPage(*this, pageNum, true, frameData)) != 0 )
+		{
+			pool->unpinPage(*this, pageNum, isDirty);
+			return errCode;
+		}
 
-	if( setup_file_info )
-	{
-		//allocate memory buffer for 1st page
-		void* data = malloc(PAGE_SIZE);
+		syncFreeSpaceMap(pageNum, frameData);
 
-		int errCode = 0;
+		if( log != NULL )
+		{
+			pfm->beginOperation();
 
-		//allow access to the header page
-		fileHandle._info->_numPages = 1;
+			//logged image is written to the file as is by recovery, so it has to carry valid checksum
+			sealPage(frameData);
 
-		//explicitly read the number of pages from the file's first header
-		if( (errCode = fileHandle.readPage(0, data)) != 0 )
-			return errCode;
+			if( (errCode = log->logPage(_info->_name, pageNum, frameData, getPhysicalPageSize(), lsn)) == 0 )
+				errCode = pool->unpinPage(*this, pageNum, true, lsn);
 
-		//get the page number
-		fileHandle._info->_numPages = ((Header*)data)->_totFileSize;
-	}
+			pool->unpinPage(*this, pageNum, false);
 
-	//file is opened successfully => return 0
-	return 0;
+			RC endCode = pfm->endOperation(errCode);
+			return errCode != 0 ? errCode : endCode;
+		}
 
-}
+		pool->unpinPage(*this, pageNum, false);
+	}
 
-RC PagedFileManager::closeFile(FileHandle &fileHandle)
-{
-	//make sure that fileHandle actually points to some file
-	if( fileHandle._filePtr == NULL || fileHandle._info == NULL )
+	if( (errCode = pool->unpinPage(*this, pageNum, isDirty)) != 0 )
 	{
-		return -9;
+		return errCode;
 	}
 
-	//decrement "file open instance" counter
-	(fileHandle._info->_numOpen)--;
-
-	//close file
-	fclose(fileHandle._filePtr);
-
-	//reset attributes of fileHandler to null for both info and file_ptr
-	fileHandle._filePtr = NULL;
-	fileHandle._info = NULL;
-
-	//file is closed successfully => return 0
+	//success
 	return 0;
 }
 
-
-FileHandle::FileHandle()
-: _info(NULL), _filePtr(NULL), readPageCounter(0), writePageCounter(0), appendPageCounter(0)
-{
-}
-
-RC FileHandle::collectCounterValues(unsigned &readPageCount, unsigned &writePageCount, unsigned &appendPageCount)
+void FileHandle::syncFreeSpaceMap(PageNum pageNum, const void* data)
 {
-	RC errCode = 0;
+	//allocation map is dropped as well, once the first header page does not reference its chain (e.g. all records got deleted)
+	if( pageNum == 0 && _info != NULL && _info->_allocMap != NULL && _info->_allocMap->getFirstMapPage() != ((const Header*)data)->_allocMapPageId )
+	{
+		delete _info->_allocMap;
+		_info->_allocMap = NULL;
+	}
 
-	readPageCount += this->readPageCounter;
-	writePageCount += this->writePageCounter;
-	appendPageCount += this->appendPageCounter;
+	if( _info == NULL || _info->_freeSpaceMap == NULL || _info->_freeSpaceMap->isHeaderPage(pageNum) == false )
+		return;
 
-	return errCode;
+	//if header chain has been re-linked, then drop the map (it would be re-built on next getDataPage)
+	if( _info->_freeSpaceMap->syncHeaderPage(pageNum, data) == false )
+	{
+		delete _info->_freeSpaceMap;
+		_info->_freeSpaceMap = NULL;
+	}
 }
 
 FileHandle::~FileHandle()
 {
 	_info = NULL;
 	_filePtr = NULL;
+	_fd = -1;
 }
 
 
@@ -691,7 +2259,7 @@ FileHandle::~FileHandle()
 RC FileHandle::readPage(PageNum pageNum, void *data)
 {
     //check that file handler is pointing to some file
-    if( _filePtr == NULL || _info == NULL )
+    if( isOpened() == false )
     {
     	return -9;
     }
@@ -708,23 +2276,43 @@ RC FileHandle::readPage(PageNum pageNum, void *data)
     	return -11;
     }
 
-    long int size = PAGE_SIZE * pageNum;
+    RC errCode = 0;
+    unsigned long long startTime = ioClock();
+
+    //memory-mapped page does not need buffer pool
+    const void* mappedPage = NULL;
+    if( _ioMode == IO_MMAP && readMappedPage(pageNum, mappedPage) == 0 )
+    {
+    	memcpy(data, mappedPage, getPageSize());
+
+    	//update counter
+    	readPageCounter = readPageCounter + 1;
+    	_ioStats.record(IO_READ, (unsigned long long)pageNum * getPhysicalPageSize(), getPageSize(), ioClock() - startTime);
+
+    	//success
+    	return 0;
+    }
+
+    //sequential reader gets next pages read in the background
+    readAhead(pageNum);
+
+    BufferPool* pool = PagedFileManager::instance()->getBufferPool();
 
-    //go to the specified page
-    if( fseek(_filePtr, size, SEEK_SET) != 0 )
+    //get the page from buffer pool (it would go to the disk, only if page is not cached)
+    void* frameData = NULL;
+    if( (errCode = pool->pinPage(*this, pageNum, true, frameData)) != 0 )
     {
-    	//error occurred during fseek
-    	return -12;
+    	return errCode;
     }
 
-    //attempt to read PAGE_SIZE bytes
-    size_t numBytes = fread(data, 1, PAGE_SIZE, _filePtr);
+    //copy page to the caller
+    memcpy(data, frameData, getPageSize());
 
-    if( numBytes == 0 )
-    	return -13;
+    pool->unpinPage(*this, pageNum, false);
 
     //update counter
     readPageCounter = readPageCounter + 1;
+    _ioStats.record(IO_READ, (unsigned long long)pageNum * getPhysicalPageSize(), getPageSize(), ioClock() - startTime);
 
     //success
     return 0;
@@ -734,7 +2322,7 @@ RC FileHandle::readPage(PageNum pageNum, void *data)
 RC FileHandle::writePage(PageNum pageNum, const void *data)
 {
 	//check that file handler is pointing to some file
-	if( _filePtr == NULL || _info == NULL )
+	if( isOpened() == false )
 	{
 		return -9;
 	}
@@ -751,21 +2339,54 @@ RC FileHandle::writePage(PageNum pageNum, const void *data)
 		return -11;
 	}
 
-	//go to the specified page
-	if( fseek(_filePtr, PAGE_SIZE * pageNum, SEEK_SET) != 0 )
+	//memory-mapped file is read-only
+	if( _ioMode == IO_MMAP )
 	{
-		//error occurred during fseek
-		return -12;
+		return -70;
 	}
 
-	//attempt to write PAGE_SIZE bytes
-	size_t numBytes = fwrite(data, 1, PAGE_SIZE, _filePtr);
+	RC errCode = 0;
+	unsigned long long startTime = ioClock();
+	PagedFileManager* pfm = PagedFileManager::instance();
+	BufferPool* pool = pfm->getBufferPool();
+	LogManager* log = getLogManager();
+
+	//get frame for this page (whole page is overwritten, so no need to read it from disk)
+	void* frameData = NULL;
+	if( (errCode = pool->pinPage(*this, pageNum, false, frameData)) != 0 )
+	{
+		return errCode;
+	}
 
-	if( numBytes != PAGE_SIZE )
-		return -13;
+	//modify cached copy; it would be written back to the disk on eviction or when file is closed
+	memcpy(frameData, data, getPageSize());
+
+	//log page image; write that is not a part of the bigger operation is committed as an operation by itself
+	LSN lsn = 0;
+	if( log != NULL )
+	{
+		pfm->beginOperation();
+		sealPage(frameData);
+		errCode = log->logPage(_info->_name, pageNum, frameData, getPhysicalPageSize(), lsn);
+	}
+
+	pool->unpinPage(*this, pageNum, true, lsn);
+
+	if( log != NULL )
+	{
+		RC endCode = pfm->endOperation(errCode);
+		if( errCode != 0 || (errCode = endCode) != 0 )
+		{
+			return errCode;
+		}
+	}
+
+	//keep free-space map consistent with header pages
+	syncFreeSpaceMap(pageNum, data);
 
 	//update counter
 	writePageCounter = writePageCounter + 1;
+	_ioStats.record(IO_WRITE, (unsigned long long)pageNum * getPhysicalPageSize(), getPageSize(), ioClock() - startTime);
 
 	//success
 	return 0;
@@ -780,56 +2401,284 @@ RC FileHandle::appendPage(const void *data)
 	}
 
 	//check that file handler is pointing to some file
-	if( _filePtr == NULL || _info == NULL )
+	if( isOpened() == false )
 	{
 		return -9;
 	}
 
-	//go to the ending page of the file
-	if( fseek(_filePtr, 0, SEEK_END) != 0 )
+	//memory-mapped file is read-only
+	if( _ioMode == IO_MMAP )
 	{
-		//error occurred during fseek
-		return -12;
+		return -70;
 	}
 
-	//write data
-	size_t numBytes = fwrite(data, 1, PAGE_SIZE, _filePtr);
+	RC errCode = 0;
+	unsigned long long startTime = ioClock();
+	PagedFileManager* pfm = PagedFileManager::instance();
+	BufferPool* pool = pfm->getBufferPool();
+	LogManager* log = getLogManager();
+
+	//new page goes right after the last one; it is created inside buffer pool and reaches the end of file on write back
+	PageNum pageNum = _info->_numPages;
 
-	//check that number of bytes written is equal exactly to the page size
-	if( numBytes != PAGE_SIZE )
+	//make sure that disk space for it is reserved, so that file is not grown block by block on write back
+	reserveExtent(pageNum);
+
+	void* frameData = NULL;
+	if( (errCode = pool->pinPage(*this, pageNum, false, frameData)) != 0 )
 	{
-		//fwrite failed
-		return -13;
+		return errCode;
+	}
+
+	memcpy(frameData, data, getPageSize());
+
+	LSN lsn = 0;
+	if( log != NULL )
+	{
+		pfm->beginOperation();
+		sealPage(frameData);
+		errCode = log->logPage(_info->_name, pageNum, frameData, getPhysicalPageSize(), lsn);
 	}
 
+	pool->unpinPage(*this, pageNum, true, lsn);
+
 	//increment page count
 	_info->_numPages++;
 
+	if( log != NULL )
+	{
+		RC endCode = pfm->endOperation(errCode);
+		if( errCode != 0 || (errCode = endCode) != 0 )
+		{
+			return errCode;
+		}
+	}
+
 	//update counter
 	appendPageCounter = appendPageCounter + 1;
+	_ioStats.record(IO_APPEND, (unsigned long long)pageNum * getPhysicalPageSize(), getPageSize(), ioClock() - startTime);
 
 	//success
 	return 0;
 }
 
-void FileHandle::writeBackNumOfPages()
+/*
+ * number of pages that readPages/writePages keep pinned at once (not more than a quarter of the buffer pool)
+**/
+static unsigned int vectoredBatchSize()
 {
-	//allocate buffer for the first header page
-	void* firstPageBuffer = malloc(PAGE_SIZE);
+	unsigned int numPages = PagedFileManager::instance()->getBufferPool()->getNumFrames() / 4;
 
-	//null it
-	memset(firstPageBuffer, 0, PAGE_SIZE);
+	if( numPages > MAX_VECTORED_PAGES )
+		numPages = MAX_VECTORED_PAGES;
 
-	//try to read the first header page
-	if( readPage(0, firstPageBuffer) != 0 )
-		return;
+	return numPages == 0 ? 1 : numPages;
+}
+
+RC FileHandle::readPages(PageNum firstPage, unsigned numPages, void *data)
+{
+	std::vector<PageNum> pageNums;
+	for( unsigned int i = 0; i < numPages; i++ )
+	{
+		pageNums.push_back(firstPage + i);
+	}
+
+	return readPages(pageNums, data);
+}
+
+RC FileHandle::readPages(const std::vector<PageNum> &pageNums, void *data)
+{
+	//check that file handler is pointing to some file
+	if( isOpened() == false )
+	{
+		return -9;
+	}
+
+	//check that data is not corrupted (i.e. data ptr is not null)
+	if( data == NULL )
+	{
+		return -11;
+	}
+
+	//check that all pages are within the boundaries of a given file
+	for( unsigned int i = 0; i < pageNums.size(); i++ )
+	{
+		if( pageNums[i] >= getNumberOfPages() )
+			return -10;
+	}
+
+	RC errCode = 0;
+
+	//memory-mapped pages are copied straight from the mapping, i.e. there are no system calls to save
+	if( _ioMode == IO_MMAP )
+	{
+		for( unsigned int i = 0; i < pageNums.size(); i++ )
+		{
+			if( (errCode = readPage(pageNums[i], (char*)data + (size_t)i * getPageSize())) != 0 )
+				return errCode;
+		}
+
+		return 0;
+	}
+
+	unsigned long long startTime = ioClock();
+	BufferPool* pool = PagedFileManager::instance()->getBufferPool();
+	unsigned int batchSize = vectoredBatchSize();
+
+	for( unsigned int start = 0; start < pageNums.size(); start += batchSize )
+	{
+		unsigned int end = (start + batchSize < pageNums.size() ? start + batchSize : pageNums.size());
+		std::vector<PageNum> batch(pageNums.begin() + start, pageNums.begin() + end);
+		std::vector<void*> frames;
+
+		//pin the whole batch, so that pages missing from the pool are read together
+		if( (errCode = pool->pinPages(*this, batch, true, frames)) != 0 )
+		{
+			return errCode;
+		}
+
+		for( unsigned int i = 0; i < batch.size(); i++ )
+		{
+			memcpy((char*)data + (size_t)(start + i) * getPageSize(), frames[i], getPageSize());
+			pool->unpinPage(*this, batch[i], false);
+		}
+	}
+
+	//update counter (pages of a single call are accounted for as one transfer that starts at the first of them)
+	readPageCounter = readPageCounter + pageNums.size();
+	if( pageNums.empty() == false )
+		_ioStats.record(IO_READ, (unsigned long long)pageNums[0] * getPhysicalPageSize(), (unsigned long long)pageNums.size() * getPageSize(), ioClock() - startTime);
+
+	//success
+	return 0;
+}
+
+RC FileHandle::writePages(PageNum firstPage, unsigned numPages, const void *data)
+{
+	std::vector<PageNum> pageNums;
+	for( unsigned int i = 0; i < numPages; i++ )
+	{
+		pageNums.push_back(firstPage + i);
+	}
+
+	return writePages(pageNums, data);
+}
+
+RC FileHandle::writePages(const std::vector<PageNum> &pageNums, const void *data)
+{
+	//check that file handler is pointing to some file
+	if( isOpened() == false )
+	{
+		return -9;
+	}
 
-	//increment the page count
-	((Header*)firstPageBuffer)->_totFileSize = _info->_numPages;
+	//check that data is not corrupted (i.e. data ptr is not null)
+	if( data == NULL )
+	{
+		return -11;
+	}
+
+	//memory-mapped file is read-only
+	if( _ioMode == IO_MMAP )
+	{
+		return -70;
+	}
+
+	//check that all pages are within the boundaries of a given file
+	for( unsigned int i = 0; i < pageNums.size(); i++ )
+	{
+		if( pageNums[i] >= getNumberOfPages() )
+			return -10;
+	}
+
+	RC errCode = 0;
+	unsigned long long startTime = ioClock();
+	PagedFileManager* pfm = PagedFileManager::instance();
+	BufferPool* pool = pfm->getBufferPool();
+	LogManager* log = getLogManager();
+	unsigned int batchSize = vectoredBatchSize();
+
+	for( unsigned int start = 0; start < pageNums.size(); start += batchSize )
+	{
+		unsigned int end = (start + batchSize < pageNums.size() ? start + batchSize : pageNums.size());
+		std::vector<PageNum> batch(pageNums.begin() + start, pageNums.begin() + end);
+		std::vector<void*> frames;
+
+		//whole pages are overwritten, so nothing is read from disk
+		if( (errCode = pool->pinPages(*this, batch, false, frames)) != 0 )
+		{
+			return errCode;
+		}
+
+		//pages of the batch are logged as one operation
+		if( log != NULL )
+			pfm->beginOperation();
+
+		for( unsigned int i = 0; i < batch.size(); i++ )
+		{
+			LSN lsn = 0;
+			memcpy(frames[i], (const char*)data + (size_t)(start + i) * getPageSize(), getPageSize());
+
+			if( log != NULL && errCode == 0 )
+			{
+				sealPage(frames[i]);
+				errCode = log->logPage(_info->_name, batch[i], frames[i], getPhysicalPageSize(), lsn);
+			}
+
+			pool->unpinPage(*this, batch[i], true, lsn);
+		}
+
+		if( log != NULL )
+		{
+			RC endCode = pfm->endOperation(errCode);
+			if( errCode != 0 || (errCode = endCode) != 0 )
+			{
+				return errCode;
+			}
+		}
 
-	if( writePage(0, firstPageBuffer) != 0 )
+		//keep free-space map consistent with header pages
+		for( unsigned int i = 0; i < batch.size(); i++ )
+		{
+			syncFreeSpaceMap(batch[i], (const char*)data + (size_t)(start + i) * getPageSize());
+		}
+
+		//write the batch thru (instead of page by page on eviction)
+		if( (errCode = pool->writeBackPages(*this, batch)) != 0 )
+		{
+			return errCode;
+		}
+	}
+
+	//update counter
+	writePageCounter = writePageCounter + pageNums.size();
+	if( pageNums.empty() == false )
+		_ioStats.record(IO_WRITE, (unsigned long long)pageNums[0] * getPhysicalPageSize(), (unsigned long long)pageNums.size() * getPageSize(), ioClock() - startTime);
+
+	//success
+	return 0;
+}
+
+void FileHandle::writeBackNumOfPages()
+{
+	//read-only handle cannot modify the file (and it cannot append pages either, so the count is up to date), and first page
+	//of the file without header page (or of the earlier format) is not a header to be updated
+	if( _ioMode == IO_MMAP || _info == NULL || _info->_hasFormatHeader == false )
 		return;
 
+	//allocate buffer for the first header page
+	void* firstPageBuffer = malloc(getPageSize());
+
+	//null it
+	memset(firstPageBuffer, 0, getPageSize());
+
+	//try to read the first header page, and if it succeeds increment the page count
+	if( readPage(0, firstPageBuffer) == 0 )
+	{
+		((Header*)firstPageBuffer)->_totFileSize = _info->_numPages;
+		writePage(0, firstPageBuffer);
+	}
+
 	//free buffer
 	free(firstPageBuffer);
 }
@@ -848,7 +2697,10 @@ unsigned FileHandle::getNumberOfPages()
 
 
 FileInfo::FileInfo(std::string name, unsigned int numOpen, PageNum numpages)
-: _name(name), _numOpen(numOpen), _numPages(numpages)
+: _name(name), _numOpen(numOpen), _numPages(numpages), _physicalReadCounter(0), _physicalWriteCounter(0), _readCallCounter(0), _writeCallCounter(0), _freeSpaceMap(NULL),
+  _allocMap(NULL), _mapping(NULL), _mappingSize(0), _numMappedOpen(0), _pageSize(PAGE_SIZE), _pageChecksums(false), _hasFormatHeader(false), _pageLayout(0), _pageMap(NULL),
+  _numAllocatedPages(0), _extentCounter(0), _cachedFilePtr(NULL), _cachedFd(-1), _cachedIOMode(IO_STDIO), _cachedDevice(0), _cachedInode(0),
+  _forwardedReadCounter(0), _forwardedRecordCounter(0), _migratedRecordCounter(0), _migrationCursor(0)
 {
 	//do nothing
 }
@@ -867,7 +2719,7 @@ void FileHandle::setAccess(access_flag flag, bool& success)
 	//modifies information about the system flag.
 
 	//allocate data for first header page
-	void* data = malloc(PAGE_SIZE);
+	void* data = malloc(getPageSize());
 
 	//read this header
 	if( readPage(0, data) != 0 )
@@ -900,7 +2752,7 @@ access_flag FileHandle::getAccess(bool& success)
 	access_flag flag = user_can_modify;
 
 	//allocate data for first header page
-	void* data = malloc(PAGE_SIZE);
+	void* data = malloc(getPageSize());
 
 	//read this header
 	if( readPage(0, data) != 0 )
@@ -924,20 +2776,32 @@ void printFile(FileHandle& fileHandle)
 {
 	RC errCode = 0;
 
-	void* data = malloc(PAGE_SIZE);
-	memset(data, 0, PAGE_SIZE);
+	//pages are read in batches, one system call per batch
+	void* buffer = malloc((size_t)fileHandle.getPageSize() * MAX_VECTORED_PAGES);
+	memset(buffer, 0, (size_t)fileHandle.getPageSize() * MAX_VECTORED_PAGES);
 
 	for( unsigned int i = 0; i < fileHandle._info->_numPages; i++ )
 	{
-		std::cout << std::endl << std::endl << "====================PAGE#" << i << "====================" << std::endl << std::endl;
-		if( (errCode = fileHandle.readPage(i, data)) != 0 )
+		unsigned int indexInBatch = i % MAX_VECTORED_PAGES;
+		if( indexInBatch == 0 )
 		{
-			std::cout << "error code: " << errCode << "; aborting...";
-			free(data);
-			exit(-1);
+			unsigned int numPages = fileHandle._info->_numPages - i;
+			if( numPages > MAX_VECTORED_PAGES )
+				numPages = MAX_VECTORED_PAGES;
+
+			if( (errCode = fileHandle.readPages(i, numPages, buffer)) != 0 )
+			{
+				std::cout << "error code: " << errCode << "; aborting...";
+				free(buffer);
+				exit(-1);
+			}
 		}
 
-		for(int j = 0; j < PAGE_SIZE; j++)
+		void* data = (char*)buffer + (size_t)indexInBatch * fileHandle.getPageSize();
+
+		std::cout << std::endl << std::endl << "====================PAGE#" << i << "====================" << std::endl << std::endl;
+
+		for(int j = 0; j < (int)fileHandle.getPageSize(); j++)
 		{
 			__uint8_t c = ((char*)data)[j];
 
@@ -958,5 +2822,5 @@ void printFile(FileHandle& fileHandle)
 		}
 	}
 
-	free(data);
+	free(buffer);
 }
@@ -3,13 +3,61 @@
 
 #include <string>
 #include <map>
+#include <list>
+#include <vector>
+#include <stdio.h>
+#include <pthread.h>
+
+#include "iostats.h"
 
 typedef int RC;
 typedef unsigned PageNum;
+typedef unsigned long long LSN;	//log sequence number (see wal.h)
 
+/*
+ * default (and the smallest) page size; every file has its own page size in range [PAGE_SIZE, MAX_PAGE_SIZE], which is
+ * chosen when file is created and kept in its first header page
+**/
 #define PAGE_SIZE 4096
+#define MAX_PAGE_SIZE 65536
+/*
+ * size of the checksum trailer at the end of every page of files created with page checksums
+**/
+#define PAGE_CHECKSUM_SIZE sizeof(unsigned int)
+/*
+ * maximum number of pages transferred by a single vectored system call (readPages/writePages split larger requests)
+**/
+#define MAX_VECTORED_PAGES 64
+/*
+ * default bounds of the extent size (in pages): when appended page does not fit into the disk space reserved for the file,
+ * next extent is reserved; its size is the current size of the reservation (i.e. it doubles) kept within these bounds
+**/
+#define EXTENT_MIN_PAGES 64
+#define EXTENT_MAX_PAGES 4096
+/*
+ * default number of OS file-handlers that are kept opened after their files are closed, so that next openFile of the
+ * same file does not have to open it again (least recently closed one is closed first)
+**/
+#define HANDLE_CACHE_DEFAULT_SIZE 16
 
 class FileHandle;
+class BufferPool;
+class FreeSpaceMap;
+class PageAllocMap;
+class PageMap;
+class LogManager;
+class Prefetcher;
+class BackgroundWriter;
+
+/*
+ * how FileHandle accesses the OS file
+ * IO_STDIO - stdio FILE* (fseek followed by fread/fwrite), all handles of the file share a single cursor
+ * IO_PREAD - raw file descriptor with positional pread/pwrite (no cursor), pages of the same file can be read by several threads at once
+ * IO_DIRECT - same as IO_PREAD, but file is opened with O_DIRECT to bypass the OS page cache (falls back to IO_PREAD if file system does not support it)
+ * IO_MMAP - read-only; file is mapped into memory, readPage copies straight from the mapping and readMappedPage returns pointer
+ *           into it (no copy). writePage/appendPage fail. Pages modified thru other handles are seen once they are written back
+**/
+typedef enum { IO_STDIO = 0, IO_PREAD, IO_DIRECT, IO_MMAP } FileIOMode;
 
 /*
  * maintain information about the file
@@ -34,6 +82,84 @@ public:
 	 * number of pages
 	**/
 	unsigned int _numPages;
+	/*
+	 * number of pages actually read from / written to the OS file (i.e. misses and write-backs of the buffer pool)
+	**/
+	unsigned int _physicalReadCounter;
+	unsigned int _physicalWriteCounter;
+	/*
+	 * number of system calls that transferred the pages above (vectored call moves several pages at once)
+	**/
+	unsigned int _readCallCounter;
+	unsigned int _writeCallCounter;
+	/*
+	 * in-memory copy of free space information stored in the header pages (NULL until first getDataPage)
+	**/
+	FreeSpaceMap* _freeSpaceMap;
+	/*
+	 * in-memory copy of the page allocation map (NULL until first page is allocated or freed)
+	**/
+	PageAllocMap* _allocMap;
+	/*
+	 * read-only mapping of the file shared by all IO_MMAP handles (NULL if there are none), it covers pages that
+	 * existed when the first of them was opened
+	**/
+	void* _mapping;
+	size_t _mappingSize;
+	unsigned int _numMappedOpen;
+	/*
+	 * size of the pages of this file in bytes (as stored in the OS file, i.e. including checksum trailer)
+	**/
+	unsigned int _pageSize;
+	/*
+	 * pages of this file end with CRC32C of their content, which is verified when page is read from the OS file
+	**/
+	bool _pageChecksums;
+	/*
+	 * first page of the file is a header page of the current format (see FILE_FORMAT_MAGIC); only such files have header
+	 * chain, free-space map and page allocation map
+	**/
+	bool _hasFormatHeader;
+	/*
+	 * layout of the data pages of this file (as stored in the first header page)
+	**/
+	unsigned int _pageLayout;
+	/*
+	 * slots of the pages of compressed file (NULL if file is not compressed), see pagemap.h
+	**/
+	PageMap* _pageMap;
+	/*
+	 * number of pages for which disk space is reserved (space beyond the last page does not count towards file size),
+	 * and number of extents reserved so far
+	**/
+	unsigned int _numAllocatedPages;
+	unsigned int _extentCounter;
+	/*
+	 * OS file-handler left opened by closeFile (NULL/-1 if there is none), the mode it was opened in, and identity
+	 * of the OS file (file that got replaced under the same name is opened again)
+	**/
+	FILE* _cachedFilePtr;
+	int _cachedFd;
+	FileIOMode _cachedIOMode;
+	unsigned long long _cachedDevice;
+	unsigned long long _cachedInode;
+	/*
+	 * transfers between the OS file and memory (done thru any of the handles of the file, including buffer pool write backs
+	 * and read-ahead), and calls of readPage/writePage/appendPage of the handles of this file that have been closed
+	**/
+	IOStats _ioStats;
+	IOStats _callStats;
+	/*
+	 * record reads that went thru a TombStone (or moved slot of PAX page) to the place the record was moved to, updates that
+	 * left record outside of its home page, and moved records that came back into their home page
+	**/
+	unsigned int _forwardedReadCounter;
+	unsigned int _forwardedRecordCounter;
+	unsigned int _migratedRecordCounter;
+	/*
+	 * page at which the next call of RecordBasedFileManager::migrateForwardedRecords continues
+	**/
+	PageNum _migrationCursor;
 };
 
 class PagedFileManager
@@ -43,27 +169,144 @@ public:
 
     bool isExisting(const char *fileName)	const;
     RC getNumOpenInstances(const char* fileName);
-    RC createFile    (const char *fileName);                         // Create a new file
+    RC createFile    (const char *fileName, const unsigned int pageSize = PAGE_SIZE); // Create a new file
     RC createFileHeader(const char* fileName);
     RC destroyFile   (const char *fileName);                         // Destroy a file
     int countNumberOfOpenedInstances(const char* fileName);
-    RC openFile      (const char *fileName, FileHandle &fileHandle); // Open a file
+    RC openFile      (const char *fileName, FileHandle &fileHandle, FileIOMode ioMode = IO_STDIO); // Open a file
     RC closeFile     (FileHandle &fileHandle);                       // Close a file
     RC getDataPage(FileHandle &fileHandle, const unsigned int recordSize, PageNum& pageNum, PageNum& headerPage, unsigned int& freeSpaceLeftInPage);
     RC insertPage(FileHandle &fileHandle, PageNum& headerPageId, PageNum& dataPageId, const void* content);
     RC findHeaderPage(FileHandle& fileHandle, PageNum pageId, PageNum& retHeaderPage);
     RC getLastHeaderPage(FileHandle& fileHeader, PageNum& lastHeaderPageId);
+    RC getFreeSpaceMap(FileHandle& fileHandle, FreeSpaceMap*& freeSpaceMap);
+
+    //page allocation map of the file organized into header pages: freed page is re-used by allocatePage (and insertPage)
+    //before file grows, free pages at the end of the file are given back to the OS by truncateFile (file must not be opened)
+    RC getAllocMap(FileHandle& fileHandle, PageAllocMap*& allocMap);
+    RC allocatePage(FileHandle& fileHandle, const void* content, PageNum& pageNum);
+    RC freePage(FileHandle& fileHandle, const PageNum pageNum);
+    RC getNumFreePages(FileHandle& fileHandle, unsigned& numFreePages);
+    RC truncateFile(const char* fileName);
+
+    //buffer pool that sits underneath FileHandle::readPage/writePage/appendPage
+    BufferPool* getBufferPool();
+    RC setBufferPoolSize(const unsigned int numFrames);             // Re-size buffer pool (all pages have to be unpinned)
+    RC flushBufferPool();                                           // Write back all dirty pages of all files
+    void collectBufferPoolCounters(unsigned &hitCount, unsigned &missCount, unsigned &evictionCount, unsigned &writeBackCount);
+
+    //write-ahead log: page writes are logged once log is opened (recovery from the given log is done first; no file may be opened)
+    RC openLog(const char* logFileName);
+    RC closeLog();                                                  // Take checkpoint and stop logging
+    LogManager* getLogManager();
+    //commit is durable when endOperation returns; up to numCommits operations of concurrent threads share one fsync of
+    //the log (1 by default), and commit waits at most LOG_GROUP_COMMIT_DELAY (see wal.h) for the others to join it
+    RC setGroupCommitSize(const unsigned int numCommits);
+    //page writes between begin and end form one atomic operation (may be nested; page write outside of them is an operation by itself);
+    //operation that failed (opCode != 0) is rolled back instead of being committed, while logging is on
+    void beginOperation();
+    RC endOperation(const RC opCode = 0);
+    RC flushLog();                                                  // Make all committed operations durable
+    RC checkpoint();                                                // Write back dirty pages and truncate the log
+    void collectLogCounters(unsigned &recordCount, unsigned &commitCount, unsigned &fsyncCount);
+
+    //background thread that writes back dirty pages ahead of eviction and takes checkpoints (off by default), and its
+    //policy: share of dirty frames it keeps the pool under, age after which dirty page is written, time between checkpoints
+    void setBackgroundWriter(const bool enabled);
+    bool getBackgroundWriter();
+    void setBackgroundWriterPolicy(const unsigned int dirtyPercent, const unsigned int maxDirtyAgeMs, const unsigned int checkpointIntervalMs);
+    void collectBackgroundWriterCounters(unsigned &writeCount, unsigned &checkpointCount);
+
+    //read-ahead of sequentially read files into the buffer pool
+    Prefetcher* getPrefetcher();
+    void setPrefetchWindow(const unsigned int numPages);           // Number of pages read ahead (0 turns read-ahead off)
+    unsigned int getPrefetchWindow();
+    void collectPrefetchCounters(unsigned &requestCount, unsigned &prefetchCount, unsigned &droppedCount);
+
+    //files created from now on keep checksum of every page (off by default; existing files keep their setting)
+    void setPageChecksums(const bool enabled);
+    bool getPageChecksums();
+
+    //files created from now on store their pages compressed (off by default; compressed files are not covered by the
+    //write-ahead log and cannot be opened as IO_MMAP or IO_DIRECT)
+    void setPageCompression(const bool enabled);
+    bool getPageCompression();
+
+    //files grow by extents of [minPages, maxPages] pages (minPages == 0 turns extent allocation off)
+    void setExtentSize(const unsigned int minPages, const unsigned int maxPages);
+    void getExtentSize(unsigned int& minPages, unsigned int& maxPages);
+
+    //OS file-handlers of closed files are kept opened for re-use, up to the given number (0 turns the cache off)
+    void setHandleCacheSize(const unsigned int numHandles);
+    unsigned int getHandleCacheSize();
+    void collectHandleCacheCounters(unsigned &hitCount, unsigned &missCount, unsigned &evictionCount);
+
+    //I/O statistics of the file (calls of its closed handles, and transfers to/from the OS file), and same for all files
+    RC collectIOStats(const char* fileName, IOStats &callStats, IOStats &ioStats);
+    void collectIOStats(IOStats &callStats, IOStats &ioStats);
 
 protected:
     PagedFileManager();                                   // Constructor
     ~PagedFileManager();                                  // Destructor
 
+    //close OS file-handler kept for the file (if any)
+    void releaseCachedHandle(FileInfo* info);
+
+    //checkpoint taken by the background writer (or by checkpoint of the thread that is not inside operation): waits for
+    //the operation in progress to end, and holds up the next one until log is truncated
+    RC takeCheckpoint();
+    friend class BackgroundWriter;
+
 private:
     static PagedFileManager *_pf_manager;
     /*
      * hash-map that stores information about all files
     **/
     std::map<std::string, FileInfo> _files;
+    /*
+     * process-wide page cache shared by all opened files
+    **/
+    BufferPool* _bufferPool;
+    /*
+     * write-ahead log (NULL if logging is off)
+    **/
+    LogManager* _log;
+    /*
+     * held by the thread that is inside operation (from outermost beginOperation to endOperation), so that checkpoint
+     * is not taken in the middle of it
+    **/
+    pthread_mutex_t _operationMutex;
+    /*
+     * background writer of the dirty pages
+    **/
+    BackgroundWriter* _writer;
+    /*
+     * background readers of the pages that sequential readers are about to access, and number of pages to read ahead
+    **/
+    Prefetcher* _prefetcher;
+    unsigned int _prefetchWindow;
+    /*
+     * whether new files are created with page checksums
+    **/
+    bool _pageChecksums;
+    /*
+     * whether new files are created compressed
+    **/
+    bool _pageCompression;
+    /*
+     * bounds of the extent size
+    **/
+    unsigned int _extentMinPages;
+    unsigned int _extentMaxPages;
+    /*
+     * files that keep OS file-handler after being closed (most recently closed first), maximum length of this list,
+     * and number of opens that re-used / could not re-use such handler, as well as handlers closed to respect the limit
+    **/
+    std::list<FileInfo*> _handleCache;
+    unsigned int _handleCacheSize;
+    unsigned int _handleCacheHitCounter;
+    unsigned int _handleCacheMissCounter;
+    unsigned int _handleCacheEvictionCounter;
 };
 
 //accessibility to the files, in the sense which files can be modified by (user and system) and which solely by the system
@@ -82,6 +325,12 @@ public:
     RC readPage(PageNum pageNum, void *data);                           // Get a specific page
     RC writePage(PageNum pageNum, const void *data);                    // Write a specific page
     RC appendPage(const void *data);                                    // Append a specific page
+    //multi-page transfer: run of consecutive pages, or list of arbitrary pages; i-th page is at data + i * getPageSize()
+    //pages that are not cached are read by vectored system calls; written pages are written to the file right away
+    RC readPages(PageNum firstPage, unsigned numPages, void *data);
+    RC readPages(const std::vector<PageNum> &pageNums, void *data);
+    RC writePages(PageNum firstPage, unsigned numPages, const void *data);
+    RC writePages(const std::vector<PageNum> &pageNums, const void *data);
     unsigned getNumberOfPages();                                        // Get the number of pages in the file
     void writeBackNumOfPages();											// write back to the header the number of pages
     /* for project 2: flag indicates whether file represents data for the system table or the user table */
@@ -90,6 +339,62 @@ public:
 
     //new method for project 3
     RC collectCounterValues(unsigned &readPageCount, unsigned &writePageCount, unsigned &appendPageCount);
+    //counters above are logical (i.e. number of calls), this one reports how many of them reached the OS file
+    RC collectPhysicalCounterValues(unsigned &readPageCount, unsigned &writePageCount);
+    //number of system calls that did the physical reads/writes
+    RC collectIOCallCounterValues(unsigned &readCallCount, unsigned &writeCallCount);
+    //compressed file only: bytes of compressed pages read from / written to the OS file, and bytes of the same pages before compression
+    RC collectCompressionCounterValues(unsigned long long &readByteCount, unsigned long long &writeByteCount, unsigned long long &uncompressedByteCount);
+    //record reads that followed a TombStone, updates that moved record out of its home page, and moved records that got back
+    //into their home page (tracked per file, see RecordBasedFileManager::migrateForwardedRecords)
+    RC collectForwardingCounterValues(unsigned &forwardedReadCount, unsigned &forwardedRecordCount, unsigned &migratedRecordCount);
+    //latency histograms, bytes and seek distance of readPage/writePage/appendPage calls of this handle (latency includes
+    //buffer pool), and same for transfers between the OS file and memory (thru any handle of the file)
+    RC collectIOStats(IOStats &stats);
+    RC collectPhysicalIOStats(IOStats &stats);
+
+    //access page directly inside the buffer pool (no copy), every pinPage has to be matched by unpinPage
+    RC pinPage(PageNum pageNum, void*& data);
+    RC unpinPage(PageNum pageNum, bool isDirty);
+
+    //header page got modified, so bring free-space map of the file up to date
+    void syncFreeSpaceMap(PageNum pageNum, const void* data);
+
+    //handle is associated with opened file
+    bool isOpened() const;
+    //transfer page between OS file and memory, bypassing buffer pool (used by buffer pool on misses and write backs)
+    //(with page checksums, read verifies the trailer of the page and write fills it in)
+    RC readPhysicalPage(PageNum pageNum, void* data) const;
+    RC writePhysicalPage(PageNum pageNum, void* data) const;
+    //same for consecutive pages starting at firstPage (at most MAX_VECTORED_PAGES), each in its own buffer, by a single preadv/pwritev
+    RC readPhysicalPages(PageNum firstPage, const std::vector<void*>& pages) const;
+    RC writePhysicalPages(PageNum firstPage, const std::vector<void*>& pages) const;
+
+    //IO_MMAP only: get pointer to the page inside the mapping (valid until file is closed), fails if page is not mapped
+    RC readMappedPage(PageNum pageNum, const void*& data) const;
+
+    //size of the pages of the opened file, i.e. size of the buffer that readPage/writePage/appendPage transfer
+    unsigned getPageSize() const;
+    //size of the page in the OS file and in the buffer pool (includes checksum trailer, if file has one)
+    unsigned getPhysicalPageSize() const;
+    bool hasPageChecksums() const;
+    bool hasPageCompression() const;
+    //layout of the data pages (records are interpreted by RecordBasedFileManager, see PageLayout in rbfm.h)
+    unsigned getPageLayout() const;
+    //store checksum of the page (of physical page size) in its trailer / check it (-77 if it does not match)
+    void sealPage(void* data) const;
+    RC verifyPage(const void* data) const;
+    //number of data pages that a single header page of this file can describe
+    unsigned getNumOfPageIds() const;
+
+    //write-ahead log that records page writes of this file (NULL if logging is off or file is compressed)
+    LogManager* getLogManager() const;
+
+    //page is about to be appended; if it is beyond the reserved disk space, then reserve next extent (fallocate)
+    void reserveExtent(PageNum pageNum);
+
+    //page is about to be read; if reads are sequential, then ask prefetcher to read the following pages
+    void readAhead(PageNum pageNum);
 
 public:
     /*
@@ -97,15 +402,36 @@ public:
     **/
     FileInfo* _info;
     /*
-     * pointer to the OS file-handler
+     * pointer to the OS file-handler (IO_STDIO)
     **/
     FILE* _filePtr;
+    /*
+     * OS file descriptor (IO_PREAD and IO_DIRECT), -1 if not used
+    **/
+    int _fd;
+    /*
+     * which of the two above is used to access the file
+    **/
+    FileIOMode _ioMode;
 
     //new variables for project 3
     //keep counter for each operation
 	unsigned readPageCounter;
 	unsigned writePageCounter;
 	unsigned appendPageCounter;
+
+	/*
+	 * detection of sequential reads: last page read thru this handle, number of consecutive pages read in a row,
+	 * and first page that has not been requested from the prefetcher yet
+	**/
+	PageNum _lastReadPage;
+	unsigned _numSequentialReads;
+	PageNum _readAheadPage;
+
+	/*
+	 * statistics of the calls done thru this handle (offsets are in terms of pages, i.e. page number * page size)
+	**/
+	IOStats _ioStats;
  };
 
 
@@ -135,7 +461,15 @@ struct PageInfo
 	unsigned int _numFreeBytes;
 };
 
-#define NUM_OF_PAGE_IDS ( PAGE_SIZE - sizeof(PageNum) - sizeof(PageIdNum) - sizeof(PageNum) - sizeof(access_flag) ) / sizeof(PageInfo)
+#define NUM_OF_PAGE_IDS ( PAGE_SIZE - sizeof(PageNum) - sizeof(PageIdNum) - sizeof(PageNum) - sizeof(access_flag) - 6 * sizeof(unsigned int) - sizeof(PageNum) ) / sizeof(PageInfo)
+
+/*
+ * first header page of the file starts its format fields with FILE_FORMAT_MAGIC ("RBFM") and the version of the format of the
+ * file (header pages, data pages and records); files created before these were stored (and files that do not start with a
+ * header page) do not have them, and their header fields are not trusted, see PagedFileManager::openFile
+**/
+#define FILE_FORMAT_MAGIC 0x4d464252
+#define FILE_FORMAT_VERSION 1
 
 /*
  * header page
@@ -159,7 +493,34 @@ struct Header
 	**/
 	PageIdNum _numUsedPageIds;
 	/*
-	 * array of page IDs, occupying the remaining part of the header file
+	 * page size of the file (meaningful only in the first header page)
+	**/
+	unsigned int _pageSize;
+	/*
+	 * 1 if pages of the file have checksum trailer (meaningful only in the first header page)
+	**/
+	unsigned int _pageChecksums;
+	/*
+	 * 1 if pages of the file (except for the first one) are compressed (meaningful only in the first header page)
+	**/
+	unsigned int _pageCompression;
+	/*
+	 * page number of the first page of the page allocation map, see allocmap.h (meaningful only in the first header page;
+	 * 0 if no page of the file has ever been freed)
+	**/
+	PageNum _allocMapPageId;
+	/*
+	 * layout of the data pages, see PageLayout in rbfm.h (meaningful only in the first header page; 0 => row-wise pages)
+	**/
+	unsigned int _pageLayout;
+	/*
+	 * FILE_FORMAT_MAGIC and FILE_FORMAT_VERSION (meaningful only in the first header page)
+	**/
+	unsigned int _magic;
+	unsigned int _formatVersion;
+	/*
+	 * array of page IDs, occupying the remaining part of the header file (declared for PAGE_SIZE, in files with larger
+	 * pages it continues up to the end of the page, see FileHandle::getNumOfPageIds)
 	**/
 	PageInfo _arrOfPageIds[ NUM_OF_PAGE_IDS ];
 };
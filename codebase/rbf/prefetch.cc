@@ -0,0 +1,159 @@
+#include "prefetch.h"
+#include "bpm.h"
+
+Prefetcher::Prefetcher(BufferPool* bufferPool)
+: _requestCounter(0), _droppedCounter(0), _bufferPool(bufferPool), _stopping(false)
+{
+	pthread_mutex_init(&_mutex, NULL);
+	pthread_cond_init(&_queueCond, NULL);
+	pthread_cond_init(&_idleCond, NULL);
+}
+
+Prefetcher::~Prefetcher()
+{
+	stop();
+
+	pthread_cond_destroy(&_idleCond);
+	pthread_cond_destroy(&_queueCond);
+	pthread_mutex_destroy(&_mutex);
+}
+
+void* Prefetcher::workerMain(void* prefetcher)
+{
+	((Prefetcher*)prefetcher)->serveRequests();
+	return NULL;
+}
+
+void Prefetcher::start()
+{
+	//expects mutex to be held by the caller
+	_stopping = false;
+
+	for( unsigned int i = 0; i < PREFETCH_NUM_THREADS; i++ )
+	{
+		pthread_t thread;
+		if( pthread_create(&thread, NULL, workerMain, this) != 0 )
+			break;
+
+		_threads.push_back(thread);
+	}
+}
+
+void Prefetcher::stop()
+{
+	pthread_mutex_lock(&_mutex);
+	_stopping = true;
+	_queue.clear();
+	pthread_cond_broadcast(&_queueCond);
+	pthread_mutex_unlock(&_mutex);
+
+	for( unsigned int i = 0; i < _threads.size(); i++ )
+	{
+		pthread_join(_threads[i], NULL);
+	}
+
+	_threads.clear();
+	_activeFiles.clear();
+}
+
+void Prefetcher::serveRequests()
+{
+	pthread_mutex_lock(&_mutex);
+
+	//slot where this thread publishes the file it is reading
+	unsigned int slot = _activeFiles.size();
+	_activeFiles.push_back(NULL);
+
+	while( true )
+	{
+		while( _queue.empty() && _stopping == false )
+		{
+			pthread_cond_wait(&_queueCond, &_mutex);
+		}
+
+		if( _stopping )
+			break;
+
+		PrefetchRequest request = _queue.front();
+		_queue.pop_front();
+
+		_activeFiles[slot] = request._handle._info;
+		pthread_mutex_unlock(&_mutex);
+
+		std::vector<PageNum> pageNums;
+		for( unsigned int i = 0; i < request._numPages; i++ )
+		{
+			pageNums.push_back(request._firstPage + i);
+		}
+
+		//failure is not an error for read-ahead (e.g. all frames are pinned), pages would be read on demand
+		_bufferPool->prefetchPages(request._handle, pageNums);
+
+		pthread_mutex_lock(&_mutex);
+		_activeFiles[slot] = NULL;
+		pthread_cond_broadcast(&_idleCond);
+	}
+
+	pthread_mutex_unlock(&_mutex);
+}
+
+void Prefetcher::request(FileHandle& fileHandle, PageNum firstPage, PageNum lastPage)
+{
+	pthread_mutex_lock(&_mutex);
+
+	if( _threads.empty() )
+		start();
+
+	for( PageNum pageNum = firstPage; pageNum <= lastPage; pageNum += MAX_VECTORED_PAGES )
+	{
+		//reader is too far ahead of the workers
+		if( _queue.size() >= PREFETCH_QUEUE_SIZE )
+		{
+			_droppedCounter += lastPage - pageNum + 1;
+			break;
+		}
+
+		PrefetchRequest request;
+		request._handle = fileHandle;
+		request._firstPage = pageNum;
+		request._numPages = (lastPage - pageNum + 1 < MAX_VECTORED_PAGES ? lastPage - pageNum + 1 : MAX_VECTORED_PAGES);
+		_queue.push_back(request);
+
+		_requestCounter += request._numPages;
+	}
+
+	pthread_cond_broadcast(&_queueCond);
+	pthread_mutex_unlock(&_mutex);
+}
+
+void Prefetcher::cancelFile(FileInfo* file)
+{
+	pthread_mutex_lock(&_mutex);
+
+	//remove queued requests of this file
+	std::deque<PrefetchRequest>::iterator iter = _queue.begin();
+	while( iter != _queue.end() )
+	{
+		if( iter->_handle._info == file )
+			iter = _queue.erase(iter);
+		else
+			iter++;
+	}
+
+	//wait for workers that are reading pages of this file
+	bool busy = true;
+	while( busy )
+	{
+		busy = false;
+		for( unsigned int i = 0; i < _activeFiles.size(); i++ )
+		{
+			if( _activeFiles[i] == file )
+				busy = true;
+		}
+
+		if( busy )
+			pthread_cond_wait(&_idleCond, &_mutex);
+	}
+
+	pthread_mutex_unlock(&_mutex);
+}
@@ -0,0 +1,87 @@
+#ifndef _prefetch_h_
+#define _prefetch_h_
+
+#include <vector>
+#include <deque>
+#include <pthread.h>
+
+#include "../rbf/pfm.h"
+
+/*
+ * default number of pages that are read ahead of the sequential reader (0 = read-ahead is off)
+**/
+#define PREFETCH_DEFAULT_WINDOW 16
+/*
+ * number of consecutive page reads after which access to the file handle is considered to be sequential
+**/
+#define PREFETCH_SEQUENTIAL_THRESHOLD 2
+/*
+ * number of background threads that read pages into the buffer pool
+**/
+#define PREFETCH_NUM_THREADS 2
+/*
+ * maximum number of queued page requests (requests beyond it are dropped)
+**/
+#define PREFETCH_QUEUE_SIZE 256
+
+class BufferPool;
+
+/*
+ * request to read a run of consecutive pages (at most MAX_VECTORED_PAGES) of the opened file
+**/
+struct PrefetchRequest
+{
+	/*
+	 * copy of the handle of the sequential reader (OS file stays opened until requests of the file are cancelled)
+	**/
+	FileHandle _handle;
+	PageNum _firstPage;
+	unsigned int _numPages;
+};
+
+/*
+ * asynchronous read-ahead into the buffer pool
+ *
+ * FileHandle detects sequential reads and asks for the next pages; worker threads take requests from the queue
+ * and read pages into the buffer pool (one vectored read per request), so that the reader finds them cached. Threads are started with the first
+ * request. Read-ahead is best-effort: failed or dropped requests simply leave the page to be read on demand.
+**/
+class Prefetcher
+{
+public:
+	Prefetcher(BufferPool* bufferPool);
+	~Prefetcher();
+
+	//queue reads of pages [firstPage, lastPage] of the file
+	void request(FileHandle& fileHandle, PageNum firstPage, PageNum lastPage);
+	//drop queued requests of the file and wait for the ones being served (has to be done before the file is closed)
+	void cancelFile(FileInfo* file);
+
+	//statistics (in pages)
+	unsigned int _requestCounter;
+	unsigned int _droppedCounter;
+
+protected:
+	static void* workerMain(void* prefetcher);
+	void serveRequests();
+	void start();
+	void stop();
+
+private:
+	BufferPool* _bufferPool;
+	std::deque<PrefetchRequest> _queue;
+	std::vector<pthread_t> _threads;
+	/*
+	 * file served by each of the worker threads (NULL if thread is idle)
+	**/
+	std::vector<FileInfo*> _activeFiles;
+	bool _stopping;
+	/*
+	 * guards all members; workers wait on _queueCond for requests, cancelFile waits on _idleCond for workers
+	**/
+	pthread_mutex_t _mutex;
+	pthread_cond_t _queueCond;
+	pthread_cond_t _idleCond;
+};
+
+#endif
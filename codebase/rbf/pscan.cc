@@ -0,0 +1,357 @@
+#include "pscan.h"
+
+ParallelScan::ParallelScan()
+: _nextMorsel(0), _nextWorker(0), _errCode(0), _isOpened(false), _stopping(false)
+{
+	pthread_mutex_init(&_mutex, NULL);
+	pthread_cond_init(&_batchCond, NULL);
+	pthread_cond_init(&_spaceCond, NULL);
+}
+
+ParallelScan::~ParallelScan()
+{
+	if( _isOpened )
+		close();
+
+	pthread_cond_destroy(&_spaceCond);
+	pthread_cond_destroy(&_batchCond);
+	pthread_mutex_destroy(&_mutex);
+}
+
+RC ParallelScan::open(const string &fileName,
+		const vector<Attribute> &recordDescriptor,
+		const string &conditionAttribute,
+		const CompOp compOp,
+		const void *value,
+		const vector<string> &attributeNames,
+		const unsigned int numWorkers,
+		const unsigned int morselPages)
+{
+	RC errCode = 0;
+
+	if( _isOpened || numWorkers == 0 || numWorkers > PSCAN_MAX_WORKERS || morselPages == 0 )
+	{
+		return -81;
+	}
+
+	RecordBasedFileManager* rbfm = RecordBasedFileManager::instance();
+
+	_isOpened = true;
+	_stopping = false;
+	_errCode = 0;
+	_nextMorsel = 0;
+	_nextWorker = 0;
+
+	//handles are opened here rather than by the workers, since file manager is not thread-safe
+	for( unsigned int i = 0; i < numWorkers; i++ )
+	{
+		FileHandle fileHandle;
+		if( (errCode = rbfm->openFile(fileName, fileHandle, IO_PREAD)) != 0 )
+		{
+			close();
+			return errCode;
+		}
+
+		ParallelScanWorker* worker = new ParallelScanWorker();
+		worker->_scan = this;
+		worker->_isStarted = false;
+		worker->_isDone = false;
+
+		//iterator owns the handle from now on (it is closed along with the iterator)
+		rbfm->scan(fileHandle, recordDescriptor, conditionAttribute, compOp, value, attributeNames, worker->_iterator);
+
+		_workers.push_back(worker);
+	}
+
+	//directory of header pages is shared by all handles of the file, so it is built once before workers look at it
+	if( (errCode = buildMorsels(_workers[0]->_iterator._fileHandle, morselPages)) != 0 )
+	{
+		close();
+		return errCode;
+	}
+
+	for( unsigned int i = 0; i < _workers.size(); i++ )
+	{
+		if( pthread_create(&_workers[i]->_thread, NULL, workerMain, _workers[i]) != 0 )
+		{
+			close();
+			return -81;
+		}
+
+		_workers[i]->_isStarted = true;
+	}
+
+	//success
+	return 0;
+}
+
+RC ParallelScan::buildMorsels(FileHandle &fileHandle, const unsigned int morselPages)
+{
+	RecordBasedFileManager* rbfm = RecordBasedFileManager::instance();
+
+	_morselFirstPages.clear();
+	_morselEndPages.clear();
+
+	PageNum numPages = fileHandle.getNumberOfPages();
+
+	//every morsel starts with a data page, header pages and overflow pages are left to the morsel they fall into (iterator skips them)
+	unsigned int numDataPages = 0;
+	for( PageNum pageNum = 1; pageNum < numPages; pageNum++ )
+	{
+		if( rbfm->isDataPage(fileHandle, pageNum) == false )
+			continue;
+
+		if( numDataPages % morselPages == 0 )
+		{
+			if( _morselFirstPages.empty() == false )
+				_morselEndPages.push_back(pageNum);
+
+			_morselFirstPages.push_back(pageNum);
+		}
+
+		numDataPages++;
+	}
+
+	//last morsel goes to the end of file
+	if( _morselFirstPages.empty() == false )
+		_morselEndPages.push_back(numPages);
+
+	//success
+	return 0;
+}
+
+void* ParallelScan::workerMain(void* worker)
+{
+	((ParallelScanWorker*)worker)->_scan->scanMorsels((ParallelScanWorker*)worker);
+	return NULL;
+}
+
+void ParallelScan::scanMorsels(ParallelScanWorker* worker)
+{
+	RBFM_ScanIterator& iterator = worker->_iterator;
+	RecordBatch* batch = new RecordBatch();
+
+	pthread_mutex_lock(&_mutex);
+
+	//take morsels until all of them are handed out (mutex is held at the top of the loop)
+	while( _stopping == false && _nextMorsel < _morselFirstPages.size() )
+	{
+		unsigned int morsel = _nextMorsel++;
+		pthread_mutex_unlock(&_mutex);
+
+		//limit iterator to the pages of the morsel
+		iterator._pagenum = _morselFirstPages[morsel];
+		iterator._endPagenum = _morselEndPages[morsel];
+		iterator._slotnum = 0;
+
+		RC errCode = 0;
+		while( true )
+		{
+			errCode = iterator.getNextBatch(*batch);
+
+			pthread_mutex_lock(&_mutex);
+
+			if( errCode != 0 || _stopping )
+				break;
+
+			//wait for the consumer to take some of the batches
+			while( worker->_queue.size() >= PSCAN_QUEUE_SIZE && _stopping == false )
+			{
+				pthread_cond_wait(&_spaceCond, &_mutex);
+			}
+
+			if( _stopping )
+				break;
+
+			worker->_queue.push_back(batch);
+			pthread_cond_broadcast(&_batchCond);
+
+			//re-use batch emptied by the consumer
+			batch = NULL;
+			if( worker->_freeBatches.empty() == false )
+			{
+				batch = worker->_freeBatches.back();
+				worker->_freeBatches.pop_back();
+			}
+
+			pthread_mutex_unlock(&_mutex);
+
+			if( batch == NULL )
+				batch = new RecordBatch();
+		}
+
+		//failure of any worker stops the whole scan
+		if( errCode != 0 && errCode != RBFM_EOF && _errCode == 0 )
+		{
+			_errCode = errCode;
+			_stopping = true;
+			pthread_cond_broadcast(&_spaceCond);
+		}
+	}
+
+	worker->_isDone = true;
+	pthread_cond_broadcast(&_batchCond);
+
+	pthread_mutex_unlock(&_mutex);
+
+	delete batch;
+}
+
+unsigned int ParallelScan::getNumWorkers() const
+{
+	return _workers.size();
+}
+
+unsigned int ParallelScan::getNumMorsels() const
+{
+	return _morselFirstPages.size();
+}
+
+void ParallelScan::takeBatch(ParallelScanWorker* worker, RecordBatch &batch)
+{
+	RecordBatch* filled = worker->_queue.front();
+	worker->_queue.pop_front();
+
+	batch.swap(*filled);
+
+	//caller's buffer goes to the worker, unless it is too small to hold any record
+	if( filled->getCapacity() >= RECORD_BATCH_DEFAULT_CAPACITY )
+	{
+		filled->clear();
+		worker->_freeBatches.push_back(filled);
+	}
+	else
+	{
+		delete filled;
+	}
+
+	pthread_cond_broadcast(&_spaceCond);
+}
+
+RC ParallelScan::getNextBatch(const unsigned int worker, RecordBatch &batch)
+{
+	RC errCode = 0;
+
+	batch.clear();
+
+	if( _isOpened == false || worker >= _workers.size() )
+	{
+		return -81;
+	}
+
+	pthread_mutex_lock(&_mutex);
+
+	ParallelScanWorker* curWorker = _workers[worker];
+	while( curWorker->_queue.empty() && curWorker->_isDone == false && _errCode == 0 )
+	{
+		pthread_cond_wait(&_batchCond, &_mutex);
+	}
+
+	if( _errCode != 0 )
+		errCode = _errCode;
+	else if( curWorker->_queue.empty() )
+		errCode = RBFM_EOF;
+	else
+		takeBatch(curWorker, batch);
+
+	pthread_mutex_unlock(&_mutex);
+
+	return errCode;
+}
+
+RC ParallelScan::getNextBatch(RecordBatch &batch)
+{
+	RC errCode = 0;
+
+	batch.clear();
+
+	if( _isOpened == false )
+	{
+		return -81;
+	}
+
+	pthread_mutex_lock(&_mutex);
+
+	while( true )
+	{
+		if( _errCode != 0 )
+		{
+			errCode = _errCode;
+			break;
+		}
+
+		//look thru the workers starting from the one after the last served
+		bool isFound = false, isDone = true;
+		for( unsigned int i = 0; i < _workers.size() && isFound == false; i++ )
+		{
+			unsigned int index = (_nextWorker + i) % _workers.size();
+
+			if( _workers[index]->_queue.empty() == false )
+			{
+				takeBatch(_workers[index], batch);
+				_nextWorker = (index + 1) % _workers.size();
+				isFound = true;
+			}
+			else if( _workers[index]->_isDone == false )
+			{
+				isDone = false;
+			}
+		}
+
+		if( isFound )
+			break;
+
+		if( isDone )
+		{
+			errCode = RBFM_EOF;
+			break;
+		}
+
+		pthread_cond_wait(&_batchCond, &_mutex);
+	}
+
+	pthread_mutex_unlock(&_mutex);
+
+	return errCode;
+}
+
+RC ParallelScan::close()
+{
+	RC errCode = 0;
+
+	pthread_mutex_lock(&_mutex);
+	_stopping = true;
+	pthread_cond_broadcast(&_spaceCond);
+	pthread_cond_broadcast(&_batchCond);
+	pthread_mutex_unlock(&_mutex);
+
+	for( unsigned int i = 0; i < _workers.size(); i++ )
+	{
+		if( _workers[i]->_isStarted )
+			pthread_join(_workers[i]->_thread, NULL);
+	}
+
+	for( unsigned int i = 0; i < _workers.size(); i++ )
+	{
+		ParallelScanWorker* worker = _workers[i];
+
+		//iterator closes the worker's handle
+		RC closeErrCode = worker->_iterator.close();
+		if( closeErrCode != 0 && errCode == 0 )
+			errCode = closeErrCode;
+
+		for( unsigned int j = 0; j < worker->_queue.size(); j++ )
+			delete worker->_queue[j];
+		for( unsigned int j = 0; j < worker->_freeBatches.size(); j++ )
+			delete worker->_freeBatches[j];
+
+		delete worker;
+	}
+
+	_workers.clear();
+	_morselFirstPages.clear();
+	_morselEndPages.clear();
+	_isOpened = false;
+
+	return errCode;
+}
@@ -0,0 +1,133 @@
+#ifndef _pscan_h_
+#define _pscan_h_
+
+#include <vector>
+#include <deque>
+#include <pthread.h>
+
+#include "../rbf/rbfm.h"
+
+/*
+ * default number of data pages in a morsel (unit of work handed to a worker thread)
+**/
+#define PSCAN_DEFAULT_MORSEL_PAGES 16
+/*
+ * maximum number of filled batches waiting in the output queue of a single worker (worker waits for the consumer beyond it)
+**/
+#define PSCAN_QUEUE_SIZE 4
+/*
+ * largest number of worker threads of a single scan
+**/
+#define PSCAN_MAX_WORKERS 64
+
+class ParallelScan;
+
+/*
+ * worker thread of the parallel scan, along with its output queue
+**/
+struct ParallelScanWorker
+{
+	/*
+	 * scan over the worker's own handle of the file (IO_PREAD), limited to the page range of the current morsel
+	**/
+	RBFM_ScanIterator _iterator;
+	/*
+	 * scan this worker belongs to, and its thread (if it was started)
+	**/
+	ParallelScan* _scan;
+	pthread_t _thread;
+	bool _isStarted;
+	/*
+	 * filled batches in the order they were produced, and emptied ones that are re-used
+	**/
+	std::deque<RecordBatch*> _queue;
+	std::vector<RecordBatch*> _freeBatches;
+	/*
+	 * worker has no more morsels to take (its queue may still have batches)
+	**/
+	bool _isDone;
+};
+
+/*
+ * parallel scan of the record based file
+ *
+ * data pages of the file are split into morsels, i.e. runs of PSCAN_DEFAULT_MORSEL_PAGES data pages (header and overflow pages in between
+ * are skipped and do not count). Worker threads take morsels one at a time from a shared counter, so faster workers scan more
+ * of them; each worker runs the condition and projection of RBFM_ScanIterator::getNextBatch over its morsel, and puts filled
+ * batches into its own output queue. Consumer takes batches either from a particular worker (e.g. one consumer thread per
+ * worker that aggregates its part) or from any of them.
+ *
+ * records come out in the same format as getNextBatch, but not in the order of the file. Each worker opens its own handle
+ * with IO_PREAD, so that pages are read at once by several threads; file should not be modified while it is scanned.
+**/
+class ParallelScan
+{
+public:
+	ParallelScan();
+	~ParallelScan();
+
+	//start numWorkers threads (1..PSCAN_MAX_WORKERS) that scan the file (arguments are the same as RecordBasedFileManager::scan;
+	//value is not copied, so it has to stay valid until the scan is closed). Returns -81 if scan is already opened, number
+	//of workers is out of range, or threads cannot be started
+	RC open(const string &fileName,
+			const vector<Attribute> &recordDescriptor,
+			const string &conditionAttribute,
+			const CompOp compOp,
+			const void *value,
+			const vector<string> &attributeNames,
+			const unsigned int numWorkers,
+			const unsigned int morselPages = PSCAN_DEFAULT_MORSEL_PAGES);
+
+	unsigned int getNumWorkers() const;
+	unsigned int getNumMorsels() const;
+
+	//swap the next batch of the given worker into the caller's batch (caller's buffer goes back to the worker); waits until
+	//worker produces one. Returns RBFM_EOF once worker is done and its queue is empty, error of the failed worker, or -81 if
+	//scan is not opened (or there is no such worker)
+	RC getNextBatch(const unsigned int worker, RecordBatch &batch);
+	//same, but batch is taken from whichever worker has one ready
+	RC getNextBatch(RecordBatch &batch);
+
+	//stop workers (batches that were not taken are dropped) and close their handles
+	RC close();
+
+protected:
+	static void* workerMain(void* worker);
+	void scanMorsels(ParallelScanWorker* worker);
+
+	//split data pages of the file into morsels (builds header page directory before workers use it)
+	RC buildMorsels(FileHandle &fileHandle, const unsigned int morselPages);
+
+	//hand the first batch of the worker's queue over to the caller (expects mutex to be held by the caller)
+	void takeBatch(ParallelScanWorker* worker, RecordBatch &batch);
+
+private:
+	ParallelScan(const ParallelScan&);
+	ParallelScan& operator=(const ParallelScan&);
+
+	std::vector<ParallelScanWorker*> _workers;
+	/*
+	 * first and last (exclusive) page of each morsel, and index of the morsel that is taken next
+	**/
+	std::vector<PageNum> _morselFirstPages;
+	std::vector<PageNum> _morselEndPages;
+	unsigned int _nextMorsel;
+	/*
+	 * worker that getNextBatch(batch) looks at first (consumer goes round robin over workers)
+	**/
+	unsigned int _nextWorker;
+	/*
+	 * error of the first failed worker (0 if none)
+	**/
+	RC _errCode;
+	bool _isOpened;
+	bool _stopping;
+	/*
+	 * guards all members; consumer waits on _batchCond for filled batches, workers wait on _spaceCond for room in their queue
+	**/
+	pthread_mutex_t _mutex;
+	pthread_cond_t _batchCond;
+	pthread_cond_t _spaceCond;
+};
+
+#endif
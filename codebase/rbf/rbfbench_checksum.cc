@@ -0,0 +1,139 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <sys/time.h>
+
+#include "pfm.h"
+#include "crc.h"
+
+using namespace std;
+
+const int success = 0;
+
+// Page checksum benchmark: cost of CRC32C of a page (hardware and portable) compared with reading the page from
+// the (OS-cached) file, and reading pages with and without checksum verification (usage: ./rbfbench_checksum [numPages] [pageSize])
+
+double now() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000.0 + tv.tv_usec;
+}
+
+// create raw paged file filled with pseudo-random pages
+void createFile(const char *fileName, const unsigned numPages, const unsigned pageSize, const bool checksums) {
+	PagedFileManager *pfm = PagedFileManager::instance();
+	RC rc;
+
+	remove(fileName);
+
+	pfm->setPageChecksums(checksums);
+	rc = pfm->createFile(fileName, pageSize);
+	assert(rc == success);
+	pfm->setPageChecksums(false);
+
+	FileHandle fileHandle;
+	rc = pfm->openFile(fileName, fileHandle, IO_PREAD);
+	assert(rc == success);
+
+	char *page = (char *) malloc(fileHandle.getPhysicalPageSize());
+	for (unsigned i = 0; i < numPages; i++) {
+		for (unsigned j = 0; j < fileHandle.getPageSize(); j++)
+			page[j] = (char) (i * 31 + j * 7);
+
+		// physical write fills in the trailer
+		rc = fileHandle.writePhysicalPage(i, page);
+		assert(rc == success);
+	}
+
+	rc = pfm->closeFile(fileHandle);
+	assert(rc == success);
+	free(page);
+}
+
+// read all pages straight from the file (bypassing buffer pool), returns microseconds
+double readPages(const char *fileName, const unsigned numPages) {
+	PagedFileManager *pfm = PagedFileManager::instance();
+	RC rc;
+
+	FileHandle fileHandle;
+	rc = pfm->openFile(fileName, fileHandle, IO_PREAD);
+	assert(rc == success);
+
+	// numPages is not known to a raw file (it has no header), so use the one given
+	void *page = malloc(fileHandle.getPhysicalPageSize());
+
+	double start = now();
+	for (unsigned i = 0; i < numPages; i++) {
+		rc = fileHandle.readPhysicalPage(i, page);
+		assert(rc == success);
+	}
+	double elapsed = now() - start;
+
+	rc = pfm->closeFile(fileHandle);
+	assert(rc == success);
+	free(page);
+
+	return elapsed;
+}
+
+// compute checksum of every page of the in-memory buffer, returns microseconds
+double checksumPages(unsigned (*function)(const void *, const size_t), const char *buffer, const unsigned numPages,
+		const unsigned pageSize, unsigned &result) {
+	double start = now();
+	for (unsigned i = 0; i < numPages; i++)
+		result ^= function(buffer + (size_t) i * pageSize, pageSize);
+	return now() - start;
+}
+
+void report(const char *label, const double elapsed, const unsigned numPages, const unsigned pageSize, const double base) {
+	double perPage = elapsed * 1000.0 / numPages;
+	printf("%-28s %10.1f ns/page %10.0f MB/s", label, perPage, (double) numPages * pageSize / elapsed);
+	if (base > 0)
+		printf(" %8.1f%% of raw read", elapsed * 100.0 / base);
+	printf("\n");
+}
+
+int main(int argc, char *argv[]) {
+	unsigned numPages = (argc > 1 ? atoi(argv[1]) : 8192);
+	unsigned pageSize = (argc > 2 ? atoi(argv[2]) : PAGE_SIZE);
+	const char *plainFile = "bench_checksum_plain";
+	const char *checkedFile = "bench_checksum_crc";
+	unsigned portableResult = 0, hardwareResult = 0;
+
+	createFile(plainFile, numPages, pageSize, false);
+	createFile(checkedFile, numPages, pageSize, true);
+
+	// warm up OS page cache, so that reads measure system call and copy (the cheapest read checksums are added to)
+	readPages(plainFile, numPages);
+	readPages(checkedFile, numPages);
+
+	double rawRead = readPages(plainFile, numPages);
+	double checkedRead = readPages(checkedFile, numPages);
+
+	char *buffer = (char *) malloc((size_t) numPages * pageSize);
+	for (size_t i = 0; i < (size_t) numPages * pageSize; i++)
+		buffer[i] = (char) (i * 13 + i / 4096);
+
+	double portable = checksumPages(crc32cPortable, buffer, numPages, pageSize, portableResult);
+	double hardware = crc32cHardwareSupported() ? checksumPages(crc32cHardware, buffer, numPages, pageSize, hardwareResult) : 0;
+
+	printf("%u pages of %u bytes\n", numPages, pageSize);
+	report("raw read", rawRead, numPages, pageSize, 0);
+	report("read + verify", checkedRead, numPages, pageSize, rawRead);
+	if (hardware > 0) {
+		report("crc32c (sse4.2)", hardware, numPages, pageSize, rawRead);
+		assert(hardwareResult == portableResult);
+	}
+	else
+		printf("%-28s not supported by this CPU\n", "crc32c (sse4.2)");
+	report("crc32c (portable)", portable, numPages, pageSize, rawRead);
+
+	PagedFileManager::instance()->destroyFile(plainFile);
+	PagedFileManager::instance()->destroyFile(checkedFile);
+	free(buffer);
+
+	return 0;
+}
@@ -0,0 +1,154 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <sys/time.h>
+
+#include "rbfm.h"
+#include "codec.h"
+
+using namespace std;
+
+// Record codec benchmark: records of an all-int/real schema and of a schema with varchar attributes are encoded and decoded
+// in memory, first thru RecordBasedFileManager::encodeRecord/decodeRecord (before) and then thru the codec built for the
+// descriptor (after), reporting million records per second (usage: ./rbfbench_codec [numRecords] [numRounds])
+
+const unsigned numDistinctRecords = 1024;
+const unsigned maxRecordSize = 256;
+
+double now() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000.0 + tv.tv_usec;
+}
+
+void addAttribute(vector<Attribute> &recordDescriptor, const string &name, const AttrType type, const AttrLength length) {
+	Attribute attr;
+	attr.name = name;
+	attr.type = type;
+	attr.length = length;
+	recordDescriptor.push_back(attr);
+}
+
+// id, age, salary (int), height, weight, score (real)
+void createFixedDescriptor(vector<Attribute> &recordDescriptor) {
+	addAttribute(recordDescriptor, "id", TypeInt, 4);
+	addAttribute(recordDescriptor, "age", TypeInt, 4);
+	addAttribute(recordDescriptor, "salary", TypeInt, 4);
+	addAttribute(recordDescriptor, "height", TypeReal, 4);
+	addAttribute(recordDescriptor, "weight", TypeReal, 4);
+	addAttribute(recordDescriptor, "score", TypeReal, 4);
+}
+
+// id (int), name (varchar), age (int), height (real), salary (int)
+void createMixedDescriptor(vector<Attribute> &recordDescriptor) {
+	addAttribute(recordDescriptor, "id", TypeInt, 4);
+	addAttribute(recordDescriptor, "name", TypeVarChar, 30);
+	addAttribute(recordDescriptor, "age", TypeInt, 4);
+	addAttribute(recordDescriptor, "height", TypeReal, 4);
+	addAttribute(recordDescriptor, "salary", TypeInt, 4);
+}
+
+// varchar values are 5 to 29 chars long
+void prepareRecord(const vector<Attribute> &recordDescriptor, const int id, void *buffer) {
+	int offset = 0;
+	for (unsigned i = 0; i < recordDescriptor.size(); i++) {
+		if (recordDescriptor[i].type == TypeVarChar) {
+			int length = 5 + id % 25;
+			memcpy((char *) buffer + offset, &length, sizeof(int));
+			offset += sizeof(int);
+			memset((char *) buffer + offset, 'a' + id % 26, length);
+			offset += length;
+		} else {
+			int value = id + i;
+			memcpy((char *) buffer + offset, &value, sizeof(int));
+			offset += sizeof(int);
+		}
+	}
+}
+
+void runBenchmark(const string &name, const vector<Attribute> &recordDescriptor, const unsigned numRecords, const unsigned numRounds) {
+	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+	RecordCodec *codec = RecordCodec::create(recordDescriptor);
+
+	char *records = (char *) malloc(numDistinctRecords * maxRecordSize);
+	char *encRecords = (char *) malloc(numDistinctRecords * maxRecordSize);
+	char *decoded = (char *) malloc(maxRecordSize);
+	for (unsigned i = 0; i < numDistinctRecords; i++) {
+		prepareRecord(recordDescriptor, i, records + i * maxRecordSize);
+		unsigned szEncRecord = 0;
+		char *record = records + i * maxRecordSize;
+		rbfm->encodeRecord(recordDescriptor, record, sizeOfRecord(recordDescriptor, record), szEncRecord, encRecords + i * maxRecordSize);
+	}
+
+	// checksum of the decoded records keeps the work from being optimized away, and has to be the same for both paths
+	double encodeGeneric = 0, encodeCodec = 0, decodeGeneric = 0, decodeCodec = 0;
+	unsigned sumGeneric = 0, sumCodec = 0;
+	char *encoded = (char *) malloc(maxRecordSize);
+	for (unsigned round = 0; round < numRounds; round++) {
+		double start = now();
+		for (unsigned i = 0; i < numRecords; i++) {
+			const char *record = records + (i % numDistinctRecords) * maxRecordSize;
+			unsigned szEncRecord = 0;
+			rbfm->encodeRecord(recordDescriptor, record, sizeOfRecord(recordDescriptor, record), szEncRecord, encoded);
+			sumGeneric += szEncRecord + encoded[szEncRecord - 1];
+		}
+		encodeGeneric += now() - start;
+
+		start = now();
+		for (unsigned i = 0; i < numRecords; i++) {
+			const char *record = records + (i % numDistinctRecords) * maxRecordSize;
+			unsigned szEncRecord = 0;
+			codec->sizeOfRecord(record);
+			codec->encodeRecord(record, szEncRecord, encoded);
+			sumCodec += szEncRecord + encoded[szEncRecord - 1];
+		}
+		encodeCodec += now() - start;
+
+		start = now();
+		for (unsigned i = 0; i < numRecords; i++) {
+			unsigned szDecoded = 0;
+			rbfm->decodeRecord(recordDescriptor, encRecords + (i % numDistinctRecords) * maxRecordSize, szDecoded, decoded);
+			sumGeneric += szDecoded + decoded[szDecoded - 1];
+		}
+		decodeGeneric += now() - start;
+
+		start = now();
+		for (unsigned i = 0; i < numRecords; i++) {
+			unsigned szDecoded = 0;
+			codec->decodeRecord(encRecords + (i % numDistinctRecords) * maxRecordSize, szDecoded, decoded);
+			sumCodec += szDecoded + decoded[szDecoded - 1];
+		}
+		decodeCodec += now() - start;
+	}
+	assert(sumGeneric == sumCodec);
+
+	double total = (double) numRecords * numRounds;
+	cout << name << "\t" << total / encodeGeneric << "\t" << total / encodeCodec << "\t"
+			<< total / decodeGeneric << "\t" << total / decodeCodec << endl;
+
+	free(records);
+	free(encRecords);
+	free(encoded);
+	free(decoded);
+	delete codec;
+}
+
+int main(int argc, char *argv[]) {
+	unsigned numRecords = (argc > 1 ? atoi(argv[1]) : 5000000);
+	unsigned numRounds = (argc > 2 ? atoi(argv[2]) : 3);
+
+	vector<Attribute> fixedDescriptor, mixedDescriptor;
+	createFixedDescriptor(fixedDescriptor);
+	createMixedDescriptor(mixedDescriptor);
+
+	cout << "encoding and decoding " << numRecords << " records, " << numRounds << " rounds (million records/sec)" << endl;
+	cout << "schema\tencode\tencode (codec)\tdecode\tdecode (codec)" << endl;
+
+	runBenchmark("int/real", fixedDescriptor, numRecords, numRounds);
+	runBenchmark("varchar", mixedDescriptor, numRecords, numRounds);
+
+	return 0;
+}
@@ -0,0 +1,215 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include "pfm.h"
+#include "bpm.h"
+#include "rbfm.h"
+
+using namespace std;
+
+const int success = 0;
+
+// Compressed file benchmark: sample table data/employee_50 is scaled up (rows are repeated with varying age and salary)
+// and stored in a regular and in a compressed file; both are scanned with cold buffer pool, reporting size of the file,
+// bytes read from the OS file and CPU time per scanned tuple (usage: ./rbfbench_compress [numRecords] [sampleFile])
+
+double now() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000.0 + tv.tv_usec;
+}
+
+// user + system time of this process
+double cpuTime() {
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000.0 + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+void createRecordDescriptor(vector<Attribute> &recordDescriptor) {
+
+	Attribute attr;
+	attr.name = "EmpName";
+	attr.type = TypeVarChar;
+	attr.length = (AttrLength) 30;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "Age";
+	attr.type = TypeInt;
+	attr.length = (AttrLength) 4;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "Height";
+	attr.type = TypeReal;
+	attr.length = (AttrLength) 4;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "Salary";
+	attr.type = TypeInt;
+	attr.length = (AttrLength) 4;
+	recordDescriptor.push_back(attr);
+}
+
+struct Employee {
+	string name;
+	int age;
+	float height;
+	int salary;
+};
+
+// lines of the sample file: name,age,height,salary
+int loadSample(const string &fileName, vector<Employee> &employees) {
+	ifstream file(fileName.c_str());
+	string line;
+	while (getline(file, line)) {
+		Employee employee;
+		size_t first = line.find(','), second = line.find(',', first + 1), third = line.find(',', second + 1);
+		if (first == string::npos || second == string::npos || third == string::npos)
+			continue;
+		employee.name = line.substr(0, first);
+		employee.age = atoi(line.substr(first + 1, second - first - 1).c_str());
+		employee.height = atof(line.substr(second + 1, third - second - 1).c_str());
+		employee.salary = atoi(line.substr(third + 1).c_str());
+		employees.push_back(employee);
+	}
+	return employees.empty() ? -1 : 0;
+}
+
+int prepareRecord(const Employee &employee, const unsigned copy, void *buffer) {
+	int offset = 0;
+	int nameLength = employee.name.size();
+	int age = employee.age + copy % 7;
+	int salary = employee.salary + (copy % 100) * 10;
+
+	memcpy((char *) buffer + offset, &nameLength, sizeof(int));
+	offset += sizeof(int);
+	memcpy((char *) buffer + offset, employee.name.c_str(), nameLength);
+	offset += nameLength;
+	memcpy((char *) buffer + offset, &age, sizeof(int));
+	offset += sizeof(int);
+	memcpy((char *) buffer + offset, &employee.height, sizeof(float));
+	offset += sizeof(float);
+	memcpy((char *) buffer + offset, &salary, sizeof(int));
+	offset += sizeof(int);
+
+	return offset;
+}
+
+off_t fileSize(const string &fileName) {
+	struct stat info;
+	return stat(fileName.c_str(), &info) == 0 ? info.st_size : 0;
+}
+
+void run(const vector<Employee> &employees, const unsigned numRecords, const bool compressed) {
+	PagedFileManager *pfm = PagedFileManager::instance();
+	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+	string fileName = compressed ? "bench_compress_lz" : "bench_compress_raw";
+	vector<Attribute> recordDescriptor;
+	createRecordDescriptor(recordDescriptor);
+	RC rc;
+
+	remove(fileName.c_str());
+	remove((fileName + ".pmap").c_str());
+
+	pfm->setPageCompression(compressed);
+	rc = rbfm->createFile(fileName);
+	assert(rc == success);
+	pfm->setPageCompression(false);
+
+	FileHandle fileHandle;
+	rc = rbfm->openFile(fileName, fileHandle, IO_PREAD);
+	assert(rc == success);
+
+	char record[PAGE_SIZE];
+	RID rid;
+	double start = now();
+	for (unsigned i = 0; i < numRecords; i++) {
+		prepareRecord(employees[i % employees.size()], i / employees.size(), record);
+		rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+		assert(rc == success);
+	}
+	unsigned numPages = fileHandle.getNumberOfPages();
+	rc = rbfm->closeFile(fileHandle);
+	assert(rc == success);
+	double loadTime = now() - start;
+
+	// cold buffer pool
+	rc = pfm->setBufferPoolSize(pfm->getBufferPool()->getNumFrames());
+	assert(rc == success);
+
+	rc = rbfm->openFile(fileName, fileHandle, IO_PREAD);
+	assert(rc == success);
+
+	unsigned physicalReads = 0, physicalWrites = 0;
+	fileHandle.collectPhysicalCounterValues(physicalReads, physicalWrites);
+	unsigned long long readBytes = 0, writtenBytes = 0, uncompressedBytes = 0;
+	if (compressed)
+		fileHandle.collectCompressionCounterValues(readBytes, writtenBytes, uncompressedBytes);
+	unsigned firstPhysicalReads = physicalReads;
+	unsigned long long firstReadBytes = readBytes;
+
+	vector<string> attributeNames;
+	for (unsigned i = 0; i < recordDescriptor.size(); i++)
+		attributeNames.push_back(recordDescriptor[i].name);
+
+	RBFM_ScanIterator iterator;
+	rc = rbfm->scan(fileHandle, recordDescriptor, "", NO_OP, NULL, attributeNames, iterator);
+	assert(rc == success);
+
+	unsigned numTuples = 0;
+	double startCpu = cpuTime();
+	start = now();
+	while (iterator.getNextRecord(rid, record) != RBFM_EOF)
+		numTuples++;
+	double scanTime = now() - start;
+	double scanCpu = cpuTime() - startCpu;
+
+	physicalReads = 0;
+	physicalWrites = 0;
+	iterator._fileHandle.collectPhysicalCounterValues(physicalReads, physicalWrites);
+	readBytes = 0;
+	writtenBytes = 0;
+	uncompressedBytes = 0;
+	if (compressed)
+		iterator._fileHandle.collectCompressionCounterValues(readBytes, writtenBytes, uncompressedBytes);
+
+	// physical bytes read by the scan
+	unsigned long long scanBytes = compressed ? readBytes - firstReadBytes :
+			(unsigned long long) (physicalReads - firstPhysicalReads) * iterator._fileHandle.getPhysicalPageSize();
+
+	iterator.close();
+
+	off_t size = fileSize(fileName) + (compressed ? fileSize(fileName + ".pmap") : 0);
+	cout << (compressed ? "lz " : "raw") << "\t" << numPages << "\t" << size << "\t" << loadTime / numRecords << "\t" << numTuples
+			<< "\t" << (double) scanBytes / numTuples << "\t" << scanCpu / numTuples << "\t" << scanTime / numTuples << endl;
+
+	rc = rbfm->destroyFile(fileName);
+	assert(rc == success);
+}
+
+int main(int argc, char *argv[]) {
+	unsigned numRecords = (argc > 1 ? atoi(argv[1]) : 500000);
+	string sampleFile = (argc > 2 ? argv[2] : "../data/employee_50");
+
+	vector<Employee> employees;
+	if (loadSample(sampleFile, employees) != success) {
+		cout << "cannot read " << sampleFile << endl;
+		return -1;
+	}
+
+	cout << "scanning " << numRecords << " records of " << sampleFile << " (" << employees.size() << " distinct rows)" << endl;
+	cout << "file\tpages\tbytes\tusec/insert\ttuples\tbytes read/tuple\tcpu usec/tuple\tusec/tuple" << endl;
+
+	run(employees, numRecords, false);
+	run(employees, numRecords, true);
+
+	return 0;
+}
@@ -0,0 +1,138 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <sys/time.h>
+
+#include "pfm.h"
+#include "rbfm.h"
+
+using namespace std;
+
+const int success = 0;
+
+// Insert benchmark: average per-insert latency is reported for every batch of records, so that it is visible
+// whether insertion cost grows with the size of the file (usage: ./rbfbench_insert [numRecords] [batchSize] [bulkSize]);
+// with bulkSize > 0 records are inserted by insertRecords, bulkSize records per call
+
+double now() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000.0 + tv.tv_usec;
+}
+
+void createRecordDescriptor(vector<Attribute> &recordDescriptor) {
+
+	Attribute attr;
+	attr.name = "id";
+	attr.type = TypeInt;
+	attr.length = (AttrLength) 4;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "name";
+	attr.type = TypeVarChar;
+	attr.length = (AttrLength) 50;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "score";
+	attr.type = TypeReal;
+	attr.length = (AttrLength) 4;
+	recordDescriptor.push_back(attr);
+}
+
+// id (int), name (varchar of 10 to 40 chars), score (real)
+int prepareRecord(const int id, void *buffer) {
+	int offset = 0;
+	int nameLength = 10 + id % 31;
+	float score = id * 0.5f;
+
+	memcpy((char *) buffer + offset, &id, sizeof(int));
+	offset += sizeof(int);
+	memcpy((char *) buffer + offset, &nameLength, sizeof(int));
+	offset += sizeof(int);
+	memset((char *) buffer + offset, 'a' + id % 26, nameLength);
+	offset += nameLength;
+	memcpy((char *) buffer + offset, &score, sizeof(float));
+	offset += sizeof(float);
+
+	return offset;
+}
+
+int main(int argc, char *argv[]) {
+	unsigned numRecords = (argc > 1 ? atoi(argv[1]) : 2000000);
+	unsigned batchSize = (argc > 2 ? atoi(argv[2]) : 100000);
+	unsigned bulkSize = (argc > 3 ? atoi(argv[3]) : 0);
+	string fileName = "bench_insert";
+
+	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+	RC rc;
+
+	remove(fileName.c_str());
+
+	rc = rbfm->createFile(fileName.c_str());
+	assert(rc == success);
+
+	FileHandle fileHandle;
+	rc = rbfm->openFile(fileName.c_str(), fileHandle);
+	assert(rc == success);
+
+	vector<Attribute> recordDescriptor;
+	createRecordDescriptor(recordDescriptor);
+
+	void *record = malloc(PAGE_SIZE);
+	RID rid;
+
+	// records of the bulk (each one has its own buffer)
+	vector<const void*> bulk;
+	vector<RID> rids;
+	for (unsigned i = 0; i < bulkSize; i++)
+		bulk.push_back(malloc(PAGE_SIZE));
+
+	cout << "inserting " << numRecords << " records, batches of " << batchSize;
+	if (bulkSize > 0)
+		cout << ", " << bulkSize << " records per insertRecords";
+	cout << endl;
+	cout << "records\tpages\tusec/insert" << endl;
+
+	double total = 0;
+	double start = now();
+	for (unsigned i = 0; i < numRecords; i++) {
+		if (bulkSize == 0) {
+			prepareRecord(i, record);
+			rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+			assert(rc == success);
+		} else {
+			// bulk is inserted once it is full (or at the end of a batch)
+			prepareRecord(i, (void *) bulk[i % batchSize % bulkSize]);
+			if ((i % batchSize + 1) % bulkSize == 0 || (i + 1) % batchSize == 0 || i + 1 == numRecords) {
+				vector<const void*> records(bulk.begin(), bulk.begin() + i % batchSize % bulkSize + 1);
+				rc = rbfm->insertRecords(fileHandle, recordDescriptor, records, rids);
+				assert(rc == success);
+			}
+		}
+
+		if ((i + 1) % batchSize == 0 || i + 1 == numRecords) {
+			double end = now();
+			unsigned n = ((i + 1) % batchSize == 0 ? batchSize : (i + 1) % batchSize);
+			cout << i + 1 << "\t" << fileHandle.getNumberOfPages() << "\t" << (end - start) / n << endl;
+			total += end - start;
+			start = now();
+		}
+	}
+
+	cout << "average usec/insert: " << total / numRecords << endl;
+
+	rc = rbfm->closeFile(fileHandle);
+	assert(rc == success);
+
+	rc = rbfm->destroyFile(fileName.c_str());
+	assert(rc == success);
+
+	free(record);
+	for (unsigned i = 0; i < bulk.size(); i++)
+		free((void *) bulk[i]);
+
+	return 0;
+}
@@ -0,0 +1,178 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <sys/time.h>
+#include <pthread.h>
+
+#include "pfm.h"
+#include "rbfm.h"
+
+using namespace std;
+
+const int success = 0;
+
+// Write-ahead log benchmark: the same insertions are done by concurrent writers (each into its own file) without log,
+// with commits that sync the log right away (concurrent ones still share the fsync that is in progress), and with group
+// commit; every commit is durable when insertion returns, so commits share fsyncs only across writers. Throughput and
+// number of log fsyncs are reported
+// (usage: ./rbfbench_wal [numRecords] [groupSize] [numThreads])
+
+double now() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000.0 + tv.tv_usec;
+}
+
+void createRecordDescriptor(vector<Attribute> &recordDescriptor) {
+
+	Attribute attr;
+	attr.name = "id";
+	attr.type = TypeInt;
+	attr.length = (AttrLength) 4;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "name";
+	attr.type = TypeVarChar;
+	attr.length = (AttrLength) 50;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "score";
+	attr.type = TypeReal;
+	attr.length = (AttrLength) 4;
+	recordDescriptor.push_back(attr);
+}
+
+int prepareRecord(const int id, void *buffer) {
+	int offset = 0;
+	int nameLength = 10 + id % 31;
+	float score = id * 0.5f;
+
+	memcpy((char *) buffer + offset, &id, sizeof(int));
+	offset += sizeof(int);
+	memcpy((char *) buffer + offset, &nameLength, sizeof(int));
+	offset += sizeof(int);
+	memset((char *) buffer + offset, 'a' + id % 26, nameLength);
+	offset += nameLength;
+	memcpy((char *) buffer + offset, &score, sizeof(float));
+	offset += sizeof(float);
+
+	return offset;
+}
+
+// records inserted by one writer thread into its own file
+struct Writer {
+	pthread_t _thread;
+	FileHandle _fileHandle;
+	unsigned _firstRecord;
+	unsigned _numRecords;
+};
+
+void *insertRecords(void *arg) {
+	Writer *writer = (Writer *) arg;
+	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+	vector<Attribute> recordDescriptor;
+	createRecordDescriptor(recordDescriptor);
+
+	void *record = malloc(PAGE_SIZE);
+	RID rid;
+
+	for (unsigned i = writer->_firstRecord; i < writer->_firstRecord + writer->_numRecords; i++) {
+		prepareRecord(i, record);
+		RC rc = rbfm->insertRecord(writer->_fileHandle, recordDescriptor, record, rid);
+		assert(rc == success);
+	}
+
+	free(record);
+	return NULL;
+}
+
+// insert records into new files by numThreads writers; groupSize == 0 means that log is off
+int runInserts(const unsigned numRecords, const unsigned groupSize, const unsigned numThreads, const char *label) {
+	PagedFileManager *pfm = PagedFileManager::instance();
+	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+	string logName = "bench_wal.log";
+	RC rc;
+
+	remove(logName.c_str());
+
+	if (groupSize > 0) {
+		rc = pfm->openLog(logName.c_str());
+		assert(rc == success);
+		rc = pfm->setGroupCommitSize(groupSize);
+		assert(rc == success);
+	}
+
+	vector<Writer> writers(numThreads);
+	for (unsigned i = 0; i < numThreads; i++) {
+		char fileName[64];
+		sprintf(fileName, "bench_wal%u", i);
+		remove(fileName);
+
+		rc = rbfm->createFile(fileName);
+		assert(rc == success);
+		rc = rbfm->openFile(fileName, writers[i]._fileHandle);
+		assert(rc == success);
+
+		writers[i]._firstRecord = i * (numRecords / numThreads);
+		writers[i]._numRecords = numRecords / numThreads;
+	}
+
+	unsigned recordsBefore = 0, commitsBefore = 0, fsyncsBefore = 0;
+	pfm->collectLogCounters(recordsBefore, commitsBefore, fsyncsBefore);
+
+	double start = now();
+
+	for (unsigned i = 0; i < numThreads; i++)
+		pthread_create(&writers[i]._thread, NULL, insertRecords, &writers[i]);
+	for (unsigned i = 0; i < numThreads; i++)
+		pthread_join(writers[i]._thread, NULL);
+
+	double elapsed = now() - start;
+
+	unsigned numLogRecords = 0, numCommits = 0, numFsyncs = 0;
+	pfm->collectLogCounters(numLogRecords, numCommits, numFsyncs);
+
+	unsigned numInserted = numThreads * (numRecords / numThreads);
+	printf("%-24s %10.0f inserts/sec %10u log records %10u commits %10u fsyncs\n", label,
+			numInserted / (elapsed / 1000000.0), numLogRecords - recordsBefore, numCommits - commitsBefore, numFsyncs - fsyncsBefore);
+
+	for (unsigned i = 0; i < numThreads; i++) {
+		rc = rbfm->closeFile(writers[i]._fileHandle);
+		assert(rc == success);
+	}
+
+	rc = pfm->closeLog();
+	assert(rc == success);
+
+	for (unsigned i = 0; i < numThreads; i++) {
+		char fileName[64];
+		sprintf(fileName, "bench_wal%u", i);
+		rc = rbfm->destroyFile(fileName);
+		assert(rc == success);
+	}
+
+	remove(logName.c_str());
+
+	return 0;
+}
+
+int main(int argc, char *argv[]) {
+	unsigned numRecords = (argc > 1 ? atoi(argv[1]) : 20000);
+	unsigned groupSize = (argc > 2 ? atoi(argv[2]) : 64);
+	unsigned numThreads = (argc > 3 ? atoi(argv[3]) : 8);
+	if (numThreads == 0)
+		numThreads = 1;
+
+	char label[64];
+	sprintf(label, "group commit (%u)", groupSize);
+
+	runInserts(numRecords, 0, numThreads, "no log");
+	runInserts(numRecords, 1, numThreads, "commit without delay");
+	runInserts(numRecords, groupSize, numThreads, label);
+
+	return 0;
+}
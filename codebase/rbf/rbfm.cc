@@ -1,8 +1,14 @@
 
 #include "rbfm.h"
+#include "bpm.h"
+#include "fsm.h"
+#include "allocmap.h"
+#include "pax.h"
+#include "codec.h"
 #include <iostream>
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
 
 RecordBasedFileManager* RecordBasedFileManager::_rbf_manager = 0;
 PagedFileManager* RecordBasedFileManager::_pfm = 0;
@@ -53,16 +59,17 @@ RecordBasedFileManager::~RecordBasedFileManager()
  * -25 = cannot update record without change of rid (no space within the given page, and cannot move to a different page!)
  * -26 = no requested attribute was found inside the record
  * -27 = page number exceeds the total number of pages in a file
+ * -28 = record batch is too small to hold a single record
 **/
 
-RC RecordBasedFileManager::createFile(const string &fileName) {
+RC RecordBasedFileManager::createFile(const string &fileName, const unsigned int pageSize, const PageLayout layout) {
 	//error value
 	RC errCode = 0;
 
 	const char* cArrFileName = fileName.c_str();
 
 	//create an empty file using pfm (i.e. PagedFileManager)
-	if( (errCode = _pfm->createFile( cArrFileName )) != 0 )
+	if( (errCode = _pfm->createFile( cArrFileName, pageSize )) != 0 )
 	{
 		return errCode;
 	}
@@ -73,6 +80,36 @@ RC RecordBasedFileManager::createFile(const string &fileName) {
 		return errCode;
 	}
 
+	//layout of the data pages is stored in the first header page
+	if( layout != LAYOUT_ROW )
+	{
+		FileHandle fileHandle;
+		if( (errCode = _pfm->openFile( cArrFileName, fileHandle )) != 0 )
+		{
+			return errCode;
+		}
+
+		void* data = malloc(fileHandle.getPageSize());
+		if( (errCode = fileHandle.readPage(0, data)) == 0 )
+		{
+			((Header*)data)->_pageLayout = layout;
+			errCode = fileHandle.writePage(0, data);
+		}
+		free(data);
+
+		//file information may outlive this handle, so it gets the layout as well
+		if( errCode == 0 )
+		{
+			fileHandle._info->_pageLayout = layout;
+		}
+
+		RC closeCode = _pfm->closeFile( fileHandle );
+		if( errCode == 0 )
+		{
+			errCode = closeCode;
+		}
+	}
+
 	//success => return 0
 	return errCode;
 }
@@ -90,16 +127,24 @@ RC RecordBasedFileManager::destroyFile(const string &fileName) {
 	return errCode;
 }
 
-RC RecordBasedFileManager::openFile(const string &fileName, FileHandle &fileHandle) {
+RC RecordBasedFileManager::openFile(const string &fileName, FileHandle &fileHandle, FileIOMode ioMode) {
     //error value
 	RC errCode = 0;
 
 	//open a specified file and assign a given handler to this file
-	if( (errCode = _pfm->openFile( fileName.c_str(), fileHandle )) != 0 )
+	if( (errCode = _pfm->openFile( fileName.c_str(), fileHandle, ioMode )) != 0 )
 	{
 		return errCode;
 	}
 
+	//records, data pages and header pages of the file of the earlier format (or of the file that is not a record-based file)
+	//cannot be read, so such file is not opened
+	if( fileHandle._info->_hasFormatHeader == false )
+	{
+		_pfm->closeFile( fileHandle );
+		return -76;
+	}
+
 	//added
 		//printFile(fileHandle);
 
@@ -139,8 +184,8 @@ RC RecordBasedFileManager::findRecordSlot(FileHandle &fileHandle, PageNum pagenu
 	RC errCode = 0;
 
 	//prepare parameters for reading the data page
-	void* data = malloc(PAGE_SIZE);
-	memset(data, 0, PAGE_SIZE);
+	void* data = malloc(fileHandle.getPageSize());
+	memset(data, 0, fileHandle.getPageSize());
 
 	//get content of the data page
 	if( (errCode = fileHandle.readPage(pagenum, data)) != 0 )
@@ -151,6 +196,39 @@ RC RecordBasedFileManager::findRecordSlot(FileHandle &fileHandle, PageNum pagenu
 		//return error code
 		return errCode;
 	}
+
+	//reserve slot and space for the record inside the page
+	if( (errCode = reserveRecordSlot(data, fileHandle.getPageSize(), szRecord, slot, slotNum)) != 0 )
+	{
+		//free data
+		free(data);
+
+		//return error code
+		return errCode;
+	}
+
+	//write page to the file
+	if( (errCode = fileHandle.writePage(pagenum, data)) != 0 )
+	{
+		//deallocate data page
+		free(data);
+
+		//return error
+		return errCode;
+	}
+
+	//deallocate data
+	free(data);
+
+	//added
+		//printFile(fileHandle);
+
+	//return success
+	return errCode;
+}
+
+RC RecordBasedFileManager::reserveRecordSlot(void* data, const unsigned int pageSize, const unsigned int szRecord, PageDirSlot& slot, unsigned int& slotNum)
+{
 	/*
 	 * data page has a following format:
 	 * [list of records without any spaces in between][free space for records][list of directory slots][(number of slots):unsigned int][(offset from page start to the start of free space):unsigned int]
@@ -158,7 +236,7 @@ RC RecordBasedFileManager::findRecordSlot(FileHandle &fileHandle, PageNum pagenu
 	 * start of page                                                          start of dirSlot        end of dirSlot                                                                          end of page
 	 */
 	//determine pointer to the end of the list of directory slots
-	PageDirSlot* endOfDirSlot = (PageDirSlot*)((char*)data + PAGE_SIZE - sizeof(unsigned int) - sizeof(unsigned int));
+	PageDirSlot* endOfDirSlot = (PageDirSlot*)((char*)data + pageSize - sizeof(unsigned int) - sizeof(unsigned int));
 
 	//number of slots
 	unsigned int* ptrNumSlots = (unsigned int*)(endOfDirSlot);
@@ -193,6 +271,7 @@ RC RecordBasedFileManager::findRecordSlot(FileHandle &fileHandle, PageNum pagenu
 	}
 
 	//if there is not available page directory slot, then "reserve next" (get a pointer to it)
+	bool newSlot = false;
 	if( curSlot == endOfDirSlot )
 	{
 		//assign a new slot
@@ -201,31 +280,25 @@ RC RecordBasedFileManager::findRecordSlot(FileHandle &fileHandle, PageNum pagenu
 		//point it at the slot right before start of list of directory slots
 		curSlot = (PageDirSlot*)(startOfDirSlot - 1);
 		startOfDirSlot = curSlot;
-
-		//initialize it to 0's
-		curSlot->_offRecord = 0;
-		curSlot->_szRecord = 0;
-
-		//increment number of slots(unsigned int*)( (char*)(endOfDirSlot) + sizeof(unsigned int) )
-		*ptrNumSlots += 1;
+		newSlot = true;
 	}
 
 	//determine size of free space in this page
 	unsigned int szOfFreeSpace = (unsigned int)((char*)startOfDirSlot - ptrToFreeSpace);
 
 	//if size of free space is not enough return -22 (because it was suppose to be enough, since this page was found by method getPage)
-	if( szOfFreeSpace < szRecord )
+	if( (char*)startOfDirSlot < ptrToFreeSpace || szOfFreeSpace < szRecord )
 	{
-		//lower number of assigned slots
-		*ptrNumSlots -= 1;
-
-		//free data
-		free(data);
-
 		//could not insert record (page header contains incorrect information)
 		return -22;
 	}
 
+	//increment number of slots(unsigned int*)( (char*)(endOfDirSlot) + sizeof(unsigned int) )
+	if( newSlot )
+	{
+		*ptrNumSlots += 1;
+	}
+
 	//update record size and offset
 	curSlot->_szRecord = szRecord;
 	curSlot->_offRecord = *ptrVarForFreeSpace;
@@ -236,24 +309,8 @@ RC RecordBasedFileManager::findRecordSlot(FileHandle &fileHandle, PageNum pagenu
 	//assign slot passed by reference
 	slot = *curSlot;
 
-	//write page to the file
-	if( (errCode = fileHandle.writePage(pagenum, data)) != 0 )
-	{
-		//deallocate data page
-		free(data);
-
-		//return error
-		return errCode;
-	}
-
-	//deallocate data
-	free(data);
-
-	//added
-		//printFile(fileHandle);
-
-	//return success
-	return errCode;
+	//success
+	return 0;
 }
 
 void RecordBasedFileManager::decodeRecord(
@@ -262,68 +319,69 @@ void RecordBasedFileManager::decodeRecord(
 		unsigned int& decodedSize,
 		void* decodedRecordData)
 {
-	//get number of fields in this record
-	unsigned int numFields = *((unsigned int*)encodedRecordData);
-
-	//calculate size of record directory
-	unsigned int szOfDir = sizeof(unsigned int) * (numFields + 1);
+	//get number of fields in this record, and how many of them are VarChar (see RecordHeader)
+	const RecordHeader* header = (const RecordHeader*)encodedRecordData;
+	unsigned int numFields = header->_numFields;
 
-	//loop thru record fields (both data and attributes)
-
-	//setup parameters for the loop
-	std::vector<Attribute>::const_iterator iterator = recordDescriptor.begin(), max = recordDescriptor.end();
-	const void *curDir = (void*)((char*)encodedRecordData + sizeof(unsigned int)),
-			   *ptrInEncodedData = (void*)((char*)encodedRecordData + szOfDir + sizeof(unsigned int));
-	void* ptrInDecodedRecord = decodedRecordData;
+	//setup parameters for the loop: TypeInt/TypeReal values are at static offsets, characters of VarChar values follow them
+	const char* ptrFixed = (const char*)encodedRecordData + RECORD_FIXED_OFFSET(numFields, header->_numVarFields);
+	const unsigned int* curDir = (const unsigned int*)((const char*)encodedRecordData + RECORD_DIR_OFFSET(numFields));
+	unsigned int curOffset = RECORD_VARCHAR_OFFSET(numFields);
+	char* ptrInDecodedRecord = (char*)decodedRecordData;
 
 	//loop
-	for( ; iterator != max; iterator++ )
+	for( unsigned int i = 0; i < recordDescriptor.size(); i++ )
 	{
-		//calculate size of the record field
-		unsigned int szOfField = 0;
-		switch(iterator->type)
+		//field that record does not have (attribute was added after the record was written) is treated as NULL
+		bool isInRecord = i < numFields;
+		bool isNull = isInRecord == false || RECORD_FIELD_IS_NULL(encodedRecordData, i);
+
+		//locate the record field
+		const char* ptrField = NULL;
+		unsigned int szOfField = sizeof(unsigned int);
+		if( recordDescriptor[i].type == TypeVarChar )
 		{
-		case TypeInt:
-			szOfField = sizeof(unsigned int);
-			break;
-		case TypeReal:
-			szOfField = sizeof(float);
-			break;
-		case TypeVarChar:
-			szOfField = *( ((unsigned int*)curDir) + 1 ) - *( (unsigned int*)curDir );	//next offset - current offset
-
-			//only write out data into the decoded buffer, if the field is not deleted
-			if( iterator->length > 0 )
+			szOfField = 0;
+			if( isInRecord )
 			{
-				//place length into decoded record data
-				*((unsigned int*)ptrInDecodedRecord) = szOfField;
-
-				//update size of decoded record by size of the integer that stores field length
-				decodedSize += sizeof(unsigned int);
-
-				//update pointer
-				ptrInDecodedRecord = (void*)((char*)ptrInDecodedRecord + sizeof(unsigned int));
+				//characters start where the previous VarChar value ends
+				ptrField = (const char*)encodedRecordData + curOffset;
+				szOfField = FIELD_OFFSET(*curDir) - curOffset;
+				curOffset = FIELD_OFFSET(*curDir);
+				curDir++;
 			}
-
-			break;
+		}
+		else if( isInRecord )
+		{
+			ptrField = ptrFixed;
+			ptrFixed += sizeof(unsigned int);
 		}
 
 		//only write out data into the decoded buffer, if the field is not deleted
-		if( iterator->length > 0 )
+		if( recordDescriptor[i].length == 0 )
 		{
-			//update size of decoded record by size of the field
-			decodedSize += szOfField;
+			continue;
+		}
 
-			//copy data
-			memcpy(ptrInDecodedRecord, ptrInEncodedData, szOfField);
+		if( recordDescriptor[i].type == TypeVarChar )
+		{
+			//place length into decoded record data (NULL field is an empty string)
+			*((unsigned int*)ptrInDecodedRecord) = szOfField;
 
-			//update decoded pointer
-			ptrInDecodedRecord = (void*)((char*)ptrInDecodedRecord + szOfField);
+			//update size of decoded record by size of the integer that stores field length, and update pointer
+			decodedSize += sizeof(unsigned int);
+			ptrInDecodedRecord += sizeof(unsigned int);
 		}
 
-		//update pointers
-		curDir = (void*)((char*)curDir + sizeof(unsigned int));
-		ptrInEncodedData = (void*)((char*)ptrInEncodedData + szOfField);
+		//copy data (NULL TypeInt/TypeReal field is 0)
+		if( isNull )
+			memset(ptrInDecodedRecord, 0, szOfField);
+		else
+			memcpy(ptrInDecodedRecord, ptrField, szOfField);
+
+		//update size of decoded record and pointer
+		decodedSize += szOfField;
+		ptrInDecodedRecord += szOfField;
 	}
 }
 
@@ -334,96 +392,88 @@ void RecordBasedFileManager::encodeRecord(
 		unsigned int& newSzOfRecord,
 		void* newRecordData)
 {
-	//new record structure includes 3 components
-	//[number of fields:integer][directory of field offsets:List<integer>][list of fields]
-
-	//calculate size of "record directory of offsets"
-	unsigned int szOfDir = sizeof(unsigned int) * (recordDescriptor.size() + 1);	//one extra offset "points" at the end of the last record
+	//new record structure includes 5 components (see RecordHeader)
+	//[number of fields, number of VarChar fields][null bitmap][directory of VarChar end offsets][TypeInt/TypeReal values][VarChar values]
+	unsigned int numFields = recordDescriptor.size(), numVarFields = 0;
+	for( unsigned int i = 0; i < numFields; i++ )
+	{
+		if( recordDescriptor[i].type == TypeVarChar )
+			numVarFields++;
+	}
 
-	//loop thru record fields (both data and attributes)
+	RecordHeader* header = (RecordHeader*)newRecordData;
+	header->_numFields = numFields;
+	header->_numVarFields = numVarFields;
 
-	//set the new size of the record to 0
-	newSzOfRecord = 0;
+	//no field is NULL, unless its attribute has been dropped
+	memset((char*)newRecordData + sizeof(RecordHeader), 0, RECORD_NULL_BITMAP_SIZE(numFields));
 
 	//setup parameters for the loop
-	std::vector<Attribute>::const_iterator iterator = recordDescriptor.begin(), max = recordDescriptor.end();
-	void *ptrEncRecordData = (void*)((char*)newRecordData + szOfDir), *ptrEncDirRecord = newRecordData;
-	const void *ptrOrigRecord = originalRecordData;
-	unsigned int curOffset = szOfDir;
-
-	//place integer representing number of fields into the start of the record (which is
-	//pointed by ptrEncDirRecord, and then increment all pointers by the size of integer)
-		//copy number of fields into the record's body as a first parameter
-		*((unsigned int*)ptrEncDirRecord) = recordDescriptor.size();
-		//update both pointers by the size of the first field (i.e. number of fields in this record)
-		ptrEncDirRecord = (void*)((char*)ptrEncDirRecord + sizeof(unsigned int));
-		ptrEncRecordData = (void*)((char*)ptrEncRecordData + sizeof(unsigned int));
-		//increment size of the decoded record
-		newSzOfRecord += sizeof(unsigned int);
-		curOffset += sizeof(unsigned int);
+	unsigned int* ptrEncDir = (unsigned int*)((char*)newRecordData + RECORD_DIR_OFFSET(numFields));
+	char* ptrEncFixed = (char*)newRecordData + RECORD_FIXED_OFFSET(numFields, numVarFields);
+	const char* ptrOrigRecord = (const char*)originalRecordData;
+	unsigned int curOffset = RECORD_VARCHAR_OFFSET(numFields);
 
 	//loop
-	for( ; iterator != max; iterator++ )
+	for( unsigned int i = 0; i < numFields; i++ )
 	{
-		//determine size of the field
-		unsigned int szOfField = 0;
-		switch( iterator->type )
+		if( recordDescriptor[i].type != TypeVarChar )
 		{
-		case TypeInt:
-			szOfField = sizeof(unsigned int);
-			break;
-		case TypeReal:
-			szOfField = sizeof(float);
-			break;
-		case TypeVarChar:
-			//if the field is inside this record (i.e. not dropped) then get length from it
-			if( iterator->length > 0 )
+			//TypeInt/TypeReal value goes to its static offset; dropped attribute still has its 4 bytes in the original record, but
+			//it is kept as NULL field
+			if( recordDescriptor[i].length > 0 )
 			{
-				szOfField = *((unsigned int*)ptrOrigRecord);
-
-				//update pointer of original record (so that it points at data; right now it points at its length)
-				ptrOrigRecord = (void*)((char*)ptrOrigRecord + sizeof(unsigned int));
+				memcpy(ptrEncFixed, ptrOrigRecord, sizeof(unsigned int));
 			}
 			else
 			{
-				//otherwise, this field VarChar has been dropped, so place a "default" value => empty string
-				//empty string in our record field format is [length:integer=0][empty string=""] => total size of sizeOf(integer) = 4 bytes
-				szOfField = 0;
+				memset(ptrEncFixed, 0, sizeof(unsigned int));
+				RECORD_SET_FIELD_NULL(newRecordData, i);
 			}
-			break;
+
+			ptrEncFixed += sizeof(unsigned int);
+			ptrOrigRecord += sizeof(unsigned int);
+			continue;
+		}
+
+		//dropped VarChar is not part of the original record, it is kept as NULL field without characters
+		if( recordDescriptor[i].length == 0 )
+		{
+			RECORD_SET_FIELD_NULL(newRecordData, i);
+			*ptrEncDir++ = curOffset;
+			continue;
 		}
 
-		//update size of the encoded record by the current field
-		newSzOfRecord += sizeof(unsigned int) + szOfField;
+		//copy characters of VarChar (its length is only kept as its end offset in the directory)
+		unsigned int szOfField = *((const unsigned int*)ptrOrigRecord);
+		ptrOrigRecord += sizeof(unsigned int);
 
-		//write offset of field in the "record directory of offsets"
-		*((unsigned int*)ptrEncDirRecord) = curOffset;
+		memcpy((char*)newRecordData + curOffset, ptrOrigRecord, szOfField);
 
-		//update offset
+		ptrOrigRecord += szOfField;
 		curOffset += szOfField;
+		*ptrEncDir++ = curOffset;
+	}
 
-		//if the field has been dropped, we still want to keep it inside the record structure, but it would occupy space ONLY inside the record directory
-		//no actual data will be written in at the record's data body
-		if( szOfField > 0 )
-		{
-			//write field into appropriate spot in encoded record
-			memcpy(ptrEncRecordData, ptrOrigRecord, szOfField);
-		}
+	//size of the encoded record is the end of the last VarChar value
+	newSzOfRecord = curOffset;
+}
 
-		//update pointers
-		ptrEncRecordData = (void*)((char*)ptrEncRecordData + szOfField);
-		ptrEncDirRecord = (void*)((char*)ptrEncDirRecord + sizeof(unsigned int));
-		ptrOrigRecord = (void*)((char*)ptrOrigRecord + szOfField);
-	}
+RC RecordBasedFileManager::insertRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *origData, RID &rid,
+		const RecordCodec* codec)
+{
+	//all pages modified by the record operation are committed to the log together
+	_pfm->beginOperation();
 
-	//write the last offset
-	*((unsigned int*)ptrEncDirRecord) = curOffset;
+	RC errCode = insertRecordInternal(fileHandle, recordDescriptor, origData, rid, codec);
 
-	//update size of the current field
-	newSzOfRecord += sizeof(unsigned int);
+	RC endCode = _pfm->endOperation(errCode);
+
+	return errCode != 0 ? errCode : endCode;
 }
 
-RC RecordBasedFileManager::insertRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *origData, RID &rid) {
+RC RecordBasedFileManager::insertRecordInternal(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *origData, RID &rid,
+		const RecordCodec* codec) {
 	RC errCode = 0;
 
 	//check if data is not NULL
@@ -432,13 +482,43 @@ RC RecordBasedFileManager::insertRecord(FileHandle &fileHandle, const vector<Att
 		return -11; //data is corrupted
 	}
 
-	//encode record
-	void* encData = malloc(PAGE_SIZE);
+	//encode record (encoded record adds the number of fields and field offsets to the original one)
+	unsigned int szOfRecord = codec != NULL ? codec->sizeOfRecord(origData) : sizeOfRecord(recordDescriptor, origData);
+	void* encData = malloc(szOfRecord + sizeof(unsigned int) * (recordDescriptor.size() + 2));
 	unsigned int szOfEncRecord = 0;
-	encodeRecord(recordDescriptor, origData, sizeOfRecord(recordDescriptor, origData), szOfEncRecord, encData);
+	if( codec != NULL )
+		codec->encodeRecord(origData, szOfEncRecord, encData);
+	else
+		encodeRecord(recordDescriptor, origData, szOfRecord, szOfEncRecord, encData);
+
+	//large VarChar values go to overflow pages
+	if( (errCode = storeOverflowFields(fileHandle, encData, szOfEncRecord)) != 0 )
+	{
+		free(encData);
+		return errCode;
+	}
+
+	//PAX page stores the record by attributes
+	if( fileHandle.getPageLayout() == LAYOUT_PAX )
+		errCode = insertPaxRecord(fileHandle, recordDescriptor, encData, PAX_SLOT_USED, rid);
+	else
+		errCode = insertEncodedRecord(fileHandle, encData, szOfEncRecord, rid);
+
+	//record was not inserted, so its overflow pages are not needed
+	if( errCode != 0 )
+		freeOverflowFields(fileHandle, encData);
+
+	free(encData);
+
+	return errCode;
+}
+
+RC RecordBasedFileManager::insertEncodedRecord(FileHandle &fileHandle, const void *encData, const unsigned int szOfEncRecord, RID &rid)
+{
+	RC errCode = 0;
 
 	//check if data is not greater than a max allowed space within the page
-	if( szOfEncRecord >= MAX_SIZE_OF_RECORD )
+	if( szOfEncRecord >= MAX_SIZE_OF_RECORD_IN_PAGE(fileHandle.getPageSize()) )
 	{
 		return -21;	//record exceeds page size (less required page meta-data)
 	}
@@ -449,9 +529,6 @@ RC RecordBasedFileManager::insertRecord(FileHandle &fileHandle, const vector<Att
 	PageNum datapagenum = 0, headerpagenum = 0;
 	if( (errCode = _pfm->getDataPage(fileHandle, szOfEncRecord, datapagenum, headerpagenum, freeSpaceLeft)) != 0 )
 	{
-		//free buffer used for encoded record
-		free(encData);
-
 		//return error code
 		return errCode;
 	}
@@ -461,20 +538,16 @@ RC RecordBasedFileManager::insertRecord(FileHandle &fileHandle, const vector<Att
 	unsigned int slotNum = 0;
 	if( (errCode = findRecordSlot(fileHandle, datapagenum, szOfEncRecord, pds, slotNum, freeSpaceLeft)) != 0 )
 	{
-		//free buffer used for encoded record
-		free(encData);
-
 		//return error code
 		return errCode;
 	}
 
 	//read data of the data page
-	char* dataPage = (char*)malloc(PAGE_SIZE);
-	memset(dataPage, 0, PAGE_SIZE);
+	char* dataPage = (char*)malloc(fileHandle.getPageSize());
+	memset(dataPage, 0, fileHandle.getPageSize());
 	if( (errCode = fileHandle.readPage(datapagenum, dataPage)) != 0 )
 	{
-		//free buffer used for encoded record
-		free(encData);
+		//free buffer used for the data page
 		free(dataPage);
 
 		//return error code
@@ -490,8 +563,7 @@ RC RecordBasedFileManager::insertRecord(FileHandle &fileHandle, const vector<Att
 	//write page to the file
 	if( (errCode = fileHandle.writePage(datapagenum, dataPage)) != 0 )
 	{
-		//free buffer used for encoded record
-		free(encData);
+		//free buffer used for the data page
 		free(dataPage);
 
 		//return error code
@@ -500,7 +572,6 @@ RC RecordBasedFileManager::insertRecord(FileHandle &fileHandle, const vector<Att
 
 	//deallocate dataPage
 	free(dataPage);
-	free(encData);
 
 	//assign rid
 	rid.pageNum = datapagenum;
@@ -513,116 +584,582 @@ RC RecordBasedFileManager::insertRecord(FileHandle &fileHandle, const vector<Att
 	return 0;
 }
 
-RC RecordBasedFileManager::readEncodedRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid, void *data) {
-    RC errCode = 0;
-
-    if( data == NULL )
-    {
-    	return -11; //data is corrupted
-    }
+RC RecordBasedFileManager::insertRecords(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const vector<const void*> &data, vector<RID> &rids,
+		const RecordCodec* codec)
+{
+	RC errCode = 0;
 
-    if( rid.pageNum == 0 || rid.pageNum >= fileHandle.getNumberOfPages() )
-    {
-    	return -27; //rid is not setup correctly
-    }
+	rids.clear();
 
-    //allocate array for storing contents of the data page
-    void* dataPage = malloc(PAGE_SIZE);
-    memset(dataPage, 0, PAGE_SIZE);
+	//batch is committed to the log in parts (pages of the operation in progress stay in the buffer pool until it commits)
+	unsigned int nextRecord = 0;
+	while( nextRecord < data.size() && errCode == 0 )
+	{
+		unsigned int numInserted = rids.size();
 
-    //read data page
-    if( (errCode = fileHandle.readPage(rid.pageNum, dataPage)) != 0 )
-    {
-    	//deallocate dataPage
-    	free(dataPage);
+		_pfm->beginOperation();
 
-    	//read failed
-    	return errCode;
-    }
+		errCode = insertRecordsInternal(fileHandle, recordDescriptor, data, nextRecord, rids, codec);
 
-    /*
-	 * data page has a following format:
-	 * [list of records without any spaces in between][free space for records][list of directory slots][(number of slots):unsigned int][(offset from page start to the start of free space):unsigned int]
-	 * ^                                                                      ^                       ^                                                                                                 ^
-	 * start of page                                                          start of dirSlot        end of dirSlot                                                                          end of page
-	 */
+		RC endCode = _pfm->endOperation(errCode);
+		if( errCode == 0 )
+			errCode = endCode;
 
-    //get pointer to the end of directory slots
-    PageDirSlot* ptrEndOfDirSlot = (PageDirSlot*)((char*)dataPage + PAGE_SIZE - 2 * sizeof(unsigned int));
+		//part that failed is rolled back, so its records are not inserted
+		if( errCode != 0 && _pfm->getLogManager() != NULL )
+			rids.resize(numInserted);
+	}
 
-    //find out number of directory slots
-    unsigned int numSlots = *((unsigned int*)ptrEndOfDirSlot);
+	return errCode;
+}
 
-    //check if rid is correct in terms of indexed slot
-    if( rid.slotNum >= numSlots )
-    {
-    	//deallocate data page
-    	free(dataPage);
+RC RecordBasedFileManager::insertRecordsInternal(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const vector<const void*> &data,
+		unsigned int &nextRecord, vector<RID> &rids, const RecordCodec* codec)
+{
+	RC errCode = 0;
 
-    	return -23; //rid is not setup correctly
-    }
+	//part of the batch ends once its pages could take up half of the buffer pool
+	BufferPool* pool = _pfm->getBufferPool();
+	unsigned int maxPages = pool->getNumFrames() / 2;
+	unsigned int firstRecord = nextRecord;
 
-    //get slot
-    PageDirSlot* curSlot = (PageDirSlot*)(ptrEndOfDirSlot - rid.slotNum - 1);
+	//PAX page is re-built by every insertion anyway, so records go in one by one
+	if( fileHandle.getPageLayout() == LAYOUT_PAX )
+	{
+		for( ; nextRecord < data.size(); nextRecord++ )
+		{
+			if( nextRecord > firstRecord && pool->getNumOperationPages() >= maxPages )
+				break;
 
-    //find slot offset
-    unsigned int offRecord = curSlot->_offRecord;
-    unsigned int szRecord = curSlot->_szRecord;
+			RID rid;
+			if( (errCode = insertRecordInternal(fileHandle, recordDescriptor, data[nextRecord], rid, codec)) != 0 )
+			{
+				return errCode;
+			}
+			rids.push_back(rid);
+		}
 
-    //check if slot attributes make sense
-    if( offRecord == 0 && szRecord == 0 )
-    {
-    	//deallocate data page
-    	free(dataPage);
+		return errCode;
+	}
 
-    	return -24;	//directory slot stores wrong information
-    }
+	//free-space map is kept in sync with the copies of header pages below, so that it finds the same pages as getDataPage
+	FreeSpaceMap* fsm = NULL;
+	if( (errCode = _pfm->getFreeSpaceMap(fileHandle, fsm)) != 0 )
+	{
+		return errCode;
+	}
 
-    //determine pointer to the record
-    char* ptrRecord = (char*)(dataPage) + offRecord;
+	unsigned int pageSize = fileHandle.getPageSize();
 
-    //begin section for project 2: in case the record in this page is a TombStone
-    if( szRecord == (unsigned int)-1 )
-    {
-    	//redirect to a different location; (page, slot) is specified in the record's body
-    	RID* ptrNewRid = (RID*)ptrRecord;
+	//copies of header pages and data pages touched by the batch (written once, after the last record is placed)
+	map<PageNum, void*> headerPages;
+	map< pair<PageNum, unsigned int>, BatchPage > pages;
 
-    	//now go ahead and try to read this record
-    	errCode = readEncodedRecord(fileHandle, recordDescriptor, *ptrNewRid, data);
+	//new data pages that are not allocated yet (in the order they were added)
+	vector< pair<PageNum, unsigned int> > newPages;
 
-    	//free data page (fixing memory leak)
-    	free(dataPage);
+	//buffer for the encoded record
+	void* encData = NULL;
 
-    	return errCode;
-    }
-    //end section for project 2
+	//record in encData has chains of overflow pages, but it is not placed into a page yet
+	bool isStored = false;
 
-    //copy encoded record contents
-    memcpy(data, ptrRecord, szRecord);
+	for( ; nextRecord < data.size(); nextRecord++ )
+	{
+		//copies of the pages are written at the end, along with the overflow pages of the records
+		if( nextRecord > firstRecord && pages.size() + headerPages.size() + pool->getNumOperationPages() >= maxPages )
+			break;
 
-    //deallocate data page
-    free(dataPage);
+		const void* record = data[nextRecord];
 
-    //return success
-    return errCode;
-}
+		//check if data is not NULL
+		if( record == NULL )
+		{
+			errCode = -11; //data is corrupted
+			break;
+		}
 
-RC RecordBasedFileManager::readRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid, void *data)
-{
-	RC errCode = 0;
+		//encode record (encoded record adds the number of fields and field offsets to the original one)
+		unsigned int szOfRecord = codec != NULL ? codec->sizeOfRecord(record) : sizeOfRecord(recordDescriptor, record);
+		encData = realloc(encData, szOfRecord + sizeof(unsigned int) * (recordDescriptor.size() + 2));
+		unsigned int szOfEncRecord = 0;
+		if( codec != NULL )
+			codec->encodeRecord(record, szOfEncRecord, encData);
+		else
+			encodeRecord(recordDescriptor, record, szOfRecord, szOfEncRecord, encData);
 
-	//allocate buffer for storing encoded record
-	void* encDataRecord = malloc(PAGE_SIZE);
+		//large VarChar values go to overflow pages
+		if( (errCode = storeOverflowFields(fileHandle, encData, szOfEncRecord)) != 0 )
+		{
+			break;
+		}
+		isStored = true;
 
-	//read encoded record
-	if( (errCode = readEncodedRecord(fileHandle, recordDescriptor, rid, encDataRecord)) != 0 )
-	{
-		return errCode;
-	}
+		//check if data is not greater than a max allowed space within the page
+		if( szOfEncRecord >= MAX_SIZE_OF_RECORD_IN_PAGE(pageSize) )
+		{
+			errCode = -21;	//record exceeds page size (less required page meta-data)
+			break;
+		}
 
-	//decode record
-	unsigned int decodedSz = 0;
-	decodeRecord(recordDescriptor, encDataRecord, decodedSz, data);
+		//same first-fit choice as getDataPage makes for a single record
+		PageNum headerPageId = 0;
+		unsigned int entryIndex = 0;
+		bool newPage = false;
+		if( fsm->findPage(szOfEncRecord + sizeof(PageDirSlot), headerPageId, entryIndex) == false )
+		{
+			//no page has enough space, so new data page is added to the last header page
+			headerPageId = fsm->getLastHeaderPage();
+			newPage = true;
+		}
+
+		//get copy of the header page
+		if( headerPages.find(headerPageId) == headerPages.end() )
+		{
+			void* headerPage = malloc(pageSize);
+			if( (errCode = fileHandle.readPage(headerPageId, headerPage)) != 0 )
+			{
+				free(headerPage);
+				break;
+			}
+			headerPages[headerPageId] = headerPage;
+		}
+		Header* hPage = (Header*)headerPages[headerPageId];
+
+		if( newPage )
+		{
+			//last header page is full, so new header page is linked after it
+			if( hPage->_numUsedPageIds >= fileHandle.getNumOfPageIds() )
+			{
+				//data pages of the full header page precede the new header page in the file
+				if( (errCode = allocateBatchPages(fileHandle, headerPages, pages, newPages, rids)) != 0 )
+				{
+					break;
+				}
+
+				void* newHeader = malloc(pageSize);
+				memset(newHeader, 0, pageSize);
+
+				PageNum nextPageId = 0;
+				if( (errCode = _pfm->allocatePage(fileHandle, newHeader, nextPageId)) != 0 )
+				{
+					free(newHeader);
+					break;
+				}
+
+				hPage->_nextHeaderPageId = nextPageId;
+				fsm->addHeaderPage(headerPageId, nextPageId);
+				fsm->syncHeaderPage(headerPageId, hPage);
+
+				headerPageId = nextPageId;
+				headerPages[headerPageId] = newHeader;
+				hPage = (Header*)newHeader;
+			}
+
+			//register empty page inside the header page (page directory occupies the last two integers of the page)
+			entryIndex = hPage->_numUsedPageIds;
+			hPage->_arrOfPageIds[entryIndex]._pageid = 0;
+			hPage->_arrOfPageIds[entryIndex]._numFreeBytes = pageSize - 2 * sizeof(unsigned int);
+			hPage->_numUsedPageIds++;
+
+			BatchPage page;
+			page._data = malloc(pageSize);
+			memset(page._data, 0, pageSize);
+			page._pageNum = 0;
+			page._isNew = true;
+			page._isDirty = false;
+
+			pages[make_pair(headerPageId, entryIndex)] = page;
+			newPages.push_back(make_pair(headerPageId, entryIndex));
+		}
+		else if( pages.find(make_pair(headerPageId, entryIndex)) == pages.end() )
+		{
+			//get copy of the existing data page
+			BatchPage page;
+			page._data = malloc(pageSize);
+			page._pageNum = hPage->_arrOfPageIds[entryIndex]._pageid;
+			page._isNew = false;
+			page._isDirty = false;
+
+			if( (errCode = fileHandle.readPage(page._pageNum, page._data)) != 0 )
+			{
+				free(page._data);
+				break;
+			}
+
+			pages[make_pair(headerPageId, entryIndex)] = page;
+		}
+		BatchPage& page = pages[make_pair(headerPageId, entryIndex)];
+
+		//get the place for the new record in the data page
+		PageDirSlot pds;
+		unsigned int slotNum = 0;
+		if( (errCode = reserveRecordSlot(page._data, pageSize, szOfEncRecord, pds, slotNum)) != 0 )
+		{
+			break;
+		}
+
+		//copy data of the record
+		memcpy((char*)page._data + pds._offRecord, encData, szOfEncRecord);
+		page._isDirty = true;
+		isStored = false;
+
+		//update free space left in the page
+		hPage->_arrOfPageIds[entryIndex]._numFreeBytes -= szOfEncRecord + sizeof(PageDirSlot);
+		fsm->syncHeaderPage(headerPageId, hPage);
+
+		//assign rid (page number of the new page is known once it is allocated)
+		RID rid;
+		rid.pageNum = page._pageNum;
+		rid.slotNum = slotNum;
+		page._ridIndexes.push_back(rids.size());
+		rids.push_back(rid);
+	}
+
+	//record the batch stopped at does not need its overflow pages
+	if( isStored )
+		freeOverflowFields(fileHandle, encData);
+
+	free(encData);
+
+	//records placed so far are written even if the batch stopped half way, and rids of them are returned
+	RC writeCode = allocateBatchPages(fileHandle, headerPages, pages, newPages, rids);
+	if( errCode == 0 )
+		errCode = writeCode;
+
+	map< pair<PageNum, unsigned int>, BatchPage >::iterator pageIter = pages.begin(), pageMax = pages.end();
+	for( ; pageIter != pageMax; pageIter++ )
+	{
+		if( pageIter->second._isNew == false && pageIter->second._isDirty )
+		{
+			writeCode = fileHandle.writePage(pageIter->second._pageNum, pageIter->second._data);
+			if( errCode == 0 )
+				errCode = writeCode;
+		}
+		free(pageIter->second._data);
+	}
+
+	map<PageNum, void*>::iterator headerIter = headerPages.begin(), headerMax = headerPages.end();
+	for( ; headerIter != headerMax; headerIter++ )
+	{
+		writeCode = fileHandle.writePage(headerIter->first, headerIter->second);
+		if( errCode == 0 )
+			errCode = writeCode;
+		free(headerIter->second);
+	}
+
+	return errCode;
+}
+
+RC RecordBasedFileManager::allocateBatchPages(FileHandle &fileHandle, map<PageNum, void*> &headerPages, map< pair<PageNum, unsigned int>, BatchPage > &pages,
+		vector< pair<PageNum, unsigned int> > &newPages, vector<RID> &rids)
+{
+	RC errCode = 0;
+
+	for( unsigned int i = 0; i < newPages.size(); i++ )
+	{
+		BatchPage& page = pages[newPages[i]];
+
+		//page is written along with its records
+		if( (errCode = _pfm->allocatePage(fileHandle, page._data, page._pageNum)) != 0 )
+		{
+			return errCode;
+		}
+
+		page._isNew = false;
+		page._isDirty = false;
+
+		//update entry of the header page and rids of the records
+		((Header*)headerPages[newPages[i].first])->_arrOfPageIds[newPages[i].second]._pageid = page._pageNum;
+
+		for( unsigned int j = 0; j < page._ridIndexes.size(); j++ )
+		{
+			rids[page._ridIndexes[j]].pageNum = page._pageNum;
+		}
+	}
+
+	newPages.clear();
+
+	//success
+	return 0;
+}
+
+RC RecordBasedFileManager::readEncodedRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid, void *data) {
+    RC errCode = 0;
+
+    if( data == NULL )
+    {
+    	return -11; //data is corrupted
+    }
+
+    if( rid.pageNum == 0 || rid.pageNum >= fileHandle.getNumberOfPages() )
+    {
+    	return -27; //rid is not setup correctly
+    }
+
+    //header page does not hold any records
+    if( isHeaderPage(fileHandle, rid.pageNum) )
+    {
+    	return -23;
+    }
+
+    //PAX page does not keep the record in one piece, so it is re-assembled from the minipages
+    if( fileHandle.getPageLayout() == LAYOUT_PAX )
+    {
+    	return readPaxRecord(fileHandle, recordDescriptor, rid, data);
+    }
+
+    //memory-mapped file: copy only the record, not the whole page
+    if( fileHandle._ioMode == IO_MMAP )
+    {
+    	const void* mappedRecord = NULL;
+    	unsigned int szMappedRecord = 0;
+
+    	if( (errCode = getMappedRecord(fileHandle, rid, mappedRecord, szMappedRecord)) != -72 )
+    	{
+    		if( errCode == 0 )
+    			memcpy(data, mappedRecord, szMappedRecord);
+
+    		return errCode;
+    	}
+
+    	errCode = 0;
+    }
+
+    //allocate array for storing contents of the data page
+    void* dataPage = malloc(fileHandle.getPageSize());
+    memset(dataPage, 0, fileHandle.getPageSize());
+
+    //read data page
+    if( (errCode = fileHandle.readPage(rid.pageNum, dataPage)) != 0 )
+    {
+    	//deallocate dataPage
+    	free(dataPage);
+
+    	//read failed
+    	return errCode;
+    }
+
+    /*
+	 * data page has a following format:
+	 * [list of records without any spaces in between][free space for records][list of directory slots][(number of slots):unsigned int][(offset from page start to the start of free space):unsigned int]
+	 * ^                                                                      ^                       ^                                                                                                 ^
+	 * start of page                                                          start of dirSlot        end of dirSlot                                                                          end of page
+	 */
+
+    //get pointer to the end of directory slots
+    PageDirSlot* ptrEndOfDirSlot = (PageDirSlot*)((char*)dataPage + fileHandle.getPageSize() - 2 * sizeof(unsigned int));
+
+    //find out number of directory slots
+    unsigned int numSlots = *((unsigned int*)ptrEndOfDirSlot);
+
+    //check if rid is correct in terms of indexed slot
+    if( rid.slotNum >= numSlots )
+    {
+    	//deallocate data page
+    	free(dataPage);
+
+    	return -23; //rid is not setup correctly
+    }
+
+    //get slot
+    PageDirSlot* curSlot = (PageDirSlot*)(ptrEndOfDirSlot - rid.slotNum - 1);
+
+    //find slot offset
+    unsigned int offRecord = curSlot->_offRecord;
+    unsigned int szRecord = curSlot->_szRecord;
+
+    //check if slot attributes make sense
+    if( offRecord == 0 && szRecord == 0 )
+    {
+    	//deallocate data page
+    	free(dataPage);
+
+    	return -24;	//directory slot stores wrong information
+    }
+
+    //determine pointer to the record
+    char* ptrRecord = (char*)(dataPage) + offRecord;
+
+    //begin section for project 2: in case the record in this page is a TombStone
+    if( szRecord == (unsigned int)-1 )
+    {
+    	//redirect to a different location; (page, slot) is specified in the record's body
+    	RID* ptrNewRid = (RID*)ptrRecord;
+
+    	__sync_fetch_and_add(&fileHandle._info->_forwardedReadCounter, 1);
+
+    	//now go ahead and try to read this record
+    	errCode = readEncodedRecord(fileHandle, recordDescriptor, *ptrNewRid, data);
+
+    	//free data page (fixing memory leak)
+    	free(dataPage);
+
+    	return errCode;
+    }
+    //end section for project 2
+
+    //copy encoded record contents
+    memcpy(data, ptrRecord, szRecord);
+
+    //deallocate data page
+    free(dataPage);
+
+    //return success
+    return errCode;
+}
+
+bool RecordBasedFileManager::isHeaderPage(FileHandle &fileHandle, const PageNum pageNum)
+{
+	FreeSpaceMap* fsm = NULL;
+	if( _pfm->getFreeSpaceMap(fileHandle, fsm) == 0 && fsm->isHeaderPage(pageNum) )
+		return true;
+
+	PageAllocMap* allocMap = NULL;
+	return _pfm->getAllocMap(fileHandle, allocMap) == 0 && allocMap->isMapPage(pageNum);
+}
+
+bool RecordBasedFileManager::isDataPage(FileHandle &fileHandle, const PageNum pageNum)
+{
+	//data pages are the ones listed by header pages
+	FreeSpaceMap* fsm = NULL;
+	PageNum headerPageId = 0;
+	if( _pfm->getFreeSpaceMap(fileHandle, fsm) != 0 )
+		return isHeaderPage(fileHandle, pageNum) == false;
+
+	return fsm->findHeaderOfDataPage(pageNum, headerPageId);
+}
+
+RC RecordBasedFileManager::getMappedRecord(FileHandle &fileHandle, const RID &rid, const void*& encodedRecord, unsigned int& szRecord)
+{
+	RC errCode = 0;
+
+	if( rid.pageNum == 0 || rid.pageNum >= fileHandle.getNumberOfPages() )
+	{
+		return -27; //rid is not setup correctly
+	}
+
+	//header page does not hold any records
+	if( isHeaderPage(fileHandle, rid.pageNum) )
+	{
+		return -23;
+	}
+
+	//record of the PAX page is scattered across minipages, so it has to be copied
+	if( fileHandle.getPageLayout() == LAYOUT_PAX )
+	{
+		return -72;
+	}
+
+	//get pointer to the data page inside the mapping
+	const void* dataPage = NULL;
+	if( (errCode = fileHandle.readMappedPage(rid.pageNum, dataPage)) != 0 )
+	{
+		return errCode;
+	}
+
+	//get pointer to the end of directory slots (same page format as in readEncodedRecord)
+	const PageDirSlot* ptrEndOfDirSlot = (const PageDirSlot*)((const char*)dataPage + fileHandle.getPageSize() - 2 * sizeof(unsigned int));
+
+	//find out number of directory slots
+	unsigned int numSlots = *((const unsigned int*)ptrEndOfDirSlot);
+
+	//check if rid is correct in terms of indexed slot
+	if( rid.slotNum >= numSlots )
+	{
+		return -23; //rid is not setup correctly
+	}
+
+	//get slot
+	const PageDirSlot* curSlot = ptrEndOfDirSlot - rid.slotNum - 1;
+
+	//check if slot attributes make sense
+	if( curSlot->_offRecord == 0 && curSlot->_szRecord == 0 )
+	{
+		return -24;	//directory slot stores wrong information
+	}
+
+	const char* ptrRecord = (const char*)dataPage + curSlot->_offRecord;
+
+	//TombStone: redirect to a different location; (page, slot) is specified in the record's body
+	if( curSlot->_szRecord == (unsigned int)-1 )
+	{
+		__sync_fetch_and_add(&fileHandle._info->_forwardedReadCounter, 1);
+
+		return getMappedRecord(fileHandle, *((const RID*)ptrRecord), encodedRecord, szRecord);
+	}
+
+	encodedRecord = ptrRecord;
+	szRecord = curSlot->_szRecord;
+
+	//success
+	return 0;
+}
+
+RC RecordBasedFileManager::readRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid, void *data,
+		const RecordCodec* codec)
+{
+	RC errCode = 0;
+
+	unsigned int decodedSz = 0;
+
+	//memory-mapped file: decode record straight from the mapping
+	if( fileHandle._ioMode == IO_MMAP )
+	{
+		const void* mappedRecord = NULL;
+		unsigned int szMappedRecord = 0;
+
+		if( (errCode = getMappedRecord(fileHandle, rid, mappedRecord, szMappedRecord)) != -72 )
+		{
+			//values of overflow pages are put in place before the record is decoded
+			void* fullRecord = NULL;
+			if( errCode == 0 && hasOverflowFields(mappedRecord) && (errCode = inlineOverflowFields(fileHandle, mappedRecord, fullRecord)) == 0 )
+				mappedRecord = fullRecord;
+
+			if( errCode == 0 && codec != NULL )
+				codec->decodeRecord(mappedRecord, decodedSz, data);
+			else if( errCode == 0 )
+				decodeRecord(recordDescriptor, mappedRecord, decodedSz, data);
+
+			free(fullRecord);
+
+			return errCode;
+		}
+	}
+
+	//allocate buffer for storing encoded record
+	void* encDataRecord = malloc(fileHandle.getPageSize());
+
+	//read encoded record
+	if( (errCode = readEncodedRecord(fileHandle, recordDescriptor, rid, encDataRecord)) != 0 )
+	{
+		free(encDataRecord);
+		return errCode;
+	}
+
+	//values of overflow pages are put in place before the record is decoded
+	if( hasOverflowFields(encDataRecord) )
+	{
+		void* fullRecord = NULL;
+		if( (errCode = inlineOverflowFields(fileHandle, encDataRecord, fullRecord)) != 0 )
+		{
+			free(fullRecord);
+			free(encDataRecord);
+			return errCode;
+		}
+
+		free(encDataRecord);
+		encDataRecord = fullRecord;
+	}
+
+	//decode record
+	if( codec != NULL )
+		codec->decodeRecord(encDataRecord, decodedSz, data);
+	else
+		decodeRecord(recordDescriptor, encDataRecord, decodedSz, data);
+
+	//deallocate buffer (fixing memory leak)
+	free(encDataRecord);
 
 	//added
 		//printFile(fileHandle);
@@ -768,17 +1305,56 @@ unsigned int sizeOfRecord(const vector<Attribute> &recordDescriptor, const void
 	return size;
 }
 
-/////////////////////////////////PROJECT_2///RBFM_PART
-
-RC RecordBasedFileManager::deleteRecords(FileHandle &fileHandle)
+void getFieldIndexes(const vector<Attribute> &recordDescriptor, vector<unsigned int> &fieldIndexes)
 {
-	RC errCode = 0;
+	unsigned int numFixedFields = 0, numVarFields = 0;
 
-	//allocate array for storing contents of the data page
-	void* dataPage = malloc(PAGE_SIZE);
-	memset(dataPage, 0, PAGE_SIZE);
+	fieldIndexes.resize(recordDescriptor.size());
+	for( unsigned int i = 0; i < recordDescriptor.size(); i++ )
+		fieldIndexes[i] = recordDescriptor[i].type == TypeVarChar ? numVarFields++ : numFixedFields++;
+}
 
-	//define page index
+void getEncodedField(const void *encodedRecord, const unsigned int position, const AttrType type, const unsigned int fieldIndex,
+		const char *&ptrField, unsigned int &szOfField, bool &isOverflow, bool &isNull)
+{
+	ptrField = NULL;
+	szOfField = 0;
+	isOverflow = false;
+
+	//record inserted before the attribute was added
+	const RecordHeader* header = (const RecordHeader*)encodedRecord;
+	isNull = position >= header->_numFields || RECORD_FIELD_IS_NULL(encodedRecord, position);
+	if( isNull )
+		return;
+
+	//TypeInt/TypeReal value is at the static offset
+	if( type != TypeVarChar )
+	{
+		ptrField = (const char*)encodedRecord + RECORD_FIXED_OFFSET(header->_numFields, header->_numVarFields) + fieldIndex * sizeof(unsigned int);
+		szOfField = sizeof(unsigned int);
+		return;
+	}
+
+	//characters of VarChar value start where the previous one ends
+	const unsigned int* ptrDir = (const unsigned int*)((const char*)encodedRecord + RECORD_DIR_OFFSET(header->_numFields));
+	unsigned int begin = fieldIndex == 0 ? RECORD_VARCHAR_OFFSET(header->_numFields) : FIELD_OFFSET(ptrDir[fieldIndex - 1]);
+
+	ptrField = (const char*)encodedRecord + begin;
+	szOfField = FIELD_OFFSET(ptrDir[fieldIndex]) - begin;
+	isOverflow = (ptrDir[fieldIndex] & OVERFLOW_FIELD_FLAG) != 0;
+}
+
+/////////////////////////////////PROJECT_2///RBFM_PART
+
+RC RecordBasedFileManager::deleteRecords(FileHandle &fileHandle)
+{
+	RC errCode = 0;
+
+	//allocate array for storing contents of the data page
+	void* dataPage = malloc(fileHandle.getPageSize());
+	memset(dataPage, 0, fileHandle.getPageSize());
+
+	//define page index
 	PageNum pagenum = 0;
 
 	//determine max number of pages
@@ -792,6 +1368,12 @@ RC RecordBasedFileManager::deleteRecords(FileHandle &fileHandle)
 		if( pagenum == 0 )
 		{
 			((Header*)dataPage)->_totFileSize = 1;
+			((Header*)dataPage)->_pageSize = fileHandle.getPhysicalPageSize();
+			((Header*)dataPage)->_pageChecksums = fileHandle.hasPageChecksums() ? 1 : 0;
+			((Header*)dataPage)->_pageCompression = fileHandle.hasPageCompression() ? 1 : 0;
+			((Header*)dataPage)->_pageLayout = fileHandle.getPageLayout();
+			((Header*)dataPage)->_magic = FILE_FORMAT_MAGIC;
+			((Header*)dataPage)->_formatVersion = FILE_FORMAT_VERSION;
 		}
 
 		if( (errCode = fileHandle.writePage(pagenum, dataPage)) != 0 )
@@ -819,11 +1401,36 @@ RC RecordBasedFileManager::deleteRecords(FileHandle &fileHandle)
 }
 
 RC RecordBasedFileManager::deleteRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid)
+{
+	//all pages modified by the record operation are committed to the log together
+	_pfm->beginOperation();
+
+	RC errCode = deleteRecordInternal(fileHandle, recordDescriptor, rid);
+
+	RC endCode = _pfm->endOperation(errCode);
+
+	return errCode != 0 ? errCode : endCode;
+}
+
+RC RecordBasedFileManager::deleteRecordInternal(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid)
 {
 	RC errCode = 0;
 
+	if( fileHandle.getPageLayout() == LAYOUT_PAX )
+	{
+		//record is read first, so that its overflow pages are freed once it is deleted
+		void* deletedRecord = malloc(fileHandle.getPageSize());
+		bool hasOverflow = readEncodedRecord(fileHandle, recordDescriptor, rid, deletedRecord) == 0 && hasOverflowFields(deletedRecord);
+
+		if( (errCode = deletePaxRecord(fileHandle, rid)) == 0 && hasOverflow )
+			errCode = freeOverflowFields(fileHandle, deletedRecord);
+
+		free(deletedRecord);
+		return errCode;
+	}
+
 	//allocate buffer for storing page data
-	void* dataPage = malloc(PAGE_SIZE);
+	void* dataPage = malloc(fileHandle.getPageSize());
 
 	//read a data page pointed by rid
 	if( (errCode = fileHandle.readPage(rid.pageNum, dataPage)) != 0 )
@@ -842,11 +1449,31 @@ RC RecordBasedFileManager::deleteRecord(FileHandle &fileHandle, const vector<Att
 	 * start of page                                                          start of dirSlot        end of dirSlot                                                                          end of page
 	 */
 	//determine pointer to the end of the list of directory slots
-	PageDirSlot* endOfDirSlot = (PageDirSlot*)((char*)dataPage + PAGE_SIZE - sizeof(unsigned int) - sizeof(unsigned int));
+	PageDirSlot* endOfDirSlot = (PageDirSlot*)((char*)dataPage + fileHandle.getPageSize() - sizeof(unsigned int) - sizeof(unsigned int));
 
 	//find proper slot number pointed by rid
 	PageDirSlot* curDirSlot = endOfDirSlot - (rid.slotNum + 1);
 
+	//TombStone: record is deleted at the place it was moved to as well (TombStones never point at other TombStones)
+	if( curDirSlot->_szRecord == (unsigned int)-1 )
+	{
+		RID movedRid = *((RID*)((char*)dataPage + curDirSlot->_offRecord));
+
+		if( (movedRid.pageNum != rid.pageNum || movedRid.slotNum != rid.slotNum) &&
+			(errCode = deleteRecordInternal(fileHandle, recordDescriptor, movedRid)) != 0 )
+		{
+			free(dataPage);
+			return errCode;
+		}
+
+		//page is read again, since the record may have been moved into this very page
+		if( (errCode = fileHandle.readPage(rid.pageNum, dataPage)) != 0 )
+		{
+			free(dataPage);
+			return errCode;
+		}
+	}
+
 	/*
 	//update header page
 	//define variable to store id of the header page
@@ -863,8 +1490,8 @@ RC RecordBasedFileManager::deleteRecord(FileHandle &fileHandle, const vector<Att
 	}
 
 	//set free size for this data page inside the appropriate header page
-	void* data = malloc(PAGE_SIZE);
-	memset(data, 0, PAGE_SIZE);
+	void* data = malloc(fileHandle.getPageSize());
+	memset(data, 0, fileHandle.getPageSize());
 
 	//get the found header page
 	if( (errCode = fileHandle.readPage((PageNum)headerPage, data)) != 0 )
@@ -896,6 +1523,11 @@ RC RecordBasedFileManager::deleteRecord(FileHandle &fileHandle, const vector<Att
 	free(data);
 	*/
 
+	//regular record gives back its overflow pages (record a TombStone points to has given back its own above)
+	const char* ptrRecord = (const char*)dataPage + curDirSlot->_offRecord;
+	bool hasOverflow = (curDirSlot->_offRecord != 0 || curDirSlot->_szRecord != 0) && curDirSlot->_szRecord != (unsigned int)-1 &&
+			hasOverflowFields(ptrRecord);
+
 	//null the contents of this slot
 	curDirSlot->_offRecord = 0;
 	curDirSlot->_szRecord = 0;
@@ -910,6 +1542,10 @@ RC RecordBasedFileManager::deleteRecord(FileHandle &fileHandle, const vector<Att
 		return errCode;
 	}
 
+	//record stays inside the copy of the page
+	if( hasOverflow )
+		errCode = freeOverflowFields(fileHandle, ptrRecord);
+
 	//free data page
 	free(dataPage);
 
@@ -920,12 +1556,81 @@ RC RecordBasedFileManager::deleteRecord(FileHandle &fileHandle, const vector<Att
 	return errCode;
 }
 
-RC RecordBasedFileManager::updateRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *origData, const RID &rid)
+RC RecordBasedFileManager::updateRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *origData, const RID &rid,
+		const RecordCodec* codec)
+{
+	//all pages modified by the record operation are committed to the log together
+	_pfm->beginOperation();
+
+	RC errCode = updateRecordInternal(fileHandle, recordDescriptor, origData, rid, codec);
+
+	RC endCode = _pfm->endOperation(errCode);
+
+	return errCode != 0 ? errCode : endCode;
+}
+
+RC RecordBasedFileManager::updateRecordInternal(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *origData, const RID &rid,
+		const RecordCodec* codec)
+{
+	RC errCode = 0;
+
+	//encode record (encoded record adds the number of fields and field offsets to the original one)
+	unsigned int szOfRecord = codec != NULL ? codec->sizeOfRecord(origData) : sizeOfRecord(recordDescriptor, origData);
+	void* encRecordData = malloc(szOfRecord + sizeof(unsigned int) * (recordDescriptor.size() + 2));
+	unsigned int szOfEncRecord = 0;
+	if( codec != NULL )
+		codec->encodeRecord(origData, szOfEncRecord, encRecordData);
+	else
+		encodeRecord(recordDescriptor, origData, szOfRecord, szOfEncRecord, encRecordData);
+
+	//large VarChar values go to overflow pages
+	if( (errCode = storeOverflowFields(fileHandle, encRecordData, szOfEncRecord)) != 0 )
+	{
+		free(encRecordData);
+		return errCode;
+	}
+
+	//copy of the replaced record, if its overflow pages have to be freed
+	void* replacedRecord = NULL;
+
+	if( fileHandle.getPageLayout() == LAYOUT_PAX )
+	{
+		replacedRecord = malloc(fileHandle.getPageSize());
+		if( readEncodedRecord(fileHandle, recordDescriptor, rid, replacedRecord) != 0 || hasOverflowFields(replacedRecord) == false )
+		{
+			free(replacedRecord);
+			replacedRecord = NULL;
+		}
+
+		//put record in place of the old one (or move it)
+		errCode = updatePaxRecord(fileHandle, recordDescriptor, encRecordData, rid);
+	}
+	else
+	{
+		errCode = updateRowRecord(fileHandle, recordDescriptor, encRecordData, szOfEncRecord, rid, replacedRecord);
+	}
+
+	//old values leave overflow pages once they are replaced, and new ones if they could not replace them
+	if( errCode == 0 && replacedRecord != NULL )
+		errCode = freeOverflowFields(fileHandle, replacedRecord);
+	else if( errCode != 0 )
+		freeOverflowFields(fileHandle, encRecordData);
+
+	free(replacedRecord);
+	free(encRecordData);
+
+	return errCode;
+}
+
+RC RecordBasedFileManager::updateRowRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *encRecordData, const unsigned int szOfEncRecord,
+		const RID &rid, void*& replacedRecord)
 {
 	RC errCode = 0;
 
+	replacedRecord = NULL;
+
 	//allocate buffer for storing page data pointed by rid
-	void* dataPage = malloc(PAGE_SIZE);
+	void* dataPage = malloc(fileHandle.getPageSize());
 
 	//read a data page
 	if( (errCode = fileHandle.readPage(rid.pageNum, dataPage)) != 0 )
@@ -944,7 +1649,7 @@ RC RecordBasedFileManager::updateRecord(FileHandle &fileHandle, const vector<Att
 	 * start of page                                                          start of dirSlot        end of dirSlot                                                                          end of page
 	 */
 	//determine pointer to the end of the list of directory slots
-	PageDirSlot* endOfDirSlot = (PageDirSlot*)((char*)dataPage + PAGE_SIZE - sizeof(unsigned int) - sizeof(unsigned int));
+	PageDirSlot* endOfDirSlot = (PageDirSlot*)((char*)dataPage + fileHandle.getPageSize() - sizeof(unsigned int) - sizeof(unsigned int));
 
 	//get a pointer to the current slot
 	PageDirSlot* curDirSlot = endOfDirSlot - (rid.slotNum + 1);
@@ -952,10 +1657,22 @@ RC RecordBasedFileManager::updateRecord(FileHandle &fileHandle, const vector<Att
 	//get a pointer to the "old record"
 	char* oldRecord = (char*)dataPage + curDirSlot->_offRecord;
 
-	//encode record
-	void* encRecordData = malloc(PAGE_SIZE);
-	unsigned int szOfEncRecord = 0;
-	encodeRecord(recordDescriptor, origData, sizeOfRecord(recordDescriptor, origData), szOfEncRecord, encRecordData);
+	//TombStone: record is updated at the place it was moved to (or brought back into this page)
+	if( curDirSlot->_szRecord == (unsigned int)-1 )
+	{
+		errCode = updateForwardedRecord(fileHandle, encRecordData, szOfEncRecord, rid, dataPage, curDirSlot, replacedRecord);
+
+		free(dataPage);
+
+		return errCode;
+	}
+
+	//regular record is copied if it has overflow pages
+	if( (curDirSlot->_offRecord != 0 || curDirSlot->_szRecord != 0) && curDirSlot->_szRecord != (unsigned int)-1 && hasOverflowFields(oldRecord) )
+	{
+		replacedRecord = malloc(curDirSlot->_szRecord);
+		memcpy(replacedRecord, oldRecord, curDirSlot->_szRecord);
+	}
 
 	//newSize = sizeOfRecord(recordDescriptor, data),
 	//determine if the sizes of the old record (stored in a file) and a new one (stored in data) are the same
@@ -973,7 +1690,6 @@ RC RecordBasedFileManager::updateRecord(FileHandle &fileHandle, const vector<Att
 		{
 			//free data page
 			free(dataPage);
-			free(encRecordData);
 
 			//return error code
 			return errCode;
@@ -986,6 +1702,19 @@ RC RecordBasedFileManager::updateRecord(FileHandle &fileHandle, const vector<Att
 		return errCode;
 	}
 
+	//record keeps its place in the page (no TombStone) if the page has room for it once its records are packed together
+	if( placeRowRecord(dataPage, fileHandle.getPageSize(), rid.slotNum, encRecordData, szOfEncRecord) == 0 )
+	{
+		if( (errCode = fileHandle.writePage(rid.pageNum, dataPage)) == 0 )
+		{
+			errCode = setPageFreeSpace(fileHandle, rid.pageNum, getRowPageFreeSpace(dataPage, fileHandle.getPageSize()));
+		}
+
+		free(dataPage);
+
+		return errCode;
+	}
+
 	/*
 	 * if size is not the same, then:
 	 *	=> insert a new record to which TombStone will be pointing to
@@ -1031,7 +1760,6 @@ RC RecordBasedFileManager::updateRecord(FileHandle &fileHandle, const vector<Att
 
 			//free data page
 			free(dataPage);
-			free(encRecordData);
 
 			//fail
 			return -25;
@@ -1050,16 +1778,30 @@ RC RecordBasedFileManager::updateRecord(FileHandle &fileHandle, const vector<Att
 
 	//insert a new record
 	RID newRid = {0,0};
-	if( (errCode = insertRecord(fileHandle, recordDescriptor, origData, newRid)) != 0 )
+	if( (errCode = insertEncodedRecord(fileHandle, encRecordData, szOfEncRecord, newRid)) != 0 )
 	{
 		//free data page
 		free(dataPage);
-		free(encRecordData);
 
 		//return error code
 		return errCode;
 	}
 
+	//record may have been moved into this very page, so TombStone goes into the copy of the page that has it
+	if( newRid.pageNum == rid.pageNum )
+	{
+		if( (errCode = fileHandle.readPage(rid.pageNum, dataPage)) != 0 )
+		{
+			//free data page
+			free(dataPage);
+
+			//return error code
+			return errCode;
+		}
+
+		oldRecord = (char*)dataPage + curDirSlot->_offRecord;
+	}
+
 	//change entry in directory slot <offset remains the same, size becomes -1>, i.e. the illegal value
 	curDirSlot->_szRecord = (unsigned int)-1;
 
@@ -1073,15 +1815,15 @@ RC RecordBasedFileManager::updateRecord(FileHandle &fileHandle, const vector<Att
 	{
 		//free data page
 		free(dataPage);
-		free(encRecordData);
 
 		//return error code
 		return errCode;
 	}
 
+	__sync_fetch_and_add(&fileHandle._info->_forwardedRecordCounter, 1);
+
 	//free data page
 	free(dataPage);
-	free(encRecordData);
 
 	//added
 		//printFile(fileHandle);
@@ -1090,6 +1832,226 @@ RC RecordBasedFileManager::updateRecord(FileHandle &fileHandle, const vector<Att
 	return errCode;
 }
 
+RC RecordBasedFileManager::updateForwardedRecord(FileHandle &fileHandle, const void *encRecordData, const unsigned int szOfEncRecord, const RID &rid,
+		void *homePage, PageDirSlot *homeSlot, void*& replacedRecord)
+{
+	RC errCode = 0;
+	unsigned int pageSize = fileHandle.getPageSize();
+
+	//place the record was moved to
+	RID movedRid = *((RID*)((char*)homePage + homeSlot->_offRecord));
+
+	//record moved into its own page is updated inside the copy of the home page
+	bool isSamePage = movedRid.pageNum == rid.pageNum;
+	char* movedPage = isSamePage ? (char*)homePage : (char*)malloc(pageSize);
+
+	if( isSamePage == false && (errCode = fileHandle.readPage(movedRid.pageNum, movedPage)) != 0 )
+	{
+		free(movedPage);
+		return errCode;
+	}
+
+	//slot of the moved record has to hold a regular record
+	PageDirSlot* endOfMovedDirSlot = (PageDirSlot*)(movedPage + pageSize - 2 * sizeof(unsigned int));
+	PageDirSlot* movedSlot = endOfMovedDirSlot - (movedRid.slotNum + 1);
+	if( movedRid.slotNum >= *((unsigned int*)endOfMovedDirSlot) || (movedSlot->_offRecord == 0 && movedSlot->_szRecord == 0) ||
+		movedSlot->_szRecord == (unsigned int)-1 )
+	{
+		if( isSamePage == false )
+			free(movedPage);
+		return -24;	//TombStone points at the deleted record
+	}
+
+	char* movedRecord = movedPage + movedSlot->_offRecord;
+	if( hasOverflowFields(movedRecord) )
+	{
+		replacedRecord = malloc(movedSlot->_szRecord);
+		memcpy(replacedRecord, movedRecord, movedSlot->_szRecord);
+	}
+
+	//record still fits into its place, so it is updated where it is
+	if( szOfEncRecord <= movedSlot->_szRecord )
+	{
+		memcpy(movedRecord, encRecordData, szOfEncRecord);
+
+		errCode = fileHandle.writePage(movedRid.pageNum, movedPage);
+
+		if( isSamePage == false )
+			free(movedPage);
+		return errCode;
+	}
+
+	//moved record gives up its place, and the record goes back into its home slot if its home page has room for it
+	PageDirSlot savedMovedSlot = *movedSlot;
+	if( isSamePage )
+	{
+		movedSlot->_offRecord = 0;
+		movedSlot->_szRecord = 0;
+	}
+
+	if( placeRowRecord(homePage, pageSize, rid.slotNum, encRecordData, szOfEncRecord) == 0 )
+	{
+		if( (errCode = fileHandle.writePage(rid.pageNum, homePage)) == 0 &&
+			(errCode = setPageFreeSpace(fileHandle, rid.pageNum, getRowPageFreeSpace(homePage, pageSize))) == 0 &&
+			isSamePage == false )
+		{
+			//page the record was moved to gets its space back (and its header page entry says so)
+			movedSlot->_offRecord = 0;
+			movedSlot->_szRecord = 0;
+			packRowRecords(movedPage, pageSize);
+
+			if( (errCode = fileHandle.writePage(movedRid.pageNum, movedPage)) == 0 )
+				errCode = setPageFreeSpace(fileHandle, movedRid.pageNum, getRowPageFreeSpace(movedPage, pageSize));
+		}
+
+		if( errCode == 0 )
+			__sync_fetch_and_add(&fileHandle._info->_migratedRecordCounter, 1);
+
+		if( isSamePage == false )
+			free(movedPage);
+		return errCode;
+	}
+
+	if( isSamePage )
+	{
+		*movedSlot = savedMovedSlot;
+	}
+	else
+	{
+		free(movedPage);
+	}
+
+	//otherwise record is inserted into another page
+	RID newRid = {0, 0};
+	if( (errCode = insertEncodedRecord(fileHandle, encRecordData, szOfEncRecord, newRid)) != 0 )
+	{
+		return errCode;
+	}
+
+	//former place of the moved record is freed (page is read again, since the insertion may have used it)
+	movedPage = (char*)malloc(pageSize);
+	if( (errCode = fileHandle.readPage(movedRid.pageNum, movedPage)) == 0 )
+	{
+		movedSlot = (PageDirSlot*)(movedPage + pageSize - 2 * sizeof(unsigned int)) - (movedRid.slotNum + 1);
+		movedSlot->_offRecord = 0;
+		movedSlot->_szRecord = 0;
+		packRowRecords(movedPage, pageSize);
+
+		if( (errCode = fileHandle.writePage(movedRid.pageNum, movedPage)) == 0 )
+			errCode = setPageFreeSpace(fileHandle, movedRid.pageNum, getRowPageFreeSpace(movedPage, pageSize));
+	}
+
+	//TombStone is re-pointed at the new place (in the fresh copy of the home page, for the same reason)
+	if( errCode == 0 && (errCode = fileHandle.readPage(rid.pageNum, movedPage)) == 0 )
+	{
+		PageDirSlot* curHomeSlot = (PageDirSlot*)(movedPage + pageSize - 2 * sizeof(unsigned int)) - (rid.slotNum + 1);
+		RID* tombStone = (RID*)(movedPage + curHomeSlot->_offRecord);
+		tombStone->pageNum = newRid.pageNum;
+		tombStone->slotNum = newRid.slotNum;
+
+		errCode = fileHandle.writePage(rid.pageNum, movedPage);
+	}
+
+	if( errCode == 0 )
+		__sync_fetch_and_add(&fileHandle._info->_forwardedRecordCounter, 1);
+
+	free(movedPage);
+
+	return errCode;
+}
+
+RC RecordBasedFileManager::placeRowRecord(void* data, const unsigned int pageSize, const unsigned int slotNum, const void *encData, const unsigned int szOfEncRecord)
+{
+	//see readEncodedRecord for the format of the page
+	char* page = (char*)data;
+	PageDirSlot* endOfDirSlot = (PageDirSlot*)(page + pageSize - 2 * sizeof(unsigned int));
+	unsigned int numSlots = *((unsigned int*)endOfDirSlot);
+	unsigned int* ptrVarForFreeSpace = (unsigned int*)endOfDirSlot + 1;
+	PageDirSlot* startOfDirSlot = endOfDirSlot - numSlots;
+	PageDirSlot* curSlot = endOfDirSlot - (slotNum + 1);
+	unsigned int endOfRecords = (unsigned int)((char*)startOfDirSlot - page);
+
+	if( slotNum >= numSlots )
+	{
+		return -23;
+	}
+
+	//record goes to the start of free space, if there is enough of it
+	if( *ptrVarForFreeSpace <= endOfRecords && endOfRecords - *ptrVarForFreeSpace >= szOfEncRecord )
+	{
+		memcpy(page + *ptrVarForFreeSpace, encData, szOfEncRecord);
+		curSlot->_offRecord = *ptrVarForFreeSpace;
+		curSlot->_szRecord = szOfEncRecord;
+		*ptrVarForFreeSpace += szOfEncRecord;
+
+		return 0;
+	}
+
+	//otherwise there has to be enough space once the other records (TombStones keep their RIDs) are packed together
+	unsigned int szOfRecords = 0;
+	for( PageDirSlot* slot = startOfDirSlot; slot != endOfDirSlot; slot++ )
+	{
+		if( slot == curSlot || (slot->_offRecord == 0 && slot->_szRecord == 0) )
+			continue;
+
+		szOfRecords += slot->_szRecord == (unsigned int)-1 ? TOMBSTONE_SIZE : slot->_szRecord;
+	}
+
+	if( szOfRecords + szOfEncRecord > endOfRecords )
+	{
+		return -22;	//page does not have enough space
+	}
+
+	//pack the other records in the order of their slots, and put the record after them
+	unsigned int offRecord = packRowRecords(data, pageSize, curSlot);
+
+	memcpy(page + offRecord, encData, szOfEncRecord);
+	curSlot->_offRecord = offRecord;
+	curSlot->_szRecord = szOfEncRecord;
+	*ptrVarForFreeSpace = offRecord + szOfEncRecord;
+
+	//success
+	return 0;
+}
+
+unsigned int RecordBasedFileManager::packRowRecords(void* data, const unsigned int pageSize, const PageDirSlot* skipSlot)
+{
+	//see readEncodedRecord for the format of the page
+	char* page = (char*)data;
+	PageDirSlot* endOfDirSlot = (PageDirSlot*)(page + pageSize - 2 * sizeof(unsigned int));
+	PageDirSlot* startOfDirSlot = endOfDirSlot - *((unsigned int*)endOfDirSlot);
+
+	//records are copied aside first, since the packed ones may overlap their former places (TombStones keep their RIDs)
+	char* packedRecords = (char*)malloc(pageSize);
+	unsigned int offRecord = 0;
+	for( PageDirSlot* slot = endOfDirSlot - 1; slot >= startOfDirSlot; slot-- )
+	{
+		if( slot == skipSlot || (slot->_offRecord == 0 && slot->_szRecord == 0) )
+			continue;
+
+		unsigned int szOfRecord = slot->_szRecord == (unsigned int)-1 ? TOMBSTONE_SIZE : slot->_szRecord;
+		memcpy(packedRecords + offRecord, page + slot->_offRecord, szOfRecord);
+		slot->_offRecord = offRecord;
+		offRecord += szOfRecord;
+	}
+
+	memcpy(page, packedRecords, offRecord);
+	*((unsigned int*)endOfDirSlot + 1) = offRecord;
+
+	free(packedRecords);
+
+	return offRecord;
+}
+
+unsigned int RecordBasedFileManager::getRowPageFreeSpace(const void* data, const unsigned int pageSize)
+{
+	const PageDirSlot* endOfDirSlot = (const PageDirSlot*)((const char*)data + pageSize - 2 * sizeof(unsigned int));
+	unsigned int endOfRecords = (unsigned int)((const char*)(endOfDirSlot - *((const unsigned int*)endOfDirSlot)) - (const char*)data);
+	unsigned int offFreeSpace = *((const unsigned int*)endOfDirSlot + 1);
+
+	return offFreeSpace < endOfRecords ? endOfRecords - offFreeSpace : 0;
+}
+
 RC RecordBasedFileManager::readAttribute(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid, const string attributeName, void *data)
 {
 	RC errCode = 0;
@@ -1101,7 +2063,7 @@ RC RecordBasedFileManager::readAttribute(FileHandle &fileHandle, const vector<At
 	}
 
 	//allocate buffer of the maximum record size
-	char* recordBuf = (char*) malloc(MAX_SIZE_OF_RECORD);
+	char* recordBuf = (char*) malloc(fileHandle.getPageSize());
 
 	if( (errCode = readEncodedRecord(fileHandle, recordDescriptor, rid, recordBuf)) != 0 )
 	{
@@ -1147,18 +2109,25 @@ RC RecordBasedFileManager::readAttribute(FileHandle &fileHandle, const vector<At
 			memcpy(data, curPtr, sz);
 			*/
 
-			//new structure of the record is as follows:
-			//[number of fields:integer][directory of field offsets:List<Integers>][fields]
+			//new structure of the record is as follows (see RecordHeader):
+			//[number of fields][null bitmap][directory of VarChar end offsets][TypeInt/TypeReal values][VarChar values]
 
-			//get the very first element in this record, i.e. number of the fields in this record
-			unsigned int numOfFieldsInThisRecord = *((unsigned int*)recordBuf);
+			//index of the field among the fields of its kind
+			vector<unsigned int> fieldIndexes;
+			getFieldIndexes(recordDescriptor, fieldIndexes);
+
+			const char* startOfAttribute = NULL;
+			unsigned int szOfAttribute = 0;
+			bool isOverflow = false, isNull = false;
+			getEncodedField(recordBuf, fieldIndex, (*i).type, fieldIndexes[fieldIndex], startOfAttribute, szOfAttribute, isOverflow, isNull);
 
 			//need to check if this field actually represented by the value
-			if( numOfFieldsInThisRecord <= fieldIndex )
+			if( isNull )
 			{
 				//if the field index is out of bound, then it must mean that this field was added and the record was never updated
 				//this also means that the field ideally should be returned as a NULL. In our class, there is no NULL data type, so
 				//my guess is to return a default value for the given data type, i.e. "" for VarChar, 0 for Integer, 0.0f for Float.
+				//(the same goes for the field that is NULL inside the record)
 				switch( (*i).type )
 				{
 				case TypeInt:
@@ -1177,21 +2146,21 @@ RC RecordBasedFileManager::readAttribute(FileHandle &fileHandle, const vector<At
 				//free the used buffer
 				free(recordBuf);
 
-				//added
-					//printFile(fileHandle);
-
 				//success
 				return 0;
 			}
 
-			//determine offset from the start of the page to the requested attribute (i.e. field)
-			unsigned int *curOffset = ((unsigned int*)(recordBuf)) + fieldIndex + 1;	//extra one is added because the first element in the record is the number of the fields stored within this record
+			//value kept in overflow pages is read from its chain (other overflow pages of the record are not touched)
+			if( isOverflow )
+			{
+				OverflowPointer pointer;
+				memcpy(&pointer, startOfAttribute, sizeof(OverflowPointer));
 
-			//calculate size of attribute
-			unsigned int szOfAttribute = *(curOffset + 1) - *curOffset;
+				*((unsigned int*)data) = pointer._length;
+				errCode = readOverflowValue(fileHandle, pointer, (char*)data + sizeof(unsigned int));
 
-			//calculate start of the attribute
-			void* startOfAttribute = (void*)((char*)recordBuf + *curOffset);
+				break;
+			}
 
 			//if this attribute is character array (i.e. VarChar), then need to copy length and then contents of character array
 			if( (*i).type == TypeVarChar )
@@ -1226,6 +2195,18 @@ RC RecordBasedFileManager::readAttribute(FileHandle &fileHandle, const vector<At
 }
 
 RC RecordBasedFileManager::reorganizePage(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const unsigned pageNumber)
+{
+	//all pages modified by the record operation are committed to the log together
+	_pfm->beginOperation();
+
+	RC errCode = reorganizePageInternal(fileHandle, recordDescriptor, pageNumber);
+
+	RC endCode = _pfm->endOperation(errCode);
+
+	return errCode != 0 ? errCode : endCode;
+}
+
+RC RecordBasedFileManager::reorganizePageInternal(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const unsigned pageNumber)
 {
 	RC errCode = 0;
 
@@ -1235,8 +2216,14 @@ RC RecordBasedFileManager::reorganizePage(FileHandle &fileHandle, const vector<A
 		return -27;	//given page number exceeds total number of pages in a file
 	}
 
+	//PAX page is re-built by every modification, so it is always packed
+	if( fileHandle.getPageLayout() == LAYOUT_PAX )
+	{
+		return 0;
+	}
+
 	//allocate buffer to hold a copy of page
-	char* buffer = (char*) malloc(PAGE_SIZE);
+	char* buffer = (char*) malloc(fileHandle.getPageSize());
 
 	//read the page data that is to be re-organized
 	if( (errCode = fileHandle.readPage(pageNumber, buffer)) != 0 )
@@ -1255,34 +2242,30 @@ RC RecordBasedFileManager::reorganizePage(FileHandle &fileHandle, const vector<A
 	 * start of page                                                          start of dirSlot        end of dirSlot                                                                          end of page
 	 */
 	//determine pointer to the end of the list of directory slots
-	PageDirSlot* endOfDirSlot = (PageDirSlot*)((char*)buffer + PAGE_SIZE - sizeof(unsigned int) - sizeof(unsigned int));
+	PageDirSlot* endOfDirSlot = (PageDirSlot*)((char*)buffer + fileHandle.getPageSize() - sizeof(unsigned int) - sizeof(unsigned int));
 
 	//number of slots
 	unsigned int* ptrNumSlots = (unsigned int*)(endOfDirSlot);
 
-	//pointer to the start of free space
-	unsigned int* ptrVarForFreeSpace = (unsigned int*)( (char*)(endOfDirSlot) + sizeof(unsigned int) );	//not needed
-	//char* ptrToFreeSpace = (char*)( (char*)buffer + (*ptrVarForFreeSpace) );	//not needed
-
 	//pointer to the start of the list of directory slots
 	PageDirSlot* startOfDirSlot = (PageDirSlot*)( endOfDirSlot - (*ptrNumSlots) );
 
 	//create duplicate page, which would store re-organized page data (a.k.a. new page buffer)
-	char* reorganizedPage = (char*) malloc(PAGE_SIZE);
+	char* reorganizedPage = (char*) malloc(fileHandle.getPageSize());
 
 	//null it
-	memset(reorganizedPage, 0, PAGE_SIZE);
+	memset(reorganizedPage, 0, fileHandle.getPageSize());
 
 	//copy variable that stores number of slots
 	//cannot change position of slots, since we have to retain RID consistency
-	*((unsigned int*)(reorganizedPage + PAGE_SIZE - 2 * sizeof(unsigned int))) = *ptrNumSlots;
+	*((unsigned int*)(reorganizedPage + fileHandle.getPageSize() - 2 * sizeof(unsigned int))) = *ptrNumSlots;
 
 	//free space in a page may change, due to reorganization of records, so we have to compute it first and later place the value in the meta-data of new page buffer
-	unsigned int freeSpace = PAGE_SIZE - 2 * sizeof(unsigned int);
+	unsigned int freeSpace = fileHandle.getPageSize() - 2 * sizeof(unsigned int);
 
 	//loop thru directory slots and copy data "appropriately" into reorganizedPage buffer
 	PageDirSlot *curSlot = endOfDirSlot,
-			*curSlotInNewPageBuffer = (PageDirSlot*)((char*)reorganizedPage + PAGE_SIZE - 2 * sizeof(unsigned int));
+			*curSlotInNewPageBuffer = (PageDirSlot*)((char*)reorganizedPage + fileHandle.getPageSize() - 2 * sizeof(unsigned int));
 
 	//maintain offset of the record in the reorganized page (a.k.a. new page buffer)
 	unsigned int offOfRecord = 0;
@@ -1329,62 +2312,18 @@ RC RecordBasedFileManager::reorganizePage(FileHandle &fileHandle, const vector<A
 	} while(curSlot != startOfDirSlot);
 
 	//set offset to the free space
-	*( (unsigned int*)( (char*)reorganizedPage + PAGE_SIZE - sizeof(unsigned int) ) ) =
-			PAGE_SIZE - freeSpace - (*ptrNumSlots) * sizeof(PageDirSlot) - 2 * sizeof(unsigned int);
+	*( (unsigned int*)( (char*)reorganizedPage + fileHandle.getPageSize() - sizeof(unsigned int) ) ) =
+			fileHandle.getPageSize() - freeSpace - (*ptrNumSlots) * sizeof(PageDirSlot) - 2 * sizeof(unsigned int);
 
-	//if by reorganizing this data page, the free space increased, then it is necessary to update header page information
-	if( freeSpace != *ptrVarForFreeSpace )
+	//header page entry of this data page has to agree with the reorganized page (it is written only if the value changed)
+	if( (errCode = setPageFreeSpace(fileHandle, pageNumber, freeSpace)) != 0 )
 	{
-		//variable to store id of the header page
-		PageNum headerPage = 0;
-
-		//get header for this data page
-		if( (errCode = _pfm->findHeaderPage(fileHandle, pageNumber, headerPage)) != 0 )
-		{
-			//free buffers
-			free(reorganizedPage);
-			free(buffer);
-
-			//return error code
-			return errCode;
-		}
-
-		//set free size for this data page inside the appropriate header page
-		void* data = malloc(PAGE_SIZE);
-		memset(data, 0, PAGE_SIZE);
-
-		//get the found header page
-		if( (errCode = fileHandle.readPage((PageNum)headerPage, data)) != 0 )
-		{
-			//deallocate data
-			free(reorganizedPage);
-			free(buffer);
-			free(data);
-
-			//return error
-			return errCode;
-		}
-
-		//cast data to Header
-		Header* hPage = (Header*)data;
-
-		//set amount of free space for the data page inside this header
-		(hPage->_arrOfPageIds)[pageNumber % NUM_OF_PAGE_IDS]._numFreeBytes = freeSpace;
-
-		//write back to header
-		if( (errCode = fileHandle.writePage(headerPage, data)) != 0 )
-		{
-			//free data page
-			free(reorganizedPage);
-			free(buffer);
-			free(data);
-
-			//return error code
-			return errCode;
-		}
+		//free buffers
+		free(reorganizedPage);
+		free(buffer);
 
-		//free data buffer used for header page
-		free(data);
+		//return error code
+		return errCode;
 	}
 
 	//replace old page contents with reorganized copy
@@ -1426,6 +2365,7 @@ RC RecordBasedFileManager::scan(FileHandle &fileHandle,
 	rbfm_ScanIterator._conditionAttribute = conditionAttribute;
 	rbfm_ScanIterator._fileHandle = fileHandle;
 	rbfm_ScanIterator._pagenum = 1;
+	rbfm_ScanIterator._endPagenum = 0;
 	rbfm_ScanIterator._recordDescriptor = recordDescriptor;
 	rbfm_ScanIterator._slotnum = 0;
 	rbfm_ScanIterator._value = value;
@@ -1437,6 +2377,22 @@ RC RecordBasedFileManager::scan(FileHandle &fileHandle,
 	//always equal to recordDescriptor.
 	rbfm_ScanIterator._attributes = attributeNames;
 
+	//find positions of the condition attribute and of the projected ones once, rather than for every record
+	rbfm_ScanIterator._conditionPosition = -1;
+	rbfm_ScanIterator._attributePositions.assign(attributeNames.size(), -1);
+	getFieldIndexes(recordDescriptor, rbfm_ScanIterator._fieldIndexes);
+	for( int i = (int)recordDescriptor.size() - 1; i >= 0; i-- )
+	{
+		if( recordDescriptor[i].name == conditionAttribute )
+			rbfm_ScanIterator._conditionPosition = i;
+
+		for( unsigned int j = 0; j < attributeNames.size(); j++ )
+		{
+			if( recordDescriptor[i].name == attributeNames[j] )
+				rbfm_ScanIterator._attributePositions[j] = i;
+		}
+	}
+
 	//return success
 	return 0;
 }
@@ -1446,7 +2402,7 @@ RC RecordBasedFileManager::reorganizeFile(FileHandle &fileHandle, const vector<A
 	const string tempFile="tempFile";
 
 	//create an empty file using pfm
-	if( (errCode = createFile(tempFile)) != 0 )
+	if( (errCode = createFile(tempFile, fileHandle.getPhysicalPageSize())) != 0 )
 		return errCode;
 
 	//create a handle for the file
@@ -1468,10 +2424,12 @@ RC RecordBasedFileManager::reorganizeFile(FileHandle &fileHandle, const vector<A
 	scan(fileHandle, recordDescriptor, conditionAttribute, compOp, NULL, attributeNames, iterator );
 
 
-	//insert the records into temp file
+	//insert the records into temp file (buffer grows for the values kept in overflow pages, since records come back decoded)
 	RID itRid = {0, 0};
-	void* encData = malloc(PAGE_SIZE);
-	memset(encData, 0, PAGE_SIZE);
+	unsigned int szOfEncData = fileHandle.getPageSize();
+	void* encData = malloc(szOfEncData);
+	memset(encData, 0, szOfEncData);
+	unsigned int szData = 0;
 
 	//allocate buffer for decoded data
 	//void* decodedData = malloc(PAGE_SIZE);
@@ -1479,10 +2437,20 @@ RC RecordBasedFileManager::reorganizeFile(FileHandle &fileHandle, const vector<A
 	//create map for storing actual rids for those cases when records are tombStones
 	std::map<RID, RID> tombStoneRids;
 
-	vector<RID> rids;
-
-	while(iterator.getNextRecord(itRid, encData) != RBFM_EOF)
+	while( (errCode = iterator.getNextRecord(itRid, encData, szData, szOfEncData)) != RBFM_EOF )
 	{
+		if( errCode == -28 )
+		{
+			encData = realloc(encData, szData);
+			szOfEncData = szData;
+			continue;
+		}
+
+		if( errCode != 0 )
+		{
+			free(encData);
+			return errCode;
+		}
 
 		//get rid (if it is a tombStone, then a returned rid is not going to equal to itRid)
 		RID updatedRid = iterator.getActualRecordId();
@@ -1525,8 +2493,6 @@ RC RecordBasedFileManager::reorganizeFile(FileHandle &fileHandle, const vector<A
 				//return error code
 				return errCode;
 			}
-
-			rids.push_back(itRid);
 		}
 
 		//debug information (subject for later removal)
@@ -1534,15 +2500,34 @@ RC RecordBasedFileManager::reorganizeFile(FileHandle &fileHandle, const vector<A
 
 	}
 
-	//delete records from the original file
+	//delete records from the original file (number of pages drops to 1, but the pages stay in the OS file)
+	PageNum numOldPages = fileHandle.getNumberOfPages();
 	if((errCode=deleteRecords(fileHandle))!=0)
+	{
+		free(encData);
+		return errCode;
+	}
+
+	//bring back all records to the original file (temp file has no TombStones, so it is simply scanned)
+	RBFM_ScanIterator tempIterator;
+	FileHandle tempScanHandle;
+	if( (errCode = _pfm->openFile(tempFile.c_str(), tempScanHandle)) != 0 ||
+		(errCode = scan(tempScanHandle, recordDescriptor, conditionAttribute, compOp, NULL, attributeNames, tempIterator)) != 0 )
+	{
+		free(encData);
 		return errCode;
+	}
 
-	//bring back all records to the original file
-	for(unsigned int i = 0; i < rids.size(); i++)
+	while( (errCode = tempIterator.getNextRecord(itRid, encData, szData, szOfEncData)) != RBFM_EOF )
 	{
-		memset(/*decodedData*/encData, 0, PAGE_SIZE);
-		if((errCode=readRecord(tempFileHandle, recordDescriptor, rids[i], /*decodedData*/encData)) != 0)
+		if( errCode == -28 )
+		{
+			encData = realloc(encData, szData);
+			szOfEncData = szData;
+			continue;
+		}
+
+		if( errCode != 0 || (errCode=insertRecord(fileHandle, recordDescriptor, /*decodedData*/encData, itRid)) != 0 )
 		{
 			//free buffers used for encoded and decoded data
 			free(encData);
@@ -1551,90 +2536,1509 @@ RC RecordBasedFileManager::reorganizeFile(FileHandle &fileHandle, const vector<A
 			//return error code
 			return errCode;
 		}
-		if((errCode=insertRecord(fileHandle, recordDescriptor, /*decodedData*/encData, itRid)) != 0)
+	}
+
+	//iterator closes its own handle of the temp file
+	if( (errCode = tempIterator.close()) != 0 )
+	{
+		free(encData);
+		return errCode;
+	}
+
+	//pages left behind by the compaction go to the allocation map, so that following insertions re-use them (and
+	//PagedFileManager::truncateFile gives them back to the OS)
+	PageNum numNewPages = fileHandle.getNumberOfPages();
+	if( numNewPages < numOldPages )
+	{
+		fileHandle._info->_numPages = numOldPages;
+
+		for( PageNum pageNum = numNewPages; pageNum < numOldPages; pageNum++ )
 		{
-			//free buffers used for encoded and decoded data
-			free(encData);
-			//free(decodedData);
+			if( (errCode = _pfm->freePage(fileHandle, pageNum)) != 0 )
+			{
+				free(encData);
+				return errCode;
+			}
+		}
+	}
+
+	//close and destroy temporary file
+	if((errCode=_pfm->closeFile(tempFileHandle)) != 0)
+	{
+		//free buffers used for encoded and decoded data
+		free(encData);
+		//free(decodedData);
+
+		//return error code
+		return errCode;
+	}
+	if((errCode=_pfm->destroyFile(tempFile.c_str())) != 0)
+	{
+		//free buffers used for encoded and decoded data
+		free(encData);
+		//free(decodedData);
+
+		//return error code
+		return errCode;
+	}
+
+	//free buffers used for encoded and decoded data
+	free(encData);
+	//free(decodedData);
+
+	//added
+		//printFile(fileHandle);
+
+	return errCode;
+
+}
+
+//overflow pages section of code
+
+RC RecordBasedFileManager::migrateForwardedRecords(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const unsigned int maxPages,
+		unsigned int &numMigrated)
+{
+	RC errCode = 0;
+
+	numMigrated = 0;
+
+	if( fileHandle._info == NULL )
+	{
+		return -9;
+	}
+
+	//walk (at most) once around the file, starting where the previous call stopped
+	PageNum numPages = fileHandle.getNumberOfPages();
+	PageNum& cursor = fileHandle._info->_migrationCursor;
+	unsigned int numExamined = 0;
+
+	for( PageNum i = 0; i < numPages && (maxPages == 0 || numExamined < maxPages); i++ )
+	{
+		if( cursor == 0 || cursor >= numPages )
+			cursor = 1;
+
+		PageNum pageNum = cursor++;
+
+		//header pages, overflow pages and free pages have no records
+		if( isDataPage(fileHandle, pageNum) == false )
+			continue;
+
+		numExamined++;
+
+		if( fileHandle.getPageLayout() == LAYOUT_PAX )
+			errCode = migratePaxPage(fileHandle, recordDescriptor, pageNum, numMigrated);
+		else
+			errCode = migrateRowPage(fileHandle, pageNum, numMigrated);
+
+		if( errCode != 0 )
+			return errCode;
+	}
+
+	//success
+	return 0;
+}
+
+RC RecordBasedFileManager::migrateRowPage(FileHandle &fileHandle, const PageNum pageNum, unsigned int &numMigrated)
+{
+	RC errCode = 0;
+	unsigned int pageSize = fileHandle.getPageSize();
+
+	char* homePage = (char*)malloc(pageSize);
+	char* movedPage = (char*)malloc(pageSize);
+
+	if( (errCode = fileHandle.readPage(pageNum, homePage)) != 0 )
+	{
+		free(homePage);
+		free(movedPage);
+		return errCode;
+	}
+
+	//see readEncodedRecord for the format of the page
+	PageDirSlot* endOfDirSlot = (PageDirSlot*)(homePage + pageSize - 2 * sizeof(unsigned int));
+	unsigned int numSlots = *((unsigned int*)endOfDirSlot);
+
+	for( unsigned int slotNum = 0; slotNum < numSlots && errCode == 0; slotNum++ )
+	{
+		PageDirSlot* homeSlot = endOfDirSlot - (slotNum + 1);
+		if( homeSlot->_szRecord != (unsigned int)-1 )
+			continue;
+
+		RID movedRid = *((RID*)(homePage + homeSlot->_offRecord));
+
+		_pfm->beginOperation();
+
+		if( movedRid.pageNum == pageNum )
+		{
+			//record was moved within this page, so home slot simply takes its place
+			PageDirSlot* movedSlot = endOfDirSlot - (movedRid.slotNum + 1);
+			if( movedRid.slotNum < numSlots && movedSlot->_szRecord != (unsigned int)-1 && (movedSlot->_offRecord != 0 || movedSlot->_szRecord != 0) )
+			{
+				*homeSlot = *movedSlot;
+				movedSlot->_offRecord = 0;
+				movedSlot->_szRecord = 0;
+
+				if( (errCode = fileHandle.writePage(pageNum, homePage)) == 0 )
+				{
+					numMigrated++;
+					__sync_fetch_and_add(&fileHandle._info->_migratedRecordCounter, 1);
+				}
+			}
+		}
+		else if( (errCode = fileHandle.readPage(movedRid.pageNum, movedPage)) == 0 )
+		{
+			PageDirSlot* endOfMovedDirSlot = (PageDirSlot*)(movedPage + pageSize - 2 * sizeof(unsigned int));
+			PageDirSlot* movedSlot = endOfMovedDirSlot - (movedRid.slotNum + 1);
+
+			//record goes back only if home page has room for it (TombStone space is re-used)
+			if( movedRid.slotNum < *((unsigned int*)endOfMovedDirSlot) && movedSlot->_szRecord != (unsigned int)-1 &&
+				(movedSlot->_offRecord != 0 || movedSlot->_szRecord != 0) &&
+				placeRowRecord(homePage, pageSize, slotNum, movedPage + movedSlot->_offRecord, movedSlot->_szRecord) == 0 )
+			{
+				//page the record was moved to gets its space back (and its header page entry says so)
+				movedSlot->_offRecord = 0;
+				movedSlot->_szRecord = 0;
+				packRowRecords(movedPage, pageSize);
+
+				if( (errCode = fileHandle.writePage(pageNum, homePage)) == 0 &&
+					(errCode = setPageFreeSpace(fileHandle, pageNum, getRowPageFreeSpace(homePage, pageSize))) == 0 &&
+					(errCode = fileHandle.writePage(movedRid.pageNum, movedPage)) == 0 &&
+					(errCode = setPageFreeSpace(fileHandle, movedRid.pageNum, getRowPageFreeSpace(movedPage, pageSize))) == 0 )
+				{
+					numMigrated++;
+					__sync_fetch_and_add(&fileHandle._info->_migratedRecordCounter, 1);
+				}
+			}
+		}
+
+		RC endCode = _pfm->endOperation(errCode);
+		if( errCode == 0 )
+			errCode = endCode;
+	}
+
+	free(homePage);
+	free(movedPage);
+
+	return errCode;
+}
+
+RC RecordBasedFileManager::migratePaxPage(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const PageNum pageNum, unsigned int &numMigrated)
+{
+	RC errCode = 0;
+	unsigned int pageSize = fileHandle.getPageSize();
+
+	void* homePage = malloc(pageSize);
+	void* movedPage = malloc(pageSize);
+	void* record = malloc(pageSize);
+
+	if( (errCode = fileHandle.readPage(pageNum, homePage)) != 0 )
+	{
+		free(homePage);
+		free(movedPage);
+		free(record);
+		return errCode;
+	}
+
+	for( unsigned int slotNum = 0; slotNum < PaxPage(homePage, pageSize).getNumSlots() && errCode == 0; slotNum++ )
+	{
+		PaxPage page(homePage, pageSize);
+		if( page.getSlotState(slotNum) != PAX_SLOT_MOVED )
+			continue;
+
+		RID movedRid = page.getMovedRid(slotNum);
+		if( (errCode = fileHandle.readPage(movedRid.pageNum, movedPage)) != 0 )
+			break;
+
+		PaxPage curMovedPage(movedPage, pageSize);
+		if( curMovedPage.getSlotState(movedRid.slotNum) != PAX_SLOT_RELOCATED )
+			continue;
+
+		curMovedPage.getRecord(movedRid.slotNum, record);
+
+		//record goes back only if home page has room for it (page is left intact otherwise)
+		if( page.updateRecord(slotNum, recordDescriptor, record) != 0 )
+			continue;
+
+		_pfm->beginOperation();
+
+		if( (errCode = fileHandle.writePage(pageNum, homePage)) == 0 &&
+			(errCode = setPageFreeSpace(fileHandle, pageNum, page.getNumFreeBytes())) == 0 &&
+			(errCode = deletePaxRecord(fileHandle, movedRid)) == 0 )
+		{
+			numMigrated++;
+			__sync_fetch_and_add(&fileHandle._info->_migratedRecordCounter, 1);
+		}
+
+		RC endCode = _pfm->endOperation(errCode);
+		if( errCode == 0 )
+			errCode = endCode;
+
+		//deletion may have changed this very page
+		if( errCode == 0 )
+			errCode = fileHandle.readPage(pageNum, homePage);
+	}
+
+	free(homePage);
+	free(movedPage);
+	free(record);
+
+	return errCode;
+}
+
+RC RecordBasedFileManager::storeOverflowFields(FileHandle &fileHandle, void *encData, unsigned int &szOfEncRecord)
+{
+	RC errCode = 0;
+
+	unsigned int pageSize = fileHandle.getPageSize();
+
+	//only VarChar values have entries in the directory (their end offsets), and their characters start at varOffset
+	const RecordHeader* header = (const RecordHeader*)encData;
+	unsigned int numFields = header->_numFields, numVarFields = header->_numVarFields;
+	const unsigned int* ptrDir = (const unsigned int*)((const char*)encData + RECORD_DIR_OFFSET(numFields));
+	unsigned int varOffset = RECORD_VARCHAR_OFFSET(numFields);
+
+	//pick values that are moved out of the record (and the size record gets)
+	vector<bool> isMoved(numVarFields, false);
+	unsigned int numMoved = 0, size = szOfEncRecord;
+
+	for( unsigned int i = 0; i < numVarFields; i++ )
+	{
+		unsigned int szOfField = ptrDir[i] - (i == 0 ? varOffset : ptrDir[i - 1]);
+		if( szOfField > OVERFLOW_THRESHOLD(pageSize) )
+		{
+			isMoved[i] = true;
+			numMoved++;
+			size -= szOfField - sizeof(OverflowPointer);
+		}
+	}
+
+	//record that still does not fit gives up its largest values
+	while( size >= MAX_SIZE_OF_RECORD_IN_PAGE(pageSize) )
+	{
+		unsigned int largest = numVarFields, szOfLargest = sizeof(OverflowPointer);
+		for( unsigned int i = 0; i < numVarFields; i++ )
+		{
+			unsigned int szOfField = ptrDir[i] - (i == 0 ? varOffset : ptrDir[i - 1]);
+			if( isMoved[i] == false && szOfField > szOfLargest )
+			{
+				largest = i;
+				szOfLargest = szOfField;
+			}
+		}
+
+		//nothing left to move (insertion fails with -21)
+		if( largest == numVarFields )
+			break;
+
+		isMoved[largest] = true;
+		numMoved++;
+		size -= szOfLargest - sizeof(OverflowPointer);
+	}
+
+	if( numMoved == 0 )
+	{
+		return 0;
+	}
+
+	//re-pack the record into a copy: header, null bitmap and TypeInt/TypeReal values stay as they are, characters of VarChar values
+	//are followed by OverflowPointer for the moved ones
+	char* newRecord = (char*)malloc(size);
+	memcpy(newRecord, encData, varOffset);
+	unsigned int* newDir = (unsigned int*)(newRecord + RECORD_DIR_OFFSET(numFields));
+
+	vector<PageNum> firstPages;
+	unsigned int offset = varOffset;
+	for( unsigned int i = 0; i < numVarFields; i++ )
+	{
+		unsigned int begin = i == 0 ? varOffset : ptrDir[i - 1];
+		const char* ptrField = (const char*)encData + begin;
+		unsigned int szOfField = ptrDir[i] - begin;
+
+		if( isMoved[i] == false )
+		{
+			memcpy(newRecord + offset, ptrField, szOfField);
+			offset += szOfField;
+			newDir[i] = offset;
+			continue;
+		}
+
+		OverflowPointer pointer;
+		pointer._length = szOfField;
+		if( (errCode = writeOverflowValue(fileHandle, ptrField, szOfField, pointer._firstPage)) != 0 )
+		{
+			break;
+		}
+		firstPages.push_back(pointer._firstPage);
+
+		memcpy(newRecord + offset, &pointer, sizeof(OverflowPointer));
+		offset += sizeof(OverflowPointer);
+		newDir[i] = offset | OVERFLOW_FIELD_FLAG;
+	}
+
+	if( errCode != 0 )
+	{
+		//chains written before the failure are given back, record is left as it was
+		for( unsigned int i = 0; i < firstPages.size(); i++ )
+			freeOverflowChain(fileHandle, firstPages[i]);
+
+		free(newRecord);
+		return errCode;
+	}
+
+	memcpy(encData, newRecord, offset);
+	szOfEncRecord = offset;
+
+	free(newRecord);
+
+	//success
+	return 0;
+}
+
+RC RecordBasedFileManager::writeOverflowValue(FileHandle &fileHandle, const void *value, const unsigned int length, PageNum &firstPage)
+{
+	RC errCode = 0;
+
+	unsigned int pageSize = fileHandle.getPageSize();
+	unsigned int szOfChunk = OVERFLOW_CHUNK_SIZE(pageSize);
+
+	//chain is written from its last page, so that each page knows the page that follows it
+	void* page = malloc(pageSize);
+	PageNum nextPage = 0;
+
+	for( unsigned int numChunks = (length + szOfChunk - 1) / szOfChunk; numChunks > 0; numChunks-- )
+	{
+		unsigned int begin = (numChunks - 1) * szOfChunk;
+		unsigned int numBytes = length - begin < szOfChunk ? length - begin : szOfChunk;
+
+		memset(page, 0, pageSize);
+		OverflowPageHeader* header = (OverflowPageHeader*)page;
+		header->_nextPage = nextPage;
+		header->_numBytes = numBytes;
+		memcpy((char*)page + sizeof(OverflowPageHeader), (const char*)value + begin, numBytes);
+
+		PageNum pageNum = 0;
+		if( (errCode = _pfm->allocatePage(fileHandle, page, pageNum)) != 0 )
+		{
+			free(page);
+
+			if( nextPage != 0 )
+				freeOverflowChain(fileHandle, nextPage);
+
+			return errCode;
+		}
+
+		nextPage = pageNum;
+	}
+
+	free(page);
+
+	firstPage = nextPage;
+
+	//success
+	return 0;
+}
+
+RC RecordBasedFileManager::readOverflowValue(FileHandle &fileHandle, const OverflowPointer &pointer, void *value)
+{
+	RC errCode = 0;
+
+	unsigned int pageSize = fileHandle.getPageSize();
+	void* page = malloc(pageSize);
+
+	PageNum pageNum = pointer._firstPage;
+	unsigned int numRead = 0;
+	while( numRead < pointer._length )
+	{
+		if( pageNum == 0 || pageNum >= fileHandle.getNumberOfPages() )
+		{
+			errCode = -82;	//chain of overflow pages is corrupted
+			break;
+		}
+
+		if( (errCode = fileHandle.readPage(pageNum, page)) != 0 )
+		{
+			break;
+		}
+
+		const OverflowPageHeader* header = (const OverflowPageHeader*)page;
+		if( header->_numBytes == 0 || header->_numBytes > OVERFLOW_CHUNK_SIZE(pageSize) || header->_numBytes > pointer._length - numRead )
+		{
+			errCode = -82;	//chain of overflow pages is corrupted
+			break;
+		}
+
+		memcpy((char*)value + numRead, (const char*)page + sizeof(OverflowPageHeader), header->_numBytes);
+		numRead += header->_numBytes;
+		pageNum = header->_nextPage;
+	}
+
+	free(page);
+
+	return errCode;
+}
+
+RC RecordBasedFileManager::freeOverflowChain(FileHandle &fileHandle, const PageNum firstPage)
+{
+	RC errCode = 0;
+
+	void* page = malloc(fileHandle.getPageSize());
+
+	//chain cannot be longer than the file (guards against the loop in a corrupted chain)
+	PageNum pageNum = firstPage;
+	for( PageNum numPages = 0; pageNum != 0; numPages++ )
+	{
+		if( pageNum >= fileHandle.getNumberOfPages() || numPages >= fileHandle.getNumberOfPages() )
+		{
+			errCode = -82;	//chain of overflow pages is corrupted
+			break;
+		}
+
+		if( (errCode = fileHandle.readPage(pageNum, page)) != 0 )
+		{
+			break;
+		}
+
+		PageNum nextPage = ((const OverflowPageHeader*)page)->_nextPage;
+
+		if( (errCode = _pfm->freePage(fileHandle, pageNum)) != 0 )
+		{
+			break;
+		}
+
+		pageNum = nextPage;
+	}
+
+	free(page);
+
+	return errCode;
+}
+
+RC RecordBasedFileManager::freeOverflowFields(FileHandle &fileHandle, const void *encData)
+{
+	RC errCode = 0;
+
+	//only VarChar values have entries in the directory
+	unsigned int numFields = ((const RecordHeader*)encData)->_numFields, numVarFields = ((const RecordHeader*)encData)->_numVarFields;
+	const unsigned int* ptrDir = (const unsigned int*)((const char*)encData + RECORD_DIR_OFFSET(numFields));
+
+	for( unsigned int i = 0; i < numVarFields; i++ )
+	{
+		if( (ptrDir[i] & OVERFLOW_FIELD_FLAG) == 0 )
+			continue;
+
+		OverflowPointer pointer;
+		unsigned int begin = i == 0 ? RECORD_VARCHAR_OFFSET(numFields) : FIELD_OFFSET(ptrDir[i - 1]);
+		memcpy(&pointer, (const char*)encData + begin, sizeof(OverflowPointer));
+
+		//rest of the chains are freed even if one of them fails
+		RC freeCode = freeOverflowChain(fileHandle, pointer._firstPage);
+		if( errCode == 0 )
+			errCode = freeCode;
+	}
+
+	return errCode;
+}
+
+bool RecordBasedFileManager::hasOverflowFields(const void *encData)
+{
+	unsigned int numFields = ((const RecordHeader*)encData)->_numFields, numVarFields = ((const RecordHeader*)encData)->_numVarFields;
+	const unsigned int* ptrDir = (const unsigned int*)((const char*)encData + RECORD_DIR_OFFSET(numFields));
+
+	for( unsigned int i = 0; i < numVarFields; i++ )
+	{
+		if( ptrDir[i] & OVERFLOW_FIELD_FLAG )
+			return true;
+	}
+
+	return false;
+}
+
+RC RecordBasedFileManager::inlineOverflowFields(FileHandle &fileHandle, const void *encData, void*& fullRecord)
+{
+	RC errCode = 0;
+
+	unsigned int numFields = ((const RecordHeader*)encData)->_numFields, numVarFields = ((const RecordHeader*)encData)->_numVarFields;
+	const unsigned int* ptrDir = (const unsigned int*)((const char*)encData + RECORD_DIR_OFFSET(numFields));
+	unsigned int varOffset = RECORD_VARCHAR_OFFSET(numFields);
+
+	//size of the record with all values in place
+	unsigned int size = varOffset;
+	for( unsigned int i = 0; i < numVarFields; i++ )
+	{
+		unsigned int begin = i == 0 ? varOffset : FIELD_OFFSET(ptrDir[i - 1]);
+		if( ptrDir[i] & OVERFLOW_FIELD_FLAG )
+		{
+			OverflowPointer pointer;
+			memcpy(&pointer, (const char*)encData + begin, sizeof(OverflowPointer));
+			size += pointer._length;
+		}
+		else
+		{
+			size += ptrDir[i] - begin;
+		}
+	}
+
+	//header, null bitmap and TypeInt/TypeReal values stay as they are
+	fullRecord = malloc(size);
+	memcpy(fullRecord, encData, varOffset);
+	unsigned int* newDir = (unsigned int*)((char*)fullRecord + RECORD_DIR_OFFSET(numFields));
+
+	unsigned int offset = varOffset;
+	for( unsigned int i = 0; i < numVarFields; i++ )
+	{
+		unsigned int begin = i == 0 ? varOffset : FIELD_OFFSET(ptrDir[i - 1]);
+		const char* ptrField = (const char*)encData + begin;
+
+		if( ptrDir[i] & OVERFLOW_FIELD_FLAG )
+		{
+			OverflowPointer pointer;
+			memcpy(&pointer, ptrField, sizeof(OverflowPointer));
+
+			if( (errCode = readOverflowValue(fileHandle, pointer, (char*)fullRecord + offset)) != 0 )
+			{
+				return errCode;
+			}
+			offset += pointer._length;
+		}
+		else
+		{
+			unsigned int szOfField = ptrDir[i] - begin;
+			memcpy((char*)fullRecord + offset, ptrField, szOfField);
+			offset += szOfField;
+		}
+
+		newDir[i] = offset;
+	}
+
+	//success
+	return 0;
+}
+
+//PAX layout section of code
+
+RC RecordBasedFileManager::insertPaxRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *encData, const unsigned int state, RID &rid)
+{
+	RC errCode = 0;
+
+	unsigned int pageSize = fileHandle.getPageSize();
+	unsigned int szOfSlot = PaxPage::getSlotSize(recordDescriptor, encData);
+
+	//record has to fit into an empty page
+	if( PAX_PAGE_HEADER_SIZE(recordDescriptor.size()) + szOfSlot > pageSize )
+	{
+		return -21;	//record exceeds page size (less required page meta-data)
+	}
+
+	//header page holds exact number of free bytes of the PAX page (getDataPage adds size of the directory slot, which PAX page does not have)
+	PageNum datapagenum = 0, headerpagenum = 0;
+	unsigned int freeSpaceLeft = 0;
+	if( (errCode = _pfm->getDataPage(fileHandle, szOfSlot > sizeof(PageDirSlot) ? szOfSlot - sizeof(PageDirSlot) : 0, datapagenum, headerpagenum, freeSpaceLeft)) != 0 )
+	{
+		return errCode;
+	}
+
+	void* dataPage = malloc(pageSize);
+	if( (errCode = fileHandle.readPage(datapagenum, dataPage)) != 0 )
+	{
+		free(dataPage);
+		return errCode;
+	}
+
+	PaxPage page(dataPage, pageSize);
+	unsigned int slotNum = 0;
+	if( (errCode = page.insertRecord(recordDescriptor, encData, state, slotNum)) == -22 )
+	{
+		//page has different number of attributes than the record, so the record takes more than its own size there; found page
+		//keeps its exact free space, and record goes to a new page ((unsigned int)-1 is never the free space of the PAX page)
+		if( (errCode = setPageFreeSpace(fileHandle, datapagenum, page.getNumFreeBytes())) != 0 ||
+			(errCode = _pfm->getDataPage(fileHandle, (unsigned int)-1, datapagenum, headerpagenum, freeSpaceLeft)) != 0 )
+		{
+			free(dataPage);
+			return errCode;
+		}
+
+		memset(dataPage, 0, pageSize);
+		PaxPage emptyPage(dataPage, pageSize);
+		errCode = emptyPage.insertRecord(recordDescriptor, encData, state, slotNum);
+	}
+
+	if( errCode != 0 )
+	{
+		free(dataPage);
+		return errCode;
+	}
+
+	//write page, and its exact free space
+	if( (errCode = fileHandle.writePage(datapagenum, dataPage)) != 0 ||
+		(errCode = setPageFreeSpace(fileHandle, datapagenum, PaxPage(dataPage, pageSize).getNumFreeBytes())) != 0 )
+	{
+		free(dataPage);
+		return errCode;
+	}
+
+	free(dataPage);
+
+	//assign rid
+	rid.pageNum = datapagenum;
+	rid.slotNum = slotNum;
+
+	//success
+	return 0;
+}
+
+RC RecordBasedFileManager::readPaxRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid, void *data)
+{
+	RC errCode = 0;
+
+	void* dataPage = malloc(fileHandle.getPageSize());
+	if( (errCode = fileHandle.readPage(rid.pageNum, dataPage)) != 0 )
+	{
+		free(dataPage);
+		return errCode;
+	}
+
+	PaxPage page(dataPage, fileHandle.getPageSize());
+
+	//check if rid is correct in terms of indexed slot
+	if( rid.slotNum >= page.getNumSlots() )
+	{
+		free(dataPage);
+		return -23; //rid is not setup correctly
+	}
+
+	switch( page.getSlotState(rid.slotNum) )
+	{
+	case PAX_SLOT_DELETED:
+		errCode = -24;	//record is deleted
+		break;
+	case PAX_SLOT_MOVED:
+		//redirect to the place record was moved to
+		__sync_fetch_and_add(&fileHandle._info->_forwardedReadCounter, 1);
+		errCode = readEncodedRecord(fileHandle, recordDescriptor, page.getMovedRid(rid.slotNum), data);
+		break;
+	default:
+		page.getRecord(rid.slotNum, data);
+		break;
+	}
+
+	free(dataPage);
+
+	return errCode;
+}
+
+RC RecordBasedFileManager::deletePaxRecord(FileHandle &fileHandle, const RID &rid)
+{
+	RC errCode = 0;
+
+	if( rid.pageNum == 0 || rid.pageNum >= fileHandle.getNumberOfPages() )
+	{
+		return -27; //rid is not setup correctly
+	}
+
+	if( isHeaderPage(fileHandle, rid.pageNum) )
+	{
+		return -23;
+	}
+
+	void* dataPage = malloc(fileHandle.getPageSize());
+	if( (errCode = fileHandle.readPage(rid.pageNum, dataPage)) != 0 )
+	{
+		free(dataPage);
+		return errCode;
+	}
+
+	PaxPage page(dataPage, fileHandle.getPageSize());
+
+	if( rid.slotNum >= page.getNumSlots() )
+	{
+		free(dataPage);
+		return -23; //rid is not setup correctly
+	}
+
+	unsigned int state = page.getSlotState(rid.slotNum);
+	if( state == PAX_SLOT_DELETED )
+	{
+		free(dataPage);
+		return -24;	//record is already deleted
+	}
+
+	//moved record is deleted at the place it was moved to as well
+	if( state == PAX_SLOT_MOVED )
+	{
+		if( (errCode = deletePaxRecord(fileHandle, page.getMovedRid(rid.slotNum))) != 0 && errCode != -24 )
+		{
+			free(dataPage);
+			return errCode;
+		}
+	}
+
+	//deleted slot gives up all of its space (page only shrinks, so it always succeeds)
+	if( (errCode = page.deleteRecord(rid.slotNum)) != 0 ||
+		(errCode = fileHandle.writePage(rid.pageNum, dataPage)) != 0 ||
+		(errCode = setPageFreeSpace(fileHandle, rid.pageNum, page.getNumFreeBytes())) != 0 )
+	{
+		free(dataPage);
+		return errCode;
+	}
+
+	free(dataPage);
+
+	//success
+	return 0;
+}
+
+RC RecordBasedFileManager::updatePaxRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *encData, const RID &rid)
+{
+	RC errCode = 0;
+
+	if( rid.pageNum == 0 || rid.pageNum >= fileHandle.getNumberOfPages() )
+	{
+		return -27; //rid is not setup correctly
+	}
+
+	if( isHeaderPage(fileHandle, rid.pageNum) )
+	{
+		return -23;
+	}
+
+	unsigned int pageSize = fileHandle.getPageSize();
+	void* dataPage = malloc(pageSize);
+	if( (errCode = fileHandle.readPage(rid.pageNum, dataPage)) != 0 )
+	{
+		free(dataPage);
+		return errCode;
+	}
+
+	PaxPage page(dataPage, pageSize);
+
+	if( rid.slotNum >= page.getNumSlots() )
+	{
+		free(dataPage);
+		return -23; //rid is not setup correctly
+	}
+
+	unsigned int state = page.getSlotState(rid.slotNum);
+	if( state == PAX_SLOT_DELETED )
+	{
+		free(dataPage);
+		return -24;	//record is deleted
+	}
+
+	//record that was moved is updated at its new place
+	RID curRid = rid;
+	if( state == PAX_SLOT_MOVED )
+	{
+		curRid = page.getMovedRid(rid.slotNum);
+
+		if( (errCode = fileHandle.readPage(curRid.pageNum, dataPage)) != 0 )
+		{
+			free(dataPage);
+			return errCode;
+		}
+	}
+
+	//try to put the record in place of the old one
+	PaxPage curPage(dataPage, pageSize);
+	if( (errCode = curPage.updateRecord(curRid.slotNum, recordDescriptor, encData)) == 0 )
+	{
+		if( (errCode = fileHandle.writePage(curRid.pageNum, dataPage)) == 0 )
+		{
+			errCode = setPageFreeSpace(fileHandle, curRid.pageNum, curPage.getNumFreeBytes());
+		}
+
+		free(dataPage);
+		return errCode;
+	}
+
+	if( errCode != -22 )
+	{
+		free(dataPage);
+		return errCode;
+	}
+
+	//record does not fit into its page, so it is moved to a different one; slot that keeps the rid has to have room for the entry
+	//of the moved record (its values are dropped)
+	if( state != PAX_SLOT_MOVED )
+	{
+		void* copyOfPage = malloc(pageSize);
+		memcpy(copyOfPage, dataPage, pageSize);
+
+		RID testRid = {0, 0};
+		errCode = PaxPage(copyOfPage, pageSize).moveRecord(rid.slotNum, testRid);
+
+		free(copyOfPage);
+
+		if( errCode != 0 )
+		{
+			free(dataPage);
+			return -25;	//cannot update record without change of rid
+		}
+	}
+
+	//insert a new record (scan skips it, since the record is returned at its original rid)
+	RID newRid = {0, 0};
+	if( (errCode = insertPaxRecord(fileHandle, recordDescriptor, encData, PAX_SLOT_RELOCATED, newRid)) != 0 )
+	{
+		free(dataPage);
+		return errCode;
+	}
+
+	//record that was moved before leaves its former new place
+	if( state == PAX_SLOT_MOVED && (errCode = deletePaxRecord(fileHandle, curRid)) != 0 )
+	{
+		free(dataPage);
+		return errCode;
+	}
+
+	//page is read again, since the insertion above may have used it
+	if( (errCode = fileHandle.readPage(rid.pageNum, dataPage)) != 0 )
+	{
+		free(dataPage);
+		return errCode;
+	}
+
+	PaxPage movedPage(dataPage, pageSize);
+	if( (errCode = movedPage.moveRecord(rid.slotNum, newRid)) != 0 ||
+		(errCode = fileHandle.writePage(rid.pageNum, dataPage)) != 0 ||
+		(errCode = setPageFreeSpace(fileHandle, rid.pageNum, movedPage.getNumFreeBytes())) != 0 )
+	{
+		free(dataPage);
+		return errCode;
+	}
+
+	__sync_fetch_and_add(&fileHandle._info->_forwardedRecordCounter, 1);
+
+	free(dataPage);
+
+	//success
+	return 0;
+}
+
+RC RecordBasedFileManager::setPageFreeSpace(FileHandle &fileHandle, const PageNum pageNum, const unsigned int numFreeBytes)
+{
+	RC errCode = 0;
+
+	//get header for this data page (findHeaderPage does not account for header pages in between, so data pages listed by
+	//later header pages are looked up in the free-space map)
+	FreeSpaceMap* fsm = NULL;
+	PageNum headerPage = 0;
+	if( (errCode = _pfm->getFreeSpaceMap(fileHandle, fsm)) != 0 )
+	{
+		return errCode;
+	}
+
+	if( fsm->findHeaderOfDataPage(pageNum, headerPage) == false )
+	{
+		return -16;
+	}
+
+	void* data = malloc(fileHandle.getPageSize());
+	if( (errCode = fileHandle.readPage(headerPage, data)) != 0 )
+	{
+		free(data);
+		return errCode;
+	}
+
+	//find entry of the data page (header page is written, and free-space map is updated, only if the value changed)
+	Header* hPage = (Header*)data;
+	for( unsigned int i = 0; i < hPage->_numUsedPageIds; i++ )
+	{
+		if( hPage->_arrOfPageIds[i]._pageid == pageNum )
+		{
+			if( hPage->_arrOfPageIds[i]._numFreeBytes != numFreeBytes )
+			{
+				hPage->_arrOfPageIds[i]._numFreeBytes = numFreeBytes;
+				errCode = fileHandle.writePage(headerPage, data);
+			}
+			break;
+		}
+	}
+
+	free(data);
+
+	return errCode;
+}
+
+//RBFM_ScanIterator section of code
+
+RBFM_ScanIterator::RBFM_ScanIterator()
+{
+	_compO = NO_OP;
+	_conditionAttribute = "";
+	_pagenum = 0;
+	_endPagenum = 0;
+	_recordDescriptor.clear();
+	_slotnum = (unsigned int)-1;
+	_value = NULL;
+	_conditionPosition = -1;
+}
+
+RBFM_ScanIterator::~RBFM_ScanIterator()
+{
+	//do nothing
+}
+
+RC RBFM_ScanIterator::close()
+{
+	_compO = NO_OP;
+	_conditionAttribute = "";
+	_pagenum = 0;
+	_endPagenum = 0;
+	_recordDescriptor.clear();
+	_slotnum = (unsigned int)-1;
+	_value = NULL;
+	_conditionPosition = -1;
+	_attributePositions.clear();
+	_fieldIndexes.clear();
+	RC errCode = 0;
+	if( (errCode = RecordBasedFileManager::instance()->closeFile(_fileHandle)) != 0 )
+	{
+		return errCode;
+	}
+	return 0;
+}
+
+RC	RBFM_ScanIterator::getNextRecord(RID &rid, void* data)
+{
+	unsigned int szData = 0;
+	return getNextRecord(rid, data, szData, (unsigned int)-1);
+}
+
+RC	RBFM_ScanIterator::getNextRecord(RID &rid, void* data, unsigned int &szData, const unsigned int szOfData)
+{
+	RC errCode = 0;
+
+	//check if data is setup correctly
+	if( data == NULL )
+	{
+		return -11; //data is corrupted
+	}
+
+	//check if rid is at the end-of-file; if it is return RBFM_EOF
+	if( _pagenum == 0 )
+	{
+		return RBFM_EOF;
+	}
+
+	//PAX pages are walked slot by slot, without re-assembling records
+	if( _fileHandle.getPageLayout() == LAYOUT_PAX )
+	{
+		return getNextPaxRecord(rid, data, szData, szOfData);
+	}
+
+	//setup working instance of record based file manager
+	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+	//allocate space where encoded record is stored (it is decoded only partially, if it matches)
+	void* curRecord = malloc(_fileHandle.getPageSize());
+
+	/*
+	 * the general goal is to check whether the current record (pointed by rid) satisfies condition (given by scan function)
+	 * 		=> if yes, then return data to the caller containing this record
+	 * 		=> if no, then go to the next record and repeat the process
+	 */
+
+	//loop until the required record is found
+	while( true )
+	{
+		//scan is limited to pages before _endPagenum
+		if( _endPagenum != 0 && _pagenum >= _endPagenum )
+		{
+			free(curRecord);
+			_pagenum = 0;
+			return RBFM_EOF;
+		}
+
+		//overflow pages are skipped without being read
+		if( _slotnum == 0 && _pagenum < _fileHandle.getNumberOfPages() && rbfm->isDataPage(_fileHandle, _pagenum) == false )
+		{
+			_pagenum++;
+			continue;
+		}
+
+		//update rid values
+		rid.pageNum = _pagenum;
+		rid.slotNum = _slotnum;
+
+		//read current record (without decoding it)
+		if( (errCode = rbfm->readEncodedRecord(_fileHandle, _recordDescriptor, rid, curRecord)) != 0 )
+		{
+			//if slot number in rid exceeds the maximum stored in this data page, then
+			if( errCode == -23 )
+			{
+				//need to go to the next page
+				_pagenum++;
+
+				//set slot to the start of the page
+				_slotnum = 0;
+
+				//loop again
+				continue;
+			}
+
+			//if page number exceeds the maximum stored in this file, then
+			if( errCode == -27 )
+			{
+				//deallocate space assigned for record
+				free(curRecord);
+
+				//set internal page counter to 0, so that it this iterator is called again, it would quit immediately
+				_pagenum = 0;
+
+				//went thru entire file, i.e. cannot find the next record
+				return RBFM_EOF;
+			}
+
+			//if the given slot points to the deleted record (i.e. we are stepping thru the file record-by-record, so
+			//if some of them are deleted, it is possible to encounter this "error"
+			if( errCode == -24 )
+			{
+				//go to the next slot
+				_slotnum++;
+
+				//loop again
+				continue;
+			}
+		}
+
+		//check whether this record satisfies given condition (and copy selected fields into data); record that does not fit
+		//stays current, i.e. slot is not advanced
+		bool isMatching = false;
+		if( (errCode = filterRecord(curRecord, data, szData, isMatching, szOfData)) != 0 )
+		{
+			free(curRecord);
+			return errCode;
+		}
+
+		//go to the next slot
+		_slotnum++;
+
+		if( isMatching )
+		{
+			//deallocate space for record
+			free(curRecord);
+
+			//return success
+			return 0;	//do not substitute 0 with errCode, since the later value is likely to be equal to -27 or -23 (see above)
+		}
+	}
+
+	//deallocate space for record
+	free(curRecord);
+
+	//return success
+	return errCode;
+}
+
+RC RBFM_ScanIterator::filterRecord(const void* encodedRecord, void* data, unsigned int& szData, bool& isMatching, const unsigned int szOfData)
+{
+	RC errCode = 0;
+
+	szData = 0;
+	isMatching = false;
+
+	if( _compO == NO_OP )
+	{
+		//iterate over all fields
+		isMatching = true;
+	}
+	else
+	{
+		//condition attribute is not part of the record, so no record can match
+		if( _conditionPosition < 0 )
+		{
+			return 0;
+		}
+
+		//compare value with the field inside the encoded record
+		const char* ptrField = NULL;
+		unsigned int szOfField = 0;
+		bool isOverflow = false;
+		getEncodedField(encodedRecord, _conditionPosition, ptrField, szOfField, isOverflow);
+
+		if( (errCode = compareField(ptrField, szOfField, isOverflow, isMatching)) != 0 )
+		{
+			return errCode;
+		}
+	}
+
+	//if it is not match, then go to next record
+	if( isMatching == false )
+	{
+		return 0;
+	}
+
+	//caller's buffer may be too small for the values kept in overflow pages
+	if( szOfData != (unsigned int)-1 )
+	{
+		for( unsigned int i = 0; i < _attributePositions.size(); i++ )
+		{
+			const char* ptrField = NULL;
+			unsigned int szOfField = 0;
+			bool isOverflow = false;
+			if( _attributePositions[i] >= 0 )
+			{
+				getEncodedField(encodedRecord, _attributePositions[i], ptrField, szOfField, isOverflow);
+				szData += getProjectedFieldSize(_attributePositions[i], ptrField, szOfField, isOverflow);
+			}
+		}
+
+		if( szData > szOfData )
+		{
+			return -28;
+		}
+	}
+
+	//copy only fields that are directly mentioned inside _attributes (in their order)
+	char* ptrData = (char*)data;
+	for( unsigned int i = 0; i < _attributePositions.size(); i++ )
+	{
+		//skip attributes that are not part of the record
+		if( _attributePositions[i] < 0 )
+		{
+			continue;
+		}
+
+		const char* ptrField = NULL;
+		unsigned int szOfField = 0;
+		bool isOverflow = false;
+		getEncodedField(encodedRecord, _attributePositions[i], ptrField, szOfField, isOverflow);
+
+		if( (errCode = copyField(_attributePositions[i], ptrField, szOfField, isOverflow, ptrData)) != 0 )
+		{
+			return errCode;
+		}
+	}
+
+	//size of selected fields
+	szData = (unsigned int)(ptrData - (char*)data);
+
+	//success
+	return 0;
+}
+
+RC RBFM_ScanIterator::compareField(const char* ptrField, const unsigned int szOfField, const bool isOverflow, bool& isMatching)
+{
+	RC errCode = 0;
+
+	int cmpValue = 0;
+	if( _recordDescriptor[_conditionPosition].type == TypeVarChar && isOverflow )
+	{
+		//length of the value kept in overflow pages is known from its pointer, so its chain is read only for the same length
+		OverflowPointer pointer;
+		memcpy(&pointer, ptrField, sizeof(OverflowPointer));
+
+		unsigned int szOfValue = ((const unsigned int*)_value)[0];
+		if( pointer._length == szOfValue )
+		{
+			char* value = (char*)malloc(pointer._length);
+			if( (errCode = RecordBasedFileManager::instance()->readOverflowValue(_fileHandle, pointer, value)) != 0 )
+			{
+				free(value);
+				return errCode;
+			}
+
+			cmpValue = memcmp(value, (const char*)_value + sizeof(unsigned int), pointer._length);
+			free(value);
+		}
+		else
+		{
+			cmpValue = pointer._length < szOfValue ? -1 : 1;
+		}
+	}
+	else if( _recordDescriptor[_conditionPosition].type == TypeVarChar )
+	{
+		//value is given as [length][characters], while encoded field has characters only (its length comes from the directory)
+		//shorter string goes first, strings of the same length are compared character by character
+		unsigned int szOfValue = ((const unsigned int*)_value)[0];
+		if( szOfField == szOfValue )
+			cmpValue = szOfField == 0 ? 0 : memcmp(ptrField, (const char*)_value + sizeof(unsigned int), szOfField);
+		else
+			cmpValue = szOfField < szOfValue ? -1 : 1;
+	}
+	else
+	{
+		cmpValue = szOfField == 0 ? -1 : memcmp(ptrField, _value, szOfField);
+	}
+
+	//determine if condition matches
+	switch(_compO)
+	{
+	case EQ_OP:
+		isMatching = cmpValue == 0;
+		break;
+	case LT_OP:
+		isMatching = cmpValue < 0;
+		break;
+	case GT_OP:
+		isMatching = cmpValue > 0;
+		break;
+	case LE_OP:
+		isMatching = cmpValue <= 0;
+		break;
+	case GE_OP:
+		isMatching = cmpValue >= 0;
+		break;
+	case NE_OP:
+		isMatching = cmpValue != 0;
+		break;
+	default:
+		return -1;
+	}
+
+	return 0;
+}
+
+unsigned int RBFM_ScanIterator::getProjectedFieldSize(const int position, const char* ptrField, const unsigned int szOfField, const bool isOverflow)
+{
+	if( _recordDescriptor[position].type != TypeVarChar )
+	{
+		return sizeof(int);
+	}
+
+	if( isOverflow )
+	{
+		OverflowPointer pointer;
+		memcpy(&pointer, ptrField, sizeof(OverflowPointer));
+		return sizeof(unsigned int) + pointer._length;
+	}
+
+	return sizeof(unsigned int) + szOfField;
+}
+
+RC RBFM_ScanIterator::copyField(const int position, const char* ptrField, const unsigned int szOfField, const bool isOverflow, char*& ptrData)
+{
+	//value kept in overflow pages is read only when it is projected
+	if( isOverflow )
+	{
+		OverflowPointer pointer;
+		memcpy(&pointer, ptrField, sizeof(OverflowPointer));
+
+		memcpy(ptrData, &pointer._length, sizeof(unsigned int));
+		ptrData += sizeof(unsigned int);
+
+		RC errCode = RecordBasedFileManager::instance()->readOverflowValue(_fileHandle, pointer, ptrData);
+		ptrData += pointer._length;
+
+		return errCode;
+	}
+
+	//VarChar gets its length back
+	if( _recordDescriptor[position].type == TypeVarChar )
+	{
+		memcpy(ptrData, &szOfField, sizeof(unsigned int));
+		ptrData += sizeof(unsigned int);
+	}
+	else if( szOfField == 0 )
+	{
+		//fixed size field that record does not have is returned as 0
+		memset(ptrData, 0, sizeof(int));
+		ptrData += sizeof(int);
+		return 0;
+	}
+
+	if( szOfField > 0 )
+	{
+		memcpy(ptrData, ptrField, szOfField);
+		ptrData += szOfField;
+	}
+
+	return 0;
+}
+
+RC RBFM_ScanIterator::filterPaxRecord(PaxPage& page, const unsigned int slotNum, void* movedRecord, void* data, unsigned int& szData, bool& isMatching,
+		const unsigned int szOfData)
+{
+	RC errCode = 0;
+
+	szData = 0;
+	isMatching = false;
+
+	switch( page.getSlotState(slotNum) )
+	{
+	case PAX_SLOT_USED:
+		break;
+	case PAX_SLOT_MOVED:
+		//moved record is returned at its original rid, so it is read from the place it was moved to (and filtered as a whole)
+		__sync_fetch_and_add(&_fileHandle._info->_forwardedReadCounter, 1);
+		if( (errCode = RecordBasedFileManager::instance()->readEncodedRecord(_fileHandle, _recordDescriptor, page.getMovedRid(slotNum), movedRecord)) != 0 )
+		{
+			return errCode == -24 ? 0 : errCode;
+		}
+		return filterRecord(movedRecord, data, szData, isMatching, szOfData);
+	default:
+		//deleted slot, or record that is returned at the slot it was moved from
+		return 0;
+	}
+
+	if( _compO == NO_OP )
+	{
+		isMatching = true;
+	}
+	else
+	{
+		//condition attribute is not part of the record, so no record can match
+		if( _conditionPosition < 0 )
+		{
+			return 0;
+		}
+
+		//only minipage of the condition attribute is looked at
+		const char* ptrField = NULL;
+		unsigned int szOfField = 0;
+		bool isOverflow = false;
+		page.getField(slotNum, _conditionPosition, ptrField, szOfField, isOverflow);
+
+		if( (errCode = compareField(ptrField, szOfField, isOverflow, isMatching)) != 0 )
+		{
+			return errCode;
+		}
+	}
+
+	if( isMatching == false )
+	{
+		return 0;
+	}
+
+	//caller's buffer may be too small for the values kept in overflow pages
+	if( szOfData != (unsigned int)-1 )
+	{
+		for( unsigned int i = 0; i < _attributePositions.size(); i++ )
+		{
+			const char* ptrField = NULL;
+			unsigned int szOfField = 0;
+			bool isOverflow = false;
+			if( _attributePositions[i] >= 0 )
+			{
+				page.getField(slotNum, _attributePositions[i], ptrField, szOfField, isOverflow);
+				szData += getProjectedFieldSize(_attributePositions[i], ptrField, szOfField, isOverflow);
+			}
+		}
+
+		if( szData > szOfData )
+		{
+			return -28;
+		}
+	}
+
+	//projected fields come straight from their minipages
+	char* ptrData = (char*)data;
+	for( unsigned int i = 0; i < _attributePositions.size(); i++ )
+	{
+		if( _attributePositions[i] < 0 )
+		{
+			continue;
+		}
+
+		const char* ptrField = NULL;
+		unsigned int szOfField = 0;
+		bool isOverflow = false;
+		page.getField(slotNum, _attributePositions[i], ptrField, szOfField, isOverflow);
+
+		if( (errCode = copyField(_attributePositions[i], ptrField, szOfField, isOverflow, ptrData)) != 0 )
+		{
+			return errCode;
+		}
+	}
+
+	szData = (unsigned int)(ptrData - (char*)data);
+
+	//success
+	return 0;
+}
+
+RC RBFM_ScanIterator::getNextPaxRecord(RID &rid, void* data, unsigned int &szData, const unsigned int szOfData)
+{
+	RC errCode = 0;
+
+	//setup working instance of record based file manager
+	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
 
-			//return error code
-			return errCode;
-		}
-	}
+	unsigned int pageSize = _fileHandle.getPageSize();
 
-	//close and destroy temporary file
-	if((errCode=_pfm->closeFile(tempFileHandle)) != 0)
-	{
-		//free buffers used for encoded and decoded data
-		free(encData);
-		//free(decodedData);
+	//buffers for the data page and for the moved record
+	void* dataPage = malloc(pageSize);
+	void* movedRecord = malloc(pageSize);
 
-		//return error code
-		return errCode;
-	}
-	if((errCode=_pfm->destroyFile(tempFile.c_str())) != 0)
+	bool isMatching = false;
+	while( isMatching == false )
 	{
-		//free buffers used for encoded and decoded data
-		free(encData);
-		//free(decodedData);
+		//went thru entire file (or its part the scan is limited to), so if this iterator is called again, it would quit immediately
+		if( _pagenum >= _fileHandle.getNumberOfPages() || (_endPagenum != 0 && _pagenum >= _endPagenum) )
+		{
+			_pagenum = 0;
+			errCode = RBFM_EOF;
+			break;
+		}
 
-		//return error code
-		return errCode;
-	}
+		//header pages and overflow pages do not hold any records (overflow pages are not even read)
+		if( rbfm->isDataPage(_fileHandle, _pagenum) == false )
+		{
+			_pagenum++;
+			_slotnum = 0;
+			continue;
+		}
 
-	//free buffers used for encoded and decoded data
-	free(encData);
-	//free(decodedData);
+		if( (errCode = _fileHandle.readPage(_pagenum, dataPage)) != 0 )
+		{
+			break;
+		}
 
-	//added
-		//printFile(fileHandle);
+		PaxPage page(dataPage, pageSize);
+		for( ; _slotnum < page.getNumSlots(); _slotnum++ )
+		{
+			if( (errCode = filterPaxRecord(page, _slotnum, movedRecord, data, szData, isMatching, szOfData)) != 0 )
+			{
+				break;
+			}
 
-	return errCode;
+			if( isMatching )
+			{
+				rid.pageNum = _pagenum;
+				rid.slotNum = _slotnum;
 
-}
+				//go to the next slot
+				_slotnum++;
+				break;
+			}
+		}
 
-//RBFM_ScanIterator section of code
+		if( errCode != 0 || isMatching )
+		{
+			break;
+		}
 
-RBFM_ScanIterator::RBFM_ScanIterator()
-{
-	_compO = NO_OP;
-	_conditionAttribute = "";
-	_pagenum = 0;
-	_recordDescriptor.clear();
-	_slotnum = (unsigned int)-1;
-	_value = NULL;
-}
+		//go to the next page
+		_pagenum++;
+		_slotnum = 0;
+	}
 
-RBFM_ScanIterator::~RBFM_ScanIterator()
-{
-	//do nothing
+	free(dataPage);
+	free(movedRecord);
+
+	return errCode;
 }
 
-RC RBFM_ScanIterator::close()
+void RBFM_ScanIterator::getEncodedField(const void* encodedRecord, const int position, const char*& ptrField, unsigned int& szOfField, bool& isOverflow)
 {
-	_compO = NO_OP;
-	_conditionAttribute = "";
-	_pagenum = 0;
-	_recordDescriptor.clear();
-	_slotnum = (unsigned int)-1;
-	_value = NULL;
-	RC errCode = 0;
-	if( (errCode = RecordBasedFileManager::instance()->closeFile(_fileHandle)) != 0 )
+	//attribute is not part of the descriptor
+	if( position < 0 )
 	{
-		return errCode;
+		ptrField = NULL;
+		szOfField = 0;
+		isOverflow = false;
+		return;
 	}
-	return 0;
+
+	//NULL field is returned empty, as the field that record does not have
+	bool isNull = false;
+	::getEncodedField(encodedRecord, position, _recordDescriptor[position].type, _fieldIndexes[position], ptrField, szOfField, isOverflow, isNull);
 }
 
-RC	RBFM_ScanIterator::getNextRecord(RID &rid, void* data)
+RC RBFM_ScanIterator::getNextBatch(RecordBatch& batch)
 {
 	RC errCode = 0;
 
-	//check if data is setup correctly
-	if( data == NULL )
-	{
-		return -11; //data is corrupted
-	}
+	batch.clear();
 
 	//check if rid is at the end-of-file; if it is return RBFM_EOF
 	if( _pagenum == 0 )
@@ -1645,236 +4049,247 @@ RC	RBFM_ScanIterator::getNextRecord(RID &rid, void* data)
 	//setup working instance of record based file manager
 	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
 
-	//allocate space where record is stored
-	void* curRecord = malloc(PAGE_SIZE);
+	unsigned int pageSize = _fileHandle.getPageSize();
 
-	/*
-	 * the general goal is to check whether the current record (pointed by rid) satisfies condition (given by scan function)
-	 * 		=> if yes, then return data to the caller containing this record
-	 * 		=> if no, then go to the next record and repeat the process
-	 */
+	//buffers for the data page, moved record and selected fields of the record
+	void* dataPage = malloc(pageSize);
+	void* movedRecord = malloc(pageSize);
+	void* selectedFields = malloc(pageSize);
+	unsigned int szOfSelectedFields = pageSize;
 
-	//loop until the required record is found
-	while( true )
-	{
-		//update rid values
-		rid.pageNum = _pagenum;
-		rid.slotNum = _slotnum;
+	bool isFull = false;
 
-		//read current record
-		if( (errCode = rbfm->readRecord(_fileHandle, _recordDescriptor, rid, curRecord)) != 0 )
+	//loop thru pages until batch is full
+	while( isFull == false )
+	{
+		//went thru entire file (or its part the scan is limited to), so if this iterator is called again, it would quit immediately
+		if( _pagenum >= _fileHandle.getNumberOfPages() || (_endPagenum != 0 && _pagenum >= _endPagenum) )
 		{
-			//if slot number in rid exceeds the maximum stored in this data page, then
-			if( errCode == -23 )
-			{
-				//need to go to the next page
-				_pagenum++;
+			_pagenum = 0;
+			break;
+		}
 
-				//set slot to the start of the page
-				_slotnum = 0;
+		//header pages and overflow pages do not hold any records (overflow pages are not even read)
+		if( rbfm->isDataPage(_fileHandle, _pagenum) == false )
+		{
+			_pagenum++;
+			_slotnum = 0;
+			continue;
+		}
 
-				//loop again
-				continue;
-			}
+		//data page is read once for all of its records
+		if( (errCode = _fileHandle.readPage(_pagenum, dataPage)) != 0 )
+		{
+			break;
+		}
 
-			//if page number exceeds the maximum stored in this file, then
-			if( errCode == -27 )
+		//PAX page: records are filtered straight from the minipages
+		if( _fileHandle.getPageLayout() == LAYOUT_PAX )
+		{
+			PaxPage page(dataPage, pageSize);
+			for( ; _slotnum < page.getNumSlots(); _slotnum++ )
 			{
-				//deallocate space assigned for record
-				free(curRecord);
+				bool isMatching = false;
+				unsigned int szData = 0;
+				errCode = filterPaxRecord(page, _slotnum, movedRecord, selectedFields, szData, isMatching, szOfSelectedFields);
 
-				//set internal page counter to 0, so that it this iterator is called again, it would quit immediately
-				_pagenum = 0;
+				//buffer grows for the values kept in overflow pages
+				if( errCode == -28 )
+				{
+					selectedFields = realloc(selectedFields, szData);
+					szOfSelectedFields = szData;
+					errCode = filterPaxRecord(page, _slotnum, movedRecord, selectedFields, szData, isMatching, szOfSelectedFields);
+				}
 
-				//went thru entire file, i.e. cannot find the next record
-				return RBFM_EOF;
-			}
+				if( errCode != 0 )
+				{
+					break;
+				}
 
-			//if the given slot points to the deleted record (i.e. we are stepping thru the file record-by-record, so
-			//if some of them are deleted, it is possible to encounter this "error"
-			if( errCode == -24 )
-			{
-				//go to the next slot
-				_slotnum++;
+				RID rid;
+				rid.pageNum = _pagenum;
+				rid.slotNum = _slotnum;
 
-				//loop again
-				continue;
+				//record that does not fit is returned by the next call
+				if( isMatching && batch.addRecord(rid, selectedFields, szData) == false )
+				{
+					isFull = true;
+					break;
+				}
 			}
-		}
 
-		//check whether this record satisfies given condition
+			if( errCode != 0 || isFull )
+			{
+				break;
+			}
 
-		//loop thru record using stored record descriptor
-		void* ptrField = curRecord;
-		//std::map<string, AttrType> matchNameToSize;
+			//go to the next page
+			_pagenum++;
+			_slotnum = 0;
+			continue;
+		}
 
-		vector<Attribute>::iterator i = _recordDescriptor.begin(), max = _recordDescriptor.end();
+		//get pointer to the end of directory slots, and number of slots (see readEncodedRecord for the format of the page)
+		PageDirSlot* ptrEndOfDirSlot = (PageDirSlot*)((char*)dataPage + pageSize - 2 * sizeof(unsigned int));
+		unsigned int numSlots = *((unsigned int*)ptrEndOfDirSlot);
 
-		//loop thru record elements to determine if it is matching
-		for( i = _recordDescriptor.begin(); i != max; i++ )
+		for( ; _slotnum < numSlots; _slotnum++ )
 		{
+			PageDirSlot* curSlot = (PageDirSlot*)(ptrEndOfDirSlot - _slotnum - 1);
 
-			unsigned int szOfField = 0;
-
-			switch( i->type )
+			//skip deleted records
+			if( curSlot->_offRecord == 0 && curSlot->_szRecord == 0 )
 			{
-			case TypeInt:
-				//setup size of field as integer
-				szOfField = sizeof(int);
-				break;
-			case TypeReal:
-				//setup size of field as float
-				szOfField = sizeof(int);
-				break;
-			case TypeVarChar:
-				//setup size of field as integer
-				szOfField = ((unsigned int*)curRecord)[0] + sizeof(unsigned int);
-
-				//skip the size and go to the character array
-				//ptrField = (void*)( (char*)ptrField );//+ sizeof(int) );
-				break;
+				continue;
 			}
 
-			//if this is a comparing field, then
-			if( i->name == _conditionAttribute || _compO == NO_OP )
+			RID rid;
+			rid.pageNum = _pagenum;
+			rid.slotNum = _slotnum;
+
+			//encoded record is filtered right inside the copy of the page
+			const void* curRecord = (char*)dataPage + curSlot->_offRecord;
+
+			if( curSlot->_szRecord == (unsigned int)-1 )
 			{
-				//define variable to store boolean result, whether condition matches
-				bool isMatching = false;
+				//TombStone: record is read from the page it was moved to (rid of that place is stored in the copy of this page)
+				RID movedRid;
+				memcpy(&movedRid, curRecord, TOMBSTONE_SIZE);
+				__sync_fetch_and_add(&_fileHandle._info->_forwardedReadCounter, 1);
 
-				if( _compO != NO_OP )
+				if( (errCode = rbfm->readEncodedRecord(_fileHandle, _recordDescriptor, movedRid, movedRecord)) != 0 )
 				{
-					int cmpValue = 0;
-					if( i->type == TypeVarChar )
-					{
-						if( ((unsigned int*)ptrField)[0] == ((unsigned int*)_value)[0] )
-							cmpValue = strncmp((char*)ptrField, (char*)_value, szOfField);
-						else
-							cmpValue = ((unsigned int*)ptrField)[0] < ((unsigned int*)_value)[0] ? -1 : 1;
-					}
-					else
-					{
-						cmpValue = memcmp(ptrField, _value, szOfField);
-					}
-
-					//determine if condition matches
-					switch(_compO)
-					{
-					case EQ_OP:
-						isMatching = cmpValue == 0;
-						break;
-					case LT_OP:
-						isMatching = cmpValue < 0;
+					if( errCode != -24 )
 						break;
-					case GT_OP:
-						isMatching = cmpValue > 0;
-						break;
-					case LE_OP:
-						isMatching = cmpValue <= 0;
-						break;
-					case GE_OP:
-						isMatching = cmpValue >= 0;
-						break;
-					case NE_OP:
-						isMatching = cmpValue != 0;
-						break;
-					default:
-						return -1;
-					}
-				}
-				else
-				{
-					//iterate over all fields
-					isMatching = true;
-				}
 
-				//if it matches, then
-				if( isMatching )
-				{
-					//determine exact size of record
-					//unsigned int szOfRecord = sizeOfRecord(_recordDescriptor, curRecord);
-
-					//priorly misunderstood function: copy record to the data
-					//memcpy(data, curRecord, szOfRecord);
-					//copy only fields that are directly mentioned inside _attributes
-					std::vector<string>::iterator selectAttrIter = _attributes.begin(),
-							selectAttrEnd = _attributes.end();
-
-					void* ptrOfCurRecord = curRecord;
-
-					//loop thru fields that needs to be placed into select set
-					for( ; selectAttrIter != selectAttrEnd; selectAttrIter++ )
-					{
-						//reset current record pointer
-						curRecord = ptrOfCurRecord;
-
-						//another alternative I can think of is to use readAttribute function which would be called from within this loop at every iteration
-						//to read the record fields into the data buffer
-						//loop thru all fields of record to determine proper starting offset of the selected attribute
-						std::vector<Attribute>::iterator allAttrIter = _recordDescriptor.begin(), allAttrEnd = _recordDescriptor.end();
-						for( ; allAttrIter != allAttrEnd; allAttrIter++ )
-						{
-							//add size of attribute to data, which stores the set of selected fields
-							int attrSz = 0;
-							switch(allAttrIter->type)
-							{
-							case AttrType(0):	//Integer
-								attrSz = sizeof(int);
-								//memcpy(data, curRecord, attrSz);
-								break;
-							case AttrType(1):	//Real
-								attrSz = sizeof(float);
-								//memcpy(data, curRecord, attrSz);
-								break;
-							case AttrType(2):	//VarChar
-								attrSz = *((unsigned int*)curRecord) + sizeof(unsigned int);
-								//memcpy(data, curRecord, attrSz);
-								break;
-							}
-
-							//if the iterated attribute is the one selected, then
-							if( allAttrIter->name == *selectAttrIter )
-							{
-								//copy it into the data buffer
-								memcpy(data, curRecord, attrSz);
-
-								//increment the data buffer pointer
-								data = (void*)((char*)data + attrSz);
-
-								//go to the next selected attribute
-								break;
-							}
-							curRecord = (void*)((char*)curRecord + attrSz);
-						}
-					}
-
-					//deallocate space for record
-					free(ptrOfCurRecord);
-
-					//increment internal slot counter to next item
-					_slotnum++;
-
-					//return success
-					return 0;	//do not substitute 0 with errCode, since the later value is likely to be equal to -27 or -23 (see above)
+					errCode = 0;
+					continue;
 				}
 
-				//if it is not match, then go to next record
+				curRecord = movedRecord;
+			}
+
+			//check whether this record satisfies given condition (and get its selected fields)
+			bool isMatching = false;
+			unsigned int szData = 0;
+			errCode = filterRecord(curRecord, selectedFields, szData, isMatching, szOfSelectedFields);
+
+			//buffer grows for the values kept in overflow pages
+			if( errCode == -28 )
+			{
+				selectedFields = realloc(selectedFields, szData);
+				szOfSelectedFields = szData;
+				errCode = filterRecord(curRecord, selectedFields, szData, isMatching, szOfSelectedFields);
+			}
+
+			if( errCode != 0 )
+			{
 				break;
 			}
 
-			//increment to the next field
-			ptrField = (void*)( (char*)ptrField + szOfField );
+			//record that does not fit is returned by the next call
+			if( isMatching && batch.addRecord(rid, selectedFields, szData) == false )
+			{
+				isFull = true;
+				break;
+			}
 		}
 
-		//go to the next slot
-		_slotnum++;
+		if( errCode != 0 || isFull )
+		{
+			break;
+		}
 
+		//go to the next page
+		_pagenum++;
+		_slotnum = 0;
 	}
 
-	//deallocate space for record
-	free(curRecord);
+	free(dataPage);
+	free(movedRecord);
+	free(selectedFields);
 
-	//return success
-	return errCode;
+	if( errCode != 0 )
+	{
+		return errCode;
+	}
+
+	//batch cannot hold a single record
+	if( isFull && batch.getNumRecords() == 0 )
+	{
+		return -28;
+	}
+
+	return batch.getNumRecords() == 0 ? RBFM_EOF : 0;
+}
+
+//RecordBatch section of code
+
+RecordBatch::RecordBatch(const unsigned int capacity)
+: _data((char*)malloc(capacity)), _capacity(capacity), _size(0)
+{
+}
+
+RecordBatch::~RecordBatch()
+{
+	free(_data);
+}
+
+unsigned int RecordBatch::getNumRecords() const
+{
+	return _rids.size();
+}
+
+const RID& RecordBatch::getRid(const unsigned int index) const
+{
+	return _rids[index];
+}
+
+const void* RecordBatch::getRecord(const unsigned int index) const
+{
+	return _data + _offsets[index];
+}
+
+unsigned int RecordBatch::getRecordSize(const unsigned int index) const
+{
+	return (index + 1 < _offsets.size() ? _offsets[index + 1] : _size) - _offsets[index];
+}
+
+unsigned int RecordBatch::getCapacity() const
+{
+	return _capacity;
+}
+
+void RecordBatch::clear()
+{
+	_size = 0;
+	_rids.clear();
+	_offsets.clear();
+}
+
+bool RecordBatch::addRecord(const RID &rid, const void *data, const unsigned int size)
+{
+	if( _size + size > _capacity )
+	{
+		return false;
+	}
+
+	memcpy(_data + _size, data, size);
+
+	_rids.push_back(rid);
+	_offsets.push_back(_size);
+	_size += size;
+
+	return true;
+}
+
+void RecordBatch::swap(RecordBatch &other)
+{
+	std::swap(_data, other._data);
+	std::swap(_capacity, other._capacity);
+	std::swap(_size, other._size);
+	_rids.swap(other._rids);
+	_offsets.swap(other._offsets);
 }
 
 RID RBFM_ScanIterator::getActualRecordId()
@@ -1888,8 +4303,8 @@ RID RBFM_ScanIterator::getActualRecordId()
     }
 
     //allocate array for storing contents of the data page
-    void* dataPage = malloc(PAGE_SIZE);
-    memset(dataPage, 0, PAGE_SIZE);
+    void* dataPage = malloc(_fileHandle.getPageSize());
+    memset(dataPage, 0, _fileHandle.getPageSize());
 
     //read data page
     if(  _fileHandle.readPage(_pagenum, dataPage) != 0 )
@@ -1901,6 +4316,30 @@ RID RBFM_ScanIterator::getActualRecordId()
     	return actual_rid;
     }
 
+    unsigned int olderSlotNumber = (_slotnum <= 0 ? 0 : _slotnum - 1);
+
+    //PAX page keeps place of the moved record in its list of moved records
+    if( _fileHandle.getPageLayout() == LAYOUT_PAX )
+    {
+    	PaxPage page(dataPage, _fileHandle.getPageSize());
+
+    	switch( page.getSlotState(olderSlotNumber) )
+    	{
+    	case PAX_SLOT_DELETED:
+    		break;
+    	case PAX_SLOT_MOVED:
+    		actual_rid = page.getMovedRid(olderSlotNumber);
+    		break;
+    	default:
+    		actual_rid.pageNum = _pagenum;
+    		actual_rid.slotNum = olderSlotNumber;
+    		break;
+    	}
+
+    	free(dataPage);
+    	return actual_rid;
+    }
+
     /*
 	 * data page has a following format:
 	 * [list of records without any spaces in between][free space for records][list of directory slots][(number of slots):unsigned int][(offset from page start to the start of free space):unsigned int]
@@ -1909,13 +4348,11 @@ RID RBFM_ScanIterator::getActualRecordId()
 	 */
 
     //get pointer to the end of directory slots
-    PageDirSlot* ptrEndOfDirSlot = (PageDirSlot*)((char*)dataPage + PAGE_SIZE - 2 * sizeof(unsigned int));
+    PageDirSlot* ptrEndOfDirSlot = (PageDirSlot*)((char*)dataPage + _fileHandle.getPageSize() - 2 * sizeof(unsigned int));
 
     //find out number of directory slots
     unsigned int numSlots = *((unsigned int*)ptrEndOfDirSlot);
 
-    unsigned int olderSlotNumber = (_slotnum <= 0 ? 0 : _slotnum - 1);
-
     //check if rid is correct in terms of indexed slot
     if( olderSlotNumber >= numSlots )
     {
@@ -1947,32 +4384,15 @@ RID RBFM_ScanIterator::getActualRecordId()
     //in case the record in this page is a TombStone
     if( szRecord == (unsigned int)-1 )
     {
-    	//redirect to a different location; (page, slot) is specified in the record's body
+    	//redirect to a different location; (page, slot) is specified in the record's body (TombStone never points at another
+    	//TombStone, see updateForwardedRecord, so the moved record itself is not read)
     	RID* ptrNewRid = (RID*)ptrRecord;
 
-    	//create buffer for reading the redirected page
-    	void* redir_page = malloc(PAGE_SIZE);
-    	memset(redir_page, 0, PAGE_SIZE);
-
-    	//setup working instance of record based file manager
-    	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
-
-    	//now go ahead and try to read this record
-    	if( rbfm->readRecord(_fileHandle, _recordDescriptor, *ptrNewRid, redir_page) < 0 )
-    	{
-    		//free buffer for page
-    		free(dataPage);
-    		free(redir_page);
-
-    		return actual_rid;
-    	}
-
     	//check if pointer to new rid makes sense
-    	if( ptrNewRid->pageNum == 0 || ptrNewRid->slotNum == (unsigned int)-1 )
+    	if( ptrNewRid->pageNum == 0 || ptrNewRid->pageNum >= _fileHandle.getNumberOfPages() || ptrNewRid->slotNum == (unsigned int)-1 )
     	{
     		//free buffer for page
     		free(dataPage);
-    		free(redir_page);
 
     		return actual_rid;
     	}
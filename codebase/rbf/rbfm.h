@@ -41,6 +41,14 @@ typedef enum { EQ_OP = 0,  // =
            NO_OP       // no condition
 } CompOp;
 
+// Layout of the data pages, chosen when the file is created
+typedef enum { LAYOUT_ROW = 0,  // records are stored one after another (N-ary storage)
+           LAYOUT_PAX       // values of each attribute are grouped in minipages, see pax.h
+} PageLayout;
+
+class PaxPage;
+class RecordCodec;
+
 
 
 /****************************************************************************
@@ -59,13 +67,69 @@ The scan iterator is NOT required to be implemented for part 1 of the project
 //  rbfmScanIterator.close();
 
 
+//default capacity of the record batch (in bytes)
+#define RECORD_BATCH_DEFAULT_CAPACITY (16 * PAGE_SIZE)
+
+/*
+ * caller-owned batch of records returned by RBFM_ScanIterator::getNextBatch: records (in the format of getNextRecord) are stored
+ * one after another inside a single buffer, along with their rids and offsets. Buffer is allocated once and re-used by every call
+**/
+class RecordBatch
+{
+public:
+	RecordBatch(const unsigned int capacity = RECORD_BATCH_DEFAULT_CAPACITY);
+	~RecordBatch();
+
+	unsigned int getNumRecords() const;
+	const RID& getRid(const unsigned int index) const;
+	const void* getRecord(const unsigned int index) const;
+	unsigned int getRecordSize(const unsigned int index) const;
+	//size of the buffer in bytes
+	unsigned int getCapacity() const;
+
+	//remove all records (capacity stays)
+	void clear();
+
+	//append copy of the record; returns false if there is not enough room left in the buffer
+	bool addRecord(const RID &rid, const void *data, const unsigned int size);
+
+	//exchange records and buffers with another batch (batch filled by another thread is handed over without copying)
+	void swap(RecordBatch &other);
+
+private:
+	RecordBatch(const RecordBatch&);
+	RecordBatch& operator=(const RecordBatch&);
+
+	/*
+	 * buffer for records, its size in bytes, and number of bytes used
+	**/
+	char* _data;
+	unsigned int _capacity;
+	unsigned int _size;
+	/*
+	 * rid and offset (from the start of the buffer) of each record
+	**/
+	vector<RID> _rids;
+	vector<unsigned int> _offsets;
+};
+
 class RBFM_ScanIterator {
 public:
 	RBFM_ScanIterator();
 	~RBFM_ScanIterator();
 
 	// "data" follows the same format as RecordBasedFileManager::insertRecord()
+	// (data has to hold projected VarChar values in full, including the ones kept in overflow pages)
 	RC getNextRecord(RID &rid, void *data);
+	//same as getNextRecord for the buffer of szOfData bytes (szData is set to the size of the returned data); if the next record
+	//takes more, returns -28 with szData set to the required size, and the same record is returned by the next call
+	RC getNextRecord(RID &rid, void *data, unsigned int &szData, const unsigned int szOfData);
+	/*
+	 * fill the batch with the next qualifying records (same records, in the same order, as getNextRecord would return them); each
+	 * data page is read once, and all of its records are filtered from that copy. Returns RBFM_EOF if there are no more
+	 * records, -28 if the batch cannot hold even a single record
+	**/
+	RC getNextBatch(RecordBatch &batch);
 	/* returns rid:
 	 * 		if record is a TombStone, then an actual rid is returned
 	 * 		if record is deleted, then rid of {0,0} (i.e. page number = 0 and slot number = 0) is returned (that is a first header page, so such rid is incorrect)
@@ -73,9 +137,39 @@ public:
 	**/
 	RID getActualRecordId();
 	RC close();
+protected:
+	//next record of the file with LAYOUT_PAX: condition and projection touch only minipages of their attributes
+	RC getNextPaxRecord(RID &rid, void *data, unsigned int &szData, const unsigned int szOfData);
+
+	//check condition on the encoded record (see RecordBasedFileManager::encodeRecord), and only if it matches, copy projected attributes
+	//straight from the encoded record into data (szData is set to their size); record is never decoded as a whole. If projected
+	//attributes take more than szOfData bytes, returns -28 with szData set to the required size (data is left untouched)
+	RC filterRecord(const void *encodedRecord, void *data, unsigned int &szData, bool &isMatching, const unsigned int szOfData = (unsigned int)-1);
+
+	//locate field inside the encoded record (fields that record does not have, and NULL fields, are returned empty); isOverflow is
+	//set if the field holds OverflowPointer rather than the value
+	void getEncodedField(const void *encodedRecord, const int position, const char *&ptrField, unsigned int &szOfField, bool &isOverflow);
+
+	//same as filterRecord for the slot of the PAX page, fields are taken straight from the minipages (moved record is read into
+	//movedRecord); records that are not returned at this slot (deleted, or moved here from another slot) never match
+	RC filterPaxRecord(PaxPage &page, const unsigned int slotNum, void *movedRecord, void *data, unsigned int &szData, bool &isMatching,
+			const unsigned int szOfData = (unsigned int)-1);
+
+	//compare field (in the form it has inside the encoded record) with the value of the condition (value kept in overflow pages
+	//is read only if its length is the same as the length of the condition value)
+	RC compareField(const char *ptrField, const unsigned int szOfField, const bool isOverflow, bool &isMatching);
+
+	//number of bytes copyField appends for the field (value kept in overflow pages counts in full)
+	unsigned int getProjectedFieldSize(const int position, const char *ptrField, const unsigned int szOfField, const bool isOverflow);
+
+	//append projected field to data (VarChar gets its length back, fixed size field that record does not have is returned as 0,
+	//value kept in overflow pages is read from them)
+	RC copyField(const int position, const char *ptrField, const unsigned int szOfField, const bool isOverflow, char *&ptrData);
 public:
 	PageNum	_pagenum;
 	unsigned int	_slotnum;
+	//scan stops before this page (0 = scan goes to the end of file), used by ParallelScan to limit iterator to a morsel
+	PageNum _endPagenum;
 	FileHandle _fileHandle;
 	vector<Attribute> _recordDescriptor;
 	vector<string> _attributes;
@@ -83,6 +177,96 @@ public:
 	CompOp _compO;					// comparision type such as "<" and "="
 	const void* _value;					// used in the comparison
 	//vector<string> _attributeNames;
+	//positions of the condition attribute and of the projected attributes inside _recordDescriptor (-1 if not found), set by scan
+	int _conditionPosition;
+	vector<int> _attributePositions;
+	//index of each attribute among the attributes of its kind (see ::getFieldIndexes), set by scan
+	vector<unsigned int> _fieldIndexes;
+};
+
+/*
+ * copy of the data page filled by RecordBasedFileManager::insertRecords (pages of the batch are identified by header page id and
+ * index of their entry, since new pages get their page id only when they are allocated)
+**/
+struct BatchPage
+{
+	/*
+	 * content of the page
+	**/
+	void* _data;
+	/*
+	 * page id (meaningful once page is allocated)
+	**/
+	PageNum _pageNum;
+	/*
+	 * new page is not allocated yet (i.e. it is appended, or takes free page, along with its records)
+	**/
+	bool _isNew;
+	/*
+	 * page has records that are not written yet
+	**/
+	bool _isDirty;
+	/*
+	 * indexes of rids (of the batch) that point to this page
+	**/
+	vector<unsigned int> _ridIndexes;
+};
+
+/*
+ * encoded record (see RecordBasedFileManager::encodeRecord) has a following format:
+ * [RecordHeader][null bitmap][end offset of each VarChar value][TypeInt/TypeReal values][characters of VarChar values]
+ *
+ * null bitmap has a bit for each field of the record (set = field is NULL, see RECORD_FIELD_IS_NULL), in whole unsigned ints;
+ * TypeInt/TypeReal values take 4 bytes each (NULL one too) and are stored in the order of their attributes, so that their offsets
+ * depend only on the number of fields; only VarChar values have entries in the directory, i.e. their end offsets (measured from
+ * the start of the record, the first value starts right after the TypeInt/TypeReal values)
+**/
+struct RecordHeader
+{
+	/*
+	 * number of fields of the record (attributes added to the table afterwards are not there)
+	**/
+	unsigned short _numFields;
+	/*
+	 * number of VarChar fields among them, i.e. number of entries of the directory
+	**/
+	unsigned short _numVarFields;
+};
+
+/*
+ * field of the encoded record whose VarChar value is kept in a chain of overflow pages (see RecordBasedFileManager::storeOverflowFields);
+ * it takes place of the value inside the record, and the end offset of the field in the record directory has OVERFLOW_FIELD_FLAG set
+**/
+struct OverflowPointer
+{
+	/*
+	 * number of characters of the value
+	**/
+	unsigned int _length;
+	/*
+	 * first page of the chain
+	**/
+	PageNum _firstPage;
+};
+
+/*
+ * overflow page has a following format:
+ * [OverflowPageHeader][characters][free space][0:unsigned int][0:unsigned int]
+ *
+ * it is not referenced by header pages; the first three integers and the last two are 0, so that page looks empty to the scan
+ * of either layout (0 slots of the PAX page, and 0 directory slots of the row-wise page)
+**/
+struct OverflowPageHeader
+{
+	unsigned int _reserved[3];
+	/*
+	 * next page of the chain (0 = last page)
+	**/
+	PageNum _nextPage;
+	/*
+	 * number of characters stored in this page
+	**/
+	unsigned int _numBytes;
 };
 
 class RecordBasedFileManager
@@ -90,11 +274,13 @@ class RecordBasedFileManager
 public:
   static RecordBasedFileManager* instance();
 
-  RC createFile(const string &fileName);
+  //page size of the file can be chosen in range [PAGE_SIZE, MAX_PAGE_SIZE] (power of two), layout of its data pages is stored
+  //in the first header page (every operation below handles both layouts)
+  RC createFile(const string &fileName, const unsigned int pageSize = PAGE_SIZE, const PageLayout layout = LAYOUT_ROW);
   
   RC destroyFile(const string &fileName);
   
-  RC openFile(const string &fileName, FileHandle &fileHandle);
+  RC openFile(const string &fileName, FileHandle &fileHandle, FileIOMode ioMode = IO_STDIO);
   
   RC closeFile(FileHandle &fileHandle);
 
@@ -103,14 +289,30 @@ public:
   //  2) For int and real: use 4 bytes to store the value;
   //     For varchar: use 4 bytes to store the length of characters, then store the actual characters.
   //  !!!The same format is used for updateRecord(), the returned data of readRecord(), and readAttribute()
-  RC insertRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *data, RID &rid);
+  //  VarChar values too large for the page are kept in chains of overflow pages, so record may be larger than a page
+  //  codec (see codec.h), if given, has to be built for recordDescriptor; it replaces sizeOfRecord/encodeRecord/decodeRecord
+  //  here and in insertRecords(), readRecord() and updateRecord()
+  RC insertRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *data, RID &rid, const RecordCodec* codec = NULL);
+
+  //insert batch of records (each one in the format of insertRecord): records are packed into copies of the data pages, so that
+  //each touched data page and header page is written once per part of the batch; records end up in the same pages as if they
+  //were inserted one by one. Every part is an operation of the write-ahead log that takes up at most half of the buffer pool.
+  //On failure rids holds the records that stay inserted: the ones before the failed record, or (while logging is on) the
+  //ones of the parts committed before the failed part, which is rolled back
+  RC insertRecords(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const vector<const void*> &data, vector<RID> &rids,
+		  const RecordCodec* codec = NULL);
 
   //read record and decoded it
-  RC readRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid, void *data);
+  RC readRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid, void *data, const RecordCodec* codec = NULL);
   
-  //read record but do not decode it
+  //read record but do not decode it (fields kept in overflow pages are left as OverflowPointer, see storeOverflowFields)
   RC readEncodedRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid, void *data);
 
+  //memory-mapped (IO_MMAP) handles only: get pointer to the encoded record inside the mapping, i.e. without copying the page
+  //tombstones are followed, fields in overflow pages are left as OverflowPointer; returns -72 if the page is not mapped (caller
+  //should use readEncodedRecord)
+  RC getMappedRecord(FileHandle &fileHandle, const RID &rid, const void*& encodedRecord, unsigned int& szRecord);
+
   /*
    * get page (if necessary insert new) that has enough free space for specified size of record
   **/
@@ -131,8 +333,9 @@ public:
   //elements, and this function basically loops thru the list and determines the number of real fields
   int numOfFieldsInRecordDirectory(const vector<Attribute> recordDescriptor);
 
-  //convert record's data (stored by originalRecordData) into new format that allows O(1) field access, which is accomplished through the use of
-  //"record directory of offsets" that stores list of offsets of each field (from the start of the first record to the end of the last record)
+  //convert record's data (stored by originalRecordData) into new format that allows O(1) field access (see RecordHeader): TypeInt/TypeReal
+  //fields are stored at static offsets, and "record directory of offsets" keeps only end offsets of VarChar fields; dropped attributes
+  //are NULL fields of the record
   //NOTE: all of these offsets are measured from the start of the record
   void encodeRecord(
 		  const vector<Attribute> &recordDescriptor,
@@ -142,6 +345,7 @@ public:
 		  void* newRecordData);
 
   //convert encoded record format into original, i.e. by removing "record directory of offsets" and restoring length parameters for the VARCHAR cases
+  //(NULL fields, and fields that record does not have, get default value: 0 for TypeInt/TypeReal, "" for VarChar)
   void decodeRecord(
 		  const vector<Attribute>& recordDescriptor,
 		  const void* encodedRecordData,
@@ -158,7 +362,7 @@ IMPORTANT, PLEASE READ: All methods below this comment (other than the construct
   RC deleteRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid);
 
   // Assume the rid does not change after update
-  RC updateRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *data, const RID &rid);
+  RC updateRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *data, const RID &rid, const RecordCodec* codec = NULL);
 
   RC readAttribute(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid, const string attributeName, void *data);
 
@@ -179,12 +383,104 @@ public:
 
   RC reorganizeFile(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor);
 
+  //online pass that moves records forwarded by updateRecord (TombStones, moved slots of PAX pages) back into their home pages,
+  //once those have enough free space; each call examines at most maxPages data pages (0 = whole file), continuing from the page
+  //the previous call of the file stopped at, and each moved record is a separate operation of the write-ahead log
+  RC migrateForwardedRecords(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const unsigned int maxPages, unsigned int &numMigrated);
+
 
 protected:
   RecordBasedFileManager();
   ~RecordBasedFileManager();
 
+  //bodies of the modifying operations (public versions wrap them into atomic operation of the write-ahead log)
+  RC insertRecordInternal(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *data, RID &rid, const RecordCodec* codec);
+  //inserts records from nextRecord on, until the part of the batch is full (nextRecord is moved past the inserted ones)
+  RC insertRecordsInternal(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const vector<const void*> &data,
+		  unsigned int &nextRecord, vector<RID> &rids, const RecordCodec* codec);
+  RC deleteRecordInternal(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid);
+  RC updateRecordInternal(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *data, const RID &rid, const RecordCodec* codec);
+  RC reorganizePageInternal(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const unsigned pageNumber);
+
+  //allocate new pages of the batch (in the order they were added, so that page ids come out as for records inserted one by one)
+  RC allocateBatchPages(FileHandle &fileHandle, map<PageNum, void*> &headerPages, map< pair<PageNum, unsigned int>, BatchPage > &pages,
+		  vector< pair<PageNum, unsigned int> > &newPages, vector<RID> &rids);
+
+  //reserve directory slot and space for the record inside the data page (in memory), -22 if page does not have enough space
+  RC reserveRecordSlot(void* data, const unsigned int pageSize, const unsigned int szRecord, PageDirSlot& slot, unsigned int& slotNum);
+
+  //LAYOUT_PAX versions of the record operations (see pax.h), record is inserted with the given slot state
+  RC insertPaxRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *encData, const unsigned int state, RID &rid);
+  RC readPaxRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid, void *data);
+  RC deletePaxRecord(FileHandle &fileHandle, const RID &rid);
+  RC updatePaxRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *encData, const RID &rid);
+
+  //insert encoded record into the row-wise data page that has enough free space (-21 if record cannot fit into a page)
+  RC insertEncodedRecord(FileHandle &fileHandle, const void *encData, const unsigned int szOfEncRecord, RID &rid);
+
+  //put encoded record in place of the one at rid of the row-wise file (or move it, leaving TombStone behind); if the replaced
+  //record has fields in overflow pages, its copy is returned in replacedRecord (caller frees it), so that its chains can be freed
+  RC updateRowRecord(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const void *encRecordData, const unsigned int szOfEncRecord,
+		  const RID &rid, void*& replacedRecord);
+
+  //updateRowRecord of the record whose home slot (homeSlot inside homePage, the copy of the page at rid) is a TombStone: record is
+  //updated where it is, or brought back into its home page, or else moved again with the TombStone re-pointed at its new place
+  //(TombStones never point at other TombStones)
+  RC updateForwardedRecord(FileHandle &fileHandle, const void *encRecordData, const unsigned int szOfEncRecord, const RID &rid,
+		  void *homePage, PageDirSlot *homeSlot, void*& replacedRecord);
+
+  //put encoded record into the slot of the row-wise data page (in memory), in place of whatever the slot held; records of the page
+  //are packed together if its free space is fragmented. Returns -22 if page does not have enough space (page is left intact)
+  RC placeRowRecord(void* data, const unsigned int pageSize, const unsigned int slotNum, const void *encData, const unsigned int szOfEncRecord);
+
+  //pack records of the row-wise data page (in memory) together in the order of their slots, leaving out the record of skipSlot
+  //(if given); free space starts right after them. Returns offset of the start of free space
+  unsigned int packRowRecords(void* data, const unsigned int pageSize, const PageDirSlot* skipSlot = NULL);
+
+  //number of contiguous free bytes of the row-wise data page (the value kept in its header page entry)
+  unsigned int getRowPageFreeSpace(const void* data, const unsigned int pageSize);
+
+  //bring forwarded records of the home page back into it (numMigrated is incremented for each of them)
+  RC migrateRowPage(FileHandle &fileHandle, const PageNum pageNum, unsigned int &numMigrated);
+  RC migratePaxPage(FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const PageNum pageNum, unsigned int &numMigrated);
+
+  //move VarChar values of the encoded record that are larger than OVERFLOW_THRESHOLD into chains of overflow pages, and then the
+  //largest remaining ones until record fits into a page; record is re-packed in place with OverflowPointer instead of each moved
+  //value (record that has no large values is left as is)
+  RC storeOverflowFields(FileHandle &fileHandle, void *encData, unsigned int &szOfEncRecord);
+
+  //write value into a new chain of overflow pages
+  RC writeOverflowValue(FileHandle &fileHandle, const void *value, const unsigned int length, PageNum &firstPage);
+
+  //read value of the chain into the buffer (of at least pointer._length bytes), -82 if chain is corrupted
+  RC readOverflowValue(FileHandle &fileHandle, const OverflowPointer &pointer, void *value);
+
+  //give pages of the chain back to the allocation map
+  RC freeOverflowChain(FileHandle &fileHandle, const PageNum firstPage);
+
+  //free chains of all fields of the encoded record that are kept in overflow pages
+  RC freeOverflowFields(FileHandle &fileHandle, const void *encData);
+
+  //encoded record has fields kept in overflow pages
+  bool hasOverflowFields(const void *encData);
+
+  //copy of the encoded record with values of overflow pages put back in place (allocated with malloc, caller frees it)
+  RC inlineOverflowFields(FileHandle &fileHandle, const void *encData, void*& fullRecord);
+
+  //store exact number of free bytes of the data page in its header page entry (if it changed)
+  RC setPageFreeSpace(FileHandle &fileHandle, const PageNum pageNum, const unsigned int numFreeBytes);
+
+  //header pages (and pages of the allocation map) are interleaved with data pages, so record-by-record walk of the file has to skip them
+  bool isHeaderPage(FileHandle &fileHandle, const PageNum pageNum);
+
+  //page is listed by a header page, i.e. it is not a header page, page of the allocation map, overflow page or free page
+  bool isDataPage(FileHandle &fileHandle, const PageNum pageNum);
+
 private:
+  //batch scan walks data pages by itself, so it needs to skip header pages (and overflow pages)
+  friend class RBFM_ScanIterator;
+  friend class ParallelScan;
+
   static RecordBasedFileManager *_rbf_manager;
   static PagedFileManager *_pfm;
 };
@@ -194,14 +490,51 @@ private:
 //size of TombStone (for part 2 of the project)
 #define TOMBSTONE_SIZE (sizeof(RID))	//page number, slot number
 
+//set in the record directory on the end offset of the field that is kept in overflow pages, and the offset without it
+#define OVERFLOW_FIELD_FLAG 0x80000000
+#define FIELD_OFFSET(offset) ((offset) & ~OVERFLOW_FIELD_FLAG)
+
+//parts of the encoded record with numFields fields, numVarFields of them VarChar (see RecordHeader): size of the null bitmap,
+//offset of the directory, offset of the first TypeInt/TypeReal value and offset of the first character of VarChar values
+#define RECORD_NULL_BITMAP_SIZE(numFields) (sizeof(unsigned int) * (((numFields) + 31) / 32))
+#define RECORD_DIR_OFFSET(numFields) (sizeof(RecordHeader) + RECORD_NULL_BITMAP_SIZE(numFields))
+#define RECORD_FIXED_OFFSET(numFields, numVarFields) (RECORD_DIR_OFFSET(numFields) + sizeof(unsigned int) * (numVarFields))
+#define RECORD_VARCHAR_OFFSET(numFields) (RECORD_DIR_OFFSET(numFields) + sizeof(unsigned int) * (numFields))
+
+//bit of the field in the null bitmap (it follows RecordHeader)
+#define RECORD_FIELD_IS_NULL(encodedRecord, position) \
+	((((const unsigned int*)((const char*)(encodedRecord) + sizeof(RecordHeader)))[(position) / 32] >> ((position) % 32)) & 1)
+#define RECORD_SET_FIELD_NULL(encodedRecord, position) \
+	(((unsigned int*)((char*)(encodedRecord) + sizeof(RecordHeader)))[(position) / 32] |= 1u << ((position) % 32))
+
+//VarChar values longer than this always go to overflow pages (shorter ones only if record does not fit into a page otherwise)
+#define OVERFLOW_THRESHOLD(pageSize) ((pageSize) / 2)
+
+//number of characters held by a single overflow page
+#define OVERFLOW_CHUNK_SIZE(pageSize) ((pageSize) - sizeof(OverflowPageHeader) - 2 * sizeof(unsigned int))
+
 /*
  * threshold size of the record, i.e. the largest size that can fit within single page and allow some space for meta-data and slot directory be left
 **/
-#define MAX_SIZE_OF_RECORD (PAGE_SIZE - sizeof(unsigned int) - sizeof(unsigned int) - sizeof(PageDirSlot))
+#define MAX_SIZE_OF_RECORD_IN_PAGE(pageSize) ((pageSize) - sizeof(unsigned int) - sizeof(unsigned int) - sizeof(PageDirSlot))
+#define MAX_SIZE_OF_RECORD MAX_SIZE_OF_RECORD_IN_PAGE(PAGE_SIZE)
 
 /*
  * prototype for the stand-alone function for determining size of the record (in bytes)
 **/
 unsigned int sizeOfRecord(const vector<Attribute> &recordDescriptor, const void *data);
 
+/*
+ * index of each attribute among the TypeInt/TypeReal attributes or among the VarChar attributes (i.e. its entry in the directory
+ * of the encoded record), depending on its type; computed once per descriptor, so that getEncodedField is O(1)
+**/
+void getFieldIndexes(const vector<Attribute> &recordDescriptor, vector<unsigned int> &fieldIndexes);
+
+/*
+ * locate field of the encoded record (fieldIndex comes from getFieldIndexes): fields that record does not have (added to the table
+ * after the record was written) and NULL fields are returned empty, with isNull set; isOverflow is set if the field holds OverflowPointer
+**/
+void getEncodedField(const void *encodedRecord, const unsigned int position, const AttrType type, const unsigned int fieldIndex,
+		const char *&ptrField, unsigned int &szOfField, bool &isOverflow, bool &isNull);
+
 #endif
@@ -0,0 +1,160 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "pfm.h"
+#include "bpm.h"
+
+using namespace std;
+
+const int success = 0;
+
+// Check if a file exists
+bool FileExists(string fileName) {
+	struct stat stFileInfo;
+
+	if (stat(fileName.c_str(), &stFileInfo) == 0)
+		return true;
+	else
+		return false;
+}
+
+void preparePage(const unsigned pageNum, void *data) {
+	for (unsigned i = 0; i < PAGE_SIZE; i++) {
+		*((char *) data + i) = (i + pageNum) % 94 + 32;
+	}
+}
+
+int RBFTest_17(PagedFileManager *pfm) {
+	// Functions Tested:
+	// 1. Append/Read/Write pages thru buffer pool that is smaller than the file
+	// 2. Write back of dirty pages on eviction and on close
+	// 3. Logical vs. physical page counters
+	// 4. Pin/Unpin
+	cout << "****In RBF Test Case 17****" << endl;
+
+	RC rc;
+	string fileName = "test17";
+	const unsigned numPages = 20;
+
+	// Small buffer pool, so that pages get evicted
+	rc = pfm->setBufferPoolSize(4);
+	assert(rc == success);
+
+	rc = pfm->createFile(fileName.c_str());
+	assert(rc == success);
+
+	FileHandle fileHandle;
+	rc = pfm->openFile(fileName.c_str(), fileHandle);
+	assert(rc == success);
+
+	void *data = malloc(PAGE_SIZE);
+	void *buffer = malloc(PAGE_SIZE);
+
+	// Append pages
+	for (unsigned i = 0; i < numPages; i++) {
+		preparePage(i, data);
+		rc = fileHandle.appendPage(data);
+		assert(rc == success);
+	}
+
+	// Read them back (most of them were evicted)
+	for (unsigned i = 0; i < numPages; i++) {
+		preparePage(i, data);
+		rc = fileHandle.readPage(i, buffer);
+		assert(rc == success);
+		if (memcmp(data, buffer, PAGE_SIZE) != 0) {
+			cout << "Page " << i << " is corrupted after eviction" << endl;
+			return -1;
+		}
+	}
+
+	unsigned readCount = 0, writeCount = 0, appendCount = 0;
+	unsigned physReadCount = 0, physWriteCount = 0;
+	fileHandle.collectCounterValues(readCount, writeCount, appendCount);
+	fileHandle.collectPhysicalCounterValues(physReadCount, physWriteCount);
+	cout << "logical - read: " << readCount << " write: " << writeCount << " append: " << appendCount << endl;
+	cout << "physical - read: " << physReadCount << " write: " << physWriteCount << endl;
+	if (readCount != numPages || appendCount != numPages || physWriteCount == 0) {
+		cout << "Counters are not correct" << endl;
+		return -1;
+	}
+
+	// Same page is read twice, second read has to be a hit
+	unsigned hits = 0, misses = 0, evictions = 0, writeBacks = 0, hits2 = 0;
+	rc = fileHandle.readPage(numPages - 1, buffer);
+	assert(rc == success);
+	pfm->collectBufferPoolCounters(hits, misses, evictions, writeBacks);
+	rc = fileHandle.readPage(numPages - 1, buffer);
+	assert(rc == success);
+	pfm->collectBufferPoolCounters(hits2, misses, evictions, writeBacks);
+	if (hits2 != hits + 1) {
+		cout << "Re-reading cached page did not hit the buffer pool" << endl;
+		return -1;
+	}
+
+	// Modify page in place
+	void *frame = NULL;
+	rc = fileHandle.pinPage(3, frame);
+	assert(rc == success);
+	memset(frame, 'x', PAGE_SIZE);
+	rc = fileHandle.unpinPage(3, true);
+	assert(rc == success);
+
+	// Unpinning page that is not pinned should fail
+	rc = fileHandle.unpinPage(3, false);
+	assert(rc != success);
+
+	rc = pfm->closeFile(fileHandle);
+	assert(rc == success);
+
+	// Data has to survive close and re-open
+	rc = pfm->openFile(fileName.c_str(), fileHandle);
+	assert(rc == success);
+
+	for (unsigned i = 0; i < numPages; i++) {
+		if (i == 3)
+			memset(data, 'x', PAGE_SIZE);
+		else
+			preparePage(i, data);
+		rc = fileHandle.readPage(i, buffer);
+		assert(rc == success);
+		if (memcmp(data, buffer, PAGE_SIZE) != 0) {
+			cout << "Page " << i << " is corrupted after re-open" << endl;
+			return -1;
+		}
+	}
+
+	rc = pfm->closeFile(fileHandle);
+	assert(rc == success);
+
+	rc = pfm->destroyFile(fileName.c_str());
+	assert(rc == success);
+
+	rc = pfm->setBufferPoolSize(BUFFER_POOL_DEFAULT_NUM_FRAMES);
+	assert(rc == success);
+
+	free(data);
+	free(buffer);
+
+	return 0;
+}
+
+int main() {
+	PagedFileManager *pfm = PagedFileManager::instance();
+
+	remove("test17");
+
+	int rc = RBFTest_17(pfm);
+	if (rc == 0) {
+		cout << "Test Case 17 Passed!" << endl << endl;
+	} else {
+		cout << "Test Case 17 Failed!" << endl << endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,185 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <pthread.h>
+
+#include "pfm.h"
+#include "bpm.h"
+
+using namespace std;
+
+const int success = 0;
+const unsigned numPages = 64;
+const unsigned numThreads = 4;
+const unsigned numRounds = 10;
+
+void preparePage(const unsigned pageNum, void *data) {
+	for (unsigned i = 0; i < PAGE_SIZE; i++) {
+		*((char *) data + i) = (i + pageNum) % 94 + 32;
+	}
+}
+
+struct ReaderArgs {
+	FileHandle fileHandle;
+	unsigned threadId;
+	unsigned numErrors;
+};
+
+// Each thread reads all pages of the file (starting from different page), so that pool misses of different threads overlap
+void *readPages(void *arg) {
+	ReaderArgs *args = (ReaderArgs *) arg;
+	void *data = malloc(PAGE_SIZE);
+	void *buffer = malloc(PAGE_SIZE);
+
+	for (unsigned round = 0; round < numRounds; round++) {
+		for (unsigned k = 0; k < numPages; k++) {
+			unsigned pageNum = (k + args->threadId * numPages / numThreads) % numPages;
+			preparePage(pageNum, data);
+			if (args->fileHandle.readPage(pageNum, buffer) != success || memcmp(data, buffer, PAGE_SIZE) != 0) {
+				args->numErrors++;
+			}
+		}
+	}
+
+	free(data);
+	free(buffer);
+	return NULL;
+}
+
+int readConcurrently(PagedFileManager *pfm, const string &fileName, FileIOMode ioMode) {
+	RC rc;
+	FileHandle fileHandle;
+	rc = pfm->openFile(fileName.c_str(), fileHandle, ioMode);
+	assert(rc == success);
+
+	// Threads use copies of the same handle
+	pthread_t threads[numThreads];
+	ReaderArgs args[numThreads];
+	for (unsigned i = 0; i < numThreads; i++) {
+		args[i].fileHandle = fileHandle;
+		args[i].threadId = i;
+		args[i].numErrors = 0;
+		pthread_create(&threads[i], NULL, readPages, &args[i]);
+	}
+
+	unsigned numErrors = 0;
+	for (unsigned i = 0; i < numThreads; i++) {
+		pthread_join(threads[i], NULL);
+		numErrors += args[i].numErrors;
+	}
+
+	if (numErrors > 0) {
+		cout << "Concurrent reads (mode " << ioMode << ") returned " << numErrors << " wrong pages" << endl;
+		return -1;
+	}
+
+	// Modify page thru this handle
+	void *data = malloc(PAGE_SIZE);
+	memset(data, 'a' + ioMode, PAGE_SIZE);
+	rc = fileHandle.writePage(5, data);
+	assert(rc == success);
+	free(data);
+
+	rc = pfm->closeFile(fileHandle);
+	assert(rc == success);
+
+	return 0;
+}
+
+int RBFTest_18(PagedFileManager *pfm) {
+	// Functions Tested:
+	// 1. Open file with IO_PREAD / IO_DIRECT backend
+	// 2. Read pages of the same file from several threads at once
+	// 3. Pages written thru positional I/O are visible to stdio handle
+	cout << "****In RBF Test Case 18****" << endl;
+
+	RC rc;
+	string fileName = "test18";
+
+	// Small buffer pool, so that threads keep missing
+	rc = pfm->setBufferPoolSize(8);
+	assert(rc == success);
+
+	rc = pfm->createFile(fileName.c_str());
+	assert(rc == success);
+
+	FileHandle fileHandle;
+	rc = pfm->openFile(fileName.c_str(), fileHandle);
+	assert(rc == success);
+
+	void *data = malloc(PAGE_SIZE);
+	void *buffer = malloc(PAGE_SIZE);
+
+	for (unsigned i = 0; i < numPages; i++) {
+		preparePage(i, data);
+		rc = fileHandle.appendPage(data);
+		assert(rc == success);
+	}
+
+	rc = pfm->closeFile(fileHandle);
+	assert(rc == success);
+
+	if (readConcurrently(pfm, fileName, IO_PREAD) != 0)
+		return -1;
+
+	// Page 5 is re-written by the next pass, so restore it
+	rc = pfm->openFile(fileName.c_str(), fileHandle);
+	assert(rc == success);
+	rc = fileHandle.readPage(5, buffer);
+	assert(rc == success);
+	memset(data, 'a' + IO_PREAD, PAGE_SIZE);
+	if (memcmp(data, buffer, PAGE_SIZE) != 0) {
+		cout << "Page written with pwrite is not visible thru stdio handle" << endl;
+		return -1;
+	}
+	preparePage(5, data);
+	rc = fileHandle.writePage(5, data);
+	assert(rc == success);
+	rc = pfm->closeFile(fileHandle);
+	assert(rc == success);
+
+	if (readConcurrently(pfm, fileName, IO_DIRECT) != 0)
+		return -1;
+
+	rc = pfm->openFile(fileName.c_str(), fileHandle);
+	assert(rc == success);
+	rc = fileHandle.readPage(5, buffer);
+	assert(rc == success);
+	memset(data, 'a' + IO_DIRECT, PAGE_SIZE);
+	if (memcmp(data, buffer, PAGE_SIZE) != 0) {
+		cout << "Page written with direct I/O is not visible thru stdio handle" << endl;
+		return -1;
+	}
+	rc = pfm->closeFile(fileHandle);
+	assert(rc == success);
+
+	rc = pfm->destroyFile(fileName.c_str());
+	assert(rc == success);
+
+	rc = pfm->setBufferPoolSize(BUFFER_POOL_DEFAULT_NUM_FRAMES);
+	assert(rc == success);
+
+	free(data);
+	free(buffer);
+
+	return 0;
+}
+
+int main() {
+	PagedFileManager *pfm = PagedFileManager::instance();
+
+	remove("test18");
+
+	int rc = RBFTest_18(pfm);
+	if (rc == 0) {
+		cout << "Test Case 18 Passed!" << endl << endl;
+	} else {
+		cout << "Test Case 18 Failed!" << endl << endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,243 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "pfm.h"
+#include "rbfm.h"
+
+using namespace std;
+
+const int success = 0;
+const unsigned numRecords = 2000;
+
+void createRecordDescriptor(vector<Attribute> &recordDescriptor) {
+
+	Attribute attr;
+	attr.name = "id";
+	attr.type = TypeInt;
+	attr.length = (AttrLength) 4;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "name";
+	attr.type = TypeVarChar;
+	attr.length = (AttrLength) 50;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "score";
+	attr.type = TypeReal;
+	attr.length = (AttrLength) 4;
+	recordDescriptor.push_back(attr);
+}
+
+int prepareRecord(const int id, void *buffer) {
+	int offset = 0;
+	int nameLength = 5 + id % 40;
+	float score = id * 1.5f;
+
+	memcpy((char *) buffer + offset, &id, sizeof(int));
+	offset += sizeof(int);
+	memcpy((char *) buffer + offset, &nameLength, sizeof(int));
+	offset += sizeof(int);
+	memset((char *) buffer + offset, 'a' + id % 26, nameLength);
+	offset += nameLength;
+	memcpy((char *) buffer + offset, &score, sizeof(float));
+	offset += sizeof(float);
+
+	return offset;
+}
+
+int RBFTest_19(RecordBasedFileManager *rbfm) {
+	// Functions Tested:
+	// 1. Open file in read-only memory-mapped mode (IO_MMAP)
+	// 2. readMappedPage / readRecord / scan without buffer pool
+	// 3. Modification thru memory-mapped handle is rejected
+	// 4. File with larger pages is mapped by its own page size
+	cout << "****In RBF Test Case 19****" << endl;
+
+	RC rc;
+	string fileName = "test19";
+
+	rc = rbfm->createFile(fileName);
+	assert(rc == success);
+
+	FileHandle fileHandle;
+	rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success);
+
+	vector<Attribute> recordDescriptor;
+	createRecordDescriptor(recordDescriptor);
+
+	void *record = malloc(PAGE_SIZE);
+	void *returnedData = malloc(PAGE_SIZE);
+	vector<RID> rids;
+	RID rid;
+
+	for (unsigned i = 0; i < numRecords; i++) {
+		prepareRecord(i, record);
+		rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+		assert(rc == success);
+		rids.push_back(rid);
+	}
+
+	unsigned numPages = fileHandle.getNumberOfPages();
+
+	rc = rbfm->closeFile(fileHandle);
+	assert(rc == success);
+
+	rc = rbfm->openFile(fileName, fileHandle, IO_MMAP);
+	assert(rc == success);
+
+	if (fileHandle.getNumberOfPages() != numPages) {
+		cout << "Number of pages is not correct" << endl;
+		return -1;
+	}
+
+	// Page pointer points into the mapping
+	const void *mappedPage = NULL;
+	rc = fileHandle.readMappedPage(1, mappedPage);
+	assert(rc == success);
+	rc = fileHandle.readPage(1, returnedData);
+	assert(rc == success);
+	if (memcmp(mappedPage, returnedData, PAGE_SIZE) != 0) {
+		cout << "Mapped page differs from the copied one" << endl;
+		return -1;
+	}
+
+	// Read-only handle
+	rc = fileHandle.writePage(1, returnedData);
+	assert(rc != success);
+	rc = fileHandle.appendPage(returnedData);
+	assert(rc != success);
+	prepareRecord(0, record);
+	rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+	assert(rc != success);
+
+	unsigned physReadBefore = 0, physReadAfter = 0, physWrite = 0;
+	fileHandle.collectPhysicalCounterValues(physReadBefore, physWrite);
+
+	// Read records one by one
+	for (unsigned i = 0; i < numRecords; i++) {
+		int size = prepareRecord(i, record);
+		rc = rbfm->readRecord(fileHandle, recordDescriptor, rids[i], returnedData);
+		assert(rc == success);
+		if (memcmp(record, returnedData, size) != 0) {
+			cout << "Record " << i << " is not correct" << endl;
+			return -1;
+		}
+	}
+
+	// Scan all records (scan iterator closes its copy of the handle)
+	vector<string> attributes;
+	attributes.push_back("id");
+	attributes.push_back("score");
+	RBFM_ScanIterator scanIterator;
+	rc = rbfm->scan(fileHandle, recordDescriptor, "", NO_OP, NULL, attributes, scanIterator);
+	assert(rc == success);
+
+	// Smaller records fill up earlier pages, so scan order differs from insertion order
+	unsigned count = 0;
+	vector<bool> seen(numRecords, false);
+	while (scanIterator.getNextRecord(rid, returnedData) != RBFM_EOF) {
+		int id = *(int *) returnedData;
+		float score = *(float *) ((char *) returnedData + sizeof(int));
+		if (id < 0 || id >= (int) numRecords || seen[id] || score != id * 1.5f) {
+			cout << "Scan returned wrong record " << id << endl;
+			return -1;
+		}
+		seen[id] = true;
+		count++;
+	}
+
+	if (count != numRecords) {
+		cout << "Scan returned " << count << " records instead of " << numRecords << endl;
+		return -1;
+	}
+
+	// Mapped pages are not read thru the buffer pool
+	fileHandle.collectPhysicalCounterValues(physReadAfter, physWrite);
+	if (physReadAfter != physReadBefore) {
+		cout << "Memory-mapped handle went thru the buffer pool" << endl;
+		return -1;
+	}
+
+	rc = scanIterator.close();
+	assert(rc == success);
+
+	rc = rbfm->destroyFile(fileName);
+	assert(rc == success);
+
+	// Pages of 16 KB: the last one is mapped as a whole
+	string largeFileName = "test19large";
+	const unsigned largePageSize = 4 * PAGE_SIZE;
+	rc = rbfm->createFile(largeFileName, largePageSize);
+	assert(rc == success);
+	FileHandle largeHandle;
+	rc = rbfm->openFile(largeFileName, largeHandle);
+	assert(rc == success);
+
+	rids.clear();
+	for (unsigned i = 0; i < numRecords; i++) {
+		prepareRecord(i, record);
+		rc = rbfm->insertRecord(largeHandle, recordDescriptor, record, rid);
+		assert(rc == success);
+		rids.push_back(rid);
+	}
+
+	rc = rbfm->closeFile(largeHandle);
+	assert(rc == success);
+
+	FileHandle mappedHandle;
+	rc = rbfm->openFile(largeFileName, mappedHandle, IO_MMAP);
+	assert(rc == success);
+
+	void *largePage = malloc(largePageSize);
+	numPages = mappedHandle.getNumberOfPages();
+	rc = mappedHandle.readMappedPage(numPages - 1, mappedPage);
+	assert(rc == success);
+	rc = mappedHandle.readPage(numPages - 1, largePage);
+	assert(rc == success);
+	if (mappedHandle.getPageSize() != largePageSize || memcmp(mappedPage, largePage, largePageSize) != 0) {
+		cout << "Last mapped page of the file with larger pages differs from the copied one" << endl;
+		return -1;
+	}
+	free(largePage);
+
+	for (unsigned i = 0; i < numRecords; i += 7) {
+		int size = prepareRecord(i, record);
+		rc = rbfm->readRecord(mappedHandle, recordDescriptor, rids[i], returnedData);
+		if (rc != success || memcmp(record, returnedData, size) != 0) {
+			cout << "Record " << i << " of the file with larger pages is not correct" << endl;
+			return -1;
+		}
+	}
+
+	rc = rbfm->closeFile(mappedHandle);
+	assert(rc == success);
+	rc = rbfm->destroyFile(largeFileName);
+	assert(rc == success);
+
+	free(record);
+	free(returnedData);
+
+	return 0;
+}
+
+int main() {
+	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+	remove("test19");
+	remove("test19large");
+
+	int rc = RBFTest_19(rbfm);
+	if (rc == 0) {
+		cout << "Test Case 19 Passed!" << endl << endl;
+	} else {
+		cout << "Test Case 19 Failed!" << endl << endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,238 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "wal.h"
+
+using namespace std;
+
+const int success = 0;
+const unsigned numRecords = 3000;
+
+void createRecordDescriptor(vector<Attribute> &recordDescriptor) {
+
+	Attribute attr;
+	attr.name = "id";
+	attr.type = TypeInt;
+	attr.length = (AttrLength) 4;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "name";
+	attr.type = TypeVarChar;
+	attr.length = (AttrLength) 50;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "score";
+	attr.type = TypeReal;
+	attr.length = (AttrLength) 4;
+	recordDescriptor.push_back(attr);
+}
+
+int prepareRecord(const int id, void *buffer) {
+	int offset = 0;
+	int nameLength = 5 + id % 40;
+	float score = id * 1.5f;
+
+	memcpy((char *) buffer + offset, &id, sizeof(int));
+	offset += sizeof(int);
+	memcpy((char *) buffer + offset, &nameLength, sizeof(int));
+	offset += sizeof(int);
+	memset((char *) buffer + offset, 'a' + id % 26, nameLength);
+	offset += nameLength;
+	memcpy((char *) buffer + offset, &score, sizeof(float));
+	offset += sizeof(float);
+
+	return offset;
+}
+
+// Child process: modify the file with logging on and crash without writing back the buffer pool
+void crashingWriter(const string &fileName, const string &logName) {
+	PagedFileManager *pfm = PagedFileManager::instance();
+	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+	RC rc;
+
+	// Small pool, so that some committed pages reach the data file and others do not
+	rc = pfm->setBufferPoolSize(8);
+	assert(rc == success);
+
+	rc = pfm->openLog(logName.c_str());
+	assert(rc == success);
+
+	// Commit waits for its fsync, even if commits are grouped
+	rc = pfm->setGroupCommitSize(16);
+	assert(rc == success);
+
+	rc = rbfm->createFile(fileName);
+	assert(rc == success);
+
+	FileHandle fileHandle;
+	rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success);
+
+	vector<Attribute> recordDescriptor;
+	createRecordDescriptor(recordDescriptor);
+
+	void *record = malloc(PAGE_SIZE);
+	vector<RID> rids;
+	RID rid;
+
+	// Every insertion is committed by itself
+	for (unsigned i = 0; i < numRecords; i++) {
+		prepareRecord(i, record);
+		rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+		assert(rc == success);
+		rids.push_back(rid);
+
+		if (pfm->getLogManager()->getDurableLSN() < pfm->getLogManager()->getCommittedLSN()) {
+			cout << "Insertion " << i << " returned before its commit was durable" << endl;
+			_exit(1);
+		}
+	}
+
+	// Committed deletions
+	for (unsigned i = 0; i < numRecords; i += 10) {
+		rc = rbfm->deleteRecord(fileHandle, recordDescriptor, rids[i]);
+		assert(rc == success);
+	}
+
+	// Operation that fails is rolled back: pages it modified are restored, and its records are ignored by recovery
+	unsigned numPages = fileHandle.getNumberOfPages();
+	RID abortedRid;
+	pfm->beginOperation();
+	prepareRecord(numRecords + 1, record);
+	rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, abortedRid);
+	assert(rc == success);
+	rc = rbfm->deleteRecord(fileHandle, recordDescriptor, rids[2]);
+	assert(rc == success);
+	rc = pfm->endOperation(-1);
+	assert(rc == success);
+
+	if (fileHandle.getNumberOfPages() != numPages ||
+		rbfm->readRecord(fileHandle, recordDescriptor, rids[2], record) != success || *(int *) record != 2 ||
+		(rbfm->readRecord(fileHandle, recordDescriptor, abortedRid, record) == success && *(int *) record == (int) numRecords + 1)) {
+		cout << "Failed operation was not rolled back" << endl;
+		_exit(1);
+	}
+
+	// Operation that never commits: its records are durable, but have to be ignored by recovery
+	pfm->beginOperation();
+	prepareRecord(numRecords, record);
+	rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+	assert(rc == success);
+	rc = rbfm->deleteRecord(fileHandle, recordDescriptor, rids[1]);
+	assert(rc == success);
+	rc = pfm->flushLog();
+	assert(rc == success);
+
+	// Crash: no checkpoint, no write back
+	_exit(0);
+}
+
+int RBFTest_20(RecordBasedFileManager *rbfm) {
+	// Functions Tested:
+	// 1. Write-ahead logging of page writes (openLog)
+	// 2. Redo recovery of committed operations after crash
+	// 3. Incomplete operation is not recovered
+	// 4. Failed operation is rolled back, and is not recovered either
+	// 5. Commit is durable when it returns (group commit)
+	cout << "****In RBF Test Case 20****" << endl;
+
+	PagedFileManager *pfm = PagedFileManager::instance();
+	RC rc;
+	string fileName = "test20";
+	string logName = "test20.log";
+
+	pid_t pid = fork();
+	assert(pid >= 0);
+	if (pid == 0) {
+		crashingWriter(fileName, logName);
+	}
+
+	int status = 0;
+	waitpid(pid, &status, 0);
+	if (WIFEXITED(status) == false || WEXITSTATUS(status) != 0) {
+		cout << "Writer process failed" << endl;
+		return -1;
+	}
+
+	// Recovery
+	rc = pfm->openLog(logName.c_str());
+	assert(rc == success);
+
+	FileHandle fileHandle;
+	rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success);
+
+	vector<Attribute> recordDescriptor;
+	createRecordDescriptor(recordDescriptor);
+
+	vector<string> attributes;
+	attributes.push_back("id");
+	attributes.push_back("score");
+	RBFM_ScanIterator scanIterator;
+	rc = rbfm->scan(fileHandle, recordDescriptor, "", NO_OP, NULL, attributes, scanIterator);
+	assert(rc == success);
+
+	void *returnedData = malloc(PAGE_SIZE);
+	vector<bool> seen(numRecords + 2, false);
+	unsigned count = 0;
+	RID rid;
+	while (scanIterator.getNextRecord(rid, returnedData) != RBFM_EOF) {
+		int id = *(int *) returnedData;
+		float score = *(float *) ((char *) returnedData + sizeof(int));
+		if (id < 0 || id > (int) numRecords + 1 || seen[id] || score != id * 1.5f) {
+			cout << "Recovered file has wrong record " << id << endl;
+			return -1;
+		}
+		seen[id] = true;
+		count++;
+	}
+
+	// Scan iterator closes its copy of the handle, i.e. the file itself
+	rc = scanIterator.close();
+	assert(rc == success);
+
+	for (unsigned i = 0; i <= numRecords + 1; i++) {
+		bool expected = (i < numRecords && i % 10 != 0);
+		if (seen[i] != expected) {
+			cout << "Record " << i << (expected ? " is lost" : " should not exist") << " after recovery" << endl;
+			return -1;
+		}
+	}
+
+	cout << count << " records recovered" << endl;
+
+	rc = rbfm->destroyFile(fileName);
+	assert(rc == success);
+
+	rc = pfm->closeLog();
+	assert(rc == success);
+
+	remove(logName.c_str());
+	free(returnedData);
+
+	return 0;
+}
+
+int main() {
+	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+	remove("test20");
+	remove("test20.log");
+
+	int rc = RBFTest_20(rbfm);
+	if (rc == 0) {
+		cout << "Test Case 20 Passed!" << endl << endl;
+	} else {
+		cout << "Test Case 20 Failed!" << endl << endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,210 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "prefetch.h"
+
+using namespace std;
+
+const int success = 0;
+const unsigned numRecords = 20000;
+
+void createRecordDescriptor(vector<Attribute> &recordDescriptor) {
+
+	Attribute attr;
+	attr.name = "id";
+	attr.type = TypeInt;
+	attr.length = (AttrLength) 4;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "name";
+	attr.type = TypeVarChar;
+	attr.length = (AttrLength) 50;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "score";
+	attr.type = TypeReal;
+	attr.length = (AttrLength) 4;
+	recordDescriptor.push_back(attr);
+}
+
+int prepareRecord(const int id, void *buffer) {
+	int offset = 0;
+	int nameLength = 5 + id % 40;
+	float score = id * 1.5f;
+
+	memcpy((char *) buffer + offset, &id, sizeof(int));
+	offset += sizeof(int);
+	memcpy((char *) buffer + offset, &nameLength, sizeof(int));
+	offset += sizeof(int);
+	memset((char *) buffer + offset, 'a' + id % 26, nameLength);
+	offset += nameLength;
+	memcpy((char *) buffer + offset, &score, sizeof(float));
+	offset += sizeof(float);
+
+	return offset;
+}
+
+// Scan the whole file and check that every record is returned once
+int scanAll(RecordBasedFileManager *rbfm, FileHandle &fileHandle, const vector<Attribute> &recordDescriptor) {
+	vector<string> attributes;
+	attributes.push_back("id");
+	attributes.push_back("score");
+	RBFM_ScanIterator scanIterator;
+	RC rc = rbfm->scan(fileHandle, recordDescriptor, "", NO_OP, NULL, attributes, scanIterator);
+	assert(rc == success);
+
+	void *returnedData = malloc(PAGE_SIZE);
+	vector<bool> seen(numRecords, false);
+	unsigned count = 0;
+	RID rid;
+	while (scanIterator.getNextRecord(rid, returnedData) != RBFM_EOF) {
+		int id = *(int *) returnedData;
+		float score = *(float *) ((char *) returnedData + sizeof(int));
+		if (id < 0 || id >= (int) numRecords || seen[id] || score != id * 1.5f) {
+			cout << "Scan returned wrong record " << id << endl;
+			free(returnedData);
+			return -1;
+		}
+		seen[id] = true;
+		count++;
+	}
+
+	// Scan iterator closes its copy of the handle
+	rc = scanIterator.close();
+	assert(rc == success);
+	free(returnedData);
+
+	if (count != numRecords) {
+		cout << "Scan returned " << count << " records instead of " << numRecords << endl;
+		return -1;
+	}
+
+	return 0;
+}
+
+int RBFTest_21(RecordBasedFileManager *rbfm) {
+	// Functions Tested:
+	// 1. Sequential reads are detected and following pages are read ahead into the buffer pool
+	// 2. Scan returns the same records with and without read-ahead
+	// 3. Closing the file in the middle of read-ahead
+	cout << "****In RBF Test Case 21****" << endl;
+
+	PagedFileManager *pfm = PagedFileManager::instance();
+	RC rc;
+	string fileName = "test21";
+
+	rc = rbfm->createFile(fileName);
+	assert(rc == success);
+
+	FileHandle fileHandle;
+	rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success);
+
+	vector<Attribute> recordDescriptor;
+	createRecordDescriptor(recordDescriptor);
+
+	void *record = malloc(PAGE_SIZE);
+	RID rid;
+
+	for (unsigned i = 0; i < numRecords; i++) {
+		prepareRecord(i, record);
+		rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+		assert(rc == success);
+	}
+
+	unsigned numPages = fileHandle.getNumberOfPages();
+
+	rc = rbfm->closeFile(fileHandle);
+	assert(rc == success);
+
+	unsigned requests = 0, prefetched = 0, dropped = 0;
+	unsigned hits = 0, misses = 0, evictions = 0, writeBacks = 0;
+	unsigned misses2 = 0, prefetched2 = 0;
+
+	// Scan without read-ahead (re-sizing the pool empties it)
+	pfm->setPrefetchWindow(0);
+	rc = pfm->setBufferPoolSize(256);
+	assert(rc == success);
+	FileHandle plainHandle;
+	rc = rbfm->openFile(fileName, plainHandle, IO_PREAD);
+	assert(rc == success);
+
+	pfm->collectPrefetchCounters(requests, prefetched, dropped);
+	pfm->collectBufferPoolCounters(hits, misses, evictions, writeBacks);
+	if (scanAll(rbfm, plainHandle, recordDescriptor) != 0)
+		return -1;
+	pfm->collectPrefetchCounters(requests, prefetched2, dropped);
+	pfm->collectBufferPoolCounters(hits, misses2, evictions, writeBacks);
+
+	cout << "without read-ahead: " << numPages << " pages, " << misses2 - misses << " misses" << endl;
+	if (prefetched2 != prefetched) {
+		cout << "Pages were read ahead while read-ahead is off" << endl;
+		return -1;
+	}
+
+	// Scan with read-ahead
+	pfm->setPrefetchWindow(16);
+	rc = pfm->setBufferPoolSize(256);
+	assert(rc == success);
+	FileHandle prefetchHandle;
+	rc = rbfm->openFile(fileName, prefetchHandle, IO_PREAD);
+	assert(rc == success);
+
+	pfm->collectPrefetchCounters(requests, prefetched, dropped);
+	pfm->collectBufferPoolCounters(hits, misses, evictions, writeBacks);
+	if (scanAll(rbfm, prefetchHandle, recordDescriptor) != 0)
+		return -1;
+	pfm->collectPrefetchCounters(requests, prefetched2, dropped);
+	pfm->collectBufferPoolCounters(hits, misses2, evictions, writeBacks);
+
+	cout << "with read-ahead: " << numPages << " pages, " << misses2 - misses << " misses, "
+			<< prefetched2 - prefetched << " pages read ahead" << endl;
+	if (prefetched2 == prefetched) {
+		cout << "No pages were read ahead" << endl;
+		return -1;
+	}
+
+	// Sequential page reads thru stdio handle, file is closed while requests are in flight
+	rc = pfm->setBufferPoolSize(256);
+	assert(rc == success);
+	FileHandle stdioHandle;
+	rc = rbfm->openFile(fileName, stdioHandle);
+	assert(rc == success);
+
+	for (unsigned i = 0; i < numPages && i < 8; i++) {
+		rc = stdioHandle.readPage(i, record);
+		assert(rc == success);
+	}
+
+	rc = rbfm->closeFile(stdioHandle);
+	assert(rc == success);
+
+	rc = rbfm->destroyFile(fileName);
+	assert(rc == success);
+
+	pfm->setPrefetchWindow(PREFETCH_DEFAULT_WINDOW);
+	free(record);
+
+	return 0;
+}
+
+int main() {
+	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+	remove("test21");
+
+	int rc = RBFTest_21(rbfm);
+	if (rc == 0) {
+		cout << "Test Case 21 Passed!" << endl << endl;
+	} else {
+		cout << "Test Case 21 Failed!" << endl << endl;
+	}
+
+	return 0;
+}
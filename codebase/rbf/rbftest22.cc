@@ -0,0 +1,335 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "pfm.h"
+#include "rbfm.h"
+
+using namespace std;
+
+const int success = 0;
+const unsigned numRecords = 300;
+const unsigned largePageSize = 65536;
+const unsigned numRawPages = 4;
+
+void createRecordDescriptor(vector<Attribute> &recordDescriptor) {
+
+	Attribute attr;
+	attr.name = "id";
+	attr.type = TypeInt;
+	attr.length = (AttrLength) 4;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "text";
+	attr.type = TypeVarChar;
+	attr.length = (AttrLength) 20000;
+	recordDescriptor.push_back(attr);
+}
+
+// Records are larger than the default page
+int prepareRecord(const int id, void *buffer) {
+	int offset = 0;
+	int textLength = 6000 + (id % 7) * 1000;
+
+	memcpy((char *) buffer + offset, &id, sizeof(int));
+	offset += sizeof(int);
+	memcpy((char *) buffer + offset, &textLength, sizeof(int));
+	offset += sizeof(int);
+	memset((char *) buffer + offset, 'a' + id % 26, textLength);
+	offset += textLength;
+
+	return offset;
+}
+
+// Copy of the file is opened without any state cached by the file manager
+int copyFile(const string &from, const string &to) {
+	FILE *src = fopen(from.c_str(), "rb");
+	FILE *dst = fopen(to.c_str(), "wb");
+	if (src == NULL || dst == NULL)
+		return -1;
+
+	char buffer[PAGE_SIZE];
+	size_t size = 0;
+	while ((size = fread(buffer, 1, PAGE_SIZE, src)) > 0)
+		fwrite(buffer, 1, size, dst);
+
+	fclose(src);
+	fclose(dst);
+	return 0;
+}
+
+// first header page as it was written before the format fields were added to it
+struct BaselineHeader {
+	PageNum _totFileSize;
+	access_flag _access;
+	PageNum _nextHeaderPageId;
+	PageIdNum _numUsedPageIds;
+	PageInfo _arrOfPageIds[1];
+};
+
+int writeFile(const string &fileName, const void *data, const unsigned numPages) {
+	FILE *file = fopen(fileName.c_str(), "wb");
+	if (file == NULL)
+		return -1;
+	size_t written = fwrite(data, PAGE_SIZE, numPages, file);
+	fclose(file);
+	return written == numPages ? success : -1;
+}
+
+// file written by the earlier format: header page with one data page that it knows of
+int testBaselineFile(RecordBasedFileManager *rbfm) {
+	const string fileName = "test22baseline";
+	char *pages = (char *) calloc(2, PAGE_SIZE);
+	BaselineHeader *header = (BaselineHeader *) pages;
+	header->_totFileSize = 2;
+	header->_nextHeaderPageId = 0;
+	header->_numUsedPageIds = 1;
+	header->_arrOfPageIds[0]._pageid = 1;
+	header->_arrOfPageIds[0]._numFreeBytes = PAGE_SIZE - 64;
+	assert(writeFile(fileName, pages, 2) == success);
+	free(pages);
+
+	FileHandle fileHandle;
+	RC rc = rbfm->openFile(fileName, fileHandle);
+	if (rc != -76) {
+		cout << "File of the earlier format was opened: " << rc << endl;
+		if (rc == success)
+			rbfm->closeFile(fileHandle);
+		return -1;
+	}
+
+	remove(fileName.c_str());
+	return success;
+}
+
+// file of random pages is read by pfm page by page, but is not a record-based file
+int testRawFile(RecordBasedFileManager *rbfm, PagedFileManager *pfm) {
+	const string fileName = "test22raw";
+	char *pages = (char *) malloc(numRawPages * PAGE_SIZE);
+	srand(22);
+	for (unsigned i = 0; i < numRawPages * PAGE_SIZE; i++)
+		pages[i] = (char) rand();
+	assert(writeFile(fileName, pages, numRawPages) == success);
+
+	int errCode = success;
+	FileHandle fileHandle;
+	RC rc = pfm->openFile(fileName.c_str(), fileHandle);
+	assert(rc == success);
+	if (fileHandle.getNumberOfPages() != numRawPages) {
+		cout << "Number of pages of the raw file: " << fileHandle.getNumberOfPages() << endl;
+		errCode = -1;
+	}
+
+	void *page = malloc(PAGE_SIZE);
+	for (unsigned i = 0; errCode == success && i < numRawPages; i++) {
+		if (fileHandle.readPage(i, page) != success || memcmp(page, pages + i * PAGE_SIZE, PAGE_SIZE) != 0) {
+			cout << "Page " << i << " of the raw file is not correct" << endl;
+			errCode = -1;
+		}
+	}
+	free(page);
+
+	rc = pfm->closeFile(fileHandle);
+	assert(rc == success);
+
+	FileHandle rbfHandle;
+	if (errCode == success && (rc = rbfm->openFile(fileName, rbfHandle)) != -76) {
+		cout << "Raw file was opened as record-based file: " << rc << endl;
+		if (rc == success)
+			rbfm->closeFile(rbfHandle);
+		errCode = -1;
+	}
+
+	free(pages);
+	rc = pfm->destroyFile(fileName.c_str());
+	assert(rc == success);
+	return errCode;
+}
+
+// file created by rbfm starts with the format fields
+int testFormatFields(const string &fileName) {
+	FILE *file = fopen(fileName.c_str(), "rb");
+	assert(file != NULL);
+	Header *header = (Header *) malloc(PAGE_SIZE);
+	size_t read = fread(header, PAGE_SIZE, 1, file);
+	fclose(file);
+
+	int errCode = success;
+	if (read != 1 || header->_magic != FILE_FORMAT_MAGIC || header->_formatVersion != FILE_FORMAT_VERSION) {
+		cout << "Format fields of the new file are not correct" << endl;
+		errCode = -1;
+	}
+	free(header);
+	return errCode;
+}
+
+int RBFTest_22(RecordBasedFileManager *rbfm) {
+	// Functions Tested:
+	// 1. Create file with invalid page size
+	// 2. Insert records larger than the default page into the file with 64KB pages
+	// 3. Page size is persisted in the file header
+	// 4. Read and scan records of the file with 64KB pages
+	// 5. New file has format magic and version in its first page
+	// 6. File of the earlier format is not opened by rbfm (-76)
+	// 7. File without header page is opened by pfm with the number of pages taken from its size, but not by rbfm
+	cout << "****In RBF Test Case 22****" << endl;
+
+	RC rc;
+	string fileName = "test22";
+	string smallFileName = "test22small";
+	string copyFileName = "test22copy";
+
+	rc = rbfm->createFile(fileName, 3000);
+	assert(rc == -75);
+	rc = rbfm->createFile(fileName, 2 * MAX_PAGE_SIZE);
+	assert(rc == -75);
+
+	rc = rbfm->createFile(fileName, largePageSize);
+	assert(rc == success);
+	rc = rbfm->createFile(smallFileName);
+	assert(rc == success);
+	if (testFormatFields(fileName) != success || testFormatFields(smallFileName) != success)
+		return -1;
+
+	vector<Attribute> recordDescriptor;
+	createRecordDescriptor(recordDescriptor);
+
+	void *record = malloc(largePageSize);
+	void *returnedData = malloc(largePageSize);
+	vector<RID> rids;
+	RID rid;
+
+	// Default page keeps the text of a large record in overflow pages
+	FileHandle smallHandle;
+	rc = rbfm->openFile(smallFileName, smallHandle);
+	assert(rc == success);
+	if (smallHandle.getPageSize() != PAGE_SIZE) {
+		cout << "Default page size is not correct" << endl;
+		return -1;
+	}
+	int size = prepareRecord(0, record);
+	rc = rbfm->insertRecord(smallHandle, recordDescriptor, record, rid);
+	assert(rc == success);
+	rc = rbfm->readRecord(smallHandle, recordDescriptor, rid, returnedData);
+	assert(rc == success && memcmp(returnedData, record, size) == 0);
+	rc = rbfm->closeFile(smallHandle);
+	assert(rc == success);
+
+	FileHandle fileHandle;
+	rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success);
+	if (fileHandle.getPageSize() != largePageSize) {
+		cout << "Page size is not correct" << endl;
+		return -1;
+	}
+
+	for (unsigned i = 0; i < numRecords; i++) {
+		prepareRecord(i, record);
+		rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+		assert(rc == success);
+		rids.push_back(rid);
+	}
+
+	unsigned numPages = fileHandle.getNumberOfPages();
+
+	rc = rbfm->closeFile(fileHandle);
+	assert(rc == success);
+
+	rc = copyFile(fileName, copyFileName);
+	assert(rc == success);
+
+	struct stat info;
+	stat(copyFileName.c_str(), &info);
+	if ((unsigned) info.st_size != numPages * largePageSize) {
+		cout << "File size " << info.st_size << " is not a multiple of the page size" << endl;
+		return -1;
+	}
+
+	FileHandle copyHandle;
+	rc = rbfm->openFile(copyFileName, copyHandle);
+	assert(rc == success);
+
+	if (copyHandle.getPageSize() != largePageSize || copyHandle.getNumberOfPages() != numPages) {
+		cout << "Page size is not restored from the file header" << endl;
+		return -1;
+	}
+
+	// Read records one by one
+	for (unsigned i = 0; i < numRecords; i++) {
+		int size = prepareRecord(i, record);
+		rc = rbfm->readRecord(copyHandle, recordDescriptor, rids[i], returnedData);
+		assert(rc == success);
+		if (memcmp(record, returnedData, size) != 0) {
+			cout << "Record " << i << " is not correct" << endl;
+			return -1;
+		}
+	}
+
+	// Scan all records (scan iterator closes its copy of the handle)
+	vector<string> attributes;
+	attributes.push_back("id");
+	attributes.push_back("text");
+	RBFM_ScanIterator scanIterator;
+	rc = rbfm->scan(copyHandle, recordDescriptor, "", NO_OP, NULL, attributes, scanIterator);
+	assert(rc == success);
+
+	unsigned count = 0;
+	vector<bool> seen(numRecords, false);
+	while (scanIterator.getNextRecord(rid, returnedData) != RBFM_EOF) {
+		int id = *(int *) returnedData;
+		int size = prepareRecord(id, record);
+		if (id < 0 || id >= (int) numRecords || seen[id] || memcmp(record, returnedData, size) != 0) {
+			cout << "Scan returned wrong record " << id << endl;
+			return -1;
+		}
+		seen[id] = true;
+		count++;
+	}
+
+	if (count != numRecords) {
+		cout << "Scan returned " << count << " records instead of " << numRecords << endl;
+		return -1;
+	}
+
+	rc = scanIterator.close();
+	assert(rc == success);
+
+	rc = rbfm->destroyFile(fileName);
+	assert(rc == success);
+	rc = rbfm->destroyFile(smallFileName);
+	assert(rc == success);
+	rc = rbfm->destroyFile(copyFileName);
+	assert(rc == success);
+
+	free(record);
+	free(returnedData);
+
+	if (testBaselineFile(rbfm) != success || testRawFile(rbfm, PagedFileManager::instance()) != success)
+		return -1;
+
+	return 0;
+}
+
+int main() {
+	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+	remove("test22");
+	remove("test22small");
+	remove("test22copy");
+	remove("test22baseline");
+	remove("test22raw");
+
+	int rc = RBFTest_22(rbfm);
+	if (rc == 0) {
+		cout << "Test Case 22 Passed!" << endl << endl;
+	} else {
+		cout << "Test Case 22 Failed!" << endl << endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,234 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "crc.h"
+
+using namespace std;
+
+const int success = 0;
+const unsigned numRecords = 2000;
+
+void createRecordDescriptor(vector<Attribute> &recordDescriptor) {
+
+	Attribute attr;
+	attr.name = "id";
+	attr.type = TypeInt;
+	attr.length = (AttrLength) 4;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "name";
+	attr.type = TypeVarChar;
+	attr.length = (AttrLength) 50;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "score";
+	attr.type = TypeReal;
+	attr.length = (AttrLength) 4;
+	recordDescriptor.push_back(attr);
+}
+
+int prepareRecord(const int id, void *buffer) {
+	int offset = 0;
+	int nameLength = 5 + id % 40;
+	float score = id * 1.5f;
+
+	memcpy((char *) buffer + offset, &id, sizeof(int));
+	offset += sizeof(int);
+	memcpy((char *) buffer + offset, &nameLength, sizeof(int));
+	offset += sizeof(int);
+	memset((char *) buffer + offset, 'a' + id % 26, nameLength);
+	offset += nameLength;
+	memcpy((char *) buffer + offset, &score, sizeof(float));
+	offset += sizeof(float);
+
+	return offset;
+}
+
+// Copy of the file is opened without any state cached by the file manager
+int copyFile(const string &from, const string &to) {
+	FILE *src = fopen(from.c_str(), "rb");
+	FILE *dst = fopen(to.c_str(), "wb");
+	if (src == NULL || dst == NULL)
+		return -1;
+
+	char buffer[PAGE_SIZE];
+	size_t size = 0;
+	while ((size = fread(buffer, 1, PAGE_SIZE, src)) > 0)
+		fwrite(buffer, 1, size, dst);
+
+	fclose(src);
+	fclose(dst);
+	return 0;
+}
+
+// Flip one byte of the page directly in the OS file
+int corruptPage(const string &fileName, const PageNum pageNum, const unsigned offset) {
+	FILE *file = fopen(fileName.c_str(), "rb+");
+	if (file == NULL)
+		return -1;
+
+	unsigned char byte = 0;
+	fseek(file, (long) pageNum * PAGE_SIZE + offset, SEEK_SET);
+	if (fread(&byte, 1, 1, file) != 1)
+		return -1;
+	byte ^= 0x01;
+	fseek(file, (long) pageNum * PAGE_SIZE + offset, SEEK_SET);
+	fwrite(&byte, 1, 1, file);
+
+	fclose(file);
+	return 0;
+}
+
+int RBFTest_23(PagedFileManager *pfm, RecordBasedFileManager *rbfm) {
+	// Functions Tested:
+	// 1. CRC32C (hardware and portable implementations agree)
+	// 2. Create file with page checksums (trailer is hidden from the record manager)
+	// 3. Checksum setting is persisted in the file header
+	// 4. Corrupted page is detected on read (-77)
+	cout << "****In RBF Test Case 23****" << endl;
+
+	RC rc;
+	string fileName = "test23";
+	string copyFileName = "test23copy";
+
+	// Standard check value of CRC32C
+	if (crc32c("123456789", 9) != 0xE3069283u || crc32cPortable("123456789", 9) != 0xE3069283u) {
+		cout << "CRC32C is not correct" << endl;
+		return -1;
+	}
+
+	char sample[PAGE_SIZE];
+	for (unsigned i = 0; i < PAGE_SIZE; i++)
+		sample[i] = (char) (i * 7 + i / 13);
+	if (crc32cHardwareSupported() && crc32cHardware(sample, PAGE_SIZE - 3) != crc32cPortable(sample, PAGE_SIZE - 3)) {
+		cout << "Hardware and portable CRC32C differ" << endl;
+		return -1;
+	}
+
+	pfm->setPageChecksums(true);
+	rc = rbfm->createFile(fileName);
+	assert(rc == success);
+	pfm->setPageChecksums(false);
+
+	FileHandle fileHandle;
+	rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success);
+
+	if (fileHandle.hasPageChecksums() == false || fileHandle.getPhysicalPageSize() != PAGE_SIZE
+			|| fileHandle.getPageSize() != PAGE_SIZE - PAGE_CHECKSUM_SIZE) {
+		cout << "Page checksums are not set up" << endl;
+		return -1;
+	}
+
+	vector<Attribute> recordDescriptor;
+	createRecordDescriptor(recordDescriptor);
+
+	void *record = malloc(PAGE_SIZE);
+	void *returnedData = malloc(PAGE_SIZE);
+	vector<RID> rids;
+	RID rid;
+
+	for (unsigned i = 0; i < numRecords; i++) {
+		prepareRecord(i, record);
+		rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+		assert(rc == success);
+		rids.push_back(rid);
+	}
+
+	rc = rbfm->closeFile(fileHandle);
+	assert(rc == success);
+
+	// Corrupt record data of the 2nd data page in the copy of the file
+	rc = copyFile(fileName, copyFileName);
+	assert(rc == success);
+	rc = corruptPage(copyFileName, 2, 100);
+	assert(rc == success);
+
+	FileHandle copyHandle;
+	rc = rbfm->openFile(copyFileName, copyHandle);
+	assert(rc == success);
+
+	if (copyHandle.hasPageChecksums() == false) {
+		cout << "Page checksums are not restored from the file header" << endl;
+		return -1;
+	}
+
+	unsigned numCorrupted = 0;
+	for (unsigned i = 0; i < numRecords; i++) {
+		int size = prepareRecord(i, record);
+		rc = rbfm->readRecord(copyHandle, recordDescriptor, rids[i], returnedData);
+		if (rids[i].pageNum == 2) {
+			if (rc != -77) {
+				cout << "Corrupted page is not detected" << endl;
+				return -1;
+			}
+			numCorrupted++;
+			continue;
+		}
+		assert(rc == success);
+		if (memcmp(record, returnedData, size) != 0) {
+			cout << "Record " << i << " is not correct" << endl;
+			return -1;
+		}
+	}
+
+	if (numCorrupted == 0) {
+		cout << "No records on the corrupted page" << endl;
+		return -1;
+	}
+
+	rc = copyHandle.readPage(2, returnedData);
+	assert(rc == -77);
+
+	rc = rbfm->closeFile(copyHandle);
+	assert(rc == success);
+
+	// Original file is intact
+	rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success);
+	for (unsigned i = 0; i < numRecords; i++) {
+		int size = prepareRecord(i, record);
+		rc = rbfm->readRecord(fileHandle, recordDescriptor, rids[i], returnedData);
+		assert(rc == success);
+		if (memcmp(record, returnedData, size) != 0) {
+			cout << "Record " << i << " is not correct" << endl;
+			return -1;
+		}
+	}
+	rc = rbfm->closeFile(fileHandle);
+	assert(rc == success);
+
+	rc = rbfm->destroyFile(fileName);
+	assert(rc == success);
+	rc = rbfm->destroyFile(copyFileName);
+	assert(rc == success);
+
+	free(record);
+	free(returnedData);
+
+	return 0;
+}
+
+int main() {
+	PagedFileManager *pfm = PagedFileManager::instance();
+	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+	remove("test23");
+	remove("test23copy");
+
+	int rc = RBFTest_23(pfm, rbfm);
+	if (rc == 0) {
+		cout << "Test Case 23 Passed!" << endl << endl;
+	} else {
+		cout << "Test Case 23 Failed!" << endl << endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,198 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "pfm.h"
+#include "bpm.h"
+
+using namespace std;
+
+const int success = 0;
+
+void preparePage(const unsigned pageNum, const unsigned version, void *data) {
+	for (unsigned i = 0; i < PAGE_SIZE; i++) {
+		*((char *) data + i) = (i + pageNum * 7 + version) % 94 + 32;
+	}
+}
+
+// Page content has to match the given version
+int checkPage(const unsigned pageNum, const unsigned version, const void *data) {
+	char expected[PAGE_SIZE];
+	preparePage(pageNum, version, expected);
+	if (memcmp(expected, data, PAGE_SIZE) != 0) {
+		cout << "Page " << pageNum << " is not correct" << endl;
+		return -1;
+	}
+	return 0;
+}
+
+int RBFTest_24(PagedFileManager *pfm) {
+	// Functions Tested:
+	// 1. readPages/writePages of the run of consecutive pages
+	// 2. readPages/writePages of the list of pages (scatter/gather, repeated page)
+	// 3. Pages missing from buffer pool are transferred by few vectored system calls
+	// 4. Pages written by writePages are seen by readPage and by later readPages
+	cout << "****In RBF Test Case 24****" << endl;
+
+	RC rc;
+	string fileName = "test24";
+	const unsigned numPages = 300;
+
+	rc = pfm->createFile(fileName.c_str());
+	assert(rc == success);
+
+	FileHandle fileHandle;
+	rc = pfm->openFile(fileName.c_str(), fileHandle);
+	assert(rc == success);
+
+	char *data = (char *) malloc(PAGE_SIZE * numPages);
+	char *buffer = (char *) malloc(PAGE_SIZE * numPages);
+
+	for (unsigned i = 0; i < numPages; i++) {
+		preparePage(i, 0, data);
+		rc = fileHandle.appendPage(data);
+		assert(rc == success);
+	}
+
+	rc = pfm->closeFile(fileHandle);
+	assert(rc == success);
+
+	// Drop cached pages (re-creating frames writes them back first)
+	rc = pfm->setBufferPoolSize(BUFFER_POOL_DEFAULT_NUM_FRAMES);
+	assert(rc == success);
+
+	rc = pfm->openFile(fileName.c_str(), fileHandle, IO_PREAD);
+	assert(rc == success);
+
+	unsigned physReadBefore = 0, physWriteBefore = 0, readCallsBefore = 0, writeCallsBefore = 0;
+	fileHandle.collectPhysicalCounterValues(physReadBefore, physWriteBefore);
+	fileHandle.collectIOCallCounterValues(readCallsBefore, writeCallsBefore);
+
+	// Read the whole file by vectored reads
+	rc = fileHandle.readPages(0, numPages, buffer);
+	assert(rc == success);
+	for (unsigned i = 0; i < numPages; i++) {
+		if (checkPage(i, 0, buffer + i * PAGE_SIZE) != 0)
+			return -1;
+	}
+
+	unsigned physRead = 0, physWrite = 0, readCalls = 0, writeCalls = 0;
+	fileHandle.collectPhysicalCounterValues(physRead, physWrite);
+	fileHandle.collectIOCallCounterValues(readCalls, writeCalls);
+
+	if (physRead - physReadBefore != numPages) {
+		cout << "Pages were read " << physRead - physReadBefore << " times instead of " << numPages << endl;
+		return -1;
+	}
+
+	// Every system call reads up to MAX_VECTORED_PAGES pages
+	if (readCalls - readCallsBefore > (numPages + MAX_VECTORED_PAGES - 1) / MAX_VECTORED_PAGES) {
+		cout << "Too many read calls: " << readCalls - readCallsBefore << endl;
+		return -1;
+	}
+
+	// Out-of-range page
+	rc = fileHandle.readPages(numPages - 10, 20, buffer);
+	assert(rc == -10);
+
+	// List of pages in arbitrary order, page 5 is listed twice
+	vector<PageNum> pageNums;
+	pageNums.push_back(299);
+	pageNums.push_back(5);
+	pageNums.push_back(6);
+	pageNums.push_back(7);
+	pageNums.push_back(100);
+	pageNums.push_back(5);
+	rc = fileHandle.readPages(pageNums, buffer);
+	assert(rc == success);
+	for (unsigned i = 0; i < pageNums.size(); i++) {
+		if (checkPage(pageNums[i], 0, buffer + i * PAGE_SIZE) != 0)
+			return -1;
+	}
+
+	// Write run of pages
+	for (unsigned i = 0; i < 100; i++) {
+		preparePage(50 + i, 1, data + i * PAGE_SIZE);
+	}
+	rc = fileHandle.writePages(50, 100, data);
+	assert(rc == success);
+
+	unsigned readCallsAfter = 0, writeCallsAfter = 0;
+	fileHandle.collectIOCallCounterValues(readCallsAfter, writeCallsAfter);
+	if (writeCallsAfter - writeCalls > (100 + MAX_VECTORED_PAGES - 1) / MAX_VECTORED_PAGES) {
+		cout << "Too many write calls: " << writeCallsAfter - writeCalls << endl;
+		return -1;
+	}
+
+	// Write list of pages
+	pageNums.clear();
+	pageNums.push_back(3);
+	pageNums.push_back(200);
+	pageNums.push_back(201);
+	for (unsigned i = 0; i < pageNums.size(); i++) {
+		preparePage(pageNums[i], 2, data + i * PAGE_SIZE);
+	}
+	rc = fileHandle.writePages(pageNums, data);
+	assert(rc == success);
+
+	rc = pfm->closeFile(fileHandle);
+	assert(rc == success);
+
+	// Content reached the file
+	rc = pfm->setBufferPoolSize(BUFFER_POOL_DEFAULT_NUM_FRAMES);
+	assert(rc == success);
+
+	rc = pfm->openFile(fileName.c_str(), fileHandle);
+	assert(rc == success);
+
+	for (unsigned i = 0; i < numPages; i++) {
+		unsigned version = 0;
+		if (i >= 50 && i < 150)
+			version = 1;
+		if (i == 3 || i == 200 || i == 201)
+			version = 2;
+
+		rc = fileHandle.readPage(i, buffer);
+		assert(rc == success);
+		if (checkPage(i, version, buffer) != 0)
+			return -1;
+	}
+
+	// Cached and missing pages are mixed
+	rc = fileHandle.readPages(0, numPages, buffer);
+	assert(rc == success);
+	for (unsigned i = 0; i < numPages; i++) {
+		if (checkPage(i, (i >= 50 && i < 150) ? 1 : ((i == 3 || i == 200 || i == 201) ? 2 : 0), buffer + i * PAGE_SIZE) != 0)
+			return -1;
+	}
+
+	rc = pfm->closeFile(fileHandle);
+	assert(rc == success);
+
+	rc = pfm->destroyFile(fileName.c_str());
+	assert(rc == success);
+
+	free(data);
+	free(buffer);
+
+	return 0;
+}
+
+int main() {
+	PagedFileManager *pfm = PagedFileManager::instance();
+
+	remove("test24");
+
+	int rc = RBFTest_24(pfm);
+	if (rc == 0) {
+		cout << "Test Case 24 Passed!" << endl << endl;
+	} else {
+		cout << "Test Case 24 Failed!" << endl << endl;
+	}
+
+	return 0;
+}
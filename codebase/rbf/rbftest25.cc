@@ -0,0 +1,150 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "pfm.h"
+
+using namespace std;
+
+const int success = 0;
+
+void preparePage(const unsigned pageNum, void *data) {
+	for (unsigned i = 0; i < PAGE_SIZE; i++) {
+		*((char *) data + i) = (i + pageNum * 3) % 94 + 32;
+	}
+}
+
+// Append pages to the opened file
+int appendPages(FileHandle &fileHandle, const unsigned numPages) {
+	char data[PAGE_SIZE];
+	for (unsigned i = 0; i < numPages; i++) {
+		preparePage(fileHandle.getNumberOfPages(), data);
+		if (fileHandle.appendPage(data) != success)
+			return -1;
+	}
+	return 0;
+}
+
+int RBFTest_25(PagedFileManager *pfm) {
+	// Functions Tested:
+	// 1. Files grow by extents that double up to the maximum extent size
+	// 2. Reserved space does not change file size (i.e. number of pages)
+	// 3. Extent allocation can be turned off
+	cout << "****In RBF Test Case 25****" << endl;
+
+	RC rc;
+	string fileName = "test25";
+	string plainFileName = "test25plain";
+
+	unsigned minPages = 0, maxPages = 0;
+	pfm->getExtentSize(minPages, maxPages);
+	pfm->setExtentSize(64, 256);
+
+	rc = pfm->createFile(fileName.c_str());
+	assert(rc == success);
+
+	FileHandle fileHandle;
+	rc = pfm->openFile(fileName.c_str(), fileHandle);
+	assert(rc == success);
+
+	rc = appendPages(fileHandle, 10);
+	assert(rc == success);
+
+	if (fileHandle._info->_numAllocatedPages != 64 || fileHandle._info->_extentCounter != 1) {
+		cout << "First extent is not reserved" << endl;
+		return -1;
+	}
+
+	// 64 + 64 + 128 + 256 (maximum)
+	rc = appendPages(fileHandle, 290);
+	assert(rc == success);
+
+	if (fileHandle._info->_numAllocatedPages != 512 || fileHandle._info->_extentCounter != 4) {
+		cout << "Extents are not doubled up to the maximum: " << fileHandle._info->_numAllocatedPages << " pages in "
+				<< fileHandle._info->_extentCounter << " extents" << endl;
+		return -1;
+	}
+
+	rc = pfm->closeFile(fileHandle);
+	assert(rc == success);
+
+	// File size covers written pages only, but disk blocks cover the reservation
+	struct stat info;
+	stat(fileName.c_str(), &info);
+	if (info.st_size != 300 * PAGE_SIZE || (unsigned long long) info.st_blocks * 512 < 512ULL * PAGE_SIZE) {
+		cout << "File size " << info.st_size << ", allocated " << info.st_blocks * 512 << " bytes" << endl;
+		return -1;
+	}
+
+	// Pages are intact after reopening
+	rc = pfm->openFile(fileName.c_str(), fileHandle);
+	assert(rc == success);
+	if (fileHandle.getNumberOfPages() != 300) {
+		cout << "Number of pages is not correct" << endl;
+		return -1;
+	}
+
+	char data[PAGE_SIZE], buffer[PAGE_SIZE];
+	for (unsigned i = 0; i < 300; i++) {
+		preparePage(i, data);
+		rc = fileHandle.readPage(i, buffer);
+		assert(rc == success);
+		if (memcmp(data, buffer, PAGE_SIZE) != 0) {
+			cout << "Page " << i << " is not correct" << endl;
+			return -1;
+		}
+	}
+
+	rc = pfm->closeFile(fileHandle);
+	assert(rc == success);
+
+	// No extents
+	pfm->setExtentSize(0, 0);
+
+	rc = pfm->createFile(plainFileName.c_str());
+	assert(rc == success);
+
+	FileHandle plainHandle;
+	rc = pfm->openFile(plainFileName.c_str(), plainHandle);
+	assert(rc == success);
+
+	rc = appendPages(plainHandle, 10);
+	assert(rc == success);
+
+	if (plainHandle._info->_extentCounter != 0) {
+		cout << "Extent is reserved while extent allocation is off" << endl;
+		return -1;
+	}
+
+	rc = pfm->closeFile(plainHandle);
+	assert(rc == success);
+
+	pfm->setExtentSize(minPages, maxPages);
+
+	rc = pfm->destroyFile(fileName.c_str());
+	assert(rc == success);
+	rc = pfm->destroyFile(plainFileName.c_str());
+	assert(rc == success);
+
+	return 0;
+}
+
+int main() {
+	PagedFileManager *pfm = PagedFileManager::instance();
+
+	remove("test25");
+	remove("test25plain");
+
+	int rc = RBFTest_25(pfm);
+	if (rc == 0) {
+		cout << "Test Case 25 Passed!" << endl << endl;
+	} else {
+		cout << "Test Case 25 Failed!" << endl << endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,204 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "pfm.h"
+
+using namespace std;
+
+const int success = 0;
+
+// Find header page by walking the header chain from page 0
+int walkHeaderChain(FileHandle &fileHandle, PageNum pageId, PageNum &retHeaderPage) {
+	char data[PAGE_SIZE];
+	PageNum headerPageId = 0;
+	do {
+		if (fileHandle.readPage(headerPageId, data) != success)
+			return -1;
+		Header *hPage = (Header *) data;
+		if (pageId <= hPage->_numUsedPageIds) {
+			retHeaderPage = headerPageId;
+			return 0;
+		}
+		pageId -= fileHandle.getNumOfPageIds();
+		headerPageId = hPage->_nextHeaderPageId;
+	} while (headerPageId > 0);
+	return -16;
+}
+
+// Copy file, so that it is opened for the first time under new name
+int copyFile(const char *from, const char *to) {
+	FILE *in = fopen(from, "rb");
+	FILE *out = fopen(to, "wb");
+	if (in == NULL || out == NULL)
+		return -1;
+	char buffer[PAGE_SIZE];
+	size_t n;
+	while ((n = fread(buffer, 1, PAGE_SIZE, in)) > 0)
+		fwrite(buffer, 1, n, out);
+	fclose(in);
+	fclose(out);
+	return 0;
+}
+
+// Header pages found by the directory have to match the ones found by walking the chain
+int checkHeaderPages(PagedFileManager *pfm, FileHandle &fileHandle, const PageNum lastPageId, const PageNum lastHeaderPageId) {
+	PageNum headerPageId = 0;
+	if (pfm->getLastHeaderPage(fileHandle, headerPageId) != success || headerPageId != lastHeaderPageId) {
+		cout << "Last header page is not correct" << endl;
+		return -1;
+	}
+
+	for (PageNum pageId = 0; pageId <= lastPageId + 10; pageId++) {
+		PageNum expected = 0, found = 0;
+		RC expectedRc = walkHeaderChain(fileHandle, pageId, expected);
+		RC foundRc = pfm->findHeaderPage(fileHandle, pageId, found);
+		if (expectedRc != foundRc || (foundRc == success && expected != found)) {
+			cout << "Header page of page " << pageId << " is not correct" << endl;
+			return -1;
+		}
+	}
+	return 0;
+}
+
+int RBFTest_26(PagedFileManager *pfm) {
+	// Functions Tested:
+	// 1. findHeaderPage/getLastHeaderPage agree with walk of the header chain
+	// 2. Directory is kept up to date by insertPage (new header pages)
+	// 3. Directory is built by openFile, lookups do not read any pages
+	// 4. File without header page has no directory (-76)
+	cout << "****In RBF Test Case 26****" << endl;
+
+	RC rc;
+	string fileName = "test26";
+	string copyName = "test26copy";
+
+	rc = pfm->createFile(fileName.c_str());
+	assert(rc == success);
+	rc = pfm->createFileHeader(fileName.c_str());
+	assert(rc == success);
+
+	FileHandle fileHandle;
+	rc = pfm->openFile(fileName.c_str(), fileHandle);
+	assert(rc == success);
+
+	// Data pages for three header pages
+	const unsigned numDataPages = fileHandle.getNumOfPageIds() * 2 + 100;
+	char data[PAGE_SIZE];
+	memset(data, 0, PAGE_SIZE);
+
+	PageNum headerPageId = 0, dataPageId = 0;
+	for (unsigned i = 0; i < numDataPages; i++) {
+		rc = pfm->insertPage(fileHandle, headerPageId, dataPageId, data);
+		assert(rc == success);
+
+		// Check directory while header pages are being added
+		if (i == fileHandle.getNumOfPageIds() + 5) {
+			if (checkHeaderPages(pfm, fileHandle, i, headerPageId) != success)
+				return -1;
+		}
+	}
+
+	if (headerPageId == 0) {
+		cout << "No header pages are added" << endl;
+		return -1;
+	}
+
+	if (checkHeaderPages(pfm, fileHandle, numDataPages, headerPageId) != success)
+		return -1;
+
+	rc = pfm->closeFile(fileHandle);
+	assert(rc == success);
+
+	// Open copy of the file, directory is built from its header chain
+	rc = copyFile(fileName.c_str(), copyName.c_str());
+	assert(rc == success);
+
+	FileHandle copyHandle;
+	rc = pfm->openFile(copyName.c_str(), copyHandle);
+	assert(rc == success);
+
+	unsigned readCount = 0, writeCount = 0, appendCount = 0;
+	copyHandle.collectCounterValues(readCount, writeCount, appendCount);
+
+	PageNum foundHeaderPage = 0;
+	for (PageNum pageId = 0; pageId < numDataPages; pageId++) {
+		rc = pfm->findHeaderPage(copyHandle, pageId, foundHeaderPage);
+		assert(rc == success);
+	}
+	rc = pfm->getLastHeaderPage(copyHandle, foundHeaderPage);
+	assert(rc == success && foundHeaderPage == headerPageId);
+
+	unsigned readCountAfter = 0;
+	writeCount = 0;
+	appendCount = 0;
+	copyHandle.collectCounterValues(readCountAfter, writeCount, appendCount);
+	if (readCountAfter != readCount) {
+		cout << "Header lookups read " << readCountAfter - readCount << " pages" << endl;
+		return -1;
+	}
+
+	if (checkHeaderPages(pfm, copyHandle, numDataPages, headerPageId) != success)
+		return -1;
+
+	rc = pfm->closeFile(copyHandle);
+	assert(rc == success);
+
+	rc = pfm->destroyFile(fileName.c_str());
+	assert(rc == success);
+	rc = pfm->destroyFile(copyName.c_str());
+	assert(rc == success);
+
+	// Random first page is not taken for a header chain
+	string rawName = "test26raw";
+	rc = pfm->createFile(rawName.c_str());
+	assert(rc == success);
+	FileHandle rawHandle;
+	rc = pfm->openFile(rawName.c_str(), rawHandle);
+	assert(rc == success);
+	srand(26);
+	for (unsigned i = 0; i < 3; i++) {
+		for (unsigned j = 0; j < PAGE_SIZE; j++)
+			data[j] = (char) rand();
+		rc = rawHandle.appendPage(data);
+		assert(rc == success);
+	}
+	rc = pfm->closeFile(rawHandle);
+	assert(rc == success);
+
+	rc = pfm->openFile(rawName.c_str(), rawHandle);
+	assert(rc == success);
+	FreeSpaceMap *fsm = NULL;
+	rc = pfm->getFreeSpaceMap(rawHandle, fsm);
+	if (rc != -76) {
+		cout << "Free space map of the file without header page: " << rc << endl;
+		return -1;
+	}
+	rc = pfm->closeFile(rawHandle);
+	assert(rc == success);
+	rc = pfm->destroyFile(rawName.c_str());
+	assert(rc == success);
+
+	return 0;
+}
+
+int main() {
+	PagedFileManager *pfm = PagedFileManager::instance();
+
+	remove("test26");
+	remove("test26copy");
+	remove("test26raw");
+
+	int rc = RBFTest_26(pfm);
+	if (rc == 0) {
+		cout << "Test Case 26 Passed!" << endl << endl;
+	} else {
+		cout << "Test Case 26 Failed!" << endl << endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,175 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <dirent.h>
+
+#include "pfm.h"
+
+using namespace std;
+
+const int success = 0;
+
+// Number of file descriptors opened by this process
+unsigned countOpenedDescriptors() {
+	unsigned count = 0;
+	DIR *dir = opendir("/proc/self/fd");
+	if (dir == NULL)
+		return 0;
+	while (readdir(dir) != NULL)
+		count++;
+	closedir(dir);
+	return count;
+}
+
+int RBFTest_27(PagedFileManager *pfm) {
+	// Functions Tested:
+	// 1. Re-opening closed file re-uses its OS file-handler
+	// 2. Number of kept handlers is limited (least recently closed is closed first)
+	// 3. Destroyed and re-created file is not accessed thru the old handler
+	// 4. Turning the cache off closes all kept handlers
+	cout << "****In RBF Test Case 27****" << endl;
+
+	RC rc;
+	const char *fileNames[] = { "test27a", "test27b", "test27c" };
+	const unsigned numFiles = 3;
+
+	unsigned cacheSize = pfm->getHandleCacheSize();
+	pfm->setHandleCacheSize(2);
+
+	unsigned baseDescriptors = countOpenedDescriptors();
+
+	for (unsigned i = 0; i < numFiles; i++) {
+		rc = pfm->createFile(fileNames[i]);
+		assert(rc == success);
+		rc = pfm->createFileHeader(fileNames[i]);
+		assert(rc == success);
+	}
+
+	// Repeated open/close of the same file
+	unsigned hitCount = 0, missCount = 0, evictionCount = 0;
+	pfm->collectHandleCacheCounters(hitCount, missCount, evictionCount);
+	unsigned firstHitCount = hitCount;
+
+	char data[PAGE_SIZE], buffer[PAGE_SIZE];
+	for (unsigned i = 0; i < 100; i++) {
+		FileHandle fileHandle;
+		rc = pfm->openFile(fileNames[0], fileHandle);
+		assert(rc == success);
+
+		memset(data, i, PAGE_SIZE);
+		rc = fileHandle.appendPage(data);
+		assert(rc == success);
+
+		rc = pfm->closeFile(fileHandle);
+		assert(rc == success);
+	}
+
+	// First open of the loop is not a hit, handler of the file was pushed out by creation of the other two
+	pfm->collectHandleCacheCounters(hitCount, missCount, evictionCount);
+	if (hitCount - firstHitCount != 99) {
+		cout << "Handler is re-used " << hitCount - firstHitCount << " times" << endl;
+		return -1;
+	}
+
+	// Only two handlers are kept after all three files are closed
+	FileHandle handles[numFiles];
+	for (unsigned i = 0; i < numFiles; i++) {
+		rc = pfm->openFile(fileNames[i], handles[i]);
+		assert(rc == success);
+	}
+	for (unsigned i = 0; i < numFiles; i++) {
+		rc = pfm->closeFile(handles[i]);
+		assert(rc == success);
+	}
+
+	if (countOpenedDescriptors() != baseDescriptors + 2) {
+		cout << "Number of kept handlers is not limited" << endl;
+		return -1;
+	}
+
+	// Least recently closed file (the first one) lost its handler
+	pfm->collectHandleCacheCounters(hitCount, missCount, evictionCount);
+	unsigned lastMissCount = missCount;
+
+	FileHandle fileHandle;
+	rc = pfm->openFile(fileNames[0], fileHandle);
+	assert(rc == success);
+
+	pfm->collectHandleCacheCounters(hitCount, missCount, evictionCount);
+	if (missCount != lastMissCount + 1) {
+		cout << "Least recently closed handler is not evicted" << endl;
+		return -1;
+	}
+
+	// Pages written thru re-used handlers are in the file
+	if (fileHandle.getNumberOfPages() != 101) {
+		cout << "Number of pages is not correct" << endl;
+		return -1;
+	}
+	for (unsigned i = 0; i < 100; i++) {
+		memset(data, i, PAGE_SIZE);
+		rc = fileHandle.readPage(i + 1, buffer);
+		assert(rc == success);
+		if (memcmp(data, buffer, PAGE_SIZE) != 0) {
+			cout << "Page " << i + 1 << " is not correct" << endl;
+			return -1;
+		}
+	}
+
+	rc = pfm->closeFile(fileHandle);
+	assert(rc == success);
+
+	// Re-created file has to be opened again
+	rc = pfm->destroyFile(fileNames[1]);
+	assert(rc == success);
+	rc = pfm->createFile(fileNames[1]);
+	assert(rc == success);
+	rc = pfm->createFileHeader(fileNames[1]);
+	assert(rc == success);
+
+	rc = pfm->openFile(fileNames[1], fileHandle);
+	assert(rc == success);
+	if (fileHandle.getNumberOfPages() != 1) {
+		cout << "Re-created file is not correct" << endl;
+		return -1;
+	}
+	rc = pfm->closeFile(fileHandle);
+	assert(rc == success);
+
+	// No handlers are kept when cache is off
+	pfm->setHandleCacheSize(0);
+	if (countOpenedDescriptors() != baseDescriptors) {
+		cout << "Handlers are not closed" << endl;
+		return -1;
+	}
+
+	pfm->setHandleCacheSize(cacheSize);
+
+	for (unsigned i = 0; i < numFiles; i++) {
+		rc = pfm->destroyFile(fileNames[i]);
+		assert(rc == success);
+	}
+
+	return 0;
+}
+
+int main() {
+	PagedFileManager *pfm = PagedFileManager::instance();
+
+	remove("test27a");
+	remove("test27b");
+	remove("test27c");
+
+	int rc = RBFTest_27(pfm);
+	if (rc == 0) {
+		cout << "Test Case 27 Passed!" << endl << endl;
+	} else {
+		cout << "Test Case 27 Failed!" << endl << endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,243 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "bpm.h"
+#include "lz.h"
+
+using namespace std;
+
+const int success = 0;
+const unsigned numRecords = 3000;
+
+void createRecordDescriptor(vector<Attribute> &recordDescriptor) {
+
+	Attribute attr;
+	attr.name = "id";
+	attr.type = TypeInt;
+	attr.length = (AttrLength) 4;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "name";
+	attr.type = TypeVarChar;
+	attr.length = (AttrLength) 100;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "score";
+	attr.type = TypeReal;
+	attr.length = (AttrLength) 4;
+	recordDescriptor.push_back(attr);
+}
+
+int prepareRecord(const int id, const int version, void *buffer) {
+	int offset = 0;
+	int nameLength = 5 + (id + version) % 40 + version * 30;
+	float score = id * 1.5f;
+
+	memcpy((char *) buffer + offset, &id, sizeof(int));
+	offset += sizeof(int);
+	memcpy((char *) buffer + offset, &nameLength, sizeof(int));
+	offset += sizeof(int);
+	for (int i = 0; i < nameLength; i++)
+		((char *) buffer)[offset + i] = 'a' + (id + i / 4) % 26;
+	offset += nameLength;
+	memcpy((char *) buffer + offset, &score, sizeof(float));
+	offset += sizeof(float);
+
+	return offset;
+}
+
+// Copy of the file is opened without any state cached by the file manager
+int copyFile(const string &from, const string &to) {
+	FILE *src = fopen(from.c_str(), "rb");
+	FILE *dst = fopen(to.c_str(), "wb");
+	if (src == NULL || dst == NULL)
+		return -1;
+
+	char buffer[PAGE_SIZE];
+	size_t size = 0;
+	while ((size = fread(buffer, 1, PAGE_SIZE, src)) > 0)
+		fwrite(buffer, 1, size, dst);
+
+	fclose(src);
+	fclose(dst);
+	return 0;
+}
+
+int checkRecords(RecordBasedFileManager *rbfm, FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const vector<RID> &rids,
+		const int version) {
+	char record[PAGE_SIZE], returnedData[PAGE_SIZE];
+	for (unsigned i = 0; i < rids.size(); i++) {
+		int size = prepareRecord(i, i % 3 == 0 ? version : 0, record);
+		RC rc = rbfm->readRecord(fileHandle, recordDescriptor, rids[i], returnedData);
+		if (rc != success || memcmp(record, returnedData, size) != 0) {
+			cout << "Record " << i << " is not correct" << endl;
+			return -1;
+		}
+	}
+	return 0;
+}
+
+int RBFTest_28(PagedFileManager *pfm, RecordBasedFileManager *rbfm) {
+	// Functions Tested:
+	// 1. LZ codec round trip
+	// 2. Compressed file (with page checksums) stores records that are read back
+	// 3. Compressed file is smaller than the same pages stored as is
+	// 4. Pages that grow are moved to larger slots
+	// 5. Page map is restored when file is opened for the first time
+	// 6. Compressed file cannot be memory-mapped
+	cout << "****In RBF Test Case 28****" << endl;
+
+	RC rc;
+	string fileName = "test28";
+	string copyFileName = "test28copy";
+
+	// Codec round trip (repetitive and random content)
+	char sample[PAGE_SIZE], compressed[PAGE_SIZE * 2], decompressed[PAGE_SIZE];
+	for (unsigned k = 0; k < 2; k++) {
+		srand(k);
+		for (unsigned i = 0; i < PAGE_SIZE; i++)
+			sample[i] = (k == 0 ? (char) (i % 17) : (char) rand());
+		size_t size = lzCompress(sample, PAGE_SIZE, compressed, sizeof(compressed));
+		if (size == 0 || lzDecompress(compressed, size, decompressed, PAGE_SIZE) != PAGE_SIZE
+				|| memcmp(sample, decompressed, PAGE_SIZE) != 0) {
+			cout << "LZ round trip failed" << endl;
+			return -1;
+		}
+	}
+
+	pfm->setPageCompression(true);
+	pfm->setPageChecksums(true);
+	rc = rbfm->createFile(fileName);
+	assert(rc == success);
+	pfm->setPageChecksums(false);
+	pfm->setPageCompression(false);
+
+	FileHandle fileHandle;
+	rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success);
+
+	if (fileHandle.hasPageCompression() == false) {
+		cout << "Page compression is not set up" << endl;
+		return -1;
+	}
+
+	vector<Attribute> recordDescriptor;
+	createRecordDescriptor(recordDescriptor);
+
+	char record[PAGE_SIZE];
+	vector<RID> rids;
+	RID rid;
+
+	for (unsigned i = 0; i < numRecords; i++) {
+		prepareRecord(i, 0, record);
+		rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+		assert(rc == success);
+		rids.push_back(rid);
+	}
+
+	unsigned numPages = fileHandle.getNumberOfPages();
+	rc = rbfm->closeFile(fileHandle);
+	assert(rc == success);
+
+	struct stat info;
+	stat(fileName.c_str(), &info);
+	if (info.st_size >= (off_t) numPages * PAGE_SIZE * 3 / 4) {
+		cout << "File of " << numPages << " pages takes " << info.st_size << " bytes" << endl;
+		return -1;
+	}
+
+	// Grow every 3rd record, so that pages get re-written with more content
+	rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success);
+	for (unsigned i = 0; i < numRecords; i += 3) {
+		prepareRecord(i, 2, record);
+		rc = rbfm->updateRecord(fileHandle, recordDescriptor, record, rids[i]);
+		assert(rc == success);
+	}
+	numPages = fileHandle.getNumberOfPages();
+	rc = rbfm->closeFile(fileHandle);
+	assert(rc == success);
+
+	// Pages are read from the file (not from the buffer pool)
+	rc = pfm->setBufferPoolSize(pfm->getBufferPool()->getNumFrames());
+	assert(rc == success);
+
+	rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success);
+	if (checkRecords(rbfm, fileHandle, recordDescriptor, rids, 2) != success)
+		return -1;
+
+	unsigned long long readBytes = 0, writtenBytes = 0, uncompressedBytes = 0;
+	rc = fileHandle.collectCompressionCounterValues(readBytes, writtenBytes, uncompressedBytes);
+	assert(rc == success);
+	if (readBytes == 0 || writtenBytes >= uncompressedBytes) {
+		cout << "Compression counters are not correct" << endl;
+		return -1;
+	}
+
+	rc = rbfm->closeFile(fileHandle);
+	assert(rc == success);
+
+	// Copy of the data file and its page map
+	rc = copyFile(fileName, copyFileName);
+	assert(rc == success);
+	rc = copyFile(fileName + ".pmap", copyFileName + ".pmap");
+	assert(rc == success);
+
+	FileHandle copyHandle;
+	rc = rbfm->openFile(copyFileName, copyHandle, IO_MMAP);
+	if (rc != -79) {
+		cout << "Compressed file is memory-mapped" << endl;
+		return -1;
+	}
+
+	rc = rbfm->openFile(copyFileName, copyHandle, IO_PREAD);
+	assert(rc == success);
+	if (copyHandle.hasPageCompression() == false || copyHandle.hasPageChecksums() == false
+			|| copyHandle.getNumberOfPages() != numPages) {
+		cout << "Compressed file is not restored" << endl;
+		return -1;
+	}
+	if (checkRecords(rbfm, copyHandle, recordDescriptor, rids, 2) != success)
+		return -1;
+	rc = rbfm->closeFile(copyHandle);
+	assert(rc == success);
+
+	rc = rbfm->destroyFile(fileName);
+	assert(rc == success);
+	rc = rbfm->destroyFile(copyFileName);
+	assert(rc == success);
+
+	if (stat((fileName + ".pmap").c_str(), &info) == 0) {
+		cout << "Page map is not destroyed" << endl;
+		return -1;
+	}
+
+	return 0;
+}
+
+int main() {
+	PagedFileManager *pfm = PagedFileManager::instance();
+	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+	remove("test28");
+	remove("test28.pmap");
+	remove("test28copy");
+	remove("test28copy.pmap");
+
+	int rc = RBFTest_28(pfm, rbfm);
+	if (rc == 0) {
+		cout << "Test Case 28 Passed!" << endl << endl;
+	} else {
+		cout << "Test Case 28 Failed!" << endl << endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,187 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "pfm.h"
+#include "bpm.h"
+
+using namespace std;
+
+const int success = 0;
+
+int RBFTest_29(PagedFileManager *pfm) {
+	// Functions Tested:
+	// 1. Log-scale buckets of the latency histogram
+	// 2. Handle statistics of readPage/writePage/appendPage calls
+	// 3. File statistics of transfers to/from the OS file (appends, sequential and random reads)
+	// 4. Statistics of closed handles are kept by the file and aggregated by PagedFileManager
+	cout << "****In RBF Test Case 29****" << endl;
+
+	RC rc;
+	string fileName = "test29";
+	const unsigned numPages = 64;
+
+	// Every value falls into the bucket that it is within the bounds of
+	for (unsigned long long value = 0; value < 100000; value++) {
+		unsigned bucket = IOHistogram::getBucket(value);
+		if (value > IOHistogram::getBucketLimit(bucket) || (bucket > 0 && value <= IOHistogram::getBucketLimit(bucket - 1))) {
+			cout << "Value " << value << " is in wrong bucket " << bucket << endl;
+			return -1;
+		}
+	}
+
+	IOHistogram histogram;
+	for (unsigned long long value = 1; value <= 1000; value++)
+		histogram.record(value);
+	if (histogram.getCount() != 1000 || histogram.getMax() != 1000 || histogram.getMean() != 500.5 ||
+		histogram.getPercentile(50) < 500 || histogram.getPercentile(50) > 750 || histogram.getPercentile(100) != 1000) {
+		cout << "Histogram is not correct" << endl;
+		return -1;
+	}
+
+	rc = pfm->createFile(fileName.c_str());
+	assert(rc == success);
+
+	FileHandle fileHandle;
+	rc = pfm->openFile(fileName.c_str(), fileHandle);
+	assert(rc == success);
+
+	char data[PAGE_SIZE], buffer[PAGE_SIZE];
+	for (unsigned i = 0; i < numPages; i++) {
+		memset(data, i, PAGE_SIZE);
+		rc = fileHandle.appendPage(data);
+		assert(rc == success);
+	}
+	rc = fileHandle.writePage(0, data);
+	assert(rc == success);
+
+	IOStats stats;
+	rc = fileHandle.collectIOStats(stats);
+	assert(rc == success);
+	if (stats._latency[IO_APPEND].getCount() != numPages || stats._latency[IO_WRITE].getCount() != 1 ||
+		stats._latency[IO_READ].getCount() != 0 || stats._bytesWritten != (numPages + 1) * PAGE_SIZE) {
+		cout << "Calls are not accounted for" << endl;
+		return -1;
+	}
+
+	// Appends follow each other, write goes back to the beginning of the file
+	if (stats._seekDistance._buckets[0] != numPages || stats._seekDistance.getMax() != numPages * PAGE_SIZE) {
+		cout << "Seek distance of the calls is not correct" << endl;
+		return -1;
+	}
+
+	rc = pfm->closeFile(fileHandle);
+	assert(rc == success);
+
+	// Pages were written back when file got closed (first page was overwritten in the buffer pool, so it is written once)
+	IOStats callStats, ioStats;
+	rc = pfm->collectIOStats(fileName.c_str(), callStats, ioStats);
+	assert(rc == success);
+	if (ioStats._bytesWritten != numPages * PAGE_SIZE || ioStats._bytesRead != 0 || ioStats._latency[IO_APPEND].getCount() == 0) {
+		cout << "Write backs are not accounted for" << endl;
+		return -1;
+	}
+	if (callStats._latency[IO_APPEND].getCount() != numPages || callStats._latency[IO_WRITE].getCount() != 1) {
+		cout << "Calls of the closed handle are not kept" << endl;
+		return -1;
+	}
+
+	// Cold reads: sequential pass, then pages in reverse order
+	pfm->setBufferPoolSize(pfm->getBufferPool()->getNumFrames());
+	unsigned prefetchWindow = pfm->getPrefetchWindow();
+	pfm->setPrefetchWindow(0);
+
+	rc = pfm->openFile(fileName.c_str(), fileHandle, IO_PREAD);
+	assert(rc == success);
+
+	IOStats lastStats;
+	rc = fileHandle.collectPhysicalIOStats(lastStats);
+	assert(rc == success);
+
+	for (unsigned i = 0; i < numPages; i++) {
+		rc = fileHandle.readPage(i, buffer);
+		assert(rc == success);
+	}
+
+	ioStats = IOStats();
+	rc = fileHandle.collectPhysicalIOStats(ioStats);
+	assert(rc == success);
+	unsigned long long numReads = ioStats._latency[IO_READ].getCount() - lastStats._latency[IO_READ].getCount();
+	unsigned long long numSequential = ioStats._seekDistance._buckets[0] - lastStats._seekDistance._buckets[0];
+	if (numReads != numPages || ioStats._bytesRead - lastStats._bytesRead != numPages * PAGE_SIZE || numSequential < numPages - 1) {
+		cout << "Sequential reads are not accounted for" << endl;
+		return -1;
+	}
+
+	pfm->setBufferPoolSize(pfm->getBufferPool()->getNumFrames());
+	lastStats = ioStats;
+
+	for (unsigned i = numPages; i > 0; i--) {
+		rc = fileHandle.readPage(i - 1, buffer);
+		assert(rc == success);
+	}
+
+	ioStats = IOStats();
+	rc = fileHandle.collectPhysicalIOStats(ioStats);
+	assert(rc == success);
+	// Every read but the first one skips back over two pages (the one just read and the one before it)
+	unsigned bucket = IOHistogram::getBucket(2 * PAGE_SIZE);
+	numSequential = ioStats._seekDistance._buckets[0] - lastStats._seekDistance._buckets[0];
+	if (ioStats._latency[IO_READ].getCount() - lastStats._latency[IO_READ].getCount() != numPages || numSequential > 0 ||
+		ioStats._seekDistance._buckets[bucket] - lastStats._seekDistance._buckets[bucket] != numPages - 1) {
+		cout << "Backward reads are not accounted for as seeks" << endl;
+		return -1;
+	}
+
+	// Handle statistics start with the session
+	stats = IOStats();
+	rc = fileHandle.collectIOStats(stats);
+	assert(rc == success);
+	if (stats._latency[IO_READ].getCount() != 2 * numPages || stats._latency[IO_APPEND].getCount() != 0 ||
+		stats._latency[IO_READ].getPercentile(99) < stats._latency[IO_READ].getPercentile(50)) {
+		cout << "Handle statistics are not correct" << endl;
+		return -1;
+	}
+
+	rc = pfm->closeFile(fileHandle);
+	assert(rc == success);
+	pfm->setPrefetchWindow(prefetchWindow);
+
+	// Aggregate covers both sessions
+	callStats = IOStats();
+	ioStats = IOStats();
+	pfm->collectIOStats(callStats, ioStats);
+	if (callStats._latency[IO_READ].getCount() < 2 * numPages || callStats._latency[IO_APPEND].getCount() < numPages ||
+		ioStats._bytesRead < 2 * numPages * PAGE_SIZE) {
+		cout << "Aggregate statistics are not correct" << endl;
+		return -1;
+	}
+
+	rc = pfm->destroyFile(fileName.c_str());
+	assert(rc == success);
+
+	// Statistics of destroyed file are gone
+	rc = pfm->collectIOStats(fileName.c_str(), callStats, ioStats);
+	assert(rc != success);
+
+	return 0;
+}
+
+int main() {
+	PagedFileManager *pfm = PagedFileManager::instance();
+
+	remove("test29");
+
+	int rc = RBFTest_29(pfm);
+	if (rc == 0) {
+		cout << "Test Case 29 Passed!" << endl << endl;
+	} else {
+		cout << "Test Case 29 Failed!" << endl << endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,242 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "pfm.h"
+#include "bpm.h"
+#include "wal.h"
+#include "bgwriter.h"
+
+using namespace std;
+
+const int success = 0;
+
+// Check page content straight in the OS file (bypassing the buffer pool)
+bool isPageOnDisk(const char *fileName, PageNum pageNum, const char *data) {
+	char buffer[PAGE_SIZE];
+	int fd = open(fileName, O_RDONLY);
+	if (fd < 0)
+		return false;
+	ssize_t numBytes = pread(fd, buffer, PAGE_SIZE, (off_t) pageNum * PAGE_SIZE);
+	close(fd);
+	return numBytes == PAGE_SIZE && memcmp(buffer, data, PAGE_SIZE) == 0;
+}
+
+// Wait (up to 5 seconds) until all pages of the file are on disk
+bool waitForPages(const char *fileName, unsigned numPages, char fill) {
+	char data[PAGE_SIZE];
+	for (unsigned attempt = 0; attempt < 500; attempt++) {
+		unsigned numWritten = 0;
+		for (unsigned i = 0; i < numPages; i++) {
+			memset(data, fill + i, PAGE_SIZE);
+			if (isPageOnDisk(fileName, i, data))
+				numWritten++;
+		}
+		if (numWritten == numPages)
+			return true;
+		usleep(10000);
+	}
+	return false;
+}
+
+int RBFTest_30(PagedFileManager *pfm) {
+	// Functions Tested:
+	// 1. Clean frames are evicted before dirty ones
+	// 2. Background writer writes back pages above the dirty ratio, and pages that are dirty for too long
+	// 3. Background writer takes checkpoints of the write-ahead log
+	cout << "****In RBF Test Case 30****" << endl;
+
+	RC rc;
+	const char *fileName = "test30";
+	const char *logName = "test30.log";
+	const unsigned numFrames = 16;
+	BufferPool *pool = pfm->getBufferPool();
+	unsigned numOldFrames = pool->getNumFrames();
+
+	rc = pfm->setBufferPoolSize(numFrames);
+	assert(rc == success);
+
+	rc = pfm->createFile(fileName);
+	assert(rc == success);
+
+	FileHandle fileHandle;
+	rc = pfm->openFile(fileName, fileHandle);
+	assert(rc == success);
+
+	// Half of the pool holds clean pages, the other half dirty ones
+	char data[PAGE_SIZE];
+	for (unsigned i = 0; i < numFrames; i++) {
+		memset(data, 'a' + i, PAGE_SIZE);
+		rc = fileHandle.appendPage(data);
+		assert(rc == success);
+	}
+	rc = pfm->flushBufferPool();
+	assert(rc == success);
+	for (unsigned i = 0; i < numFrames / 2; i++) {
+		memset(data, 'A' + i, PAGE_SIZE);
+		rc = fileHandle.writePage(i, data);
+		assert(rc == success);
+	}
+
+	// New pages take frames of the clean pages, dirty ones are not written back
+	unsigned hitCount = 0, missCount = 0, evictionCount = 0, writeBackCount = 0;
+	pfm->collectBufferPoolCounters(hitCount, missCount, evictionCount, writeBackCount);
+	unsigned lastWriteBackCount = writeBackCount;
+
+	pool->setCleanVictimsFirst(true);
+	for (unsigned i = 0; i < numFrames / 2; i++) {
+		memset(data, 'a' + numFrames + i, PAGE_SIZE);
+		rc = fileHandle.appendPage(data);
+		assert(rc == success);
+	}
+
+	pfm->collectBufferPoolCounters(hitCount, missCount, evictionCount, writeBackCount);
+	if (writeBackCount != lastWriteBackCount) {
+		cout << "Dirty page is evicted while there are clean ones" << endl;
+		return -1;
+	}
+
+	// All remaining pages are dirty, so one of them has to go
+	memset(data, 'a' + 2 * numFrames, PAGE_SIZE);
+	rc = fileHandle.appendPage(data);
+	assert(rc == success);
+	pfm->collectBufferPoolCounters(hitCount, missCount, evictionCount, writeBackCount);
+	if (writeBackCount != lastWriteBackCount + 1) {
+		cout << "Dirty page is not evicted when there is no clean one" << endl;
+		return -1;
+	}
+	pool->setCleanVictimsFirst(false);
+
+	rc = pfm->closeFile(fileHandle);
+	assert(rc == success);
+	rc = pfm->destroyFile(fileName);
+	assert(rc == success);
+
+	// Dirty ratio: writer brings number of dirty frames down to 25% (age and checkpoints are off)
+	rc = pfm->createFile(fileName);
+	assert(rc == success);
+	rc = pfm->openFile(fileName, fileHandle);
+	assert(rc == success);
+
+	unsigned writeCount = 0, checkpointCount = 0;
+	pfm->collectBackgroundWriterCounters(writeCount, checkpointCount);
+	unsigned lastWriteCount = writeCount;
+
+	pfm->setBackgroundWriterPolicy(25, 0, 0);
+	pfm->setBackgroundWriter(true);
+	assert(pfm->getBackgroundWriter());
+
+	for (unsigned i = 0; i < numFrames; i++) {
+		memset(data, 'a' + i, PAGE_SIZE);
+		rc = fileHandle.appendPage(data);
+		assert(rc == success);
+	}
+
+	for (unsigned attempt = 0; attempt < 500 && writeCount - lastWriteCount < numFrames * 3 / 4; attempt++) {
+		usleep(10000);
+		pfm->collectBackgroundWriterCounters(writeCount, checkpointCount);
+	}
+	usleep(50000);
+	pfm->collectBackgroundWriterCounters(writeCount, checkpointCount);
+	if (writeCount - lastWriteCount != numFrames * 3 / 4) {
+		cout << "Writer wrote " << writeCount - lastWriteCount << " pages instead of " << numFrames * 3 / 4 << endl;
+		return -1;
+	}
+
+	// Oldest pages went first
+	if (!waitForPages(fileName, numFrames * 3 / 4, 'a')) {
+		cout << "Oldest pages are not written back" << endl;
+		return -1;
+	}
+
+	// Age: the rest is written within the age limit, without closing the file
+	pfm->setBackgroundWriterPolicy(25, 50, 0);
+	if (!waitForPages(fileName, numFrames, 'a')) {
+		cout << "Old dirty pages are not written back" << endl;
+		return -1;
+	}
+
+	rc = pfm->closeFile(fileHandle);
+	assert(rc == success);
+	rc = pfm->destroyFile(fileName);
+	assert(rc == success);
+
+	pfm->setBackgroundWriter(false);
+	assert(!pfm->getBackgroundWriter());
+
+	// Checkpoints: log is emptied while the file stays opened
+	rc = pfm->openLog(logName);
+	assert(rc == success);
+
+	pfm->setBackgroundWriterPolicy(25, 50, 100);
+	pfm->setBackgroundWriter(true);
+
+	rc = pfm->createFile(fileName);
+	assert(rc == success);
+	rc = pfm->openFile(fileName, fileHandle);
+	assert(rc == success);
+
+	pfm->collectBackgroundWriterCounters(writeCount, checkpointCount);
+	unsigned lastCheckpointCount = checkpointCount;
+
+	for (unsigned i = 0; i < numFrames; i++) {
+		memset(data, 'k' + i, PAGE_SIZE);
+		rc = fileHandle.appendPage(data);
+		assert(rc == success);
+	}
+
+	LogManager *log = pfm->getLogManager();
+	for (unsigned attempt = 0; attempt < 500 && (checkpointCount == lastCheckpointCount || log->getLogSize() > 0); attempt++) {
+		usleep(10000);
+		pfm->collectBackgroundWriterCounters(writeCount, checkpointCount);
+	}
+	if (checkpointCount == lastCheckpointCount || log->getLogSize() != 0) {
+		cout << "Checkpoint is not taken" << endl;
+		return -1;
+	}
+
+	// Pages are in the data file, since their log records are gone
+	if (!waitForPages(fileName, numFrames, 'k')) {
+		cout << "Pages are not written back by checkpoint" << endl;
+		return -1;
+	}
+
+	rc = pfm->closeFile(fileHandle);
+	assert(rc == success);
+
+	pfm->setBackgroundWriter(false);
+	pfm->setBackgroundWriterPolicy(BGWRITER_DEFAULT_DIRTY_PERCENT, BGWRITER_DEFAULT_MAX_DIRTY_AGE_MS, BGWRITER_DEFAULT_CHECKPOINT_INTERVAL_MS);
+
+	rc = pfm->closeLog();
+	assert(rc == success);
+	remove(logName);
+
+	rc = pfm->destroyFile(fileName);
+	assert(rc == success);
+
+	rc = pfm->setBufferPoolSize(numOldFrames);
+	assert(rc == success);
+
+	return 0;
+}
+
+int main() {
+	PagedFileManager *pfm = PagedFileManager::instance();
+
+	remove("test30");
+	remove("test30.log");
+
+	int rc = RBFTest_30(pfm);
+	if (rc == 0) {
+		cout << "Test Case 30 Passed!" << endl << endl;
+	} else {
+		cout << "Test Case 30 Failed!" << endl << endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,178 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "pfm.h"
+
+using namespace std;
+
+const int success = 0;
+
+int RBFTest_31(PagedFileManager *pfm) {
+	// Functions Tested:
+	// 1. Freed pages are re-used by insertPage (lowest first) before the file grows
+	// 2. Pages that cannot be freed (header page, free page, page beyond the end)
+	// 3. Allocation map is stored in the file and read back by the next session
+	// 4. Offline truncate gives free pages at the end of the file back to the OS
+	cout << "****In RBF Test Case 31****" << endl;
+
+	RC rc;
+	string fileName = "test31";
+	const unsigned numDataPages = 20;
+
+	rc = pfm->createFile(fileName.c_str());
+	assert(rc == success);
+	rc = pfm->createFileHeader(fileName.c_str());
+	assert(rc == success);
+
+	FileHandle fileHandle;
+	rc = pfm->openFile(fileName.c_str(), fileHandle);
+	assert(rc == success);
+
+	char data[PAGE_SIZE], buffer[PAGE_SIZE];
+	PageNum headerPageId = 0, dataPageId = 0;
+	for (unsigned i = 0; i < numDataPages; i++) {
+		memset(data, 'a' + i, PAGE_SIZE);
+		rc = pfm->insertPage(fileHandle, headerPageId, dataPageId, data);
+		assert(rc == success && dataPageId == i + 1);
+	}
+
+	// Pages 5 and 7 are freed (and emptied), map page is appended to the file
+	rc = pfm->freePage(fileHandle, 7);
+	assert(rc == success);
+	rc = pfm->freePage(fileHandle, 5);
+	assert(rc == success);
+
+	unsigned numFreePages = 0;
+	rc = pfm->getNumFreePages(fileHandle, numFreePages);
+	assert(rc == success);
+	if (numFreePages != 2 || fileHandle.getNumberOfPages() != numDataPages + 2) {
+		cout << "Freed pages are not accounted for" << endl;
+		return -1;
+	}
+
+	rc = fileHandle.readPage(5, buffer);
+	assert(rc == success);
+	memset(data, 0, PAGE_SIZE);
+	if (memcmp(buffer, data, PAGE_SIZE) != 0) {
+		cout << "Freed page is not emptied" << endl;
+		return -1;
+	}
+
+	// Header page, free page, map page and page beyond the end cannot be freed
+	if (pfm->freePage(fileHandle, 0) != -80 || pfm->freePage(fileHandle, 5) != -80 ||
+		pfm->freePage(fileHandle, numDataPages + 1) != -80 || pfm->freePage(fileHandle, numDataPages + 2) != -80) {
+		cout << "Page that cannot be freed is freed" << endl;
+		return -1;
+	}
+
+	// Lowest free page is re-used first
+	memset(data, 'x', PAGE_SIZE);
+	rc = pfm->insertPage(fileHandle, headerPageId, dataPageId, data);
+	assert(rc == success);
+	if (dataPageId != 5 || fileHandle.getNumberOfPages() != numDataPages + 2) {
+		cout << "Insert did not re-use free page (got page " << dataPageId << ")" << endl;
+		return -1;
+	}
+	rc = fileHandle.readPage(5, buffer);
+	assert(rc == success);
+	assert(memcmp(buffer, data, PAGE_SIZE) == 0);
+
+	// Last data pages are freed as well
+	for (PageNum pageNum = numDataPages - 4; pageNum <= numDataPages; pageNum++) {
+		rc = pfm->freePage(fileHandle, pageNum);
+		assert(rc == success);
+	}
+
+	rc = pfm->closeFile(fileHandle);
+	assert(rc == success);
+
+	// Offline truncate is not allowed while file is opened
+	rc = pfm->openFile(fileName.c_str(), fileHandle);
+	assert(rc == success);
+	rc = pfm->getNumFreePages(fileHandle, numFreePages);
+	assert(rc == success);
+	if (numFreePages != 6) {
+		cout << "Allocation map is not read back, " << numFreePages << " free pages" << endl;
+		return -1;
+	}
+	if (pfm->truncateFile(fileName.c_str()) != -5) {
+		cout << "Opened file is truncated" << endl;
+		return -1;
+	}
+	rc = pfm->closeFile(fileHandle);
+	assert(rc == success);
+
+	// Free pages 16..20 and the map page after them are cut, page 7 is still free, so it needs a map page
+	// (it takes place of the first page that was cut)
+	rc = pfm->truncateFile(fileName.c_str());
+	assert(rc == success);
+
+	struct stat fileStat;
+	stat(fileName.c_str(), &fileStat);
+	const unsigned numPagesLeft = numDataPages - 3;
+	if (fileStat.st_size != (off_t) numPagesLeft * PAGE_SIZE) {
+		cout << "File size after truncate is " << fileStat.st_size << " instead of " << numPagesLeft * PAGE_SIZE << endl;
+		return -1;
+	}
+
+	rc = pfm->openFile(fileName.c_str(), fileHandle);
+	assert(rc == success);
+	rc = pfm->getNumFreePages(fileHandle, numFreePages);
+	assert(rc == success);
+	if (fileHandle.getNumberOfPages() != numPagesLeft || numFreePages != 1) {
+		cout << "Truncated file has " << fileHandle.getNumberOfPages() << " pages and " << numFreePages << " free ones" << endl;
+		return -1;
+	}
+
+	// Remaining pages are intact, free page is re-used, and then file grows again
+	for (PageNum pageNum = 1; pageNum < numDataPages - 4; pageNum++) {
+		if (pageNum == 5 || pageNum == 7)
+			continue;
+		rc = fileHandle.readPage(pageNum, buffer);
+		assert(rc == success);
+		memset(data, 'a' + pageNum - 1, PAGE_SIZE);
+		if (memcmp(buffer, data, PAGE_SIZE) != 0) {
+			cout << "Page " << pageNum << " is damaged by truncate" << endl;
+			return -1;
+		}
+	}
+
+	rc = pfm->insertPage(fileHandle, headerPageId, dataPageId, data);
+	assert(rc == success && dataPageId == 7);
+	rc = pfm->insertPage(fileHandle, headerPageId, dataPageId, data);
+	assert(rc == success && dataPageId == numPagesLeft);
+
+	rc = pfm->closeFile(fileHandle);
+	assert(rc == success);
+
+	// File without free pages is left as is
+	rc = pfm->truncateFile(fileName.c_str());
+	assert(rc == success);
+	stat(fileName.c_str(), &fileStat);
+	assert(fileStat.st_size == (off_t) (numPagesLeft + 1) * PAGE_SIZE);
+
+	rc = pfm->destroyFile(fileName.c_str());
+	assert(rc == success);
+
+	return 0;
+}
+
+int main() {
+	PagedFileManager *pfm = PagedFileManager::instance();
+
+	remove("test31");
+
+	int rc = RBFTest_31(pfm);
+	if (rc == 0) {
+		cout << "Test Case 31 Passed!" << endl << endl;
+	} else {
+		cout << "Test Case 31 Failed!" << endl << endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,326 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "pfm.h"
+#include "rbfm.h"
+
+using namespace std;
+
+const int success = 0;
+const unsigned numRecords = 3000;
+const unsigned numSmallRecords = 300;
+const unsigned numLoggedRecords = 2000;
+
+void createRecordDescriptor(vector<Attribute> &recordDescriptor) {
+
+	Attribute attr;
+	attr.name = "id";
+	attr.type = TypeInt;
+	attr.length = (AttrLength) 4;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "text";
+	attr.type = TypeVarChar;
+	attr.length = (AttrLength) 4000;
+	recordDescriptor.push_back(attr);
+}
+
+// Records of 10 to 1510 chars (about 5 of them per page, so that the file needs more than one header page)
+int prepareRecord(const int id, const int textLength, void *buffer) {
+	int offset = 0;
+
+	memcpy((char *) buffer + offset, &id, sizeof(int));
+	offset += sizeof(int);
+	memcpy((char *) buffer + offset, &textLength, sizeof(int));
+	offset += sizeof(int);
+	memset((char *) buffer + offset, 'a' + id % 26, textLength);
+	offset += textLength;
+
+	return offset;
+}
+
+// Same records go to the first file one by one, and to the second one in a batch
+int insertBoth(RecordBasedFileManager *rbfm, const vector<Attribute> &recordDescriptor, FileHandle &singleHandle, FileHandle &batchHandle,
+		const vector<const void*> &records, vector<RID> &rids, unsigned &singleWriteCount, unsigned &batchWriteCount) {
+	RC rc;
+	unsigned readCount = 0, writeCount = 0, appendCount = 0;
+
+	singleHandle.collectCounterValues(readCount, writeCount, appendCount);
+	unsigned lastCount = writeCount + appendCount;
+
+	vector<RID> singleRids;
+	for (unsigned i = 0; i < records.size(); i++) {
+		RID rid;
+		rc = rbfm->insertRecord(singleHandle, recordDescriptor, records[i], rid);
+		assert(rc == success);
+		singleRids.push_back(rid);
+	}
+
+	singleHandle.collectCounterValues(readCount, writeCount, appendCount);
+	singleWriteCount = writeCount + appendCount - lastCount;
+
+	batchHandle.collectCounterValues(readCount, writeCount, appendCount);
+	lastCount = writeCount + appendCount;
+
+	vector<RID> batchRids;
+	rc = rbfm->insertRecords(batchHandle, recordDescriptor, records, batchRids);
+	assert(rc == success);
+
+	batchHandle.collectCounterValues(readCount, writeCount, appendCount);
+	batchWriteCount = writeCount + appendCount - lastCount;
+
+	if (batchRids.size() != singleRids.size()) {
+		cout << "Batch returned " << batchRids.size() << " rids instead of " << singleRids.size() << endl;
+		return -1;
+	}
+
+	// Records end up in the same pages and slots
+	for (unsigned i = 0; i < singleRids.size(); i++) {
+		if (!(batchRids[i] == singleRids[i])) {
+			cout << "Record " << i << " is at (" << batchRids[i].pageNum << ", " << batchRids[i].slotNum << ") instead of ("
+				<< singleRids[i].pageNum << ", " << singleRids[i].slotNum << ")" << endl;
+			return -1;
+		}
+	}
+
+	rids = batchRids;
+	return 0;
+}
+
+// Batch larger than the buffer pool with logging on (pages of the operation are not written back before it commits)
+int testLoggedBatch(RecordBasedFileManager *rbfm, const vector<Attribute> &recordDescriptor) {
+	PagedFileManager *pfm = PagedFileManager::instance();
+	RC rc;
+	string fileName = "test32logged";
+	string logName = "test32.log";
+
+	rc = pfm->openLog(logName.c_str());
+	assert(rc == success);
+	rc = rbfm->createFile(fileName);
+	assert(rc == success);
+	FileHandle fileHandle;
+	rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success);
+
+	vector<const void*> records;
+	for (unsigned i = 0; i < numLoggedRecords; i++) {
+		void *record = malloc(PAGE_SIZE);
+		prepareRecord(i, 1000, record);
+		records.push_back(record);
+	}
+
+	int errCode = success;
+	vector<RID> rids;
+	rc = rbfm->insertRecords(fileHandle, recordDescriptor, records, rids);
+	if (rc != success || rids.size() != numLoggedRecords) {
+		cout << "Logged batch returned " << rc << " and " << rids.size() << " rids" << endl;
+		errCode = -1;
+	}
+
+	char *buffer = (char *) malloc(PAGE_SIZE);
+	for (unsigned i = 0; errCode == success && i < numLoggedRecords; i++) {
+		if (rbfm->readRecord(fileHandle, recordDescriptor, rids[i], buffer) != success || memcmp(buffer, records[i], sizeOfRecord(recordDescriptor, records[i])) != 0) {
+			cout << "Record " << i << " of the logged batch is wrong" << endl;
+			errCode = -1;
+		}
+	}
+
+	// Bad record at the end: parts committed before it stay inserted, the part it belongs to is rolled back
+	records.push_back(NULL);
+	rc = rbfm->insertRecords(fileHandle, recordDescriptor, records, rids);
+	records.pop_back();
+	if (errCode == success && (rc != -11 || rids.size() >= numLoggedRecords)) {
+		cout << "Logged batch with bad record returned " << rc << " and " << rids.size() << " rids" << endl;
+		errCode = -1;
+	}
+
+	// Scan iterator closes its copy of the handle, i.e. the file itself
+	vector<string> attributes;
+	attributes.push_back("id");
+	RBFM_ScanIterator iterator;
+	rc = rbfm->scan(fileHandle, recordDescriptor, "", NO_OP, NULL, attributes, iterator);
+	assert(rc == success);
+	unsigned numScanned = 0;
+	RID rid;
+	while (iterator.getNextRecord(rid, buffer) != RBFM_EOF)
+		numScanned++;
+	iterator.close();
+
+	if (errCode == success && numScanned != numLoggedRecords + rids.size()) {
+		cout << "Logged file has " << numScanned << " records instead of " << numLoggedRecords + rids.size() << endl;
+		errCode = -1;
+	}
+
+	for (unsigned i = 0; i < records.size(); i++)
+		free((void *) records[i]);
+	free(buffer);
+
+	rc = rbfm->destroyFile(fileName);
+	assert(rc == success);
+	rc = pfm->closeLog();
+	assert(rc == success);
+	remove(logName.c_str());
+
+	return errCode;
+}
+
+int RBFTest_32(RecordBasedFileManager *rbfm) {
+	// Functions Tested:
+	// 1. Insert batch of records into an empty file (more than one header page is needed)
+	// 2. Insert batch of records into the space left by deleted records
+	// 3. Batch writes each page once, and places records the same way as single inserts do
+	// 4. Batch stops at the record that cannot be inserted
+	// 5. Batch larger than the buffer pool is inserted while logging is on, failed part of it is rolled back
+	cout << "****In RBF Test Case 32****" << endl;
+
+	RC rc;
+	string singleFileName = "test32single";
+	string batchFileName = "test32batch";
+
+	rc = rbfm->createFile(singleFileName);
+	assert(rc == success);
+	rc = rbfm->createFile(batchFileName);
+	assert(rc == success);
+
+	FileHandle singleHandle, batchHandle;
+	rc = rbfm->openFile(singleFileName, singleHandle);
+	assert(rc == success);
+	rc = rbfm->openFile(batchFileName, batchHandle);
+	assert(rc == success);
+
+	vector<Attribute> recordDescriptor;
+	createRecordDescriptor(recordDescriptor);
+
+	vector<const void*> records;
+	for (unsigned i = 0; i < numRecords; i++) {
+		void *record = malloc(PAGE_SIZE);
+		prepareRecord(i, 10 + (i * 37) % 1500, record);
+		records.push_back(record);
+	}
+
+	unsigned singleWriteCount = 0, batchWriteCount = 0;
+	vector<RID> rids;
+	if (insertBoth(rbfm, recordDescriptor, singleHandle, batchHandle, records, rids, singleWriteCount, batchWriteCount) != success)
+		return -1;
+
+	// Pages are written about once (pages before the new header page are allocated early, and may be written again), single
+	// inserts write header page and data page for every record
+	unsigned numPages = batchHandle.getNumberOfPages();
+	unsigned numHeaderPages = (numPages - 1) / batchHandle.getNumOfPageIds() + 1;
+	if (singleHandle.getNumberOfPages() != numPages || numHeaderPages < 2 || batchWriteCount > 2 * numPages || batchWriteCount * 10 > singleWriteCount) {
+		cout << "Batch wrote " << batchWriteCount << " pages (single inserts wrote " << singleWriteCount << ") for "
+			<< numPages << " pages" << endl;
+		return -1;
+	}
+
+	char *buffer = (char *) malloc(PAGE_SIZE);
+	for (unsigned i = 0; i < numRecords; i++) {
+		rc = rbfm->readRecord(batchHandle, recordDescriptor, rids[i], buffer);
+		assert(rc == success);
+		assert(memcmp(buffer, records[i], sizeOfRecord(recordDescriptor, records[i])) == 0);
+	}
+
+	// Every third record is deleted from both files (slots of them are re-used), and smaller records fill space left in the pages
+	for (unsigned i = 0; i < numRecords; i += 3) {
+		rc = rbfm->deleteRecord(singleHandle, recordDescriptor, rids[i]);
+		assert(rc == success);
+		rc = rbfm->deleteRecord(batchHandle, recordDescriptor, rids[i]);
+		assert(rc == success);
+	}
+
+	for (unsigned i = 0; i < records.size(); i++)
+		free((void *) records[i]);
+	records.clear();
+
+	for (unsigned i = 0; i < numSmallRecords; i++) {
+		void *record = malloc(PAGE_SIZE);
+		prepareRecord(numRecords + i, 10 + (i * 13) % 200, record);
+		records.push_back(record);
+	}
+
+	if (insertBoth(rbfm, recordDescriptor, singleHandle, batchHandle, records, rids, singleWriteCount, batchWriteCount) != success)
+		return -1;
+
+	if (rids[0].pageNum >= numPages) {
+		cout << "Batch added pages instead of using space left in the pages" << endl;
+		return -1;
+	}
+
+	for (unsigned i = 0; i < numSmallRecords; i++) {
+		rc = rbfm->readRecord(batchHandle, recordDescriptor, rids[i], buffer);
+		assert(rc == success);
+		assert(memcmp(buffer, records[i], sizeOfRecord(recordDescriptor, records[i])) == 0);
+	}
+
+	// Record larger than a page goes to overflow pages along with the rest of the batch
+	void *largeRecord = malloc(2 * PAGE_SIZE);
+	prepareRecord(0, PAGE_SIZE, largeRecord);
+	vector<const void*> badRecords;
+	badRecords.push_back(records[0]);
+	badRecords.push_back(records[1]);
+	badRecords.push_back(largeRecord);
+	badRecords.push_back(records[2]);
+
+	rc = rbfm->insertRecords(batchHandle, recordDescriptor, badRecords, rids);
+	if (rc != success || rids.size() != 4) {
+		cout << "Batch with large record returned " << rc << " and " << rids.size() << " rids" << endl;
+		return -1;
+	}
+	void *largeBuffer = malloc(2 * PAGE_SIZE);
+	for (unsigned i = 0; i < rids.size(); i++) {
+		rc = rbfm->readRecord(batchHandle, recordDescriptor, rids[i], largeBuffer);
+		assert(rc == success);
+		assert(memcmp(largeBuffer, badRecords[i], sizeOfRecord(recordDescriptor, badRecords[i])) == 0);
+	}
+	free(largeBuffer);
+
+	// Bad record stops the batch, records before it are inserted
+	badRecords[2] = NULL;
+	rc = rbfm->insertRecords(batchHandle, recordDescriptor, badRecords, rids);
+	assert(rc == -11 && rids.size() == 2);
+
+	// Empty batch does nothing
+	rc = rbfm->insertRecords(batchHandle, recordDescriptor, vector<const void*>(), rids);
+	assert(rc == success && rids.empty());
+
+	free(largeRecord);
+	for (unsigned i = 0; i < records.size(); i++)
+		free((void *) records[i]);
+	records.clear();
+
+	rc = rbfm->closeFile(singleHandle);
+	assert(rc == success);
+	rc = rbfm->closeFile(batchHandle);
+	assert(rc == success);
+
+	free(buffer);
+
+	rc = rbfm->destroyFile(singleFileName);
+	assert(rc == success);
+	rc = rbfm->destroyFile(batchFileName);
+	assert(rc == success);
+
+	return testLoggedBatch(rbfm, recordDescriptor);
+}
+
+int main() {
+	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+	remove("test32single");
+	remove("test32batch");
+	remove("test32logged");
+	remove("test32.log");
+
+	int rc = RBFTest_32(rbfm);
+	if (rc == 0) {
+		cout << "Test Case 32 Passed!" << endl << endl;
+	} else {
+		cout << "Test Case 32 Failed!" << endl << endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,241 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "pfm.h"
+#include "rbfm.h"
+
+using namespace std;
+
+const int success = 0;
+const unsigned numRecords = 2000;
+const int excludedId = 7;
+
+void createRecordDescriptor(vector<Attribute> &recordDescriptor) {
+
+	Attribute attr;
+	attr.name = "id";
+	attr.type = TypeInt;
+	attr.length = (AttrLength) 4;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "name";
+	attr.type = TypeVarChar;
+	attr.length = (AttrLength) 1000;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "score";
+	attr.type = TypeReal;
+	attr.length = (AttrLength) 4;
+	recordDescriptor.push_back(attr);
+}
+
+int prepareRecord(const int id, const int nameLength, void *buffer) {
+	int offset = 0;
+	float score = id * 0.5f;
+
+	memcpy((char *) buffer + offset, &id, sizeof(int));
+	offset += sizeof(int);
+	memcpy((char *) buffer + offset, &nameLength, sizeof(int));
+	offset += sizeof(int);
+	memset((char *) buffer + offset, 'a' + id % 26, nameLength);
+	offset += nameLength;
+	memcpy((char *) buffer + offset, &score, sizeof(float));
+	offset += sizeof(float);
+
+	return offset;
+}
+
+// Record-at-a-time scan of all records but one (score and name are projected)
+int scanRecords(RecordBasedFileManager *rbfm, const string &fileName, const vector<Attribute> &recordDescriptor,
+		const vector<string> &attributes, vector<RID> &rids, vector<string> &records, unsigned &readCount) {
+	FileHandle fileHandle;
+	RC rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success);
+
+	RBFM_ScanIterator scanIterator;
+	rc = rbfm->scan(fileHandle, recordDescriptor, "id", NE_OP, &excludedId, attributes, scanIterator);
+	assert(rc == success);
+
+	unsigned lastCount = 0, writeCount = 0, appendCount = 0;
+	scanIterator._fileHandle.collectCounterValues(lastCount, writeCount, appendCount);
+
+	RID rid;
+	char *data = (char *) malloc(PAGE_SIZE);
+	while (scanIterator.getNextRecord(rid, data) != RBFM_EOF) {
+		rids.push_back(rid);
+		records.push_back(string(data, sizeof(float) + sizeof(int) + *(int *) (data + sizeof(float))));
+	}
+	free(data);
+
+	scanIterator._fileHandle.collectCounterValues(readCount, writeCount, appendCount);
+	readCount -= lastCount;
+
+	// Scan iterator closes its copy of the handle
+	return scanIterator.close();
+}
+
+int RBFTest_33(RecordBasedFileManager *rbfm) {
+	// Functions Tested:
+	// 1. Batch scan returns the same records (and rids) as getNextRecord, including moved and deleted records
+	// 2. Batch scan reads each data page once
+	// 3. Records that do not fit are returned by the next call, batch too small for a single record
+	cout << "****In RBF Test Case 33****" << endl;
+
+	RC rc;
+	string fileName = "test33";
+
+	rc = rbfm->createFile(fileName);
+	assert(rc == success);
+
+	FileHandle fileHandle;
+	rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success);
+
+	vector<Attribute> recordDescriptor;
+	createRecordDescriptor(recordDescriptor);
+
+	void *record = malloc(PAGE_SIZE);
+	vector<RID> insertedRids;
+	for (unsigned i = 0; i < numRecords; i++) {
+		RID rid;
+		prepareRecord(i, 1 + (i * 7) % 100, record);
+		rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+		assert(rc == success);
+		insertedRids.push_back(rid);
+	}
+
+	// Every 5th record is deleted, and every 7th one grows (most of them are moved to other pages)
+	unsigned numMoved = 0;
+	for (unsigned i = 0; i < numRecords; i++) {
+		if (i % 5 == 0) {
+			rc = rbfm->deleteRecord(fileHandle, recordDescriptor, insertedRids[i]);
+			assert(rc == success);
+		} else if (i % 7 == 0) {
+			prepareRecord(i, 900, record);
+			rc = rbfm->updateRecord(fileHandle, recordDescriptor, record, insertedRids[i]);
+			assert(rc == success);
+			numMoved++;
+		}
+	}
+
+	unsigned numPages = fileHandle.getNumberOfPages();
+
+	rc = rbfm->closeFile(fileHandle);
+	assert(rc == success);
+
+	// Projection puts score before name
+	vector<string> attributes;
+	attributes.push_back("score");
+	attributes.push_back("name");
+
+	vector<RID> rids;
+	vector<string> records;
+	unsigned singleReadCount = 0;
+	rc = scanRecords(rbfm, fileName, recordDescriptor, attributes, rids, records, singleReadCount);
+	assert(rc == success);
+
+	// Records that are not deleted, except the excluded one (moved records come up at the TombStone and at their new place)
+	unsigned numExpected = 0;
+	for (unsigned i = 0; i < numRecords; i++)
+		if (i % 5 != 0 && i != (unsigned) excludedId)
+			numExpected++;
+	if (records.size() < numExpected || records.size() > numExpected + numMoved) {
+		cout << "Scan returned " << records.size() << " records instead of " << numExpected << endl;
+		return -1;
+	}
+
+	// Small batch (few pages worth of records) needs many calls
+	FileHandle batchHandle;
+	rc = rbfm->openFile(fileName, batchHandle);
+	assert(rc == success);
+
+	RBFM_ScanIterator scanIterator;
+	rc = rbfm->scan(batchHandle, recordDescriptor, "id", NE_OP, &excludedId, attributes, scanIterator);
+	assert(rc == success);
+
+	unsigned lastCount = 0, readCount = 0, writeCount = 0, appendCount = 0;
+	scanIterator._fileHandle.collectCounterValues(lastCount, writeCount, appendCount);
+
+	RecordBatch batch(2 * PAGE_SIZE);
+	unsigned numBatches = 0, numReturned = 0;
+	while ((rc = scanIterator.getNextBatch(batch)) != RBFM_EOF) {
+		assert(rc == success && batch.getNumRecords() > 0);
+		numBatches++;
+
+		for (unsigned i = 0; i < batch.getNumRecords(); i++, numReturned++) {
+			if (numReturned >= rids.size() || !(batch.getRid(i) == rids[numReturned]) ||
+				batch.getRecordSize(i) != records[numReturned].size() ||
+				memcmp(batch.getRecord(i), records[numReturned].data(), batch.getRecordSize(i)) != 0) {
+				cout << "Batch record " << numReturned << " differs from the record returned by getNextRecord" << endl;
+				return -1;
+			}
+		}
+	}
+
+	scanIterator._fileHandle.collectCounterValues(readCount, writeCount, appendCount);
+	readCount -= lastCount;
+
+	if (numReturned != rids.size() || numBatches < 2) {
+		cout << "Batch scan returned " << numReturned << " records in " << numBatches << " batches" << endl;
+		return -1;
+	}
+
+	// Data pages are read once (records that were moved are read by readRecord from their new pages)
+	if (readCount > numPages + 2 * numMoved || readCount * 4 > singleReadCount) {
+		cout << "Batch scan read " << readCount << " pages (getNextRecord read " << singleReadCount << ") for " << numPages << " pages" << endl;
+		return -1;
+	}
+
+	// Exhausted iterator keeps returning RBFM_EOF
+	rc = scanIterator.getNextBatch(batch);
+	assert(rc == RBFM_EOF && batch.getNumRecords() == 0);
+	rc = scanIterator.close();
+	assert(rc == success);
+
+	// Batch that cannot hold a single record does not move the iterator
+	FileHandle tinyHandle;
+	rc = rbfm->openFile(fileName, tinyHandle);
+	assert(rc == success);
+
+	RBFM_ScanIterator tinyScanIterator;
+	rc = rbfm->scan(tinyHandle, recordDescriptor, "id", NE_OP, &excludedId, attributes, tinyScanIterator);
+	assert(rc == success);
+
+	RecordBatch tinyBatch(sizeof(float) + sizeof(int));
+	rc = tinyScanIterator.getNextBatch(tinyBatch);
+	if (rc != -28 || tinyBatch.getNumRecords() != 0) {
+		cout << "Too small batch returned " << rc << endl;
+		return -1;
+	}
+
+	rc = tinyScanIterator.getNextBatch(batch);
+	assert(rc == success && batch.getNumRecords() > 0 && batch.getRid(0) == rids[0]);
+	rc = tinyScanIterator.close();
+	assert(rc == success);
+
+	free(record);
+
+	rc = rbfm->destroyFile(fileName);
+	assert(rc == success);
+
+	return 0;
+}
+
+int main() {
+	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+	remove("test33");
+
+	int rc = RBFTest_33(rbfm);
+	if (rc == 0) {
+		cout << "Test Case 33 Passed!" << endl << endl;
+	} else {
+		cout << "Test Case 33 Failed!" << endl << endl;
+	}
+
+	return 0;
+}
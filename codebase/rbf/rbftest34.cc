@@ -0,0 +1,234 @@
+#include <iostream>
+#include <string>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "pfm.h"
+#include "rbfm.h"
+
+using namespace std;
+
+const int success = 0;
+const unsigned numRecords = 1000;
+const unsigned numCities = 7;
+const char *cities[numCities] = { "Irvine", "Tustin", "Anaheim", "Orange", "Fullerton", "Brea", "Cypress" };
+
+void createRecordDescriptor(vector<Attribute> &recordDescriptor) {
+
+	Attribute attr;
+	attr.name = "id";
+	attr.type = TypeInt;
+	attr.length = (AttrLength) 4;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "comment";
+	attr.type = TypeVarChar;
+	attr.length = (AttrLength) 1000;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "city";
+	attr.type = TypeVarChar;
+	attr.length = (AttrLength) 50;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "score";
+	attr.type = TypeReal;
+	attr.length = (AttrLength) 4;
+	recordDescriptor.push_back(attr);
+}
+
+// Wide comment goes before the city, so that condition on the city has to skip it
+int prepareRecord(const int id, void *buffer) {
+	int offset = 0;
+	int commentLength = 100 + (id * 31) % 400;
+	const char *city = cities[id % numCities];
+	int cityLength = strlen(city);
+	float score = id * 0.25f;
+
+	memcpy((char *) buffer + offset, &id, sizeof(int));
+	offset += sizeof(int);
+	memcpy((char *) buffer + offset, &commentLength, sizeof(int));
+	offset += sizeof(int);
+	memset((char *) buffer + offset, 'a' + id % 26, commentLength);
+	offset += commentLength;
+	memcpy((char *) buffer + offset, &cityLength, sizeof(int));
+	offset += sizeof(int);
+	memcpy((char *) buffer + offset, city, cityLength);
+	offset += cityLength;
+	memcpy((char *) buffer + offset, &score, sizeof(float));
+	offset += sizeof(float);
+
+	return offset;
+}
+
+// VarChar value in the format of the record field
+void prepareValue(const char *str, void *value) {
+	int length = strlen(str);
+	memcpy(value, &length, sizeof(int));
+	memcpy((char *) value + sizeof(int), str, length);
+}
+
+// Scan with the given condition (score and id are projected, in that order), and check every returned record
+int scanCity(RecordBasedFileManager *rbfm, const string &fileName, const vector<Attribute> &recordDescriptor,
+		const string &conditionAttribute, const CompOp compOp, const void *value, vector<bool> &seen) {
+	FileHandle fileHandle;
+	RC rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success);
+
+	vector<string> attributes;
+	attributes.push_back("score");
+	attributes.push_back("id");
+
+	RBFM_ScanIterator scanIterator;
+	rc = rbfm->scan(fileHandle, recordDescriptor, conditionAttribute, compOp, value, attributes, scanIterator);
+	assert(rc == success);
+
+	seen.assign(numRecords, false);
+
+	RecordBatch batch;
+	while ((rc = scanIterator.getNextBatch(batch)) != RBFM_EOF) {
+		assert(rc == success);
+
+		for (unsigned i = 0; i < batch.getNumRecords(); i++) {
+			const char *data = (const char *) batch.getRecord(i);
+			float score = *(float *) data;
+			int id = *(int *) (data + sizeof(float));
+			if (batch.getRecordSize(i) != sizeof(float) + sizeof(int) || id < 0 || id >= (int) numRecords || seen[id] || score != id * 0.25f) {
+				cout << "Scan returned wrong record " << id << endl;
+				return -1;
+			}
+			seen[id] = true;
+		}
+	}
+
+	// Scan iterator closes its copy of the handle
+	return scanIterator.close();
+}
+
+int RBFTest_34(RecordBasedFileManager *rbfm) {
+	// Functions Tested:
+	// 1. Condition on VarChar that follows another VarChar (field is found thru directory of offsets of the encoded record)
+	// 2. Equal and ordered comparison of VarChar (shorter string goes first)
+	// 3. Condition on attribute that is not projected, projection in different order than in the record
+	// 4. Condition on attribute that is not part of the record
+	cout << "****In RBF Test Case 34****" << endl;
+
+	RC rc;
+	string fileName = "test34";
+
+	rc = rbfm->createFile(fileName);
+	assert(rc == success);
+
+	FileHandle fileHandle;
+	rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success);
+
+	vector<Attribute> recordDescriptor;
+	createRecordDescriptor(recordDescriptor);
+
+	void *record = malloc(PAGE_SIZE);
+	RID rid;
+	for (unsigned i = 0; i < numRecords; i++) {
+		prepareRecord(i, record);
+		rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+		assert(rc == success);
+	}
+
+	rc = rbfm->closeFile(fileHandle);
+	assert(rc == success);
+
+	char value[PAGE_SIZE];
+	vector<bool> seen;
+
+	// "Irvine", "Tustin" and "Orange" have the same length, only one of them is equal
+	prepareValue("Tustin", value);
+	if (scanCity(rbfm, fileName, recordDescriptor, "city", EQ_OP, value, seen) != success)
+		return -1;
+	for (unsigned i = 0; i < numRecords; i++) {
+		if (seen[i] != (strcmp(cities[i % numCities], "Tustin") == 0)) {
+			cout << "Equality on city is wrong for record " << i << endl;
+			return -1;
+		}
+	}
+
+	prepareValue("Tustin", value);
+	if (scanCity(rbfm, fileName, recordDescriptor, "city", NE_OP, value, seen) != success)
+		return -1;
+	for (unsigned i = 0; i < numRecords; i++) {
+		if (seen[i] != (strcmp(cities[i % numCities], "Tustin") != 0)) {
+			cout << "Inequality on city is wrong for record " << i << endl;
+			return -1;
+		}
+	}
+
+	// Shorter cities go first, then cities of the same length in alphabetical order
+	prepareValue("Orange", value);
+	if (scanCity(rbfm, fileName, recordDescriptor, "city", LT_OP, value, seen) != success)
+		return -1;
+	for (unsigned i = 0; i < numRecords; i++) {
+		const char *city = cities[i % numCities];
+		bool isLess = strlen(city) < strlen("Orange") || (strlen(city) == strlen("Orange") && strcmp(city, "Orange") < 0);
+		if (seen[i] != isLess) {
+			cout << "Ordering of city is wrong for record " << i << endl;
+			return -1;
+		}
+	}
+
+	// Longer comments, and comments of the same length that are not less than "zz..z"
+	int commentLength = 300;
+	memcpy(value, &commentLength, sizeof(int));
+	memset(value + sizeof(int), 'z', commentLength);
+	if (scanCity(rbfm, fileName, recordDescriptor, "comment", GE_OP, value, seen) != success)
+		return -1;
+	for (unsigned i = 0; i < numRecords; i++) {
+		unsigned length = 100 + (i * 31) % 400;
+		if (seen[i] != (length > 300 || (length == 300 && 'a' + i % 26 == 'z'))) {
+			cout << "Ordering of comment is wrong for record " << i << endl;
+			return -1;
+		}
+	}
+
+	// No condition returns every record
+	if (scanCity(rbfm, fileName, recordDescriptor, "", NO_OP, NULL, seen) != success)
+		return -1;
+	for (unsigned i = 0; i < numRecords; i++) {
+		if (!seen[i]) {
+			cout << "Record " << i << " is not returned without condition" << endl;
+			return -1;
+		}
+	}
+
+	// Condition on attribute that record does not have matches nothing
+	if (scanCity(rbfm, fileName, recordDescriptor, "country", EQ_OP, value, seen) != success)
+		return -1;
+	for (unsigned i = 0; i < numRecords; i++) {
+		if (seen[i]) {
+			cout << "Condition on unknown attribute returned record " << i << endl;
+			return -1;
+		}
+	}
+
+	free(record);
+
+	rc = rbfm->destroyFile(fileName);
+	assert(rc == success);
+
+	return 0;
+}
+
+int main() {
+	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+	remove("test34");
+
+	int rc = RBFTest_34(rbfm);
+	if (rc == 0) {
+		cout << "Test Case 34 Passed!" << endl << endl;
+	} else {
+		cout << "Test Case 34 Failed!" << endl << endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,360 @@
+#include <iostream>
+#include <string>
+#include <set>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "pfm.h"
+#include "rbfm.h"
+
+using namespace std;
+
+const int success = 0;
+const unsigned numRecords = 1500;
+const unsigned numTags = 3;
+const char *tags[numTags] = { "alpha", "beta", "gamma" };
+
+void createRecordDescriptor(vector<Attribute> &recordDescriptor) {
+
+	Attribute attr;
+	attr.name = "id";
+	attr.type = TypeInt;
+	attr.length = (AttrLength) 4;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "name";
+	attr.type = TypeVarChar;
+	attr.length = (AttrLength) 1000;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "score";
+	attr.type = TypeReal;
+	attr.length = (AttrLength) 4;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "tag";
+	attr.type = TypeVarChar;
+	attr.length = (AttrLength) 50;
+	recordDescriptor.push_back(attr);
+}
+
+int prepareRecord(const int id, const int nameLength, void *buffer) {
+	int offset = 0;
+	float score = id * 0.5f;
+	const char *tag = tags[id % numTags];
+	int tagLength = strlen(tag);
+
+	memcpy((char *) buffer + offset, &id, sizeof(int));
+	offset += sizeof(int);
+	memcpy((char *) buffer + offset, &nameLength, sizeof(int));
+	offset += sizeof(int);
+	memset((char *) buffer + offset, 'a' + id % 26, nameLength);
+	offset += nameLength;
+	memcpy((char *) buffer + offset, &score, sizeof(float));
+	offset += sizeof(float);
+	memcpy((char *) buffer + offset, &tagLength, sizeof(int));
+	offset += sizeof(int);
+	memcpy((char *) buffer + offset, tag, tagLength);
+	offset += tagLength;
+
+	return offset;
+}
+
+// Records of both files are read back and compared with the expected ones (deleted records cannot be read)
+int checkRecords(RecordBasedFileManager *rbfm, FileHandle &rowHandle, FileHandle &paxHandle, const vector<Attribute> &recordDescriptor,
+		const vector<RID> &rowRids, const vector<RID> &paxRids, const vector<string> &expected) {
+	char *buffer = (char *) malloc(PAGE_SIZE);
+	for (unsigned i = 0; i < numRecords; i++) {
+		RC rc = rbfm->readRecord(paxHandle, recordDescriptor, paxRids[i], buffer);
+		if (expected[i].empty()) {
+			if (rc == success) {
+				cout << "Deleted record " << i << " is read from PAX file" << endl;
+				free(buffer);
+				return -1;
+			}
+			continue;
+		}
+		if (rc != success || memcmp(buffer, expected[i].data(), expected[i].size()) != 0) {
+			cout << "Record " << i << " of PAX file is wrong (" << rc << ")" << endl;
+			free(buffer);
+			return -1;
+		}
+
+		rc = rbfm->readRecord(rowHandle, recordDescriptor, rowRids[i], buffer);
+		assert(rc == success);
+		assert(memcmp(buffer, expected[i].data(), expected[i].size()) == 0);
+
+		// Single attribute comes from its minipage
+		rc = rbfm->readAttribute(paxHandle, recordDescriptor, paxRids[i], "name", buffer);
+		assert(rc == success);
+		if (memcmp(buffer, expected[i].data() + sizeof(int), sizeof(int) + *(int *) buffer) != 0) {
+			cout << "Attribute of record " << i << " of PAX file is wrong" << endl;
+			free(buffer);
+			return -1;
+		}
+	}
+	free(buffer);
+	return 0;
+}
+
+// Scan that skips one tag (score and id are projected); every record is returned once by the PAX file (and at least once by the row file)
+int scanFile(RecordBasedFileManager *rbfm, const string &fileName, const vector<Attribute> &recordDescriptor, const bool useBatch,
+		vector<RID> &rids, set<int> &ids, unsigned &numReturned) {
+	FileHandle fileHandle;
+	RC rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success);
+
+	vector<string> attributes;
+	attributes.push_back("score");
+	attributes.push_back("id");
+
+	char value[PAGE_SIZE];
+	int length = strlen(tags[1]);
+	memcpy(value, &length, sizeof(int));
+	memcpy(value + sizeof(int), tags[1], length);
+
+	RBFM_ScanIterator scanIterator;
+	rc = rbfm->scan(fileHandle, recordDescriptor, "tag", NE_OP, value, attributes, scanIterator);
+	assert(rc == success);
+
+	numReturned = 0;
+
+	RecordBatch batch;
+	RID rid;
+	char data[PAGE_SIZE];
+	while (true) {
+		vector<RID> batchRids;
+		vector<string> records;
+		if (useBatch) {
+			if ((rc = scanIterator.getNextBatch(batch)) == RBFM_EOF)
+				break;
+			assert(rc == success);
+			for (unsigned i = 0; i < batch.getNumRecords(); i++) {
+				batchRids.push_back(batch.getRid(i));
+				records.push_back(string((const char *) batch.getRecord(i), batch.getRecordSize(i)));
+			}
+		} else {
+			if (scanIterator.getNextRecord(rid, data) == RBFM_EOF)
+				break;
+			batchRids.push_back(rid);
+			records.push_back(string(data, sizeof(float) + sizeof(int)));
+		}
+
+		for (unsigned i = 0; i < records.size(); i++) {
+			float score = *(const float *) records[i].data();
+			int id = *(const int *) (records[i].data() + sizeof(float));
+			if (records[i].size() != sizeof(float) + sizeof(int) || id < 0 || id >= (int) numRecords || id % numTags == 1 || score != id * 0.5f) {
+				cout << "Scan of " << fileName << " returned wrong record " << id << endl;
+				return -1;
+			}
+			rids.push_back(batchRids[i]);
+			ids.insert(id);
+			numReturned++;
+		}
+	}
+
+	// Scan iterator closes its copy of the handle
+	return scanIterator.close();
+}
+
+int RBFTest_35(RecordBasedFileManager *rbfm) {
+	// Functions Tested:
+	// 1. File created with PAX layout keeps it after re-open
+	// 2. Insert (single and batch), read, read attribute, update (in place, grow, move), delete of PAX file give the same records as row file
+	// 3. Scan of PAX file (getNextRecord and getNextBatch) with condition and projection returns each record once, at its original rid
+	// 4. Record larger than a page, and reading of PAX file thru memory-mapped handle
+	cout << "****In RBF Test Case 35****" << endl;
+
+	RC rc;
+	string rowFileName = "test35row";
+	string paxFileName = "test35pax";
+
+	rc = rbfm->createFile(rowFileName);
+	assert(rc == success);
+	rc = rbfm->createFile(paxFileName, PAGE_SIZE, LAYOUT_PAX);
+	assert(rc == success);
+
+	FileHandle rowHandle, paxHandle;
+	rc = rbfm->openFile(rowFileName, rowHandle);
+	assert(rc == success);
+	rc = rbfm->openFile(paxFileName, paxHandle);
+	assert(rc == success);
+
+	if (rowHandle.getPageLayout() != LAYOUT_ROW || paxHandle.getPageLayout() != LAYOUT_PAX) {
+		cout << "Layout of the file is not stored" << endl;
+		return -1;
+	}
+
+	vector<Attribute> recordDescriptor;
+	createRecordDescriptor(recordDescriptor);
+
+	// First half is inserted one by one, second half in a batch
+	vector<string> expected;
+	vector<RID> rowRids, paxRids;
+	vector<const void*> records;
+	for (unsigned i = 0; i < numRecords; i++) {
+		char *record = (char *) malloc(PAGE_SIZE);
+		int size = prepareRecord(i, 1 + (i * 13) % 200, record);
+		expected.push_back(string(record, size));
+		records.push_back(record);
+
+		if (i < numRecords / 2) {
+			RID rid;
+			rc = rbfm->insertRecord(rowHandle, recordDescriptor, record, rid);
+			assert(rc == success);
+			rowRids.push_back(rid);
+			rc = rbfm->insertRecord(paxHandle, recordDescriptor, record, rid);
+			assert(rc == success);
+			paxRids.push_back(rid);
+		}
+	}
+
+	vector<const void*> batch(records.begin() + numRecords / 2, records.end());
+	vector<RID> batchRids;
+	rc = rbfm->insertRecords(rowHandle, recordDescriptor, batch, batchRids);
+	assert(rc == success);
+	rowRids.insert(rowRids.end(), batchRids.begin(), batchRids.end());
+	rc = rbfm->insertRecords(paxHandle, recordDescriptor, batch, batchRids);
+	assert(rc == success && batchRids.size() == batch.size());
+	paxRids.insert(paxRids.end(), batchRids.begin(), batchRids.end());
+
+	for (unsigned i = 0; i < records.size(); i++)
+		free((void *) records[i]);
+
+	if (checkRecords(rbfm, rowHandle, paxHandle, recordDescriptor, rowRids, paxRids, expected) != success)
+		return -1;
+
+	// Every 5th record shrinks, every 7th one grows (most of them are moved), every 6th one is deleted (some after being moved)
+	char *record = (char *) malloc(PAGE_SIZE);
+	char *largeRecord = (char *) malloc(2 * PAGE_SIZE);
+	for (unsigned i = 0; i < numRecords; i++) {
+		int size = 0;
+		if (i % 5 == 1)
+			size = prepareRecord(i, 1, record);
+		else if (i % 7 == 3)
+			size = prepareRecord(i, 800, record);
+		else
+			continue;
+
+		rc = rbfm->updateRecord(rowHandle, recordDescriptor, record, rowRids[i]);
+		assert(rc == success);
+		rc = rbfm->updateRecord(paxHandle, recordDescriptor, record, paxRids[i]);
+		assert(rc == success);
+		expected[i] = string(record, size);
+	}
+
+	// Moved record of PAX file grows again (it is moved once more), and then shrinks back
+	prepareRecord(10, 900, record);
+	rc = rbfm->updateRecord(paxHandle, recordDescriptor, record, paxRids[10]);
+	assert(rc == success);
+	rc = rbfm->readRecord(paxHandle, recordDescriptor, paxRids[10], largeRecord);
+	assert(rc == success && memcmp(largeRecord, record, sizeOfRecord(recordDescriptor, record)) == 0);
+	rc = rbfm->updateRecord(paxHandle, recordDescriptor, expected[10].data(), paxRids[10]);
+	assert(rc == success);
+
+	for (unsigned i = 0; i < numRecords; i += 6) {
+		rc = rbfm->deleteRecord(paxHandle, recordDescriptor, paxRids[i]);
+		assert(rc == success);
+		rc = rbfm->deleteRecord(rowHandle, recordDescriptor, rowRids[i]);
+		assert(rc == success);
+		expected[i].clear();
+	}
+
+	if (checkRecords(rbfm, rowHandle, paxHandle, recordDescriptor, rowRids, paxRids, expected) != success)
+		return -1;
+
+	// Record that does not fit into a page keeps its name in overflow pages
+	int largeSize = prepareRecord(0, PAGE_SIZE, largeRecord);
+	RID rid;
+	rc = rbfm->insertRecord(paxHandle, recordDescriptor, largeRecord, rid);
+	assert(rc == success);
+	char *largeBuffer = (char *) malloc(2 * PAGE_SIZE);
+	rc = rbfm->readRecord(paxHandle, recordDescriptor, rid, largeBuffer);
+	assert(rc == success && memcmp(largeBuffer, largeRecord, largeSize) == 0);
+	free(largeBuffer);
+	rc = rbfm->deleteRecord(paxHandle, recordDescriptor, rid);
+	assert(rc == success);
+
+	// PAX page is always packed
+	rc = rbfm->reorganizePage(paxHandle, recordDescriptor, paxRids[1].pageNum);
+	assert(rc == success);
+
+	rc = rbfm->closeFile(rowHandle);
+	assert(rc == success);
+	rc = rbfm->closeFile(paxHandle);
+	assert(rc == success);
+
+	// Scans return the same records
+	vector<RID> rowScanRids, paxScanRids, paxBatchRids;
+	set<int> rowIds, paxIds, paxBatchIds;
+	unsigned numRowReturned = 0, numPaxReturned = 0, numBatchReturned = 0;
+	if (scanFile(rbfm, rowFileName, recordDescriptor, false, rowScanRids, rowIds, numRowReturned) != success ||
+		scanFile(rbfm, paxFileName, recordDescriptor, false, paxScanRids, paxIds, numPaxReturned) != success ||
+		scanFile(rbfm, paxFileName, recordDescriptor, true, paxBatchRids, paxBatchIds, numBatchReturned) != success)
+		return -1;
+
+	// (row file also returns records that were deleted after being moved, since their TombStones are removed alone)
+	set<int> expectedIds;
+	for (unsigned i = 0; i < numRecords; i++)
+		if (expected[i].empty() == false && i % numTags != 1)
+			expectedIds.insert(i);
+
+	bool isSubset = true;
+	for (set<int>::iterator iter = expectedIds.begin(); iter != expectedIds.end(); iter++)
+		isSubset = isSubset && rowIds.count(*iter) > 0;
+
+	if (paxIds != expectedIds || isSubset == false || numPaxReturned != expectedIds.size() || paxBatchRids != paxScanRids) {
+		cout << "Scan of PAX file returned " << numPaxReturned << " records (" << numBatchReturned << " in batches), row file returned "
+			<< rowIds.size() << ", expected " << expectedIds.size() << endl;
+		return -1;
+	}
+
+	// Records are returned at their original rids
+	for (unsigned i = 0; i < paxScanRids.size(); i++) {
+		bool found = false;
+		for (unsigned j = 0; j < numRecords && found == false; j++)
+			found = expected[j].empty() == false && paxScanRids[i] == paxRids[j];
+		if (found == false) {
+			cout << "Scan of PAX file returned record at (" << paxScanRids[i].pageNum << ", " << paxScanRids[i].slotNum << ")" << endl;
+			return -1;
+		}
+	}
+
+	// Layout is read back, and memory-mapped handle reads records of PAX file as well
+	rc = rbfm->openFile(paxFileName, paxHandle, IO_MMAP);
+	assert(rc == success && paxHandle.getPageLayout() == LAYOUT_PAX);
+	for (unsigned i = 1; i < numRecords; i += 50) {
+		rc = rbfm->readRecord(paxHandle, recordDescriptor, paxRids[i], record);
+		assert(rc == success && memcmp(record, expected[i].data(), expected[i].size()) == 0);
+	}
+	rc = rbfm->closeFile(paxHandle);
+	assert(rc == success);
+
+	free(record);
+	free(largeRecord);
+
+	rc = rbfm->destroyFile(rowFileName);
+	assert(rc == success);
+	rc = rbfm->destroyFile(paxFileName);
+	assert(rc == success);
+
+	return 0;
+}
+
+int main() {
+	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+	remove("test35row");
+	remove("test35pax");
+
+	int rc = RBFTest_35(rbfm);
+	if (rc == 0) {
+		cout << "Test Case 35 Passed!" << endl << endl;
+	} else {
+		cout << "Test Case 35 Failed!" << endl << endl;
+	}
+
+	return 0;
+}
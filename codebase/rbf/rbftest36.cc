@@ -0,0 +1,346 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <pthread.h>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "pscan.h"
+
+using namespace std;
+
+const int success = 0;
+const unsigned numRecords = 12000;
+const unsigned numCities = 7;
+const char *cities[numCities] = { "Irvine", "Tustin", "Anaheim", "Orange", "Fullerton", "Brea", "Cypress" };
+
+void createRecordDescriptor(vector<Attribute> &recordDescriptor) {
+
+	Attribute attr;
+	attr.name = "id";
+	attr.type = TypeInt;
+	attr.length = (AttrLength) 4;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "comment";
+	attr.type = TypeVarChar;
+	attr.length = (AttrLength) 1000;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "city";
+	attr.type = TypeVarChar;
+	attr.length = (AttrLength) 50;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "score";
+	attr.type = TypeReal;
+	attr.length = (AttrLength) 4;
+	recordDescriptor.push_back(attr);
+}
+
+int prepareRecord(const int id, const int commentLength, void *buffer) {
+	int offset = 0;
+	const char *city = cities[id % numCities];
+	int cityLength = strlen(city);
+	float score = id * 0.25f;
+
+	memcpy((char *) buffer + offset, &id, sizeof(int));
+	offset += sizeof(int);
+	memcpy((char *) buffer + offset, &commentLength, sizeof(int));
+	offset += sizeof(int);
+	memset((char *) buffer + offset, 'a' + id % 26, commentLength);
+	offset += commentLength;
+	memcpy((char *) buffer + offset, &cityLength, sizeof(int));
+	offset += sizeof(int);
+	memcpy((char *) buffer + offset, city, cityLength);
+	offset += cityLength;
+	memcpy((char *) buffer + offset, &score, sizeof(float));
+	offset += sizeof(float);
+
+	return offset;
+}
+
+// Returned record as a string that starts with its rid, so that sorted results of two scans can be compared
+void appendBatch(const RecordBatch &batch, vector<string> &results) {
+	for (unsigned i = 0; i < batch.getNumRecords(); i++) {
+		string result((const char *) &batch.getRid(i), sizeof(RID));
+		result.append((const char *) batch.getRecord(i), batch.getRecordSize(i));
+		results.push_back(result);
+	}
+}
+
+// Fill file with records; every 40th record of the row file grows so much, that it is moved to another page
+int createFile(RecordBasedFileManager *rbfm, const string &fileName, const PageLayout layout, const vector<Attribute> &recordDescriptor) {
+	RC rc = rbfm->createFile(fileName, PAGE_SIZE, layout);
+	assert(rc == success);
+
+	FileHandle fileHandle;
+	rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success);
+
+	void *record = malloc(PAGE_SIZE);
+	vector<RID> rids(numRecords);
+	for (unsigned i = 0; i < numRecords; i++) {
+		prepareRecord(i, 100 + (i * 31) % 400, record);
+		rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rids[i]);
+		assert(rc == success);
+	}
+
+	for (unsigned i = 0; i < numRecords; i += 40) {
+		prepareRecord(i, 2000, record);
+		rc = rbfm->updateRecord(fileHandle, recordDescriptor, record, rids[i]);
+		assert(rc == success);
+	}
+
+	// Some of the deleted slots stay empty
+	for (unsigned i = 7; i < numRecords; i += 97) {
+		rc = rbfm->deleteRecord(fileHandle, recordDescriptor, rids[i]);
+		assert(rc == success);
+	}
+
+	free(record);
+
+	return rbfm->closeFile(fileHandle);
+}
+
+// Serial scan of the file, results are sorted
+int serialScan(RecordBasedFileManager *rbfm, const string &fileName, const vector<Attribute> &recordDescriptor,
+		const string &conditionAttribute, const CompOp compOp, const void *value, const vector<string> &attributes, vector<string> &results) {
+	FileHandle fileHandle;
+	RC rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success);
+
+	RBFM_ScanIterator scanIterator;
+	rc = rbfm->scan(fileHandle, recordDescriptor, conditionAttribute, compOp, value, attributes, scanIterator);
+	assert(rc == success);
+
+	results.clear();
+	RecordBatch batch;
+	while ((rc = scanIterator.getNextBatch(batch)) != RBFM_EOF) {
+		assert(rc == success);
+		appendBatch(batch, results);
+	}
+	sort(results.begin(), results.end());
+
+	// Scan iterator closes its copy of the handle
+	return scanIterator.close();
+}
+
+// Parallel scan of the file with batches taken from any worker, results are sorted
+int parallelScan(const string &fileName, const vector<Attribute> &recordDescriptor, const string &conditionAttribute, const CompOp compOp,
+		const void *value, const vector<string> &attributes, const unsigned numWorkers, const unsigned morselPages,
+		const unsigned batchCapacity, vector<string> &results) {
+	ParallelScan scan;
+	RC rc = scan.open(fileName, recordDescriptor, conditionAttribute, compOp, value, attributes, numWorkers, morselPages);
+	if (rc != success) {
+		cout << "Parallel scan cannot be opened (" << rc << ")" << endl;
+		return -1;
+	}
+
+	results.clear();
+	RecordBatch batch(batchCapacity);
+	while ((rc = scan.getNextBatch(batch)) != RBFM_EOF) {
+		if (rc != success) {
+			cout << "Parallel scan failed (" << rc << ")" << endl;
+			return -1;
+		}
+		appendBatch(batch, results);
+	}
+	sort(results.begin(), results.end());
+
+	return scan.close();
+}
+
+// Consumer that aggregates records of a single worker (ids are projected)
+struct Consumer {
+	ParallelScan *_scan;
+	unsigned _worker;
+	long long _sum;
+	unsigned _count;
+	RC _rc;
+};
+
+void *consumeWorker(void *arg) {
+	Consumer *consumer = (Consumer *) arg;
+	RecordBatch batch;
+	RC rc;
+	while ((rc = consumer->_scan->getNextBatch(consumer->_worker, batch)) == success) {
+		for (unsigned i = 0; i < batch.getNumRecords(); i++) {
+			consumer->_sum += *(const int *) batch.getRecord(i);
+			consumer->_count++;
+		}
+	}
+	consumer->_rc = rc;
+	return NULL;
+}
+
+int compareScans(RecordBasedFileManager *rbfm, const string &fileName, const vector<Attribute> &recordDescriptor,
+		const string &conditionAttribute, const CompOp compOp, const void *value, const vector<string> &attributes,
+		const unsigned numWorkers, const unsigned morselPages, const unsigned batchCapacity) {
+	vector<string> serial, parallel;
+	if (serialScan(rbfm, fileName, recordDescriptor, conditionAttribute, compOp, value, attributes, serial) != success)
+		return -1;
+	if (parallelScan(fileName, recordDescriptor, conditionAttribute, compOp, value, attributes, numWorkers, morselPages, batchCapacity, parallel) != success)
+		return -1;
+
+	if (serial.empty() || serial != parallel) {
+		cout << "Parallel scan of " << fileName << " with " << numWorkers << " workers returned " << parallel.size()
+				<< " records, serial one " << serial.size() << endl;
+		return -1;
+	}
+	return 0;
+}
+
+int RBFTest_36(RecordBasedFileManager *rbfm) {
+	// Functions Tested:
+	// 1. Parallel scan returns the same records (and rids) as the serial one, for row and PAX files with moved and deleted records
+	// 2. Morsels of various sizes (file has several header pages), different number of workers, small batch of the consumer
+	// 3. One consumer thread per worker (aggregation over the output queue of each worker)
+	// 4. Closing the scan before all records are taken, wrong arguments
+	cout << "****In RBF Test Case 36****" << endl;
+
+	RC rc;
+	string rowFile = "test36row";
+	string paxFile = "test36pax";
+
+	vector<Attribute> recordDescriptor;
+	createRecordDescriptor(recordDescriptor);
+
+	rc = createFile(rbfm, rowFile, LAYOUT_ROW, recordDescriptor);
+	assert(rc == success);
+	rc = createFile(rbfm, paxFile, LAYOUT_PAX, recordDescriptor);
+	assert(rc == success);
+
+	vector<string> attributes;
+	attributes.push_back("score");
+	attributes.push_back("id");
+	attributes.push_back("city");
+
+	char value[PAGE_SIZE];
+	int length = strlen("Tustin");
+	memcpy(value, &length, sizeof(int));
+	memcpy(value + sizeof(int), "Tustin", length);
+
+	int threshold = numRecords / 3;
+
+	// Whole file, condition on VarChar and on int
+	if (compareScans(rbfm, rowFile, recordDescriptor, "", NO_OP, NULL, attributes, 4, PSCAN_DEFAULT_MORSEL_PAGES, RECORD_BATCH_DEFAULT_CAPACITY) != success)
+		return -1;
+	if (compareScans(rbfm, rowFile, recordDescriptor, "city", EQ_OP, value, attributes, 3, 5, RECORD_BATCH_DEFAULT_CAPACITY) != success)
+		return -1;
+	if (compareScans(rbfm, paxFile, recordDescriptor, "", NO_OP, NULL, attributes, 4, 3, RECORD_BATCH_DEFAULT_CAPACITY) != success)
+		return -1;
+	if (compareScans(rbfm, paxFile, recordDescriptor, "id", GE_OP, &threshold, attributes, 2, PSCAN_DEFAULT_MORSEL_PAGES, RECORD_BATCH_DEFAULT_CAPACITY) != success)
+		return -1;
+
+	// Single worker and single page morsels, consumer batch that is smaller than the ones of the workers
+	if (compareScans(rbfm, rowFile, recordDescriptor, "", NO_OP, NULL, attributes, 1, 1, PAGE_SIZE) != success)
+		return -1;
+	if (compareScans(rbfm, paxFile, recordDescriptor, "", NO_OP, NULL, attributes, 8, 1, PAGE_SIZE) != success)
+		return -1;
+
+	// One consumer per worker: sum of ids has to match the serial scan
+	vector<string> idOnly;
+	idOnly.push_back("id");
+
+	vector<string> serial;
+	rc = serialScan(rbfm, rowFile, recordDescriptor, "", NO_OP, NULL, idOnly, serial);
+	assert(rc == success);
+	long long expectedSum = 0;
+	for (unsigned i = 0; i < serial.size(); i++)
+		expectedSum += *(const int *) (serial[i].data() + sizeof(RID));
+
+	const unsigned numWorkers = 4;
+	ParallelScan scan;
+	rc = scan.open(rowFile, recordDescriptor, "", NO_OP, NULL, idOnly, numWorkers, 2);
+	assert(rc == success);
+	assert(scan.getNumWorkers() == numWorkers);
+	assert(scan.getNumMorsels() > numWorkers);
+
+	Consumer consumers[numWorkers];
+	pthread_t threads[numWorkers];
+	for (unsigned i = 0; i < numWorkers; i++) {
+		consumers[i]._scan = &scan;
+		consumers[i]._worker = i;
+		consumers[i]._sum = 0;
+		consumers[i]._count = 0;
+		consumers[i]._rc = success;
+		rc = pthread_create(&threads[i], NULL, consumeWorker, &consumers[i]);
+		assert(rc == 0);
+	}
+
+	long long sum = 0;
+	unsigned count = 0;
+	for (unsigned i = 0; i < numWorkers; i++) {
+		pthread_join(threads[i], NULL);
+		if (consumers[i]._rc != RBFM_EOF) {
+			cout << "Consumer of worker " << i << " failed (" << consumers[i]._rc << ")" << endl;
+			return -1;
+		}
+		sum += consumers[i]._sum;
+		count += consumers[i]._count;
+	}
+
+	rc = scan.close();
+	assert(rc == success);
+
+	if (sum != expectedSum || count != serial.size()) {
+		cout << "Aggregation over the workers is wrong: " << count << " records, sum " << sum << endl;
+		return -1;
+	}
+
+	// Scan that is closed before all of its records are taken (workers wait for room in their queues)
+	rc = scan.open(paxFile, recordDescriptor, "", NO_OP, NULL, attributes, 3, 1);
+	assert(rc == success);
+	RecordBatch batch;
+	rc = scan.getNextBatch(batch);
+	assert(rc == success && batch.getNumRecords() > 0);
+	rc = scan.close();
+	assert(rc == success);
+	rc = scan.getNextBatch(batch);
+	assert(rc != success && batch.getNumRecords() == 0);
+
+	// Wrong arguments
+	rc = scan.open(rowFile, recordDescriptor, "", NO_OP, NULL, attributes, 0);
+	assert(rc != success);
+	rc = scan.open(rowFile, recordDescriptor, "", NO_OP, NULL, attributes, PSCAN_MAX_WORKERS + 1);
+	assert(rc != success);
+	rc = scan.open("test36missing", recordDescriptor, "", NO_OP, NULL, attributes, 2);
+	assert(rc != success);
+	rc = scan.open(rowFile, recordDescriptor, "", NO_OP, NULL, attributes, 2);
+	assert(rc == success);
+	rc = scan.open(rowFile, recordDescriptor, "", NO_OP, NULL, attributes, 2);
+	assert(rc != success);
+	rc = scan.getNextBatch(numWorkers, batch);
+	assert(rc != success);
+
+	// Scan that is not closed explicitly is closed by the destructor
+
+	rc = rbfm->destroyFile(paxFile);
+	assert(rc == success);
+
+	return 0;
+}
+
+int main() {
+	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+	remove("test36row");
+	remove("test36pax");
+
+	int rc = RBFTest_36(rbfm);
+	if (rc == 0) {
+		cout << "Test Case 36 Passed!" << endl << endl;
+	} else {
+		cout << "Test Case 36 Failed!" << endl << endl;
+	}
+
+	remove("test36row");
+
+	return 0;
+}
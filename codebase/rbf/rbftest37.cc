@@ -0,0 +1,464 @@
+#include <iostream>
+#include <string>
+#include <set>
+#include <vector>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "pfm.h"
+#include "rbfm.h"
+
+using namespace std;
+
+const int success = 0;
+const unsigned numRecords = 60;
+const unsigned largeLength = 20000;
+const unsigned maxRecordSize = 2 * largeLength + 100;
+
+void createRecordDescriptor(vector<Attribute> &recordDescriptor) {
+
+	Attribute attr;
+	attr.name = "id";
+	attr.type = TypeInt;
+	attr.length = (AttrLength) 4;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "doc";
+	attr.type = TypeVarChar;
+	attr.length = (AttrLength) 2 * largeLength;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "tag";
+	attr.type = TypeVarChar;
+	attr.length = (AttrLength) 50;
+	recordDescriptor.push_back(attr);
+}
+
+// Every 3rd record has a doc that is much larger than a page, every 3rd one (shifted) has a doc of 3000 chars (above half of the page),
+// the rest have short docs
+unsigned docLength(const unsigned id) {
+	switch (id % 3) {
+	case 0:
+		return largeLength + id;
+	case 1:
+		return 3000;
+	default:
+		return 20 + id;
+	}
+}
+
+int prepareRecord(const int id, const int length, void *buffer) {
+	int offset = 0;
+	char tag[20];
+	int tagLength = sprintf(tag, "tag%d", id % 5);
+
+	memcpy((char *) buffer + offset, &id, sizeof(int));
+	offset += sizeof(int);
+	memcpy((char *) buffer + offset, &length, sizeof(int));
+	offset += sizeof(int);
+	for (int i = 0; i < length; i++)
+		((char *) buffer)[offset + i] = 'a' + (id + i / 1000) % 26;
+	offset += length;
+	memcpy((char *) buffer + offset, &tagLength, sizeof(int));
+	offset += sizeof(int);
+	memcpy((char *) buffer + offset, tag, tagLength);
+	offset += tagLength;
+
+	return offset;
+}
+
+// Number of overflow pages taken by the doc of the given length
+unsigned numOverflowPages(const unsigned length) {
+	if (length <= PAGE_SIZE / 2)
+		return 0;
+	return (length + OVERFLOW_CHUNK_SIZE(PAGE_SIZE) - 1) / OVERFLOW_CHUNK_SIZE(PAGE_SIZE);
+}
+
+// Records are read back as a whole and attribute by attribute
+int checkRecords(RecordBasedFileManager *rbfm, FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const vector<RID> &rids,
+		const vector<string> &expected) {
+	char *buffer = (char *) malloc(maxRecordSize);
+	for (unsigned i = 0; i < numRecords; i++) {
+		RC rc = rbfm->readRecord(fileHandle, recordDescriptor, rids[i], buffer);
+		if (expected[i].empty()) {
+			assert(rc != success);
+			continue;
+		}
+		if (rc != success || memcmp(buffer, expected[i].data(), expected[i].size()) != 0) {
+			cout << "Record " << i << " is wrong (" << rc << ")" << endl;
+			free(buffer);
+			return -1;
+		}
+
+		rc = rbfm->readAttribute(fileHandle, recordDescriptor, rids[i], "doc", buffer);
+		if (rc != success || memcmp(buffer, expected[i].data() + sizeof(int), sizeof(int) + *(int *) buffer) != 0) {
+			cout << "Doc of record " << i << " is wrong (" << rc << ")" << endl;
+			free(buffer);
+			return -1;
+		}
+
+		rc = rbfm->readAttribute(fileHandle, recordDescriptor, rids[i], "tag", buffer);
+		unsigned tagOffset = 2 * sizeof(int) + *(const int *) (expected[i].data() + sizeof(int));
+		assert(rc == success && memcmp(buffer, expected[i].data() + tagOffset, expected[i].size() - tagOffset) == 0);
+	}
+	free(buffer);
+	return 0;
+}
+
+// Scan that does not project the doc reads no overflow pages; scan that projects it (with condition on it) returns the whole doc
+int scanFile(RecordBasedFileManager *rbfm, const string &fileName, const vector<Attribute> &recordDescriptor, const vector<string> &expected,
+		const unsigned numOverflow) {
+	FileHandle scanHandle;
+	RC rc = rbfm->openFile(fileName, scanHandle);
+	assert(rc == success);
+
+	vector<string> attributes;
+	attributes.push_back("tag");
+	attributes.push_back("id");
+
+	RBFM_ScanIterator scanIterator;
+	rc = rbfm->scan(scanHandle, recordDescriptor, "", NO_OP, NULL, attributes, scanIterator);
+	assert(rc == success);
+
+	unsigned readCount = 0, writeCount = 0, appendCount = 0;
+	scanIterator._fileHandle.collectCounterValues(readCount, writeCount, appendCount);
+	unsigned firstReadCount = readCount;
+
+	// (each data page is read once by the batch; row file returns moved records twice)
+	set<int> ids;
+	RecordBatch batch;
+	while ((rc = scanIterator.getNextBatch(batch)) != RBFM_EOF) {
+		assert(rc == success);
+		for (unsigned i = 0; i < batch.getNumRecords(); i++) {
+			const char *data = (const char *) batch.getRecord(i);
+			int id = *(const int *) (data + sizeof(int) + *(const int *) data);
+			assert(id >= 0 && id < (int) numRecords && expected[id].empty() == false);
+			ids.insert(id);
+		}
+	}
+
+	readCount = 0;
+	scanIterator._fileHandle.collectCounterValues(readCount, writeCount, appendCount);
+	if (readCount - firstReadCount > scanHandle.getNumberOfPages() - numOverflow) {
+		cout << "Scan without doc read " << readCount - firstReadCount << " pages of " << scanHandle.getNumberOfPages() << " (" << numOverflow
+			<< " overflow pages)" << endl;
+		return -1;
+	}
+	rc = scanIterator.close();
+	assert(rc == success);
+
+	// Condition on the doc of record 3 (docs of other lengths are not read), records larger than a page come back whole
+	FileHandle docHandle;
+	rc = rbfm->openFile(fileName, docHandle);
+	assert(rc == success);
+
+	string doc = expected[3].substr(sizeof(int), sizeof(int) + docLength(3));
+	attributes.clear();
+	attributes.push_back("doc");
+	attributes.push_back("id");
+	rc = rbfm->scan(docHandle, recordDescriptor, "doc", EQ_OP, doc.data(), attributes, scanIterator);
+	assert(rc == success);
+
+	unsigned numMatching = 0;
+	while ((rc = scanIterator.getNextBatch(batch)) != RBFM_EOF) {
+		assert(rc == success);
+		for (unsigned i = 0; i < batch.getNumRecords(); i++) {
+			const char *record = (const char *) batch.getRecord(i);
+			if (batch.getRecordSize(i) != doc.size() + sizeof(int) || memcmp(record, doc.data(), doc.size()) != 0 ||
+				*(const int *) (record + doc.size()) != 3) {
+				cout << "Scan on doc returned wrong record" << endl;
+				return -1;
+			}
+			numMatching++;
+		}
+	}
+	rc = scanIterator.close();
+	assert(rc == success);
+
+	// Same scan record by record
+	FileHandle recordHandle;
+	rc = rbfm->openFile(fileName, recordHandle);
+	assert(rc == success);
+	rc = rbfm->scan(recordHandle, recordDescriptor, "doc", EQ_OP, doc.data(), attributes, scanIterator);
+	assert(rc == success);
+	RID rid;
+	char *data = (char *) malloc(maxRecordSize);
+	while (scanIterator.getNextRecord(rid, data) != RBFM_EOF) {
+		assert(memcmp(data, doc.data(), doc.size()) == 0 && *(const int *) (data + doc.size()) == 3);
+		numMatching++;
+	}
+	rc = scanIterator.close();
+	assert(rc == success);
+
+	// Batch that cannot hold the doc
+	FileHandle smallHandle;
+	rc = rbfm->openFile(fileName, smallHandle);
+	assert(rc == success);
+	rc = rbfm->scan(smallHandle, recordDescriptor, "", NO_OP, NULL, attributes, scanIterator);
+	assert(rc == success);
+	RecordBatch smallBatch(PAGE_SIZE);
+	while ((rc = scanIterator.getNextBatch(smallBatch)) == success)
+		;
+	assert(rc == -28);
+	rc = scanIterator.close();
+	assert(rc == success);
+
+	free(data);
+
+	unsigned numExpected = 0;
+	for (unsigned i = 0; i < numRecords; i++)
+		numExpected += expected[i].empty() ? 0 : 1;
+
+	if (ids.size() != numExpected || numMatching != 2) {
+		cout << "Scans returned " << ids.size() << " of " << numExpected << " records, and " << numMatching << " matching docs" << endl;
+		return -1;
+	}
+
+	return 0;
+}
+
+int testFile(RecordBasedFileManager *rbfm, const string &fileName, const PageLayout layout) {
+	PagedFileManager *pfm = PagedFileManager::instance();
+
+	RC rc = rbfm->createFile(fileName, PAGE_SIZE, layout);
+	assert(rc == success);
+
+	FileHandle fileHandle;
+	rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success);
+
+	vector<Attribute> recordDescriptor;
+	createRecordDescriptor(recordDescriptor);
+
+	// First half is inserted one by one, second half in a batch
+	vector<string> expected;
+	vector<RID> rids;
+	vector<const void*> records;
+	unsigned numOverflow = 0;
+	for (unsigned i = 0; i < numRecords; i++) {
+		char *record = (char *) malloc(maxRecordSize);
+		int size = prepareRecord(i, docLength(i), record);
+		expected.push_back(string(record, size));
+		numOverflow += numOverflowPages(docLength(i));
+
+		if (i < numRecords / 2) {
+			RID rid;
+			rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+			assert(rc == success);
+			rids.push_back(rid);
+			free(record);
+		} else {
+			records.push_back(record);
+		}
+	}
+
+	vector<RID> batchRids;
+	rc = rbfm->insertRecords(fileHandle, recordDescriptor, records, batchRids);
+	assert(rc == success && batchRids.size() == records.size());
+	rids.insert(rids.end(), batchRids.begin(), batchRids.end());
+	for (unsigned i = 0; i < records.size(); i++)
+		free((void *) records[i]);
+
+	if (checkRecords(rbfm, fileHandle, recordDescriptor, rids, expected) != success ||
+		scanFile(rbfm, fileName, recordDescriptor, expected, numOverflow) != success)
+		return -1;
+
+	// Short doc grows into overflow pages, large one shrinks and gives its pages back, 3000 chars doc is replaced with a larger one
+	unsigned numFreePages = 0;
+	rc = pfm->getNumFreePages(fileHandle, numFreePages);
+	assert(rc == success && numFreePages == 0);
+
+	char *record = (char *) malloc(maxRecordSize);
+	int size = prepareRecord(2, 30000, record);
+	rc = rbfm->updateRecord(fileHandle, recordDescriptor, record, rids[2]);
+	assert(rc == success);
+	expected[2] = string(record, size);
+
+	size = prepareRecord(6, 10, record);
+	rc = rbfm->updateRecord(fileHandle, recordDescriptor, record, rids[6]);
+	assert(rc == success);
+	expected[6] = string(record, size);
+
+	size = prepareRecord(4, 9000, record);
+	rc = rbfm->updateRecord(fileHandle, recordDescriptor, record, rids[4]);
+	assert(rc == success);
+	expected[4] = string(record, size);
+
+	// (pages freed by record 6 are re-used by the new doc of record 4)
+	rc = pfm->getNumFreePages(fileHandle, numFreePages);
+	assert(rc == success);
+	unsigned numExpectedFree = numOverflowPages(docLength(6)) - numOverflowPages(9000) + numOverflowPages(docLength(4));
+	if (numFreePages != numExpectedFree) {
+		cout << "Update left " << numFreePages << " free pages, expected " << numExpectedFree << endl;
+		return -1;
+	}
+
+	// Deleted record gives its overflow pages back
+	rc = rbfm->deleteRecord(fileHandle, recordDescriptor, rids[9]);
+	assert(rc == success);
+	expected[9].clear();
+	numExpectedFree += numOverflowPages(docLength(9));
+
+	rc = pfm->getNumFreePages(fileHandle, numFreePages);
+	assert(rc == success);
+	if (numFreePages != numExpectedFree) {
+		cout << "Delete left " << numFreePages << " free pages, expected " << numExpectedFree << endl;
+		return -1;
+	}
+
+	numOverflow = 0;
+	for (unsigned i = 0; i < numRecords; i++)
+		if (expected[i].empty() == false)
+			numOverflow += numOverflowPages(*(const int *) (expected[i].data() + sizeof(int)));
+
+	if (checkRecords(rbfm, fileHandle, recordDescriptor, rids, expected) != success ||
+		scanFile(rbfm, fileName, recordDescriptor, expected, numOverflow) != success)
+		return -1;
+
+	// Memory-mapped handle reads overflow pages as well
+	rc = rbfm->closeFile(fileHandle);
+	assert(rc == success);
+	rc = rbfm->openFile(fileName, fileHandle, IO_MMAP);
+	assert(rc == success);
+	if (checkRecords(rbfm, fileHandle, recordDescriptor, rids, expected) != success)
+		return -1;
+
+	free(record);
+
+	rc = rbfm->closeFile(fileHandle);
+	assert(rc == success);
+	rc = rbfm->destroyFile(fileName);
+	assert(rc == success);
+
+	return 0;
+}
+
+// Reorganization moves records with values in overflow pages (scan returns them in full)
+int testReorganize(RecordBasedFileManager *rbfm, const string &fileName, const PageLayout layout) {
+	vector<Attribute> recordDescriptor;
+	createRecordDescriptor(recordDescriptor);
+
+	RC rc = rbfm->createFile(fileName, PAGE_SIZE, layout);
+	assert(rc == success);
+	FileHandle fileHandle;
+	rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success);
+
+	char *record = (char *) malloc(maxRecordSize);
+	char *returned = (char *) malloc(maxRecordSize);
+	vector<RID> rids(numRecords);
+	for (unsigned i = 0; i < numRecords; i++) {
+		prepareRecord(i, docLength(i), record);
+		rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rids[i]);
+		assert(rc == success);
+	}
+
+	// every 4th record is deleted, so that reorganization has something to compact
+	unsigned numLeft = 0;
+	for (unsigned i = 0; i < numRecords; i++) {
+		if (i % 4 == 1) {
+			rc = rbfm->deleteRecord(fileHandle, recordDescriptor, rids[i]);
+			assert(rc == success);
+		} else {
+			numLeft++;
+		}
+	}
+
+	int errCode = success;
+	if ((rc = rbfm->reorganizeFile(fileHandle, recordDescriptor)) != success) {
+		cout << "Reorganization of " << fileName << " failed: " << rc << endl;
+		errCode = -1;
+	}
+
+	// records (with their overflow values) are where reorganization put them (iterator closes the handle of the scan)
+	vector<string> attributeNames;
+	for (unsigned i = 0; i < recordDescriptor.size(); i++)
+		attributeNames.push_back(recordDescriptor[i].name);
+	FileHandle scanHandle;
+	rc = rbfm->openFile(fileName, scanHandle);
+	assert(rc == success);
+	RBFM_ScanIterator iterator;
+	rc = rbfm->scan(scanHandle, recordDescriptor, "", NO_OP, NULL, attributeNames, iterator);
+	assert(rc == success);
+
+	vector<bool> isReturned(numRecords, false);
+	unsigned numReturned = 0;
+	RID rid;
+	while (errCode == success && iterator.getNextRecord(rid, returned) != RBFM_EOF) {
+		numReturned++;
+		unsigned i = *((int *) returned);
+		if (i >= numRecords || i % 4 == 1 || isReturned[i]) {
+			cout << "Unexpected record " << i << " in " << fileName << endl;
+			errCode = -1;
+			break;
+		}
+		isReturned[i] = true;
+
+		int size = prepareRecord(i, docLength(i), record);
+		if (memcmp(record, returned, size) != 0) {
+			cout << "Record " << i << " of " << fileName << " is wrong" << endl;
+			errCode = -1;
+		}
+
+		memset(returned, 0, maxRecordSize);
+		if (rbfm->readRecord(fileHandle, recordDescriptor, rid, returned) != success || memcmp(record, returned, size) != 0) {
+			cout << "Record " << i << " of " << fileName << " is not read at its new rid" << endl;
+			errCode = -1;
+		}
+	}
+	iterator.close();
+
+	if (errCode == success && numReturned != numLeft) {
+		cout << "Scan of " << fileName << " returned " << numReturned << " records" << endl;
+		errCode = -1;
+	}
+
+	free(record);
+	free(returned);
+
+	rc = rbfm->closeFile(fileHandle);
+	assert(rc == success);
+	rc = rbfm->destroyFile(fileName);
+	assert(rc == success);
+
+	return errCode;
+}
+
+int RBFTest_37(RecordBasedFileManager *rbfm) {
+	// Functions Tested:
+	// 1. Insert (single and batch) of records with VarChar values larger than a page, in row and PAX files
+	// 2. Read record and read attribute of values kept in overflow pages (also thru memory-mapped handle)
+	// 3. Scan that does not project the large attribute does not read overflow pages, condition and batch on the large attribute
+	// 4. Update and delete give overflow pages back to the allocation map
+	// 5. Reorganization of the file with values in overflow pages
+	cout << "****In RBF Test Case 37****" << endl;
+
+	if (testFile(rbfm, "test37row", LAYOUT_ROW) != success || testFile(rbfm, "test37pax", LAYOUT_PAX) != success)
+		return -1;
+
+	if (testReorganize(rbfm, "test37reorgrow", LAYOUT_ROW) != success || testReorganize(rbfm, "test37reorgpax", LAYOUT_PAX) != success)
+		return -1;
+
+	return 0;
+}
+
+int main() {
+	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+	remove("test37row");
+	remove("test37pax");
+	remove("test37reorgrow");
+	remove("test37reorgpax");
+	remove("tempFile");
+
+	int rc = RBFTest_37(rbfm);
+	if (rc == 0) {
+		cout << "Test Case 37 Passed!" << endl << endl;
+	} else {
+		cout << "Test Case 37 Failed!" << endl << endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,511 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "pfm.h"
+#include "rbfm.h"
+
+using namespace std;
+
+const int success = 0;
+const unsigned numRecords = 100;
+const unsigned shortLength = 100;
+const unsigned maxRecordSize = 4000;
+
+void createRecordDescriptor(vector<Attribute> &recordDescriptor) {
+
+	Attribute attr;
+	attr.name = "id";
+	attr.type = TypeInt;
+	attr.length = (AttrLength) 4;
+	recordDescriptor.push_back(attr);
+
+	attr.name = "comment";
+	attr.type = TypeVarChar;
+	attr.length = (AttrLength) 2000;
+	recordDescriptor.push_back(attr);
+}
+
+int prepareRecord(const int id, const int length, void *buffer) {
+	int offset = 0;
+
+	memcpy((char *) buffer + offset, &id, sizeof(int));
+	offset += sizeof(int);
+	memcpy((char *) buffer + offset, &length, sizeof(int));
+	offset += sizeof(int);
+	memset((char *) buffer + offset, 'a' + (id + length) % 26, length);
+	offset += length;
+
+	return offset;
+}
+
+// Read the record, and count page reads and reads that went thru a TombStone
+int readRecord(RecordBasedFileManager *rbfm, FileHandle &fileHandle, const vector<Attribute> &recordDescriptor, const RID &rid,
+		const string &expected, unsigned &numPageReads, unsigned &numForwardedReads) {
+	unsigned readCount = 0, writeCount = 0, appendCount = 0, forwardedCount = 0, movedCount = 0, migratedCount = 0;
+	fileHandle.collectCounterValues(readCount, writeCount, appendCount);
+	fileHandle.collectForwardingCounterValues(forwardedCount, movedCount, migratedCount);
+	numPageReads = readCount;
+	numForwardedReads = forwardedCount;
+
+	char *buffer = (char *) malloc(maxRecordSize);
+	RC rc = rbfm->readRecord(fileHandle, recordDescriptor, rid, buffer);
+	bool isCorrect = rc == success && memcmp(buffer, expected.data(), expected.size()) == 0;
+	free(buffer);
+
+	readCount = forwardedCount = 0;
+	fileHandle.collectCounterValues(readCount, writeCount, appendCount);
+	fileHandle.collectForwardingCounterValues(forwardedCount, movedCount, migratedCount);
+	numPageReads = readCount - numPageReads;
+	numForwardedReads = forwardedCount - numForwardedReads;
+
+	if (isCorrect == false) {
+		cout << "Record " << *(const int *) expected.data() << " is wrong (" << rc << ")" << endl;
+		return -1;
+	}
+	return 0;
+}
+
+// Every record is returned by the scan with its latest content
+int scanFile(RecordBasedFileManager *rbfm, const string &fileName, const vector<Attribute> &recordDescriptor, const vector<string> &expected) {
+	FileHandle scanHandle;
+	RC rc = rbfm->openFile(fileName, scanHandle);
+	assert(rc == success);
+
+	vector<string> attributes;
+	attributes.push_back("id");
+	attributes.push_back("comment");
+
+	RBFM_ScanIterator scanIterator;
+	rc = rbfm->scan(scanHandle, recordDescriptor, "", NO_OP, NULL, attributes, scanIterator);
+	assert(rc == success);
+
+	vector<bool> isFound(numRecords, false);
+	RID rid;
+	char *data = (char *) malloc(maxRecordSize);
+	while (scanIterator.getNextRecord(rid, data) != RBFM_EOF) {
+		int id = *(const int *) data;
+		assert(id >= 0 && id < (int) numRecords);
+		if (expected[id].empty() || memcmp(data, expected[id].data(), expected[id].size()) != 0) {
+			cout << "Scan returned wrong record " << id << endl;
+			free(data);
+			return -1;
+		}
+		isFound[id] = true;
+	}
+	free(data);
+
+	rc = scanIterator.close();
+	assert(rc == success);
+
+	for (unsigned i = 0; i < numRecords; i++) {
+		if (isFound[i] == expected[i].empty()) {
+			cout << "Scan did not return record " << i << endl;
+			return -1;
+		}
+	}
+	return 0;
+}
+
+// free space that the header page keeps for the data page
+unsigned getHeaderFreeSpace(FileHandle &fileHandle, const PageNum pageNum) {
+	PageNum headerPage = 0;
+	RC rc = PagedFileManager::instance()->findHeaderPage(fileHandle, pageNum, headerPage);
+	assert(rc == success);
+
+	Header *header = (Header *) malloc(PAGE_SIZE);
+	rc = fileHandle.readPage(headerPage, header);
+	assert(rc == success);
+
+	unsigned numFreeBytes = 0;
+	for (unsigned i = 0; i < header->_numUsedPageIds; i++)
+		if (header->_arrOfPageIds[i]._pageid == pageNum)
+			numFreeBytes = header->_arrOfPageIds[i]._numFreeBytes;
+
+	free(header);
+	return numFreeBytes;
+}
+
+// place the record of the given rid was moved to (iterator closes the handle of the scan)
+RID getMovedRid(RecordBasedFileManager *rbfm, const string &fileName, const vector<Attribute> &recordDescriptor, const RID &homeRid) {
+	FileHandle scanHandle;
+	RC rc = rbfm->openFile(fileName, scanHandle);
+	assert(rc == success);
+
+	vector<string> attributeNames;
+	attributeNames.push_back("id");
+	RBFM_ScanIterator iterator;
+	rc = rbfm->scan(scanHandle, recordDescriptor, "", NO_OP, NULL, attributeNames, iterator);
+	assert(rc == success);
+
+	RID rid, movedRid = {0, 0};
+	int id = 0;
+	while (iterator.getNextRecord(rid, &id) != RBFM_EOF) {
+		if (rid.pageNum == homeRid.pageNum && rid.slotNum == homeRid.slotNum) {
+			movedRid = iterator.getActualRecordId();
+			break;
+		}
+	}
+	iterator.close();
+
+	return movedRid;
+}
+
+int testFile(RecordBasedFileManager *rbfm, const string &fileName, const PageLayout layout) {
+	RC rc = rbfm->createFile(fileName, PAGE_SIZE, layout);
+	assert(rc == success);
+
+	FileHandle fileHandle;
+	rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success);
+
+	vector<Attribute> recordDescriptor;
+	createRecordDescriptor(recordDescriptor);
+
+	vector<string> expected;
+	vector<RID> rids;
+	char *record = (char *) malloc(maxRecordSize);
+	for (unsigned i = 0; i < numRecords; i++) {
+		int size = prepareRecord(i, shortLength, record);
+		expected.push_back(string(record, size));
+
+		RID rid;
+		rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+		assert(rc == success);
+		rids.push_back(rid);
+	}
+
+	// Records that share the page of record 5
+	vector<unsigned> neighbours;
+	for (unsigned i = 0; i < numRecords; i++)
+		if (i != 5 && rids[i].pageNum == rids[5].pageNum)
+			neighbours.push_back(i);
+
+	// Record grows beyond the free space of its full page, so it is moved
+	int size = prepareRecord(5, 1500, record);
+	rc = rbfm->updateRecord(fileHandle, recordDescriptor, record, rids[5]);
+	assert(rc == success);
+	expected[5] = string(record, size);
+
+	unsigned numPageReads = 0, numForwardedReads = 0;
+	if (readRecord(rbfm, fileHandle, recordDescriptor, rids[5], expected[5], numPageReads, numForwardedReads) != success)
+		return -1;
+	if (numPageReads != 2 || numForwardedReads != 1) {
+		cout << "Moved record took " << numPageReads << " page reads, " << numForwardedReads << " thru TombStone" << endl;
+		return -1;
+	}
+
+	// Record that does not fit into its new place either is moved again, and its home slot points straight at the new place
+	size = prepareRecord(5, 2000, record);
+	rc = rbfm->updateRecord(fileHandle, recordDescriptor, record, rids[5]);
+	assert(rc == success);
+	expected[5] = string(record, size);
+
+	if (readRecord(rbfm, fileHandle, recordDescriptor, rids[5], expected[5], numPageReads, numForwardedReads) != success)
+		return -1;
+	if (numPageReads != 2 || numForwardedReads != 1) {
+		cout << "Record moved twice took " << numPageReads << " page reads, " << numForwardedReads << " thru TombStone" << endl;
+		return -1;
+	}
+
+	// (row-wise page updates the moved record only in place, PAX page of the moved record is re-packed and still has room for it)
+	unsigned numMoves = layout == LAYOUT_ROW ? 2 : 1;
+	unsigned forwardedCount = 0, movedCount = 0, migratedCount = 0;
+	rc = fileHandle.collectForwardingCounterValues(forwardedCount, movedCount, migratedCount);
+	assert(rc == success);
+	if (movedCount != numMoves || migratedCount != 0) {
+		cout << "Updates moved " << movedCount << " records, " << migratedCount << " came back" << endl;
+		return -1;
+	}
+
+	// Nothing can be brought back while the home page is full
+	unsigned numMigrated = 0;
+	rc = rbfm->migrateForwardedRecords(fileHandle, recordDescriptor, 0, numMigrated);
+	assert(rc == success && numMigrated == 0);
+
+	// Deleted neighbours free up the home page, and the pass (a couple of pages at a time) brings the record back
+	for (unsigned i = 0; i + 1 < neighbours.size(); i++) {
+		rc = rbfm->deleteRecord(fileHandle, recordDescriptor, rids[neighbours[i]]);
+		assert(rc == success);
+		expected[neighbours[i]].clear();
+	}
+
+	// (row-wise page the record was moved to reports the space it gets back)
+	RID movedRid = {0, 0};
+	unsigned movedPageFreeSpace = 0;
+	if (layout == LAYOUT_ROW) {
+		movedRid = getMovedRid(rbfm, fileName, recordDescriptor, rids[5]);
+		assert(movedRid.pageNum != 0 && movedRid.pageNum != rids[5].pageNum);
+		movedPageFreeSpace = getHeaderFreeSpace(fileHandle, movedRid.pageNum);
+	}
+
+	unsigned numPasses = 0;
+	do {
+		rc = rbfm->migrateForwardedRecords(fileHandle, recordDescriptor, 2, numMigrated);
+		assert(rc == success);
+		numPasses++;
+	} while (numMigrated == 0 && numPasses < fileHandle.getNumberOfPages());
+
+	if (numMigrated != 1 || readRecord(rbfm, fileHandle, recordDescriptor, rids[5], expected[5], numPageReads, numForwardedReads) != success)
+		return -1;
+	if (numPageReads != 1 || numForwardedReads != 0) {
+		cout << "Migrated record took " << numPageReads << " page reads, " << numForwardedReads << " thru TombStone" << endl;
+		return -1;
+	}
+	if (layout == LAYOUT_ROW && getHeaderFreeSpace(fileHandle, movedRid.pageNum) < movedPageFreeSpace + expected[5].size()) {
+		cout << "Page the record was moved from reports " << getHeaderFreeSpace(fileHandle, movedRid.pageNum) << " free bytes, "
+			<< movedPageFreeSpace << " before" << endl;
+		return -1;
+	}
+
+	// Record that grows into space freed within its page keeps its place
+	unsigned last = neighbours.back();
+	size = prepareRecord(last, 2 * shortLength, record);
+	rc = rbfm->updateRecord(fileHandle, recordDescriptor, record, rids[last]);
+	assert(rc == success);
+	expected[last] = string(record, size);
+
+	forwardedCount = movedCount = migratedCount = 0;
+	rc = fileHandle.collectForwardingCounterValues(forwardedCount, movedCount, migratedCount);
+	assert(rc == success);
+	if (movedCount != numMoves || migratedCount != 1) {
+		cout << "Updates moved " << movedCount << " records, " << migratedCount << " came back" << endl;
+		return -1;
+	}
+
+	for (unsigned i = 0; i < numRecords; i++) {
+		if (expected[i].empty() == false &&
+			readRecord(rbfm, fileHandle, recordDescriptor, rids[i], expected[i], numPageReads, numForwardedReads) != success)
+			return -1;
+	}
+
+	if (scanFile(rbfm, fileName, recordDescriptor, expected) != success)
+		return -1;
+
+	free(record);
+
+	rc = rbfm->closeFile(fileHandle);
+	assert(rc == success);
+	rc = rbfm->destroyFile(fileName);
+	assert(rc == success);
+
+	return 0;
+}
+
+// Every record is returned by the batch scan with its latest content, and deleted ones are not
+int scanBatches(RecordBasedFileManager *rbfm, const string &fileName, const vector<Attribute> &recordDescriptor, const vector<string> &expected) {
+	FileHandle scanHandle;
+	RC rc = rbfm->openFile(fileName, scanHandle);
+	assert(rc == success);
+
+	vector<string> attributes;
+	attributes.push_back("id");
+	attributes.push_back("comment");
+
+	RBFM_ScanIterator scanIterator;
+	rc = rbfm->scan(scanHandle, recordDescriptor, "", NO_OP, NULL, attributes, scanIterator);
+	assert(rc == success);
+
+	vector<bool> isFound(numRecords, false);
+	RecordBatch batch;
+	while ((rc = scanIterator.getNextBatch(batch)) != RBFM_EOF) {
+		assert(rc == success);
+		for (unsigned i = 0; i < batch.getNumRecords(); i++) {
+			int id = *(const int *) batch.getRecord(i);
+			assert(id >= 0 && id < (int) numRecords);
+			if (expected[id].empty() || batch.getRecordSize(i) != expected[id].size() ||
+				memcmp(batch.getRecord(i), expected[id].data(), expected[id].size()) != 0) {
+				cout << "Batch scan returned wrong record " << id << endl;
+				return -1;
+			}
+			isFound[id] = true;
+		}
+	}
+
+	rc = scanIterator.close();
+	assert(rc == success);
+
+	for (unsigned i = 0; i < numRecords; i++) {
+		if (isFound[i] == expected[i].empty()) {
+			cout << "Batch scan did not return record " << i << endl;
+			return -1;
+		}
+	}
+	return 0;
+}
+
+// Deleted record that was moved is gone from its new place as well
+int testDeleteMoved(RecordBasedFileManager *rbfm, const string &fileName, const PageLayout layout) {
+	RC rc = rbfm->createFile(fileName, PAGE_SIZE, layout);
+	assert(rc == success);
+
+	FileHandle fileHandle;
+	rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success);
+
+	vector<Attribute> recordDescriptor;
+	createRecordDescriptor(recordDescriptor);
+
+	vector<string> expected;
+	vector<RID> rids;
+	char *record = (char *) malloc(maxRecordSize);
+	for (unsigned i = 0; i < numRecords; i++) {
+		int size = prepareRecord(i, shortLength, record);
+		expected.push_back(string(record, size));
+
+		RID rid;
+		rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+		assert(rc == success);
+		rids.push_back(rid);
+	}
+
+	// Every fourth record grows out of its full page, and half of the moved ones are deleted
+	for (unsigned i = 0; i < numRecords; i += 4) {
+		int size = prepareRecord(i, 1500, record);
+		rc = rbfm->updateRecord(fileHandle, recordDescriptor, record, rids[i]);
+		assert(rc == success);
+		expected[i] = string(record, size);
+	}
+
+	unsigned forwardedCount = 0, movedCount = 0, migratedCount = 0;
+	rc = fileHandle.collectForwardingCounterValues(forwardedCount, movedCount, migratedCount);
+	assert(rc == success && movedCount > 0);
+
+	for (unsigned i = 0; i < numRecords; i += 8) {
+		rc = rbfm->deleteRecord(fileHandle, recordDescriptor, rids[i]);
+		assert(rc == success);
+		expected[i].clear();
+	}
+
+	free(record);
+
+	rc = rbfm->closeFile(fileHandle);
+	assert(rc == success);
+
+	if (scanFile(rbfm, fileName, recordDescriptor, expected) != success ||
+		scanBatches(rbfm, fileName, recordDescriptor, expected) != success)
+		return -1;
+
+	// File rebuilt from its scan does not bring them back either
+	if (layout == LAYOUT_ROW) {
+		rc = rbfm->openFile(fileName, fileHandle);
+		assert(rc == success);
+		rc = rbfm->reorganizeFile(fileHandle, recordDescriptor);
+		assert(rc == success);
+		rc = rbfm->closeFile(fileHandle);
+		assert(rc == success);
+
+		if (scanFile(rbfm, fileName, recordDescriptor, expected) != success)
+			return -1;
+	}
+
+	rc = rbfm->destroyFile(fileName);
+	assert(rc == success);
+
+	return 0;
+}
+
+// Reorganized page reports its own free space, and inserts that follow find room where header pages say there is some
+int testReorganizePage(RecordBasedFileManager *rbfm, const string &fileName) {
+	RC rc = rbfm->createFile(fileName);
+	assert(rc == success);
+
+	FileHandle fileHandle;
+	rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success);
+
+	vector<Attribute> recordDescriptor;
+	createRecordDescriptor(recordDescriptor);
+
+	vector<RID> rids;
+	char *record = (char *) malloc(maxRecordSize);
+	for (unsigned i = 0; i < numRecords; i++) {
+		prepareRecord(i, shortLength, record);
+
+		RID rid;
+		rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+		assert(rc == success);
+		rids.push_back(rid);
+	}
+
+	// Half of the records of the first (full) data page are deleted, and page is packed
+	PageNum pageNum = rids[0].pageNum;
+	assert(rids.back().pageNum > pageNum + 1);
+	for (unsigned i = 0; i < numRecords && rids[i].pageNum == pageNum; i += 2) {
+		rc = rbfm->deleteRecord(fileHandle, recordDescriptor, rids[i]);
+		assert(rc == success);
+	}
+
+	unsigned freeSpace = getHeaderFreeSpace(fileHandle, pageNum), nextFreeSpace = getHeaderFreeSpace(fileHandle, pageNum + 1);
+	rc = rbfm->reorganizePage(fileHandle, recordDescriptor, pageNum);
+	assert(rc == success);
+
+	if (getHeaderFreeSpace(fileHandle, pageNum) <= freeSpace + shortLength || getHeaderFreeSpace(fileHandle, pageNum + 1) != nextFreeSpace) {
+		cout << "Reorganized page reports " << getHeaderFreeSpace(fileHandle, pageNum) << " free bytes (" << freeSpace << " before), next page "
+			<< getHeaderFreeSpace(fileHandle, pageNum + 1) << " (" << nextFreeSpace << " before)" << endl;
+		return -1;
+	}
+
+	for (unsigned i = 0; i < 3 * numRecords; i++) {
+		prepareRecord(i % numRecords, shortLength, record);
+
+		RID rid;
+		if ((rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid)) != success) {
+			cout << "Insertion " << i << " after reorganization failed (" << rc << ")" << endl;
+			return -1;
+		}
+	}
+
+	free(record);
+
+	rc = rbfm->closeFile(fileHandle);
+	assert(rc == success);
+	rc = rbfm->destroyFile(fileName);
+	assert(rc == success);
+
+	return 0;
+}
+
+int RBFTest_38(RecordBasedFileManager *rbfm) {
+	// Functions Tested:
+	// 1. Update that moves record leaves TombStone that is followed by a single extra page read, and counted
+	// 2. Record moved again is not chained: TombStone is re-pointed at its latest place
+	// 3. Online migration brings the moved record back once its home page has room, in row and PAX files (row-wise page the
+	//    record was moved to reports the space it gets back)
+	// 4. Record that grows into free space of its own page is not moved
+	// 5. Deleted record that was moved is gone from scans, batch scans and reorganized file
+	// 6. Reorganized page updates its own entry of the header page
+	cout << "****In RBF Test Case 38****" << endl;
+
+	if (testFile(rbfm, "test38row", LAYOUT_ROW) != success || testFile(rbfm, "test38pax", LAYOUT_PAX) != success)
+		return -1;
+
+	if (testDeleteMoved(rbfm, "test38row", LAYOUT_ROW) != success || testDeleteMoved(rbfm, "test38pax", LAYOUT_PAX) != success)
+		return -1;
+
+	if (testReorganizePage(rbfm, "test38reorg") != success)
+		return -1;
+
+	return 0;
+}
+
+int main() {
+	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+	remove("test38row");
+	remove("test38pax");
+	remove("test38reorg");
+
+	int rc = RBFTest_38(rbfm);
+	if (rc == 0) {
+		cout << "Test Case 38 Passed!" << endl << endl;
+	} else {
+		cout << "Test Case 38 Failed!" << endl << endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,292 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "pfm.h"
+#include "rbfm.h"
+#include "codec.h"
+
+using namespace std;
+
+const int success = 0;
+const unsigned numRecords = 200;
+const unsigned maxRecordSize = 2000;
+
+void addAttribute(vector<Attribute> &recordDescriptor, const string &name, const AttrType type, const AttrLength length) {
+	Attribute attr;
+	attr.name = name;
+	attr.type = type;
+	attr.length = length;
+	recordDescriptor.push_back(attr);
+}
+
+// numFields int/real attributes
+void createFixedDescriptor(const unsigned numFields, vector<Attribute> &recordDescriptor) {
+	for (unsigned i = 0; i < numFields; i++) {
+		char name[16];
+		sprintf(name, "f%u", i);
+		addAttribute(recordDescriptor, name, i % 2 == 0 ? TypeInt : TypeReal, 4);
+	}
+}
+
+// varchar attributes after a fixed-width prefix, after another varchar, and as the first attribute
+void createMixedDescriptors(vector< vector<Attribute> > &descriptors) {
+	vector<Attribute> recordDescriptor;
+	addAttribute(recordDescriptor, "id", TypeInt, 4);
+	addAttribute(recordDescriptor, "score", TypeReal, 4);
+	addAttribute(recordDescriptor, "name", TypeVarChar, 100);
+	addAttribute(recordDescriptor, "comment", TypeVarChar, 200);
+	addAttribute(recordDescriptor, "age", TypeInt, 4);
+	descriptors.push_back(recordDescriptor);
+
+	recordDescriptor.clear();
+	addAttribute(recordDescriptor, "name", TypeVarChar, 100);
+	addAttribute(recordDescriptor, "age", TypeInt, 4);
+	addAttribute(recordDescriptor, "height", TypeReal, 4);
+	descriptors.push_back(recordDescriptor);
+
+	recordDescriptor.clear();
+	addAttribute(recordDescriptor, "name", TypeVarChar, 100);
+	descriptors.push_back(recordDescriptor);
+}
+
+// values depend on the seed, varchar values are 0 to 99 chars long
+int prepareRecord(const vector<Attribute> &recordDescriptor, const unsigned seed, void *buffer) {
+	int offset = 0;
+	for (unsigned i = 0; i < recordDescriptor.size(); i++) {
+		if (recordDescriptor[i].type == TypeVarChar) {
+			int length = (seed * 7 + i * 13) % 100;
+			memcpy((char *) buffer + offset, &length, sizeof(int));
+			offset += sizeof(int);
+			memset((char *) buffer + offset, 'a' + (seed + i) % 26, length);
+			offset += length;
+		} else {
+			int value = seed * 31 + i;
+			memcpy((char *) buffer + offset, &value, sizeof(int));
+			offset += sizeof(int);
+		}
+	}
+	return offset;
+}
+
+// Codec has to give the same results as sizeOfRecord/encodeRecord/decodeRecord
+int compareWithGeneric(RecordBasedFileManager *rbfm, const vector<Attribute> &recordDescriptor, const bool isFixedWidth) {
+	RecordCodec *codec = RecordCodec::create(recordDescriptor);
+	if (codec->isFixedWidth() != isFixedWidth) {
+		cout << "Codec of " << recordDescriptor.size() << " attributes has wrong shape" << endl;
+		delete codec;
+		return -1;
+	}
+
+	char *record = (char *) malloc(maxRecordSize);
+	char *encGeneric = (char *) calloc(maxRecordSize, 1);
+	char *encCodec = (char *) calloc(maxRecordSize, 1);
+	char *decGeneric = (char *) calloc(maxRecordSize, 1);
+	char *decCodec = (char *) calloc(maxRecordSize, 1);
+
+	int errCode = 0;
+	for (unsigned i = 0; i < numRecords && errCode == 0; i++) {
+		int size = prepareRecord(recordDescriptor, i, record);
+
+		unsigned szGeneric = sizeOfRecord(recordDescriptor, record), szCodec = codec->sizeOfRecord(record);
+		if (szGeneric != szCodec || szCodec != (unsigned) size) {
+			cout << "Size of record " << i << " is " << szCodec << " instead of " << szGeneric << endl;
+			errCode = -1;
+			break;
+		}
+
+		unsigned szEncGeneric = 0, szEncCodec = 0;
+		rbfm->encodeRecord(recordDescriptor, record, szGeneric, szEncGeneric, encGeneric);
+		codec->encodeRecord(record, szEncCodec, encCodec);
+		if (szEncGeneric != szEncCodec || memcmp(encGeneric, encCodec, szEncGeneric) != 0) {
+			cout << "Encoded record " << i << " differs" << endl;
+			errCode = -1;
+			break;
+		}
+
+		unsigned szDecGeneric = 0, szDecCodec = 0;
+		rbfm->decodeRecord(recordDescriptor, encGeneric, szDecGeneric, decGeneric);
+		codec->decodeRecord(encGeneric, szDecCodec, decCodec);
+		if (szDecGeneric != szDecCodec || szDecCodec != (unsigned) size || memcmp(decCodec, record, size) != 0) {
+			cout << "Decoded record " << i << " differs" << endl;
+			errCode = -1;
+		}
+	}
+
+	free(record);
+	free(encGeneric);
+	free(encCodec);
+	free(decGeneric);
+	free(decCodec);
+	delete codec;
+
+	return errCode;
+}
+
+// Record written before attributes were added (i.e. with fewer fields) is decoded as decodeRecord does it
+int compareOlderRecord(RecordBasedFileManager *rbfm, const unsigned numOldFields, const unsigned numFields) {
+	vector<Attribute> oldDescriptor, recordDescriptor;
+	createFixedDescriptor(numOldFields, oldDescriptor);
+	createFixedDescriptor(numFields, recordDescriptor);
+
+	RecordCodec *codec = RecordCodec::create(recordDescriptor);
+
+	char *record = (char *) malloc(maxRecordSize);
+	char *encRecord = (char *) calloc(maxRecordSize, 1);
+	char *decGeneric = (char *) calloc(maxRecordSize, 1);
+	char *decCodec = (char *) calloc(maxRecordSize, 1);
+
+	prepareRecord(oldDescriptor, 17, record);
+	unsigned szEncRecord = 0, szDecGeneric = 0, szDecCodec = 0;
+	rbfm->encodeRecord(oldDescriptor, record, sizeOfRecord(oldDescriptor, record), szEncRecord, encRecord);
+	rbfm->decodeRecord(recordDescriptor, encRecord, szDecGeneric, decGeneric);
+	codec->decodeRecord(encRecord, szDecCodec, decCodec);
+
+	int errCode = 0;
+	if (szDecGeneric != szDecCodec || memcmp(decGeneric, decCodec, szDecGeneric) != 0) {
+		cout << "Record of " << numOldFields << " fields is decoded differently" << endl;
+		errCode = -1;
+	}
+
+	free(record);
+	free(encRecord);
+	free(decGeneric);
+	free(decCodec);
+	delete codec;
+
+	return errCode;
+}
+
+// Records inserted, updated and read thru the codec are the same as those that go thru the generic functions
+int testFile(RecordBasedFileManager *rbfm, const string &fileName, const PageLayout layout, const vector<Attribute> &recordDescriptor) {
+	RC rc = rbfm->createFile(fileName, PAGE_SIZE, layout);
+	assert(rc == success);
+
+	FileHandle fileHandle;
+	rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success);
+
+	RecordCodec *codec = RecordCodec::create(recordDescriptor);
+
+	char *record = (char *) malloc(maxRecordSize);
+	char *returned = (char *) malloc(maxRecordSize);
+
+	// every other record goes thru the codec
+	vector<RID> rids;
+	for (unsigned i = 0; i < numRecords; i++) {
+		prepareRecord(recordDescriptor, i, record);
+		RID rid;
+		rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid, i % 2 == 0 ? codec : NULL);
+		assert(rc == success);
+		rids.push_back(rid);
+	}
+
+	vector<const void*> batch;
+	for (unsigned i = 0; i < 10; i++) {
+		batch.push_back(malloc(maxRecordSize));
+		prepareRecord(recordDescriptor, numRecords + i, (void *) batch.back());
+	}
+	vector<RID> batchRids;
+	rc = rbfm->insertRecords(fileHandle, recordDescriptor, batch, batchRids, codec);
+	assert(rc == success && batchRids.size() == batch.size());
+
+	for (unsigned i = 0; i < numRecords; i += 3) {
+		prepareRecord(recordDescriptor, i + 1000, record);
+		rc = rbfm->updateRecord(fileHandle, recordDescriptor, record, rids[i], codec);
+		assert(rc == success);
+	}
+
+	int errCode = 0;
+	for (unsigned i = 0; i < numRecords + batch.size() && errCode == 0; i++) {
+		unsigned seed = i >= numRecords ? i : (i % 3 == 0 ? i + 1000 : i);
+		int size = prepareRecord(recordDescriptor, seed, record);
+		const RID &rid = i >= numRecords ? batchRids[i - numRecords] : rids[i];
+
+		rc = rbfm->readRecord(fileHandle, recordDescriptor, rid, returned, i % 2 == 1 ? codec : NULL);
+		if (rc != success || memcmp(record, returned, size) != 0) {
+			cout << "Record " << i << " of " << fileName << " is wrong (" << rc << ")" << endl;
+			errCode = -1;
+		}
+	}
+
+	free(record);
+	free(returned);
+	for (unsigned i = 0; i < batch.size(); i++)
+		free((void *) batch[i]);
+	delete codec;
+
+	rc = rbfm->closeFile(fileHandle);
+	assert(rc == success);
+	rc = rbfm->destroyFile(fileName);
+	assert(rc == success);
+
+	return errCode;
+}
+
+int RBFTest_39(RecordBasedFileManager *rbfm) {
+	// Functions Tested:
+	// 1. Codecs of int/real schemas (with sizes known at compile time and at run time) match encodeRecord/decodeRecord
+	// 2. Codecs of schemas with varchar attributes match encodeRecord/decodeRecord
+	// 3. Records with fewer fields than the descriptor are decoded as decodeRecord does it
+	// 4. Descriptor with dropped attribute gets the generic codec
+	// 5. insertRecord, insertRecords, updateRecord and readRecord thru the codec, in row and PAX files
+	cout << "****In RBF Test Case 39****" << endl;
+
+	unsigned numFields[] = { 1, 3, 4, MAX_FIXED_CODEC_FIELDS, MAX_FIXED_CODEC_FIELDS + 3 };
+	for (unsigned i = 0; i < sizeof(numFields) / sizeof(numFields[0]); i++) {
+		vector<Attribute> recordDescriptor;
+		createFixedDescriptor(numFields[i], recordDescriptor);
+		if (compareWithGeneric(rbfm, recordDescriptor, true) != success)
+			return -1;
+	}
+
+	vector< vector<Attribute> > descriptors;
+	createMixedDescriptors(descriptors);
+	for (unsigned i = 0; i < descriptors.size(); i++) {
+		if (compareWithGeneric(rbfm, descriptors[i], false) != success)
+			return -1;
+	}
+
+	if (compareOlderRecord(rbfm, 2, 4) != success || compareOlderRecord(rbfm, 5, MAX_FIXED_CODEC_FIELDS + 3) != success)
+		return -1;
+
+	vector<Attribute> droppedDescriptor = descriptors[0];
+	droppedDescriptor[3].length = 0;
+	RecordCodec *codec = RecordCodec::create(droppedDescriptor);
+	bool isGeneric = dynamic_cast<GenericRecordCodec *>(codec) != NULL;
+	delete codec;
+	if (isGeneric == false) {
+		cout << "Descriptor with dropped attribute does not get the generic codec" << endl;
+		return -1;
+	}
+
+	vector<Attribute> fixedDescriptor;
+	createFixedDescriptor(4, fixedDescriptor);
+	if (testFile(rbfm, "test39fixed", LAYOUT_ROW, fixedDescriptor) != success ||
+		testFile(rbfm, "test39row", LAYOUT_ROW, descriptors[0]) != success ||
+		testFile(rbfm, "test39pax", LAYOUT_PAX, descriptors[0]) != success)
+		return -1;
+
+	return 0;
+}
+
+int main() {
+	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+	remove("test39fixed");
+	remove("test39row");
+	remove("test39pax");
+
+	int rc = RBFTest_39(rbfm);
+	if (rc == 0) {
+		cout << "Test Case 39 Passed!" << endl << endl;
+	} else {
+		cout << "Test Case 39 Failed!" << endl << endl;
+	}
+
+	return 0;
+}
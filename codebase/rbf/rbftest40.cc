@@ -0,0 +1,296 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "pfm.h"
+#include "rbfm.h"
+
+using namespace std;
+
+const int success = 0;
+const unsigned numRecords = 100;
+const unsigned maxRecordSize = 8000;
+
+void addAttribute(vector<Attribute> &recordDescriptor, const string &name, const AttrType type, const AttrLength length) {
+	Attribute attr;
+	attr.name = name;
+	attr.type = type;
+	attr.length = length;
+	recordDescriptor.push_back(attr);
+}
+
+// empno, age, salary (int), height (real)
+void createFixedDescriptor(vector<Attribute> &recordDescriptor) {
+	addAttribute(recordDescriptor, "empno", TypeInt, 4);
+	addAttribute(recordDescriptor, "age", TypeInt, 4);
+	addAttribute(recordDescriptor, "salary", TypeInt, 4);
+	addAttribute(recordDescriptor, "height", TypeReal, 4);
+}
+
+// empno (int), name (varchar), height (real), comment (varchar), age (int)
+void createMixedDescriptor(vector<Attribute> &recordDescriptor) {
+	addAttribute(recordDescriptor, "empno", TypeInt, 4);
+	addAttribute(recordDescriptor, "name", TypeVarChar, 30);
+	addAttribute(recordDescriptor, "height", TypeReal, 4);
+	addAttribute(recordDescriptor, "comment", TypeVarChar, 4000);
+	addAttribute(recordDescriptor, "age", TypeInt, 4);
+}
+
+// values depend on the seed, varchar values are szOfVarChar chars long
+int prepareRecord(const vector<Attribute> &recordDescriptor, const unsigned seed, const int szOfVarChar, void *buffer) {
+	int offset = 0;
+	for (unsigned i = 0; i < recordDescriptor.size(); i++) {
+		if (recordDescriptor[i].type == TypeVarChar) {
+			memcpy((char *) buffer + offset, &szOfVarChar, sizeof(int));
+			offset += sizeof(int);
+			memset((char *) buffer + offset, 'a' + (seed + i) % 26, szOfVarChar);
+			offset += szOfVarChar;
+		} else {
+			int value = seed * 31 + i;
+			memcpy((char *) buffer + offset, &value, sizeof(int));
+			offset += sizeof(int);
+		}
+	}
+	return offset;
+}
+
+// Encoded records have no directory entries for int/real fields, and fields sit at the offsets given by the header
+int testEncodedSize(RecordBasedFileManager *rbfm) {
+	vector<Attribute> fixedDescriptor, mixedDescriptor;
+	createFixedDescriptor(fixedDescriptor);
+	createMixedDescriptor(mixedDescriptor);
+
+	char *record = (char *) malloc(maxRecordSize);
+	char *encRecord = (char *) malloc(maxRecordSize);
+	int errCode = 0;
+
+	int size = prepareRecord(fixedDescriptor, 7, 0, record);
+	unsigned szEncRecord = 0;
+	rbfm->encodeRecord(fixedDescriptor, record, size, szEncRecord, encRecord);
+	if (szEncRecord != RECORD_DIR_OFFSET(fixedDescriptor.size()) + size ||
+		memcmp(encRecord + RECORD_DIR_OFFSET(fixedDescriptor.size()), record, size) != 0) {
+		cout << "Encoded int/real record has " << szEncRecord << " bytes" << endl;
+		errCode = -1;
+	}
+
+	size = prepareRecord(mixedDescriptor, 7, 10, record);
+	rbfm->encodeRecord(mixedDescriptor, record, size, szEncRecord, encRecord);
+	const RecordHeader *header = (const RecordHeader *) encRecord;
+	const unsigned *ptrDir = (const unsigned *) (encRecord + RECORD_DIR_OFFSET(mixedDescriptor.size()));
+	const int *ptrFixed = (const int *) (encRecord + RECORD_FIXED_OFFSET(mixedDescriptor.size(), 2));
+	if (header->_numFields != mixedDescriptor.size() || header->_numVarFields != 2 ||
+		szEncRecord != RECORD_VARCHAR_OFFSET(mixedDescriptor.size()) + 20 || ptrDir[1] != szEncRecord ||
+		ptrFixed[0] != 7 * 31 + 0 || ptrFixed[1] != 7 * 31 + 2 || ptrFixed[2] != 7 * 31 + 4) {
+		cout << "Encoded record with varchar attributes has wrong layout" << endl;
+		errCode = -1;
+	}
+
+	for (unsigned i = 0; i < mixedDescriptor.size(); i++) {
+		if (RECORD_FIELD_IS_NULL(encRecord, i)) {
+			cout << "Field " << i << " is NULL" << endl;
+			errCode = -1;
+		}
+	}
+
+	free(record);
+	free(encRecord);
+
+	return errCode;
+}
+
+// Fields of dropped attributes are NULL in the encoded record, and decoded records skip them
+int testDroppedAttributes(RecordBasedFileManager *rbfm) {
+	vector<Attribute> recordDescriptor;
+	createMixedDescriptor(recordDescriptor);
+
+	char *record = (char *) malloc(maxRecordSize);
+	char *encRecord = (char *) malloc(maxRecordSize);
+	char *decRecord = (char *) malloc(maxRecordSize);
+
+	// record of the descriptor without "comment" still has 4 bytes of "height"
+	vector<Attribute> droppedDescriptor = recordDescriptor;
+	droppedDescriptor[2].length = 0;
+	droppedDescriptor[3].length = 0;
+	vector<Attribute> shortDescriptor;
+	shortDescriptor.push_back(recordDescriptor[0]);
+	shortDescriptor.push_back(recordDescriptor[1]);
+	shortDescriptor.push_back(recordDescriptor[2]);
+	shortDescriptor.push_back(recordDescriptor[4]);
+	int size = prepareRecord(shortDescriptor, 3, 12, record);
+
+	unsigned szEncRecord = 0, szDecRecord = 0;
+	rbfm->encodeRecord(droppedDescriptor, record, size, szEncRecord, encRecord);
+	rbfm->decodeRecord(droppedDescriptor, encRecord, szDecRecord, decRecord);
+
+	int errCode = 0;
+	if (RECORD_FIELD_IS_NULL(encRecord, 0) || RECORD_FIELD_IS_NULL(encRecord, 1) || RECORD_FIELD_IS_NULL(encRecord, 2) == 0 ||
+		RECORD_FIELD_IS_NULL(encRecord, 3) == 0 || RECORD_FIELD_IS_NULL(encRecord, 4)) {
+		cout << "Null bitmap does not match dropped attributes" << endl;
+		errCode = -1;
+	}
+
+	// decoded record is empno, name and age
+	int age = *((int *) (decRecord + szDecRecord - sizeof(int)));
+	if (szDecRecord != sizeof(int) + sizeof(int) + 12 + sizeof(int) || memcmp(decRecord, record, sizeof(int) + sizeof(int) + 12) != 0 ||
+		age != 3 * 31 + 3) {
+		cout << "Record with dropped attributes is decoded wrong" << endl;
+		errCode = -1;
+	}
+
+	free(record);
+	free(encRecord);
+	free(decRecord);
+
+	return errCode;
+}
+
+// Records written before attributes were added read those attributes as 0/"" (readRecord, readAttribute and scan); long varchar
+// values go to overflow pages and the int/real values after them are still at their offsets
+int testFile(RecordBasedFileManager *rbfm, const string &fileName, const PageLayout layout) {
+	RC rc = rbfm->createFile(fileName, PAGE_SIZE, layout);
+	assert(rc == success);
+
+	FileHandle fileHandle;
+	rc = rbfm->openFile(fileName, fileHandle);
+	assert(rc == success);
+
+	vector<Attribute> recordDescriptor, newDescriptor;
+	createMixedDescriptor(recordDescriptor);
+	newDescriptor = recordDescriptor;
+	addAttribute(newDescriptor, "bonus", TypeInt, 4);
+	addAttribute(newDescriptor, "title", TypeVarChar, 30);
+
+	char *record = (char *) malloc(maxRecordSize);
+	char *returned = (char *) malloc(maxRecordSize);
+
+	// every 10th record has varchar values above the overflow threshold
+	vector<RID> rids;
+	for (unsigned i = 0; i < numRecords; i++) {
+		prepareRecord(recordDescriptor, i, i % 10 == 0 ? 3000 : i % 20, record);
+		RID rid;
+		rc = rbfm->insertRecord(fileHandle, recordDescriptor, record, rid);
+		assert(rc == success);
+		rids.push_back(rid);
+	}
+
+	int errCode = 0;
+	for (unsigned i = 0; i < numRecords && errCode == 0; i++) {
+		int size = prepareRecord(recordDescriptor, i, i % 10 == 0 ? 3000 : i % 20, record);
+		memset(returned, 0xff, maxRecordSize);
+		rc = rbfm->readRecord(fileHandle, newDescriptor, rids[i], returned);
+		if (rc != success || memcmp(record, returned, size) != 0 || *((int *) (returned + size)) != 0 ||
+			*((int *) (returned + size + sizeof(int))) != 0) {
+			cout << "Record " << i << " of " << fileName << " is wrong (" << rc << ")" << endl;
+			errCode = -1;
+			break;
+		}
+
+		int value = -1;
+		rc = rbfm->readAttribute(fileHandle, newDescriptor, rids[i], "age", &value);
+		if (rc != success || value != (int) (i * 31 + 4)) {
+			cout << "Attribute age of record " << i << " of " << fileName << " is wrong" << endl;
+			errCode = -1;
+		}
+
+		rc = rbfm->readAttribute(fileHandle, newDescriptor, rids[i], "bonus", &value);
+		if (rc != success || value != 0) {
+			cout << "Added attribute of record " << i << " of " << fileName << " is not 0" << endl;
+			errCode = -1;
+		}
+	}
+
+	// condition on the field that record does not have never matches (iterator closes the handle of the scan)
+	vector<string> attributeNames;
+	attributeNames.push_back("empno");
+	attributeNames.push_back("height");
+	attributeNames.push_back("bonus");
+	attributeNames.push_back("title");
+	attributeNames.push_back("age");
+	int zero = 0;
+	FileHandle scanHandle;
+	rc = rbfm->openFile(fileName, scanHandle);
+	assert(rc == success);
+	RBFM_ScanIterator iterator;
+	rc = rbfm->scan(scanHandle, newDescriptor, "bonus", EQ_OP, &zero, attributeNames, iterator);
+	assert(rc == success);
+
+	RID rid;
+	if (errCode == 0 && iterator.getNextRecord(rid, returned) != RBFM_EOF) {
+		cout << "Scan of " << fileName << " matched missing field" << endl;
+		errCode = -1;
+	}
+	iterator.close();
+
+	// projected fields that record does not have are 0/""
+	FileHandle projectHandle;
+	rc = rbfm->openFile(fileName, projectHandle);
+	assert(rc == success);
+	RBFM_ScanIterator projectIterator;
+	rc = rbfm->scan(projectHandle, newDescriptor, "", NO_OP, NULL, attributeNames, projectIterator);
+	assert(rc == success);
+
+	unsigned numReturned = 0;
+	while (errCode == 0 && projectIterator.getNextRecord(rid, returned) != RBFM_EOF) {
+		numReturned++;
+		const int *fields = (const int *) returned;
+		unsigned i = fields[0] / 31;
+		if (fields[0] != (int) (i * 31) || fields[1] != (int) (i * 31 + 2) || fields[2] != 0 || fields[3] != 0 ||
+			fields[4] != (int) (i * 31 + 4)) {
+			cout << "Scanned record " << i << " of " << fileName << " is wrong" << endl;
+			errCode = -1;
+		}
+	}
+	projectIterator.close();
+
+	if (errCode == 0 && numReturned != numRecords) {
+		cout << "Scan of " << fileName << " returned " << numReturned << " records" << endl;
+		errCode = -1;
+	}
+
+	free(record);
+	free(returned);
+
+	rc = rbfm->closeFile(fileHandle);
+	assert(rc == success);
+	rc = rbfm->destroyFile(fileName);
+	assert(rc == success);
+
+	return errCode;
+}
+
+int RBFTest_40(RecordBasedFileManager *rbfm) {
+	// Functions Tested:
+	// 1. Encoded records: header, null bitmap, directory of varchar offsets only, int/real values at static offsets
+	// 2. Dropped attributes are NULL fields
+	// 3. Attributes added after the record was written read as 0/"" thru readRecord, readAttribute and scan (row and PAX files)
+	// 4. Long varchar values in overflow pages with int/real values after them
+	cout << "****In RBF Test Case 40****" << endl;
+
+	if (testEncodedSize(rbfm) != success || testDroppedAttributes(rbfm) != success)
+		return -1;
+
+	if (testFile(rbfm, "test40row", LAYOUT_ROW) != success || testFile(rbfm, "test40pax", LAYOUT_PAX) != success)
+		return -1;
+
+	return 0;
+}
+
+int main() {
+	RecordBasedFileManager *rbfm = RecordBasedFileManager::instance();
+
+	remove("test40row");
+	remove("test40pax");
+
+	int rc = RBFTest_40(rbfm);
+	if (rc == 0) {
+		cout << "Test Case 40 Passed!" << endl << endl;
+	} else {
+		cout << "Test Case 40 Failed!" << endl << endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,576 @@
+#include "wal.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <map>
+#include <vector>
+
+/*
+ * error codes (continuation of PagedFileManager error codes, see pfm.cc):
+ * -74 = log file I/O failed
+**/
+
+/*
+ * FNV-1a hash, used as checksum of the log records
+**/
+static unsigned int hashBytes(unsigned int hash, const void* data, const unsigned int length)
+{
+	const unsigned char* ptr = (const unsigned char*)data;
+	for( unsigned int i = 0; i < length; i++ )
+	{
+		hash ^= ptr[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static unsigned int checksumOfRecord(const LogRecordHeader& header, const char* name, const void* data)
+{
+	LogRecordHeader h = header;
+	h._checksum = 0;
+
+	unsigned int hash = hashBytes(2166136261u, &h, sizeof(LogRecordHeader));
+	hash = hashBytes(hash, name, header._nameLength);
+	if( header._type == LOG_PAGE )
+		hash = hashBytes(hash, data, header._pageSize);
+
+	return hash;
+}
+
+LogManager::LogManager()
+: _recordCounter(0), _commitCounter(0), _fsyncCounter(0),
+  _fd(-1), _buffer((char*)malloc(LOG_BUFFER_SIZE)), _bufferUsed(0), _fileSize(0),
+  _lastLSN(0), _committedLSN(0), _writtenLSN(0), _durableLSN(0),
+  _groupCommitSize(LOG_DEFAULT_GROUP_COMMIT_SIZE), _pendingCommits(0), _activeOperations(0),
+  _syncing(false)
+{
+	pthread_mutex_init(&_mutex, NULL);
+	pthread_cond_init(&_syncedCond, NULL);
+	pthread_cond_init(&_committedCond, NULL);
+}
+
+LogManager::~LogManager()
+{
+	close();
+	free(_buffer);
+
+	pthread_cond_destroy(&_committedCond);
+	pthread_cond_destroy(&_syncedCond);
+	pthread_mutex_destroy(&_mutex);
+}
+
+RC LogManager::recover(const char* logFileName)
+{
+	FILE* logFile = fopen(logFileName, "rb");
+
+	//no log => nothing to recover
+	if( logFile == NULL )
+		return 0;
+
+	RC errCode = 0;
+
+	/*
+	 * records of the operation that is not committed yet
+	**/
+	struct PendingRecord
+	{
+		unsigned int _type;
+		std::string _name;
+		PageNum _pageNum;
+		std::vector<char> _image;
+	};
+	std::vector<PendingRecord> pending;
+
+	//data files that were modified by recovery
+	std::map<std::string, int> files;
+
+	char name[PAGE_SIZE];
+	void* image = malloc(MAX_PAGE_SIZE);
+
+	LogRecordHeader header;
+	while( fread(&header, sizeof(LogRecordHeader), 1, logFile) == 1 )
+	{
+		//read name and image; stop at the first incomplete or corrupted (i.e. torn) record
+		if( header._nameLength >= PAGE_SIZE || fread(name, 1, header._nameLength, logFile) != header._nameLength )
+			break;
+
+		if( header._type == LOG_PAGE &&
+			(header._pageSize > MAX_PAGE_SIZE || fread(image, 1, header._pageSize, logFile) != header._pageSize) )
+			break;
+
+		if( checksumOfRecord(header, name, image) != header._checksum )
+			break;
+
+		//operation failed, its records are not applied
+		if( header._type == LOG_ABORT )
+		{
+			pending.clear();
+			continue;
+		}
+
+		if( header._type != LOG_COMMIT )
+		{
+			PendingRecord record;
+			record._type = header._type;
+			record._name = std::string(name, header._nameLength);
+			record._pageNum = header._pageNum;
+			if( header._type == LOG_PAGE )
+				record._image.assign((char*)image, (char*)image + header._pageSize);
+			pending.push_back(record);
+			continue;
+		}
+
+		//operation is committed, so re-apply its records
+		for( unsigned int i = 0; i < pending.size() && errCode == 0; i++ )
+		{
+			PendingRecord& record = pending[i];
+			std::map<std::string, int>::iterator iter = files.find(record._name);
+
+			if( record._type == LOG_DESTROY )
+			{
+				if( iter != files.end() )
+				{
+					::close(iter->second);
+					files.erase(iter);
+				}
+
+				remove(record._name.c_str());
+				continue;
+			}
+
+			//file might have been removed after this record was logged; it is re-created and removed again by LOG_DESTROY
+			if( iter == files.end() )
+			{
+				int fd = ::open(record._name.c_str(), O_RDWR | O_CREAT, 0644);
+				if( fd < 0 )
+				{
+					errCode = -74;
+					break;
+				}
+				iter = files.insert(std::make_pair(record._name, fd)).first;
+			}
+
+			size_t pageSize = record._image.size();
+			if( pwrite(iter->second, &(record._image[0]), pageSize, (off_t)pageSize * record._pageNum) != (ssize_t)pageSize )
+			{
+				errCode = -74;
+			}
+		}
+
+		pending.clear();
+	}
+
+	//make re-applied pages durable, before log is emptied
+	for( std::map<std::string, int>::iterator iter = files.begin(); iter != files.end(); iter++ )
+	{
+		if( fsync(iter->second) != 0 )
+			errCode = -74;
+		::close(iter->second);
+	}
+
+	free(image);
+	fclose(logFile);
+
+	return errCode;
+}
+
+RC LogManager::open(const char* logFileName)
+{
+	RC errCode = 0;
+
+	if( (errCode = recover(logFileName)) != 0 )
+	{
+		return errCode;
+	}
+
+	//start with empty log (everything it had is applied to the data files)
+	if( (_fd = ::open(logFileName, O_RDWR | O_CREAT | O_TRUNC | O_APPEND, 0644)) < 0 )
+	{
+		return -74;
+	}
+
+	_logFileName = logFileName;
+	_bufferUsed = 0;
+	_fileSize = 0;
+	_pendingCommits = 0;
+	_writtenFiles.clear();
+
+	//success
+	return 0;
+}
+
+RC LogManager::close()
+{
+	if( _fd < 0 )
+		return 0;
+
+	RC errCode = flushAll();
+
+	::close(_fd);
+	_fd = -1;
+
+	return errCode;
+}
+
+RC LogManager::append(const LogRecordHeader& header, const std::string& fileName, const void* data)
+{
+	RC errCode = 0;
+
+	unsigned int szRecord = sizeof(LogRecordHeader) + header._nameLength + (header._type == LOG_PAGE ? header._pageSize : 0);
+
+	//make room in the log buffer
+	if( _bufferUsed + szRecord > LOG_BUFFER_SIZE && (errCode = writeBuffer()) != 0 )
+	{
+		return errCode;
+	}
+
+	memcpy(_buffer + _bufferUsed, &header, sizeof(LogRecordHeader));
+	memcpy(_buffer + _bufferUsed + sizeof(LogRecordHeader), fileName.c_str(), header._nameLength);
+	if( header._type == LOG_PAGE )
+		memcpy(_buffer + _bufferUsed + sizeof(LogRecordHeader) + header._nameLength, data, header._pageSize);
+
+	_bufferUsed += szRecord;
+	_recordCounter++;
+
+	//success
+	return 0;
+}
+
+RC LogManager::writeBuffer()
+{
+	unsigned int written = 0;
+
+	while( written < _bufferUsed )
+	{
+		ssize_t result = write(_fd, _buffer + written, _bufferUsed - written);
+		if( result <= 0 )
+			return -74;
+		written += result;
+	}
+
+	_fileSize += _bufferUsed;
+	_bufferUsed = 0;
+	_writtenLSN = _lastLSN;
+
+	//success
+	return 0;
+}
+
+RC LogManager::logPage(const std::string& fileName, PageNum pageNum, const void* data, const unsigned int pageSize, LSN& lsn)
+{
+	RC errCode = 0;
+
+	LogRecordHeader header;
+	memset(&header, 0, sizeof(LogRecordHeader));
+	header._type = LOG_PAGE;
+	header._pageNum = pageNum;
+	header._nameLength = fileName.size();
+	header._pageSize = pageSize;
+
+	pthread_mutex_lock(&_mutex);
+
+	header._lsn = lsn = ++_lastLSN;
+	header._checksum = checksumOfRecord(header, fileName.c_str(), data);
+
+	errCode = append(header, fileName, data);
+
+	pthread_mutex_unlock(&_mutex);
+
+	return errCode;
+}
+
+RC LogManager::logDestroy(const std::string& fileName, LSN& lsn)
+{
+	RC errCode = 0;
+
+	LogRecordHeader header;
+	memset(&header, 0, sizeof(LogRecordHeader));
+	header._type = LOG_DESTROY;
+	header._pageNum = 0;
+	header._nameLength = fileName.size();
+
+	pthread_mutex_lock(&_mutex);
+
+	header._lsn = lsn = ++_lastLSN;
+	header._checksum = checksumOfRecord(header, fileName.c_str(), NULL);
+
+	errCode = append(header, fileName, NULL);
+
+	pthread_mutex_unlock(&_mutex);
+
+	return errCode;
+}
+
+RC LogManager::appendEnd(const LogRecordType type, LSN& lsn)
+{
+	LogRecordHeader header;
+	memset(&header, 0, sizeof(LogRecordHeader));
+	header._type = type;
+	header._pageNum = 0;
+	header._nameLength = 0;
+
+	lsn = header._lsn = ++_lastLSN;
+	header._checksum = checksumOfRecord(header, "", NULL);
+
+	return append(header, "", NULL);
+}
+
+void LogManager::beginOperation()
+{
+	pthread_mutex_lock(&_mutex);
+	_activeOperations++;
+	pthread_mutex_unlock(&_mutex);
+}
+
+RC LogManager::commit(LSN& lsn)
+{
+	RC errCode = 0;
+
+	pthread_mutex_lock(&_mutex);
+
+	if( _activeOperations > 0 )
+		_activeOperations--;
+
+	if( (errCode = appendEnd(LOG_COMMIT, lsn)) == 0 )
+	{
+		_committedLSN = lsn;
+		_commitCounter++;
+		_pendingCommits++;
+	}
+
+	//leader of the group commit may be waiting for this operation
+	pthread_cond_broadcast(&_committedCond);
+
+	pthread_mutex_unlock(&_mutex);
+
+	return errCode;
+}
+
+RC LogManager::syncCommit(const LSN lsn)
+{
+	pthread_mutex_lock(&_mutex);
+
+	//group commit: let operations that are in progress join the fsync, until the group is full or the delay is over
+	if( _durableLSN < lsn && _syncing == false && _activeOperations > 0 && _pendingCommits < _groupCommitSize )
+	{
+		struct timespec deadline;
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		deadline.tv_nsec += LOG_GROUP_COMMIT_DELAY * 1000L;
+		deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+		deadline.tv_nsec %= 1000000000L;
+
+		while( _durableLSN < lsn && _syncing == false && _activeOperations > 0 && _pendingCommits < _groupCommitSize )
+		{
+			if( pthread_cond_timedwait(&_committedCond, &_mutex, &deadline) == ETIMEDOUT )
+				break;
+		}
+	}
+
+	pthread_mutex_unlock(&_mutex);
+
+	//commit returns only once its record is durable (the fsync is likely done by another committer)
+	return flush(lsn);
+}
+
+RC LogManager::abort()
+{
+	RC errCode = 0;
+	LSN lsn = 0;
+
+	pthread_mutex_lock(&_mutex);
+
+	if( _activeOperations > 0 )
+		_activeOperations--;
+
+	//records of the operation are discarded by recovery; there is nothing to sync, since they are not re-applied anyway
+	errCode = appendEnd(LOG_ABORT, lsn);
+
+	pthread_cond_broadcast(&_committedCond);
+
+	pthread_mutex_unlock(&_mutex);
+
+	return errCode;
+}
+
+RC LogManager::flush(LSN lsn)
+{
+	RC errCode = 0;
+
+	pthread_mutex_lock(&_mutex);
+
+	while( _durableLSN < lsn )
+	{
+		//somebody else is doing fsync; it may cover our records as well
+		if( _syncing )
+		{
+			pthread_cond_wait(&_syncedCond, &_mutex);
+			continue;
+		}
+
+		//move everything collected so far to the log file, and sync it without blocking other loggers
+		if( (errCode = writeBuffer()) != 0 )
+		{
+			break;
+		}
+
+		LSN target = _writtenLSN;
+		_syncing = true;
+		_pendingCommits = 0;
+
+		pthread_mutex_unlock(&_mutex);
+		int result = fdatasync(_fd);
+		pthread_mutex_lock(&_mutex);
+
+		_syncing = false;
+		_fsyncCounter++;
+
+		if( result != 0 )
+			errCode = -74;
+		else if( target > _durableLSN )
+			_durableLSN = target;
+
+		pthread_cond_broadcast(&_syncedCond);
+		pthread_cond_broadcast(&_committedCond);
+
+		if( errCode != 0 )
+			break;
+	}
+
+	pthread_mutex_unlock(&_mutex);
+
+	return errCode;
+}
+
+RC LogManager::flushAll()
+{
+	pthread_mutex_lock(&_mutex);
+	LSN lsn = _lastLSN;
+	pthread_mutex_unlock(&_mutex);
+
+	return flush(lsn);
+}
+
+void LogManager::noteDataWrite(const std::string& fileName)
+{
+	pthread_mutex_lock(&_mutex);
+	_writtenFiles.insert(fileName);
+	pthread_mutex_unlock(&_mutex);
+}
+
+RC LogManager::truncate()
+{
+	RC errCode = 0;
+
+	//move remaining records out of the buffer, so that nothing is written to the log after it is emptied
+	if( (errCode = flushAll()) != 0 )
+	{
+		return errCode;
+	}
+
+	pthread_mutex_lock(&_mutex);
+
+	//data pages written back since the last truncation have to be on stable storage, before their images are dropped
+	for( std::set<std::string>::iterator iter = _writtenFiles.begin(); iter != _writtenFiles.end(); iter++ )
+	{
+		int fd = ::open(iter->c_str(), O_RDWR);
+
+		//file has been destroyed in the meantime
+		if( fd < 0 )
+			continue;
+
+		if( fsync(fd) != 0 )
+			errCode = -74;
+
+		::close(fd);
+	}
+
+	if( errCode == 0 )
+	{
+		if( ftruncate(_fd, 0) != 0 )
+		{
+			errCode = -74;
+		}
+		else
+		{
+			_fileSize = 0;
+			_writtenFiles.clear();
+		}
+	}
+
+	pthread_mutex_unlock(&_mutex);
+
+	return errCode;
+}
+
+RC LogManager::syncDataFiles()
+{
+	RC errCode = 0;
+
+	//take the list, file that is written again in the meantime is noted again (fsync covers writes done before it only)
+	std::set<std::string> files;
+	pthread_mutex_lock(&_mutex);
+	files.swap(_writtenFiles);
+	pthread_mutex_unlock(&_mutex);
+
+	for( std::set<std::string>::iterator iter = files.begin(); iter != files.end(); iter++ )
+	{
+		int fd = ::open(iter->c_str(), O_RDWR);
+
+		//file has been destroyed in the meantime
+		if( fd < 0 )
+			continue;
+
+		//file that failed to sync stays on the list
+		if( fsync(fd) != 0 )
+		{
+			errCode = -74;
+
+			pthread_mutex_lock(&_mutex);
+			_writtenFiles.insert(*iter);
+			pthread_mutex_unlock(&_mutex);
+		}
+
+		::close(fd);
+	}
+
+	return errCode;
+}
+
+void LogManager::setGroupCommitSize(const unsigned int numCommits)
+{
+	pthread_mutex_lock(&_mutex);
+	_groupCommitSize = (numCommits == 0 ? 1 : numCommits);
+	_pendingCommits = 0;
+	pthread_mutex_unlock(&_mutex);
+}
+
+LSN LogManager::getCommittedLSN()
+{
+	pthread_mutex_lock(&_mutex);
+	LSN lsn = _committedLSN;
+	pthread_mutex_unlock(&_mutex);
+
+	return lsn;
+}
+
+LSN LogManager::getDurableLSN()
+{
+	pthread_mutex_lock(&_mutex);
+	LSN lsn = _durableLSN;
+	pthread_mutex_unlock(&_mutex);
+
+	return lsn;
+}
+
+unsigned long long LogManager::getLogSize()
+{
+	pthread_mutex_lock(&_mutex);
+	unsigned long long size = _fileSize + _bufferUsed;
+	pthread_mutex_unlock(&_mutex);
+
+	return size;
+}
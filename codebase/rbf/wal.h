@@ -0,0 +1,172 @@
+#ifndef _wal_h_
+#define _wal_h_
+
+#include <string>
+#include <set>
+#include <pthread.h>
+
+#include "../rbf/pfm.h"
+
+/*
+ * default number of commits that share a single fsync of the log (1 = fsync on every commit)
+**/
+#define LOG_DEFAULT_GROUP_COMMIT_SIZE 1
+/*
+ * longest time (in microseconds) that a commit waits for other operations to join its fsync
+**/
+#define LOG_GROUP_COMMIT_DELAY 2000
+/*
+ * size of the in-memory log buffer (it is written to the log file when full, but fsync-ed only on commit)
+**/
+#define LOG_BUFFER_SIZE (1024 * 1024)
+/*
+ * checkpoint is taken (and log is truncated) when log file grows beyond this size
+**/
+#define LOG_CHECKPOINT_SIZE (64 * 1024 * 1024)
+
+/*
+ * types of log records
+ * LOG_PAGE - redo image of the whole page
+ * LOG_COMMIT - all records since the previous commit form one atomic operation
+ * LOG_DESTROY - file has been removed
+ * LOG_ABORT - records since the previous commit belong to the operation that failed (they are discarded)
+**/
+typedef enum { LOG_PAGE = 1, LOG_COMMIT, LOG_DESTROY, LOG_ABORT } LogRecordType;
+
+/*
+ * header of the log record, followed by the file name (_nameLength bytes) and page image (_pageSize bytes, only for LOG_PAGE)
+**/
+struct LogRecordHeader
+{
+	/*
+	 * log sequence number, grows by one with every record
+	**/
+	LSN _lsn;
+	unsigned int _type;
+	PageNum _pageNum;
+	unsigned int _nameLength;
+	/*
+	 * size of the page image (only for LOG_PAGE)
+	**/
+	unsigned int _pageSize;
+	/*
+	 * checksum of the whole record (computed with this field set to 0), detects torn records at the end of log
+	**/
+	unsigned int _checksum;
+};
+
+/*
+ * write-ahead log of the paged file layer
+ *
+ * every page modification (FileHandle::writePage/appendPage/dirty unpinPage) is recorded as a full page image
+ * before the page is allowed to reach the data file. Records are collected in the log buffer and made durable by
+ * commit. Buffer pool keeps the LSN of the latest image of each cached page (page formats do not have spare bytes
+ * for it), does not write back pages of uncommitted operations, and forces the log up to page's LSN before writing
+ * the page back.
+ *
+ * durability: operation is durable once syncCommit of its commit record returns 0, i.e. nothing that has been
+ * reported as committed is lost by a crash. Group commit does not weaken this: committers wait for one shared
+ * fsync, whose leader gives the operations that are in progress up to LOG_GROUP_COMMIT_DELAY to join it (and
+ * does not wait at all when there are none), and the group is synced as soon as it has groupCommitSize commits.
+ *
+ * failed operation is aborted: its pages are restored by the buffer pool, and its records are discarded by recovery.
+ * recovery re-applies page images of committed operations in log order (images are complete, so re-applying
+ * them is idempotent) and ignores the incomplete operation at the end of log.
+**/
+class LogManager
+{
+public:
+	LogManager();
+	~LogManager();
+
+	//run redo recovery from the given log file, and start logging into it
+	RC open(const char* logFileName);
+	//stop logging (caller is expected to take checkpoint first)
+	RC close();
+
+	//append record to the log buffer
+	RC logPage(const std::string& fileName, PageNum pageNum, const void* data, const unsigned int pageSize, LSN& lsn);
+	RC logDestroy(const std::string& fileName, LSN& lsn);
+	//atomic operation is about to start (it is waited for by the leader of the group commit)
+	void beginOperation();
+	//end atomic operation by appending its commit record (it is not durable until syncCommit of the returned LSN)
+	RC commit(LSN& lsn);
+	//wait until the commit record is durable; fsync is shared with the operations that commit meanwhile (group commit)
+	RC syncCommit(const LSN lsn);
+	//end atomic operation that failed, so that its records are not re-applied by recovery
+	RC abort();
+	//make log durable up to the given LSN
+	RC flush(LSN lsn);
+	//make all records durable
+	RC flushAll();
+
+	//data file has been written, so it has to be fsync-ed before log is truncated
+	void noteDataWrite(const std::string& fileName);
+	//fsync data files written since the last truncation and empty the log (all records have to be durable and applied)
+	RC truncate();
+	//fsync data files written since the last truncation ahead of it (files are not locked meanwhile, so truncate has to
+	//sync only the ones written since then)
+	RC syncDataFiles();
+
+	void setGroupCommitSize(const unsigned int numCommits);
+	LSN getCommittedLSN();
+	LSN getDurableLSN();
+	unsigned long long getLogSize();
+
+	//statistics
+	unsigned int _recordCounter;
+	unsigned int _commitCounter;
+	unsigned int _fsyncCounter;
+
+protected:
+	RC append(const LogRecordHeader& header, const std::string& fileName, const void* data);
+	//append record that ends the operation (LOG_COMMIT or LOG_ABORT)
+	RC appendEnd(const LogRecordType type, LSN& lsn);
+	RC writeBuffer();
+	RC recover(const char* logFileName);
+
+private:
+	/*
+	 * log file descriptor (-1 if log is not opened)
+	**/
+	int _fd;
+	std::string _logFileName;
+	/*
+	 * log buffer and number of used bytes in it
+	**/
+	char* _buffer;
+	unsigned int _bufferUsed;
+	/*
+	 * size of the log file (not counting buffer)
+	**/
+	unsigned long long _fileSize;
+	/*
+	 * LSN of the last appended record, of the last commit record, of the last record written to the log file,
+	 * and of the last record that is known to be on stable storage
+	**/
+	LSN _lastLSN;
+	LSN _committedLSN;
+	LSN _writtenLSN;
+	LSN _durableLSN;
+	/*
+	 * group commit: maximal number of commits per fsync, commits that are not covered by fsync yet, and operations
+	 * that have begun but not committed (or aborted) yet
+	**/
+	unsigned int _groupCommitSize;
+	unsigned int _pendingCommits;
+	unsigned int _activeOperations;
+	/*
+	 * data files written since last truncation of the log
+	**/
+	std::set<std::string> _writtenFiles;
+	/*
+	 * guards all members; only one thread does fsync at a time, others wait on the condition and usually find
+	 * their records already durable. Leader of the group commit waits on the other condition for the commits
+	**/
+	pthread_mutex_t _mutex;
+	pthread_cond_t _syncedCond;
+	pthread_cond_t _committedCond;
+	bool _syncing;
+};
+
+#endif
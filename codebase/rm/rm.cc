@@ -965,6 +965,45 @@ RC RelationManager::printTable(const string& tableName) {
 }
 
 RelationManager::~RelationManager() {
+	//deallocate codecs of the tables
+	std::map<string, RecordCodec*>::iterator i = _recordCodecs.begin();
+	for( ; i != _recordCodecs.end(); i++ )
+		delete i->second;
+}
+
+RC RelationManager::getRecordCodec(const string& tableName, const RecordCodec*& codec)
+{
+	RC errCode = 0;
+
+	std::map<string, RecordCodec*>::iterator codecIter = _recordCodecs.find(tableName);
+	if( codecIter != _recordCodecs.end() )
+	{
+		codec = codecIter->second;
+		return errCode;
+	}
+
+	vector<Attribute> attrs;
+	//get the attributes for this table
+	if ((errCode = getAttributes(tableName, attrs)) != 0) {
+		//fail
+		return errCode;
+	}
+
+	RecordCodec* newCodec = RecordCodec::create(attrs);
+	_recordCodecs[tableName] = newCodec;
+	codec = newCodec;
+
+	return errCode;
+}
+
+void RelationManager::dropRecordCodec(const string& tableName)
+{
+	std::map<string, RecordCodec*>::iterator codecIter = _recordCodecs.find(tableName);
+	if( codecIter != _recordCodecs.end() )
+	{
+		delete codecIter->second;
+		_recordCodecs.erase(codecIter);
+	}
 }
 
 bool RelationManager::isTableExisiting(const std::string& tableName) {
@@ -972,7 +1011,8 @@ bool RelationManager::isTableExisiting(const std::string& tableName) {
 }
 
 RC RelationManager::createTable(const string &tableName,
-		const vector<Attribute> &attrs) {
+		const vector<Attribute> &attrs, const unsigned int pageSize,
+		const PageLayout layout) {
 	RC errCode = 0;
 
 	//checking the input arguments
@@ -986,7 +1026,7 @@ RC RelationManager::createTable(const string &tableName,
 	}
 
 	//create file for the table
-	if ((errCode = _rbfm->createFile(tableName)) != 0) {
+	if ((errCode = _rbfm->createFile(tableName, pageSize, layout)) != 0) {
 		//return error code
 		return errCode;
 	}
@@ -1308,6 +1348,9 @@ RC RelationManager::deleteTable(const string &tableName) {
 	//fast access for table information
 	TableInfo info = (*tableIter).second;
 
+	//codec of the table is not valid anymore
+	dropRecordCodec(tableName);
+
 	//1, remove record inside Tables
 	//find and remove record inside the table Tables for this table
 	if ((errCode = deleteTuple(CATALOG_TABLE_NAME, info._rid)) != 0) {
@@ -1574,12 +1617,13 @@ RC RelationManager::insertTuple(const string &tableName, const void *data,
 	if (tableName.empty() || data == NULL)
 		return -37;
 
-	vector<Attribute> attrs;
-	//get the attributes for this table
-	if ((errCode = getAttributes(tableName, attrs)) != 0) {
+	const RecordCodec* codec = NULL;
+	//get the codec of this table's records, along with the attributes it was built for
+	if ((errCode = getRecordCodec(tableName, codec)) != 0) {
 		//fail
 		return errCode;
 	}
+	const vector<Attribute>& attrs = codec->getRecordDescriptor();
 
 	//create the handle and open the table
 	FileHandle fileHandle;
@@ -1587,7 +1631,7 @@ RC RelationManager::insertTuple(const string &tableName, const void *data,
 		return errCode;
 
 	//insert the record
-	if ((errCode = _rbfm->insertRecord(fileHandle, attrs, data, rid)) != 0)
+	if ((errCode = _rbfm->insertRecord(fileHandle, attrs, data, rid, codec)) != 0)
 	{
 		//close file
 		_rbfm->closeFile(fileHandle);
@@ -1610,6 +1654,56 @@ RC RelationManager::insertTuple(const string &tableName, const void *data,
 
 }
 
+RC RelationManager::insertTuples(const string &tableName, const vector<const void*> &data,
+		vector<RID> &rids) {
+
+	RC errCode = 0;
+
+	//check if there is inconsistent data
+	if (tableName.empty())
+		return -37;
+
+	const RecordCodec* codec = NULL;
+	//get the codec of this table's records, along with the attributes it was built for
+	if ((errCode = getRecordCodec(tableName, codec)) != 0) {
+		//fail
+		return errCode;
+	}
+	const vector<Attribute>& attrs = codec->getRecordDescriptor();
+
+	//create the handle and open the table
+	FileHandle fileHandle;
+	if ((errCode = _rbfm->openFile(tableName, fileHandle)) != 0)
+		return errCode;
+
+	//insert the records (rids are returned for the records inserted before a failure)
+	errCode = _rbfm->insertRecords(fileHandle, attrs, data, rids, codec);
+
+	//insert records into IX component - into all indexes associated with this table
+	for (unsigned int i = 0; i < rids.size(); i++)
+	{
+		RC ixCode = insertIXEntry(tableName, attrs, data[i], rids[i]);
+		if (ixCode != 0)
+		{
+			//fail
+			_rbfm->closeFile(fileHandle);
+			return errCode != 0 ? errCode : ixCode;
+		}
+	}
+
+	if (errCode != 0)
+	{
+		//fail
+		_rbfm->closeFile(fileHandle);
+		return errCode;
+	}
+
+	errCode = _rbfm->closeFile(fileHandle);
+
+	return errCode;
+
+}
+
 RC RelationManager::deleteTuples(const string &tableName) {
 	RC errCode = 0;
 
@@ -1834,8 +1928,8 @@ RC RelationManager::deleteTuple(const string &tableName, const RID &rid) {
 	//but to do that, IX needs a key using which it can find the record inside its files organization
 
 	//so first need to read tuple
-	void* data = malloc(PAGE_SIZE);
-	memset(data, 0, PAGE_SIZE);
+	void* data = malloc(MAX_PAGE_SIZE);
+	memset(data, 0, MAX_PAGE_SIZE);
 	if ((errCode = _rbfm->readRecord(fileHandle, attrs, rid, data)) != 0)
 	{
 		_rbfm->closeFile(fileHandle);
@@ -1870,12 +1964,13 @@ RC RelationManager::updateTuple(const string &tableName, const void *data,
 	if (tableName.empty() || data == NULL || rid.pageNum == 0)
 		return -37;
 
-	vector<Attribute> attrs;
-	//get the attributes for this table
-	if ((errCode = getAttributes(tableName, attrs)) != 0) {
+	const RecordCodec* codec = NULL;
+	//get the codec of this table's records, along with the attributes it was built for
+	if ((errCode = getRecordCodec(tableName, codec)) != 0) {
 		//fail
 		return errCode;
 	}
+	const vector<Attribute>& attrs = codec->getRecordDescriptor();
 
 	//create the handle and open the table
 	FileHandle fileHandle;
@@ -1887,11 +1982,11 @@ RC RelationManager::updateTuple(const string &tableName, const void *data,
 	//it we could find and delete its records in all index files
 
 	//allocate buffer for storing "original" record
-	void* readInBuffer = malloc(PAGE_SIZE);
-	memset(readInBuffer, 0, PAGE_SIZE);
+	void* readInBuffer = malloc(MAX_PAGE_SIZE);
+	memset(readInBuffer, 0, MAX_PAGE_SIZE);
 
 	//read the original record
-	if ((errCode = _rbfm->readRecord(fileHandle, attrs, rid, readInBuffer)) != 0)
+	if ((errCode = _rbfm->readRecord(fileHandle, attrs, rid, readInBuffer, codec)) != 0)
 	{
 		free(readInBuffer);
 		_rbfm->closeFile(fileHandle);
@@ -1909,7 +2004,7 @@ RC RelationManager::updateTuple(const string &tableName, const void *data,
 	free(readInBuffer);
 
 	//update the record
-	if ((errCode = _rbfm->updateRecord(fileHandle, attrs, data, rid)) != 0)
+	if ((errCode = _rbfm->updateRecord(fileHandle, attrs, data, rid, codec)) != 0)
 	{
 		_rbfm->closeFile(fileHandle);
 		return errCode;
@@ -1936,12 +2031,13 @@ RC RelationManager::readTuple(const string &tableName, const RID &rid,
 	if (tableName.empty() || data == NULL || rid.pageNum == 0)
 		return -37;
 
-	vector<Attribute> attrs;
-	//get the attributes for this table
-	if ((errCode = getAttributes(tableName, attrs)) != 0) {
+	const RecordCodec* codec = NULL;
+	//get the codec of this table's records, along with the attributes it was built for
+	if ((errCode = getRecordCodec(tableName, codec)) != 0) {
 		//fail
 		return errCode;
 	}
+	const vector<Attribute>& attrs = codec->getRecordDescriptor();
 
 	//create the handle and open the table
 	FileHandle fileHandle;
@@ -1949,7 +2045,7 @@ RC RelationManager::readTuple(const string &tableName, const RID &rid,
 		return errCode;
 
 	//read the tuple
-	if ((errCode = _rbfm->readRecord(fileHandle, attrs, rid, data)) != 0)
+	if ((errCode = _rbfm->readRecord(fileHandle, attrs, rid, data, codec)) != 0)
 	{
 		_rbfm->closeFile(fileHandle);
 		return errCode;
@@ -2089,6 +2185,26 @@ RC RelationManager::scan(const string &tableName,
 	return errCode;
 }
 
+RC RelationManager::parallelScan(const string &tableName,
+		const string &conditionAttribute, const CompOp compOp,
+		const void *value, const vector<string> &attributeNames,
+		const unsigned int numWorkers, ParallelScan &parallelScan) {
+
+	RC errCode = 0;
+	//check if there is inconsistent data
+	if (tableName.empty())
+		return -37;
+
+	vector<Attribute> attrs;
+	//get the attributes for this table
+	if ((errCode = getAttributes(tableName, attrs)) != 0)
+		return errCode;
+
+	//workers open their own handles of the table
+	return parallelScan.open(tableName, attrs, conditionAttribute, compOp,
+			value, attributeNames, numWorkers);
+}
+
 // Extra credit
 RC RelationManager::dropAttribute(const string &tableName,
 		const string &attributeName) {
@@ -2098,6 +2214,9 @@ RC RelationManager::dropAttribute(const string &tableName,
 	if ((tableId = _catalogTable.find(tableName)->second._id) == 0) //get the table id)
 		return -31;	//accessing table that does not exist
 
+	//records are going to be read without the dropped attribute
+	dropRecordCodec(tableName);
+
 	//get columnInfo vector from catalog in memory
 	std::vector<ColumnInfo> columnsInfo = _catalogColumn[tableId];
 
@@ -2186,6 +2305,9 @@ RC RelationManager::addAttribute(const string &tableName,
 	if ((tableId = _catalogTable.find(tableName)->second._id) == 0) //get the table id)
 		return -32; // set error number
 
+	//records are going to be read with the added attribute
+	dropRecordCodec(tableName);
+
 	//open file and set handle
 	FileHandle columnHandle;
 	if ((errCode = _rbfm->openFile(CATALOG_COLUMN_NAME, columnHandle)) != 0) {
@@ -8,6 +8,8 @@
 #include <map>
 
 #include "../rbf/rbfm.h"
+#include "../rbf/pscan.h"
+#include "../rbf/codec.h"
 #include "../ix/ix.h"
 
 using namespace std;
@@ -60,7 +62,10 @@ class RelationManager
 public:
   static RelationManager* instance();
 
-  RC createTable(const string &tableName, const vector<Attribute> &attrs);
+  //pageSize is the size of the pages of the table file (power of two in [PAGE_SIZE, MAX_PAGE_SIZE]), LAYOUT_PAX groups values
+  //of each attribute together inside the pages (scans that project few attributes of the wide table touch less data)
+  RC createTable(const string &tableName, const vector<Attribute> &attrs, const unsigned int pageSize = PAGE_SIZE,
+		  const PageLayout layout = LAYOUT_ROW);
 
   RC deleteTable(const string &tableName);
 
@@ -68,6 +73,9 @@ public:
 
   RC insertTuple(const string &tableName, const void *data, RID &rid);
 
+  //insert batch of tuples (see RecordBasedFileManager::insertRecords), and their entries into all indexes of the table
+  RC insertTuples(const string &tableName, const vector<const void*> &data, vector<RID> &rids);
+
   RC deleteTuples(const string &tableName);
 
   RC deleteTuple(const string &tableName, const RID &rid);
@@ -89,6 +97,16 @@ public:
       const vector<string> &attributeNames, // a list of projected attributes
       RM_ScanIterator &rm_ScanIterator);
 
+  // parallel scan splits pages of the table between numWorkers threads (see ParallelScan), records come out in batches of
+  // the workers rather than in the order of the table
+  RC parallelScan(const string &tableName,
+      const string &conditionAttribute,
+      const CompOp compOp,
+      const void *value,
+      const vector<string> &attributeNames,
+      const unsigned int numWorkers,
+      ParallelScan &parallelScan);
+
   //delete catalog
   void cleanup();
 
@@ -161,6 +179,10 @@ protected:
   RC deleteIXEntry(const string& tableName, const std::vector<Attribute> attrs, const void* data, const RID& rid);
   // insert entry into IX index files
   RC insertIXEntry(const string& tableName, const std::vector<Attribute> attrs, const void* data, const RID& rid);
+  // get codec of the table's records (built from its attributes when the table is first accessed, see RecordCodec)
+  RC getRecordCodec(const string& tableName, const RecordCodec*& codec);
+  // forget codec of the table, once its attributes change or it is deleted
+  void dropRecordCodec(const string& tableName);
   RelationManager();
   ~RelationManager();
 
@@ -178,6 +200,9 @@ private:
   //hash map for quick lookup of index inside the catalog's Table of indexes
   std::map< int, std::map< std::string, IndexInfo > > _catalogIndex;	//<table id, <column name, index file name>>
 
+  //hash map of codecs specialized for the attributes of the tables, shared by all tuple operations on the table
+  std::map<string, RecordCodec*> _recordCodecs;	//<table name, codec of its records>
+
   //list of table IDs that are now unoccupied, and were used by the deleted tables
   std::stack<unsigned int> _freeTableIds;
 
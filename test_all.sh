@@ -13,3 +13,27 @@ make
 ./rbftest14
 ./rbftest15
 ./rbftest16
+./rbftest17
+./rbftest18
+./rbftest19
+./rbftest20
+./rbftest21
+./rbftest22
+./rbftest23
+./rbftest24
+./rbftest25
+./rbftest26
+./rbftest27
+./rbftest28
+./rbftest29
+./rbftest30
+./rbftest31
+./rbftest32
+./rbftest33
+./rbftest34
+./rbftest35
+./rbftest36
+./rbftest37
+./rbftest38
+./rbftest39
+./rbftest40